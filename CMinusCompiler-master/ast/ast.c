@@ -0,0 +1,136 @@
+/**
+ * ast.c
+ *
+ * Arena storage for Cminus syntax trees.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <util/general.h>
+#include "ast.h"
+
+#define INITIAL_NODES 1024		/**< nodes allocated for a new tree */
+#define INITIAL_STRINGS (16 * 1024)	/**< string bytes allocated for a new tree */
+
+/**
+ * Allocate an empty tree.
+ *
+ * @return a new tree
+ */
+Ast astAlloc() {
+	Ast ast = (Ast)malloc(sizeof(AstStruct));
+
+	ast->maxNodes = INITIAL_NODES;
+	ast->nodes = (AstNode*)malloc(ast->maxNodes * sizeof(AstNode));
+	ast->stringsMax = INITIAL_STRINGS;
+	ast->strings = (char*)malloc(ast->stringsMax);
+
+	astReset(ast);
+	return ast;
+}
+
+/**
+ * Empty a tree, keeping its storage for the next program.
+ *
+ * @param ast a tree
+ */
+void astReset(Ast ast) {
+	memset(&ast->nodes[AST_NULL],0,sizeof(AstNode));
+	ast->numNodes = AST_NULL + 1;
+	ast->strings[0] = '\0';
+	ast->stringsLength = 1;
+	ast->root = AST_NULL;
+}
+
+/**
+ * Free a tree.
+ *
+ * @param ast a tree
+ */
+void astFree(Ast ast) {
+	free(ast->nodes);
+	free(ast->strings);
+	free(ast);
+}
+
+/**
+ * Copy a spelling into the string array.
+ *
+ * @param ast a tree
+ * @param s a C string
+ * @return the offset of the copy
+ */
+static unsigned int addString(Ast ast, const char *s) {
+	unsigned int length = strlen(s) + 1;
+	unsigned int offset = ast->stringsLength;
+
+	if (offset + length > ast->stringsMax) {
+		while (offset + length > ast->stringsMax)
+			ast->stringsMax *= 2;
+		ast->strings = (char*)realloc(ast->strings,ast->stringsMax);
+	}
+
+	memcpy(ast->strings + offset,s,length);
+	ast->stringsLength += length;
+	return offset;
+}
+
+/**
+ * Add a node to a tree.
+ *
+ * @param ast a tree
+ * @param kind an AstKind
+ * @param line the source line of the node
+ * @param name the spelling of the node or NULL
+ * @param kid0 the first child or AST_NULL
+ * @param kid1 the second child or AST_NULL
+ * @param kid2 the third child or AST_NULL
+ * @return the index of the new node
+ */
+AstIndex astNode(Ast ast, int kind, int line, const char *name, AstIndex kid0, AstIndex kid1, AstIndex kid2) {
+	if (ast->numNodes == ast->maxNodes) {
+		ast->maxNodes *= 2;
+		ast->nodes = (AstNode*)realloc(ast->nodes,ast->maxNodes * sizeof(AstNode));
+	}
+
+	AstIndex index = ast->numNodes++;
+	AstNode *node = AST_NODE(ast,index);
+	node->kind = kind;
+	node->type = AST_TYPE_INTEGER;
+	node->line = line;
+	node->name = (name != NULL) ? addString(ast,name) : 0;
+	node->kid[0] = kid0;
+	node->kid[1] = kid1;
+	node->kid[2] = kid2;
+	node->next = AST_NULL;
+
+	return index;
+}
+
+/**
+ * Start a list with one node.
+ *
+ * @param ast a tree
+ * @param node the first node of the list
+ * @return the list
+ */
+AstList astListStart(Ast ast, AstIndex node) {
+	AstList list;
+	list.head = list.tail = node;
+	return list;
+}
+
+/**
+ * Append a node to a list.
+ *
+ * @param ast a tree
+ * @param list a list
+ * @param node the node to append
+ * @return the extended list
+ */
+AstList astListAppend(Ast ast, AstList list, AstIndex node) {
+	AST_NEXT(ast,list.tail) = node;
+	list.tail = node;
+	return list;
+}
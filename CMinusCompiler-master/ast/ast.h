@@ -0,0 +1,108 @@
+/**
+ * ast.h
+ *
+ * A compact abstract syntax tree for Cminus programs. All nodes of a program
+ * live in one contiguous, growable array and refer to each other through
+ * 32-bit indices, so the tree can be walked any number of times after parsing.
+ * Identifier and constant spellings live in a second array of characters.
+ *
+ */
+
+#ifndef AST_H_
+#define AST_H_
+
+#include <util/general.h>
+
+typedef unsigned int AstIndex;	/**< the index of a node in an Ast */
+
+#define AST_NULL 0	/**< the index of no node; slot 0 is never used */
+
+/**
+ * Node kinds. Unless noted, kid[0] and kid[1] are the operands of an expression.
+ */
+typedef enum AstKind_enum {
+	AST_PROGRAM,		/**< kid[0] global declarations, kid[1] functions */
+	AST_DECL,		/**< one declaration statement: type, kid[0] variables */
+	AST_VAR,		/**< a scalar variable declaration: name */
+	AST_ARRAY,		/**< an array variable declaration: name, kid[0] the AST_CONST size */
+	AST_FUNCTION,		/**< name, kid[0] local declarations, kid[1] statements */
+	AST_ASSIGN,		/**< kid[0] variable, kid[1] expression */
+	AST_IF,			/**< kid[0] test, kid[1] then part, kid[2] else part or AST_NULL */
+	AST_WHILE,		/**< kid[0] test, kid[1] body */
+	AST_READ,		/**< kid[0] variable */
+	AST_WRITE,		/**< kid[0] expression or AST_STRING */
+	AST_RETURN,		/**< kid[0] expression */
+	AST_EXIT,
+	AST_BLOCK,		/**< kid[0] statements */
+	AST_OR,
+	AST_AND,
+	AST_NOT,		/**< kid[0] operand */
+	AST_EQ,
+	AST_NE,
+	AST_LE,
+	AST_LT,
+	AST_GE,
+	AST_GT,
+	AST_ADD,
+	AST_SUB,
+	AST_MUL,
+	AST_DIV,
+	AST_LOAD,		/**< the value of kid[0], an AST_VAR_ADDR or AST_ARRAY_ADDR */
+	AST_CONST,		/**< an integer constant: name is its spelling */
+	AST_STRING,		/**< a string constant: name is its spelling, quotes included */
+	AST_CALL,		/**< a call of the function name */
+	AST_VAR_ADDR,		/**< the address of the variable name */
+	AST_ARRAY_ADDR,		/**< the address of name[kid[0]] */
+	AST_NUM_KINDS
+} AstKind;
+
+#define AST_TYPE_INTEGER 0	/**< AST_DECL type of int declarations */
+#define AST_TYPE_FLOAT 1	/**< AST_DECL type of float declarations */
+
+/**
+ * A node of the tree. Lists (declarations, functions, statements) are chained
+ * through next.
+ */
+typedef struct AstNode_struct {
+	unsigned short kind;	/**< an AstKind */
+	unsigned short type;	/**< the declared type of an AST_DECL */
+	unsigned int line;	/**< the source line at which the node was parsed */
+	unsigned int name;	/**< offset of the node's spelling in the string array */
+	AstIndex kid[3];	/**< children */
+	AstIndex next;		/**< the next node of a list */
+} AstNode;
+
+/**
+ * A list under construction: both ends are kept so appending is constant time.
+ */
+typedef struct AstList_struct {
+	AstIndex head;
+	AstIndex tail;
+} AstList;
+
+/**
+ * The storage for one program.
+ */
+typedef struct Ast_struct {
+	AstNode *nodes;		/**< all nodes; nodes[AST_NULL] is unused */
+	unsigned int numNodes;
+	unsigned int maxNodes;
+	char *strings;		/**< all spellings, each NUL-terminated */
+	unsigned int stringsLength;
+	unsigned int stringsMax;
+	AstIndex root;		/**< the AST_PROGRAM node */
+} AstStruct, *Ast;
+
+#define AST_NODE(ast,index) (&(ast)->nodes[(index)])			/**< the node at an index */
+#define AST_NAME(ast,index) ((ast)->strings + (ast)->nodes[(index)].name)	/**< the spelling of a node */
+#define AST_KID(ast,index,i) ((ast)->nodes[(index)].kid[(i)])			/**< a child of a node */
+#define AST_NEXT(ast,index) ((ast)->nodes[(index)].next)			/**< the next node of a list */
+
+EXTERN(Ast, astAlloc, (void));
+EXTERN(void, astReset, (Ast ast));
+EXTERN(void, astFree, (Ast ast));
+EXTERN(AstIndex, astNode, (Ast ast, int kind, int line, const char *name, AstIndex kid0, AstIndex kid1, AstIndex kid2));
+EXTERN(AstList, astListStart, (Ast ast, AstIndex node));
+EXTERN(AstList, astListAppend, (Ast ast, AstList list, AstIndex node));
+
+#endif /* AST_H_ */
@@ -0,0 +1,398 @@
+/**
+ * cache.c
+ *
+ * The on-disk cache of generated functions.
+ *
+ * An entry is the magic string, the key, the number of data declarations,
+ * each declaration, and the instructions as one block of lines. Declarations
+ * and the block are each a 32-bit length followed by their characters.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <util/general.h>
+#include <util/dlink.h>
+#include <util/string_utils.h>
+#include "mir.h"
+#include "cache.h"
+
+#define CACHE_MAGIC "cmc-cache 2\n"	/**< the start of every entry; change it when the format changes */
+#define CACHE_MAGIC_LENGTH 12
+#define MAX_ENTRY_TEXT (64 * 1024 * 1024)	/**< the longest text accepted from an entry */
+
+#define LABEL_PREFIX ".L"
+#define STRING_PREFIX ".string_const"
+
+/**
+ * Mix one 64-bit word into a key.
+ */
+static inline void mixWord(CacheKey *key, uint64_t word) {
+	key->h1 = (key->h1 ^ word) * 0x100000001b3ULL;
+	key->h2 = (key->h2 + word) * 0x9e3779b97f4a7c15ULL;
+	key->h2 ^= key->h2 >> 29;
+}
+
+/**
+ * Add bytes to a key, eight at a time.
+ *
+ * @param key a key
+ * @param data the bytes
+ * @param length the number of bytes
+ */
+void cacheKeyAdd(CacheKey *key, const void *data, size_t length) {
+	const unsigned char *p = (const unsigned char*)data;
+	uint64_t word;
+
+	mixWord(key,length);
+	for (; length >= sizeof(word); p += sizeof(word), length -= sizeof(word)) {
+		memcpy(&word,p,sizeof(word));
+		mixWord(key,word);
+	}
+	if (length > 0) {
+		word = 0;
+		memcpy(&word,p,length);
+		mixWord(key,word);
+	}
+}
+
+/**
+ * Add a string to a key.
+ *
+ * @param key a key
+ * @param s a C string
+ */
+void cacheKeyAddString(CacheKey *key, const char *s) {
+	cacheKeyAdd(key,s,strlen(s));
+}
+
+/**
+ * Add a number to a key.
+ *
+ * @param key a key
+ * @param n a number
+ */
+void cacheKeyAddInt(CacheKey *key, long n) {
+	mixWord(key,(uint64_t)n);
+}
+
+/**
+ * Start a key with the hash of the compiler and its flags.
+ *
+ * @param cache a cache
+ * @param key the key to start
+ */
+void cacheKeyInit(CodeCache cache, CacheKey *key) {
+	*key = cache->salt;
+}
+
+/**
+ * Open a cache directory, creating it if needed. The running executable is
+ * part of every key, so a rebuilt compiler never uses entries of an old one.
+ *
+ * @param dir the cache directory
+ * @param flags the options that change the generated code
+ * @return the cache or NULL if the directory cannot be created
+ */
+CodeCache cacheOpen(char *dir, char *flags) {
+	char buf[64 * 1024];
+	size_t n;
+
+	if (mkdir(dir,0777) != 0 && errno != EEXIST) {
+		fprintf(stderr,"Error: Could not create cache directory %s: %s\n",dir,strerror(errno));
+		return NULL;
+	}
+
+	CodeCache cache = (CodeCache)malloc(sizeof(CodeCacheStruct));
+	cache->dir = ssave(dir);
+	cache->hits = cache->misses = cache->stores = 0;
+	cache->salt.h1 = 0xcbf29ce484222325ULL;
+	cache->salt.h2 = 0x6a09e667f3bcc908ULL;
+
+	cacheKeyAdd(&cache->salt,CACHE_MAGIC,CACHE_MAGIC_LENGTH);
+	FILE *exe = fopen("/proc/self/exe","r");
+	if (exe != NULL) {
+		while ((n = fread(buf,1,sizeof(buf),exe)) > 0)
+			cacheKeyAdd(&cache->salt,buf,n);
+		fclose(exe);
+	} else
+		cacheKeyAddString(&cache->salt,__DATE__ " " __TIME__);
+	cacheKeyAddString(&cache->salt,flags);
+
+	return cache;
+}
+
+/**
+ * Free a cache.
+ *
+ * @param cache a cache
+ */
+void cacheClose(CodeCache cache) {
+	sfree(cache->dir);
+	free(cache);
+}
+
+/**
+ * Print the hits, misses and stores of this process to stderr.
+ *
+ * @param cache a cache
+ */
+void cachePrintStatistics(CodeCache cache) {
+	int lookups = cache->hits + cache->misses;
+
+	fprintf(stderr,"cache: %d hits, %d misses (%d%% hit rate), %d stores\n",
+		cache->hits,cache->misses,lookups ? (100 * cache->hits) / lookups : 0,cache->stores);
+}
+
+/**
+ * Get the path of the entry for a key.
+ *
+ * @param cache a cache
+ * @param key a key
+ * @return the path; the caller frees it
+ */
+static char *entryPath(CodeCache cache, CacheKey *key) {
+	char name[40];
+
+	snprintf(name,sizeof(name),"/%016llx%016llx",(unsigned long long)key->h1,(unsigned long long)key->h2);
+	return nssave(2,cache->dir,name);
+}
+
+/**
+ * Copy text, adding a delta to the number of every label and string constant
+ * in it.
+ *
+ * @param text instructions or a data declaration
+ * @param length the length of text
+ * @param labelDelta the amount to add to label numbers
+ * @param stringDelta the amount to add to string constant numbers
+ * @param leadingOnly only renumber a label at the start of the text; the
+ * 	  rest of a data declaration is the contents of a string
+ * @return the renumbered copy
+ */
+static char *renumber(const char *text, size_t length, int labelDelta, int stringDelta, bool leadingOnly) {
+	const char *p = text, *end = text + length;
+	size_t max = length + 1, used = 0;
+	char *copy = (char*)malloc(max);
+
+	if (labelDelta == 0 && stringDelta == 0) {
+		memcpy(copy,text,length);
+		copy[length] = '\0';
+		return copy;
+	}
+
+	while (p < end) {
+		const char *dot = leadingOnly ? (p == text && *p == '.' ? p : NULL) : memchr(p,'.',end - p);
+		const char *chunkEnd = (dot != NULL) ? dot : end;
+		size_t prefix = 0;
+		int delta = 0;
+
+		if (dot != NULL) {
+			if ((size_t)(end - dot) > strlen(STRING_PREFIX) && strncmp(dot,STRING_PREFIX,strlen(STRING_PREFIX)) == 0)
+				prefix = strlen(STRING_PREFIX), delta = stringDelta;
+			else if ((size_t)(end - dot) > strlen(LABEL_PREFIX) && strncmp(dot,LABEL_PREFIX,strlen(LABEL_PREFIX)) == 0)
+				prefix = strlen(LABEL_PREFIX), delta = labelDelta;
+			if (prefix > 0 && (dot[prefix] < '0' || dot[prefix] > '9'))
+				prefix = 0;
+			if (prefix == 0)
+				chunkEnd = dot + 1;
+		}
+
+		if (used + (chunkEnd - p) + prefix + 24 > max) {
+			max = 2 * max + (chunkEnd - p) + prefix + 24;
+			copy = (char*)realloc(copy,max);
+		}
+		memcpy(copy + used,p,chunkEnd - p);
+		used += chunkEnd - p;
+		p = chunkEnd;
+
+		if (prefix > 0) {
+			char *numberEnd;
+			long number = strtol(p + prefix,&numberEnd,10);
+			memcpy(copy + used,p,prefix);
+			used += prefix;
+			used += sprintf(copy + used,"%ld",number + delta);
+			p = numberEnd;
+		}
+	}
+
+	copy[used] = '\0';
+	return copy;
+}
+
+/**
+ * Write text, renumbered, to an entry.
+ *
+ * @return false if the write failed
+ */
+static bool writeText(FILE *fp, const char *text, size_t length, int labelBase, int stringBase, bool leadingOnly) {
+	char *copy = renumber(text,length,-labelBase,-stringBase,leadingOnly);
+	uint32_t copyLength = strlen(copy);
+	bool ok = fwrite(&copyLength,sizeof(copyLength),1,fp) == 1 && fwrite(copy,1,copyLength,fp) == copyLength;
+
+	free(copy);
+	return ok;
+}
+
+/**
+ * Read text from an entry and renumber it.
+ *
+ * @param buf a buffer that grows to the longest text read into it
+ * @param max the size of buf
+ * @return the renumbered text or NULL if the entry is short or damaged
+ */
+static char *readText(FILE *fp, char **buf, uint32_t *max, int labelBase, int stringBase, bool leadingOnly) {
+	uint32_t length;
+
+	if (fread(&length,sizeof(length),1,fp) != 1 || length > MAX_ENTRY_TEXT)
+		return NULL;
+	if (length + 1 > *max) {
+		*max = length + 1;
+		*buf = (char*)realloc(*buf,*max);
+	}
+	if (fread(*buf,1,length,fp) != length)
+		return NULL;
+
+	return renumber(*buf,length,labelBase,stringBase,leadingOnly);
+}
+
+/**
+ * Look up the code of a function.
+ *
+ * @param cache a cache
+ * @param key the key of the function
+ * @param labelBase the number of the function's first label
+ * @param stringBase the number of the function's first string constant
+ * @param instList the list to append the instructions to
+ * @param dataList the list to append the data declarations to
+ * @return true on a hit
+ */
+bool cacheLoad(CodeCache cache, CacheKey *key, int labelBase, int stringBase, DList instList, DList dataList) {
+	char *path = entryPath(cache,key);
+	FILE *fp = fopen(path,"r");
+	char magic[CACHE_MAGIC_LENGTH];
+	CacheKey entryKey;
+	uint32_t i, numData, max = 0;
+	char *buf = NULL, *text = NULL;
+	bool hit = false;
+
+	sfree(path);
+	if (fp != NULL) {
+		DList data = dlinkListAlloc(NULL);
+
+		hit = fread(magic,1,CACHE_MAGIC_LENGTH,fp) == CACHE_MAGIC_LENGTH &&
+		      memcmp(magic,CACHE_MAGIC,CACHE_MAGIC_LENGTH) == 0 &&
+		      fread(&entryKey,sizeof(entryKey),1,fp) == 1 &&
+		      entryKey.h1 == key->h1 && entryKey.h2 == key->h2 &&
+		      fread(&numData,sizeof(numData),1,fp) == 1;
+		for (i = 0; hit && i < numData; i++) {
+			char *decl = readText(fp,&buf,&max,labelBase,stringBase,true);
+			if (decl != NULL)
+				dlinkAppend(data,dlinkNodeAlloc(decl));
+			else
+				hit = false;
+		}
+		if (hit)
+			hit = (text = readText(fp,&buf,&max,labelBase,stringBase,false)) != NULL;
+		fclose(fp);
+		free(buf);
+
+		if (hit) {
+			DNode node;
+			while ((node = dlinkPop(data)) != NULL)
+				dlinkAppend(dataList,node);
+			dlinkAppend(instList,dlinkNodeAlloc((Generic)mirText(text)));
+		}
+		dlinkFreeNodesAndAtoms(data);
+		dlinkListFree(data);
+	}
+
+	if (hit)
+		cache->hits++;
+	else
+		cache->misses++;
+	return hit;
+}
+
+/**
+ * Count the nodes of a list.
+ */
+static uint32_t listLength(DList list) {
+	uint32_t length = 0;
+	DNode node;
+
+	for (node = dlinkHead(list); node != NULL; node = dlinkNext(node))
+		length++;
+	return length;
+}
+
+/**
+ * Store the code of a function. The instructions are printed and stored as
+ * one block of lines, which comes back from cacheLoad as a single TEXT
+ * instruction. The entry is written
+ * under a temporary name and renamed, so readers see either no entry or a
+ * whole one.
+ *
+ * @param cache a cache
+ * @param key the key of the function
+ * @param labelBase the number of the function's first label
+ * @param stringBase the number of the function's first string constant
+ * @param instList the instructions of the function
+ * @param dataList the data declarations of the function
+ */
+void cacheStore(CodeCache cache, CacheKey *key, int labelBase, int stringBase, DList instList, DList dataList) {
+	char *tmpPath = nssave(2,cache->dir,"/tmp.XXXXXX");
+	int fd = mkstemp(tmpPath);
+	FILE *fp = (fd >= 0) ? fdopen(fd,"w") : NULL;
+	DNode node;
+
+	if (fp == NULL) {
+		if (fd >= 0) {
+			close(fd);
+			unlink(tmpPath);
+		}
+		sfree(tmpPath);
+		return;
+	}
+
+	size_t length = 0, max = 4096;
+	char *text = (char*)malloc(max);
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node)) {
+		MirInst inst = (MirInst)dlinkNodeAtom(node);
+		if (length > 0)
+			text[length++] = '\n';
+		size_t instLength = mirFormat(inst,text + length,max - length);
+		if (length + instLength + 2 > max) {
+			max = 2 * max + instLength + 2;
+			text = (char*)realloc(text,max);
+			mirFormat(inst,text + length,max - length);
+		}
+		length += instLength;
+	}
+
+	uint32_t numData = listLength(dataList);
+	bool ok = fwrite(CACHE_MAGIC,1,CACHE_MAGIC_LENGTH,fp) == CACHE_MAGIC_LENGTH &&
+		  fwrite(key,sizeof(*key),1,fp) == 1 &&
+		  fwrite(&numData,sizeof(numData),1,fp) == 1;
+	for (node = dlinkHead(dataList); ok && node != NULL; node = dlinkNext(node)) {
+		char *decl = (char*)dlinkNodeAtom(node);
+		ok = writeText(fp,decl,strlen(decl),labelBase,stringBase,true);
+	}
+	ok = ok && writeText(fp,text,length,labelBase,stringBase,false);
+	ok = (fclose(fp) == 0) && ok;
+	free(text);
+
+	char *path = entryPath(cache,key);
+	if (ok && rename(tmpPath,path) == 0)
+		cache->stores++;
+	else
+		unlink(tmpPath);
+
+	sfree(path);
+	sfree(tmpPath);
+}
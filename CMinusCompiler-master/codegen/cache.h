@@ -0,0 +1,53 @@
+/**
+ * cache.h
+ *
+ * An on-disk cache of the code generated for single functions. Entries are
+ * addressed by a 128-bit hash of everything the code of a function depends
+ * on, and hold its instructions and data declarations with label and string
+ * constant numbers relative to the function's first ones, so an entry can be
+ * reused wherever the function lands in a program.
+ *
+ * Each entry is written to a temporary file and renamed into place, so any
+ * number of compiles may share a cache directory.
+ *
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <stdint.h>
+#include <util/general.h>
+#include <util/dlink.h>
+
+/**
+ * The hash of a function and its environment.
+ */
+typedef struct CacheKey_struct {
+	uint64_t h1;
+	uint64_t h2;
+} CacheKey;
+
+/**
+ * A cache directory and the statistics of its use by this process.
+ */
+typedef struct CodeCache_struct {
+	char *dir;		/**< the directory holding the entries */
+	CacheKey salt;		/**< the hash of the compiler and its flags, the start of every key */
+	int hits;
+	int misses;
+	int stores;		/**< entries written */
+} CodeCacheStruct, *CodeCache;
+
+EXTERN(CodeCache, cacheOpen, (char *dir, char *flags));
+EXTERN(void, cacheClose, (CodeCache cache));
+EXTERN(void, cachePrintStatistics, (CodeCache cache));
+
+EXTERN(void, cacheKeyInit, (CodeCache cache, CacheKey *key));
+EXTERN(void, cacheKeyAdd, (CacheKey *key, const void *data, size_t length));
+EXTERN(void, cacheKeyAddString, (CacheKey *key, const char *s));
+EXTERN(void, cacheKeyAddInt, (CacheKey *key, long n));
+
+EXTERN(bool, cacheLoad, (CodeCache cache, CacheKey *key, int labelBase, int stringBase, DList instList, DList dataList));
+EXTERN(void, cacheStore, (CodeCache cache, CacheKey *key, int labelBase, int stringBase, DList instList, DList dataList));
+
+#endif /* CACHE_H_ */
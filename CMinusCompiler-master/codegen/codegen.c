@@ -1,86 +1,143 @@
 #include <stdio.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <util/string_utils.h>
 #include <util/symtab.h>
 #include <util/dlink.h>
+#include <util/output.h>
 #include "reg.h"
+#include "mir.h"
 #include "codegen.h"
 #include "symfields.h"
 #include "types.h"
 
 extern int globalOffset;
 
+EXTERN(void,Cminus_error,(char*));
+
 /**
  * Print a data declaration to stdout. This function is called by dlinkApply only.
  *
  * @param decl a DNode containing a data declaration
  */
 static void printDataDeclaration(DNode decl) {
-	printf("%s\n",(char*)dlinkNodeAtom(decl));
+	outputLine((char*)dlinkNodeAtom(decl));
 }
 
 /**
- * Emit the assembly prologue for a procedure
+ * The callee-saved registers, in the order they are pushed.
  */
-void emitProcedurePrologue(DList instList,SymTable symtab, int index) {
-	char *name = (char*)SymGetFieldByIndex(symtab,index,SYM_NAME_FIELD); 
-	char* inst = nssave(2,"\t.globl ",name);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+static const int calleeSavedRegisters[] = { MIR_RBX, MIR_R12, MIR_R13, MIR_R14, MIR_R15 };
 
-	inst = nssave(3,"\t.type ",name,",@function");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+#define NUM_CALLEE_SAVED ((int)(sizeof(calleeSavedRegisters) / sizeof(calleeSavedRegisters[0])))
 
-	inst = nssave(2,name,":\tnop");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Append an instruction to a list of instructions.
+ *
+ * @param instList a DList of instructions
+ * @param inst the instruction
+ */
+static void append(DList instList, MirInst inst) {
+	dlinkAppend(instList,dlinkNodeAlloc((Generic)inst));
+}
 
-	inst = ssave("\tpushq %rbp");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Return the operand for the register of a symbol table entry.
+ *
+ * @param symtab a symbol table
+ * @param regIndex the symbol table index of a register
+ * @param size 4 for the 32-bit register, 8 for the 64-bit one
+ * @return see above
+ */
+static MirOperand regOperand(SymTable symtab, int regIndex, int size) {
+	int reg = (int)(long)SymGetFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD);
+	return mirReg(getIntegerRegisterNumber(reg),size);
+}
 
-	inst = ssave("\tmovq %rsp, %rbp");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Return the operand for a label made by makeLabel.
+ *
+ * @param symtab a symbol table
+ * @param labelIndex the symbol table index of the label
+ * @return see above
+ */
+static MirOperand labelOperand(SymTable symtab, int labelIndex) {
+	char *label = (char*)SymGetFieldByIndex(symtab,labelIndex,SYM_NAME_FIELD);
+	return mirLabel(atoi(label + 2));
+}
+
+/**
+ * Emit the assembly prologue for a procedure, up to where its frame is set
+ * up by emitStartFunction.
+ */
+void emitProcedurePrologue(DList instList,SymTable symtab, int index) {
+	char *name = (char*)SymGetFieldByIndex(symtab,index,SYM_NAME_FIELD); 
+	append(instList,mirInst1(MIR_GLOBL,0,mirSymbol(name)));
+	append(instList,mirInst1(MIR_TYPE,0,mirSymbol(name)));
+	append(instList,mirInst1(MIR_LABEL,0,mirSymbol(name)));
+	append(instList,mirInst(MIR_NOP,0));
+}
+
+/**
+ * Print the assembly prologue that includes the format strings and the global
+ * storage, and switch to the text section for the functions.
+ */
+void emitDataPrologue() {
+	outputString("\t.section\t.rodata\n"
+		     "\t.int_wformat: .string \"%d\\n\"\n"
+		     "\t.float_wformat: .string \"%f\\n\"\n"
+		     "\t.str_wformat: .string \"%s\\n\"\n"
+		     "\t.int_rformat: .string \"%d\"\n"
+		     "\t.float_rformat: .string \"%f\"\n");
+	if (globalOffset != 0) {
+		outputString("\t.comm _gp, ");
+		outputLong(globalOffset);
+		outputString(", 4\n");
+	}
+	outputString("\t.text\n");
 }
 
 /**
- * Print the assembly prologue that includes the data section, a declaration of main and an allocation of stack space
- * for the main routine.
+ * Print the data declarations of the program after its functions. The
+ * functions are printed as soon as they are generated, so the string
+ * constants they use are only known at the end.
  *
  * @param dataList a list of data declarations (strings and floats)
- * @param frameSize The number of bytes need for local variables declared in main
- */
-void emitDataPrologue(DList dataList) {
-	printf("\t.section\t.rodata\n");
-	printf("\t.int_wformat: .string \"%%d\\n\"\n");
-	printf("\t.float_wformat: .string \"%%f\\n\"\n");
-	printf("\t.str_wformat: .string \"%%s\\n\"\n");
-	printf("\t.int_rformat: .string \"%%d\"\n");
-	printf("\t.float_rformat: .string \"%%f\"\n");
-	if (globalOffset != 0)
-		printf("\t.comm _gp, %d, 4\n",globalOffset);  
-		                                              
+ */
+void emitDataDeclarations(DList dataList) {
+	if (dlinkListEmpty(dataList))
+		return;
+
+	outputString("\t.section\t.rodata\n");
 	dlinkApply(dataList,(DLinkApplyFunc)printDataDeclaration);
-	printf("\t.text\n");
 }
 
 /**
  * Print an assembly instruction to stdout. This function is only called by dlinkApply.
  *
- * @param inst a DNode containing an assembly instruction.
+ * @param inst a DNode containing an instruction.
  */
 static void printInstruction(DNode inst) {
-	printf("%s\n",(char*)dlinkNodeAtom(inst));
+	mirPrint((MirInst)dlinkNodeAtom(inst));
 }
 
 /**
  * Print all of the assembly instructions for the main routine to stdout.
  *
- * @param instList a DList of assembly instructions.
+ * @param instList a DList of instructions.
  */
 void emitInstructions(DList instList) {
 	dlinkApply(instList,(DLinkApplyFunc)printInstruction);
 }
 
 
+/**
+ * Return from a function. The epilogue of emitEndFunction is added before the
+ * return once the frame of the function is known.
+ *
+ * @param instList a Dlist of instructions
+ */
 void emitExit(DList instList) {
 
   /*char *inst = ssave("\tmov dword ptr [%esp], 0");
@@ -88,10 +145,7 @@ void emitExit(DList instList) {
 	inst = ssave("\tcall exit");
 	dlinkAppend(instList,dlinkNodeAlloc(inst));*/
 
-  char *inst = ssave("\tleave");
-  dlinkAppend(instList,dlinkNodeAlloc(inst));
-  inst = ssave("\tret");
-  dlinkAppend(instList,dlinkNodeAlloc(inst));
+  append(instList,mirInst(MIR_RET,0));
 }
 
 /**
@@ -99,27 +153,11 @@ void emitExit(DList instList) {
  *
  * @param instList a DList of assembly instructions
  * @param symtab a symbol table
- * @param lhsRegIndex the symbol table index of the register for the l-value address
+ * @param lhs the memory operand of the l-value
  * @param rhsRegIndex the symbol table index of the register for the r-value
  */
-void emitAssignment(DList instList, SymTable lsymtab, SymTable rsymtab, int lhsRegIndex, int rhsRegIndex) {
-	char *inst;
-	int test = 1;
-	char *regName = (char*)SymGetFieldByIndex(rsymtab,rhsRegIndex,SYM_NAME_FIELD);
-	char *setName = get64bitIntegerRegisterName(rsymtab, lhsRegIndex);
-	if (setName == NULL) {
-		test = 0;
-		setName = get64bitIntegerRegisterName(lsymtab, lhsRegIndex);
-	}
-
-	inst = nssave(5,  "\tmovl ", regName, ", (", setName, ")");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-	freeIntegerRegister((int)SymGetFieldByIndex(rsymtab,rhsRegIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	if (test) {
-		freeIntegerRegister((int)SymGetFieldByIndex(rsymtab,lhsRegIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	} else {
-		freeIntegerRegister((int)SymGetFieldByIndex(lsymtab,lhsRegIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	}
+void emitAssignment(DList instList, SymTable symtab, MirOperand lhs, int rhsRegIndex) {
+	append(instList,mirInst2(MIR_MOV,4,regOperand(symtab,rhsRegIndex,4),lhs));
 }
 
 /**
@@ -130,18 +168,27 @@ void emitAssignment(DList instList, SymTable lsymtab, SymTable rsymtab, int lhsR
  * @param addrIndex the symbol table index of the register holding the address that is to be read into
  */
 void emitReadVariable(DList instList, SymTable symtab, int addrIndex) {
-	char *inst = nssave(3,"\tmovl $", READ_INTEGER_FMT, ", %edi");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_MOV,4,mirSymbolImm(READ_INTEGER_FMT,0),mirReg(MIR_RDI,4)));
+	append(instList,mirInst2(MIR_MOV,8,regOperand(symtab,addrIndex,8),mirReg(MIR_RSI,8)));
+	append(instList,mirInst2(MIR_MOV,4,mirImm(0),mirReg(MIR_RAX,4)));
+	append(instList,mirInst1(MIR_CALL,0,mirSymbol("scanf")));
+}
 
-	inst = nssave(3,"\tmovl ", (char*)SymGetFieldByIndex(symtab,addrIndex,SYM_NAME_FIELD), ", %esi");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+static __thread int labelCount = 0;	/**< the number of the next label */
+static __thread int stringNum = 0;	/**< the number of the next string constant */
+__thread int codegenErrors = 0;		/**< the number of errors reported on this thread */
 
-	inst = ssave("\tmovl $0, %eax");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = ssave("\tcall scanf");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,addrIndex,SYMTAB_REGISTER_INDEX_FIELD));
+/**
+ * Set the numbers of the next label and string constant. Functions that are
+ * generated separately use this to number their labels as if they were
+ * generated one after another.
+ *
+ * @param labelNum the number of the next label
+ * @param stringNumber the number of the next string constant
+ */
+void setLabelNumbers(int labelNum, int stringNumber) {
+	labelCount = labelNum;
+	stringNum = stringNumber;
 }
 
 /**
@@ -149,10 +196,29 @@ void emitReadVariable(DList instList, SymTable symtab, int addrIndex) {
  * @param label a character array of size 20 in which the label will be stored
  */
 static void makeLabel(char label[20]) {
-	static int labelCount = 0;
 	snprintf(label,19,".L%d",labelCount++);
 }
 
+/**
+ * Insert a test of whether a register is zero and a branch to a new label if it is.
+ *
+ * @param instList a list of instructions
+ * @param symtab a symbol table
+ * @param regIndex the symbol table index of the register holding the value to test
+ * @return the symbol table index of the label branched to
+ */
+static int emitBranchIfZero(DList instList, SymTable symtab, int regIndex) {
+	char label[20];
+	makeLabel(label);
+
+	append(instList,mirInst2(MIR_TEST,4,regOperand(symtab,regIndex,4),regOperand(symtab,regIndex,4)));
+
+	int labelIndex = SymIndex(symtab,label);
+	append(instList,mirJump(MIR_COND_E,labelOperand(symtab,labelIndex))); /* jump to false*/
+
+	return labelIndex;
+}
+
 /**
  * Insert instructions to test whether the expression of a if-statement is false, if false, branch around the then-part
  * of the if-statement.
@@ -163,28 +229,76 @@ static void makeLabel(char label[20]) {
  * @return the symbol table index of the label that must follow the then-part of an if-statement
  */
 int emitIfTest(DList instList, SymTable symtab, int regIndex) {
+	return emitBranchIfZero(instList,symtab,regIndex);
+}
+
+/**
+ * Insert a comparison that is the test of an if-statement or while-statement, and a branch to a new label when the
+ * comparison is false. The flags of the compare feed the branch directly.
+ *
+ * @param instList a list of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param rightOperand the symbol table index of the register holding the right operand
+ * @param cond the condition under which the comparison is true
+ * @return the symbol table index of the label that must follow the then-part or the loop
+ */
+int emitCompareTest(DList instList, SymTable symtab, int leftOperand, int rightOperand, MirCondition cond) {
 	char label[20];
 	makeLabel(label);
 
-	int treg = allocateIntegerRegister();
-	char *symReg = getIntegerRegisterName(treg);
-	int tregIndex = SymIndex(symtab,symReg);
-	SymPutFieldByIndex(symtab,tregIndex,SYMTAB_REGISTER_INDEX_FIELD,(Generic)treg);
+	append(instList,mirInst2(MIR_CMP,4,regOperand(symtab,rightOperand,4),regOperand(symtab,leftOperand,4)));
 
-	char* inst = nssave(2,"\tmovl $-1, ", symReg);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	int labelIndex = SymIndex(symtab,label);
+	append(instList,mirJump(mirInvertCondition(cond),labelOperand(symtab,labelIndex)));
 
-	inst = nssave(4,"\ttestl ",(char*)SymGetFieldByIndex(symtab,regIndex,SYM_NAME_FIELD), ", ",symReg);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	return labelIndex;
+}
 
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	freeIntegerRegister(treg);
+/**
+ * Insert a comparison of a register with a constant that is the test of an
+ * if-statement or while-statement, and a branch to a new label when the
+ * comparison is false.
+ *
+ * @param instList a list of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param value the right operand
+ * @param cond the condition under which the comparison is true
+ * @return the symbol table index of the label that must follow the then-part or the loop
+ */
+int emitCompareImmediateTest(DList instList, SymTable symtab, int leftOperand, int value, MirCondition cond) {
+	char label[20];
+	makeLabel(label);
 
-	inst = nssave(2,"\tje ",label); /* jump to false*/
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_CMP,4,mirImm(value),regOperand(symtab,leftOperand,4)));
+
+	int labelIndex = SymIndex(symtab,label);
+	append(instList,mirJump(mirInvertCondition(cond),labelOperand(symtab,labelIndex)));
+
+	return labelIndex;
+}
+
+/**
+ * Insert the test of an if-statement or while-statement whose value is known:
+ * a branch to a new label when it is false, and nothing when it is true.
+ *
+ * @param instList a list of instructions
+ * @param symtab a symbol table
+ * @param value the value of the test
+ * @return the symbol table index of the label that must follow the then-part or the loop
+ */
+int emitConstantTest(DList instList, SymTable symtab, bool value) {
+	char label[20];
+	makeLabel(label);
+
+	int labelIndex = SymIndex(symtab,label);
+	if (!value)
+		append(instList,mirJump(MIR_COND_NONE,labelOperand(symtab,labelIndex)));
 
-	return SymIndex(symtab,label);
+	return labelIndex;
 }
+
 /**
  * Insert a nop as a branch target in the list of instructions.
  *
@@ -193,8 +307,8 @@ int emitIfTest(DList instList, SymTable symtab, int regIndex) {
  * @param endLabelIndex the symbol table index of the label for the nop
  */
 void emitEndBranchTarget(DList instList, SymTable symtab, int endLabelIndex) {
-	char* inst = nssave(2,SymGetFieldByIndex(symtab,endLabelIndex,SYM_NAME_FIELD),":\t nop");
-	dlinkAppend(instList, dlinkNodeAlloc(inst));
+	append(instList,mirInst1(MIR_LABEL,0,labelOperand(symtab,endLabelIndex)));
+	append(instList,mirInst(MIR_NOP,0));
 }
 
 /**
@@ -209,11 +323,11 @@ int emitThenBranch(DList instList, SymTable symtab, int elseLabelIndex) {
 	char label[20];
 	makeLabel(label);
 
-	char* inst = nssave(2,"\tjmp ",label);
-	dlinkAppend(instList, dlinkNodeAlloc(inst));
+	int labelIndex = SymIndex(symtab,label);
+	append(instList,mirJump(MIR_COND_NONE,labelOperand(symtab,labelIndex)));
 	emitEndBranchTarget(instList,symtab,elseLabelIndex);
 
-	return SymIndex(symtab,label);
+	return labelIndex;
 }
 /**
  * Insert a nop to serve as a target of the backwards branch of a while-statement
@@ -226,10 +340,10 @@ int emitWhileLoopLandingPad(DList instList,SymTable symtab) {
 	char label[20];
 	makeLabel(label);
 
-	char *inst = nssave(2,label,":\tnop");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	int labelIndex = SymIndex(symtab,label);
+	emitEndBranchTarget(instList,symtab,labelIndex);
 
-	return SymIndex(symtab,label);
+	return labelIndex;
 }
 
 /**
@@ -241,27 +355,7 @@ int emitWhileLoopLandingPad(DList instList,SymTable symtab) {
  * @return a symbol table index for the label at the end of the while-loop
  */
 int emitWhileLoopTest(DList instList, SymTable symtab, int regIndex) {
-	char label[20];
-	makeLabel(label);
-
-	int treg = allocateIntegerRegister();
-	char *symReg = getIntegerRegisterName(treg);
-	int tregIndex = SymIndex(symtab,symReg);
-	SymPutFieldByIndex(symtab,tregIndex,SYMTAB_REGISTER_INDEX_FIELD,(Generic)treg);
-
-	char* inst = nssave(2,"\tmovl $-1, ", symReg);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = nssave(4,"\ttestl ",(char*)SymGetFieldByIndex(symtab,regIndex,SYM_NAME_FIELD), ", ",symReg);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	freeIntegerRegister(treg);
-
-	inst = nssave(2,"\tje ",label);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	return SymIndex(symtab,label);
+	return emitBranchIfZero(instList,symtab,regIndex);
 }
 
 /**
@@ -273,11 +367,8 @@ int emitWhileLoopTest(DList instList, SymTable symtab, int regIndex) {
  * @param endLabelIndex a symbol table index of the lable for the exit of the while loop
  */
 void emitWhileLoopBackBranch(DList instList, SymTable symtab, int beginLabelIndex, int endLabelIndex) {
-	char *inst = nssave(2,"\tjmp ",(char*)SymGetFieldByIndex(symtab,beginLabelIndex,SYM_NAME_FIELD));
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = nssave(2,(char*)SymGetFieldByIndex(symtab,endLabelIndex,SYM_NAME_FIELD),":\t nop");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirJump(MIR_COND_NONE,labelOperand(symtab,beginLabelIndex)));
+	emitEndBranchTarget(instList,symtab,endLabelIndex);
 }
 
 /**
@@ -289,18 +380,11 @@ void emitWhileLoopBackBranch(DList instList, SymTable symtab, int beginLabelInde
  * @param syscallService the system call print service to use (format string for x86)
  */
 void emitWriteExpression(DList instList,SymTable symtab, int regIndex, char *syscallService) {
-	char *inst = nssave(3,"\tmovl ", (char*)SymGetFieldByIndex(symtab,regIndex,SYM_NAME_FIELD), ", %esi");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_MOV,4,regOperand(symtab,regIndex,4),mirReg(MIR_RSI,4)));
+	append(instList,mirInst2(MIR_MOV,4,mirImm(0),mirReg(MIR_RAX,4)));
 
-	inst = ssave("\tmovl $0, %eax");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD));
-
-	inst = nssave(3, "\tmovl $",syscallService, ", %edi");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = ssave("\tcall printf");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_MOV,4,mirSymbolImm(syscallService,0),mirReg(MIR_RDI,4)));
+	append(instList,mirInst1(MIR_CALL,0,mirSymbol("printf")));
 }
 
 /**
@@ -310,17 +394,29 @@ void emitWriteExpression(DList instList,SymTable symtab, int regIndex, char *sys
  * @param symtab a symbol table
  * @param leftOperand the symbol table index of the register holding the left operand
  * @param rightOperand the symbol table index of the register holding the right operand
- * @param opcode the opcode of the mips assembly instruction
+ * @param opcode the opcode of the instruction
  * @return
  */
-static int emitBinaryExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand, char* opcode) {
-	char* leftName = (char*)SymGetFieldByIndex(symtab,leftOperand,SYM_NAME_FIELD);
-	char* rightName = (char*)SymGetFieldByIndex(symtab,rightOperand,SYM_NAME_FIELD);
+static int emitBinaryExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand, MirOpcode opcode) {
+	append(instList,mirInst2(opcode,4,regOperand(symtab,rightOperand,4),regOperand(symtab,leftOperand,4)));
 
-	char* inst = nssave(6,"\t",opcode," ", rightName,", ",leftName);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	return leftOperand;
+}
+
+/**
+ * Add an instruction that performs a binary computation with a constant right
+ * operand: add, sub, imul, and or or.
+ *
+ * @param instList a DList of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param value the right operand
+ * @param opcode the opcode of the instruction
+ * @return the symbol table index for the result register
+ */
+int emitImmediateExpression(DList instList, SymTable symtab, int leftOperand, int value, MirOpcode opcode) {
+	append(instList,mirInst2(opcode,4,mirImm(value),regOperand(symtab,leftOperand,4)));
 
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,rightOperand,SYMTAB_REGISTER_INDEX_FIELD));
 	return leftOperand;
 }
 
@@ -334,7 +430,7 @@ static int emitBinaryExpression(DList instList, SymTable symtab, int leftOperand
  * @return the symbol table index for the result register
  */
 int emitOrExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,"orl");
+	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,MIR_OR);
 }
 
 /**
@@ -347,7 +443,7 @@ int emitOrExpression(DList instList, SymTable symtab, int leftOperand, int right
  * @return the symbol table index for the result register
  */
 int emitAndExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,"andl");
+	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,MIR_AND);
 }
 
 /**
@@ -359,26 +455,47 @@ int emitAndExpression(DList instList, SymTable symtab, int leftOperand, int righ
  * @return the symbol table index for the result register
  */
 int emitNotExpression(DList instList, SymTable symtab, int operand) {
-	char* opName = (char*)SymGetFieldByIndex(symtab,operand,SYM_NAME_FIELD);
-	char* inst = nssave(2, "\txorl $1, ", opName);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_XOR,4,mirImm(1),regOperand(symtab,operand,4)));
 
 	return operand;
 }
 
-static int emitBinaryCompareExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand, char *opcode) {
-	leftOperand = emitBinaryExpression(instList,symtab,leftOperand,rightOperand,"cmpl");
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,rightOperand,SYMTAB_REGISTER_INDEX_FIELD));
-
-	char *inst = nssave(2,"\tmovl $0, ", (char*)SymGetFieldByIndex(symtab,leftOperand,SYM_NAME_FIELD));
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Add a comparison whose value is needed: the condition is set in the low byte
+ * of the left operand's register, and zero-extended to the whole register.
+ *
+ * @param instList a DList of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param rightOperand the symbol table index of the register holding the right operand
+ * @param cond the condition under which the comparison is true
+ * @return the symbol table index for the result register
+ */
+static int emitBinaryCompareExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand, MirCondition cond) {
+	leftOperand = emitBinaryExpression(instList,symtab,leftOperand,rightOperand,MIR_CMP);
 
-	int tregIndex = getFreeIntegerRegisterIndex(symtab);
+	append(instList,mirSet(cond,regOperand(symtab,leftOperand,1)));
+	append(instList,mirInst2(MIR_MOVZBL,0,regOperand(symtab,leftOperand,1),regOperand(symtab,leftOperand,4)));
+	return leftOperand;
+}
 
-	inst = nssave(2,"\tmovl $1, ",(char*)SymGetFieldByIndex(symtab,tregIndex,SYM_NAME_FIELD));
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Add a comparison with a constant whose value is needed, as
+ * emitBinaryCompareExpression does.
+ *
+ * @param instList a DList of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param value the right operand
+ * @param cond the condition under which the comparison is true
+ * @return the symbol table index for the result register
+ */
+int emitCompareImmediateExpression(DList instList, SymTable symtab, int leftOperand, int value, MirCondition cond) {
+	leftOperand = emitImmediateExpression(instList,symtab,leftOperand,value,MIR_CMP);
 
-	return emitBinaryExpression(instList,symtab,leftOperand,tregIndex,opcode);
+	append(instList,mirSet(cond,regOperand(symtab,leftOperand,1)));
+	append(instList,mirInst2(MIR_MOVZBL,0,regOperand(symtab,leftOperand,1),regOperand(symtab,leftOperand,4)));
+	return leftOperand;
 }
 
 /**
@@ -391,7 +508,7 @@ static int emitBinaryCompareExpression(DList instList, SymTable symtab, int left
  * @return the symbol table index for the result register
  */
 int emitEqualExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-    return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,"cmove");
+    return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,MIR_COND_E);
 }
 /**
  * Add a not-equal instruction.
@@ -404,7 +521,7 @@ int emitEqualExpression(DList instList, SymTable symtab, int leftOperand, int ri
  */
 
 int emitNotEqualExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,"cmovne");
+	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,MIR_COND_NE);
 }
 
 /**
@@ -417,7 +534,7 @@ int emitNotEqualExpression(DList instList, SymTable symtab, int leftOperand, int
  * @return the symbol table index for the result register
  */
 int emitLessEqualExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,"cmovle");
+	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,MIR_COND_LE);
 }
 
 /**
@@ -430,7 +547,7 @@ int emitLessEqualExpression(DList instList, SymTable symtab, int leftOperand, in
  * @return the symbol table index for the result register
  */
 int emitLessThanExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,"cmovl");
+	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,MIR_COND_L);
 }
 
 /**
@@ -443,7 +560,7 @@ int emitLessThanExpression(DList instList, SymTable symtab, int leftOperand, int
  * @return the symbol table index for the result register
  */
 int emitGreaterEqualExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,"cmovge");
+	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,MIR_COND_GE);
 }
 
 /**
@@ -456,7 +573,7 @@ int emitGreaterEqualExpression(DList instList, SymTable symtab, int leftOperand,
  * @return the symbol table index for the result register
  */
 int emitGreaterThanExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,"cmovg");
+	return emitBinaryCompareExpression(instList,symtab,leftOperand,rightOperand,MIR_COND_G);
 }
 
 
@@ -470,7 +587,7 @@ int emitGreaterThanExpression(DList instList, SymTable symtab, int leftOperand,
  * @return the symbol table index for the result register
  */
 int emitAddExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,"addl");
+	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,MIR_ADD);
 }
 
 /**
@@ -483,7 +600,7 @@ int emitAddExpression(DList instList, SymTable symtab, int leftOperand, int righ
  * @return the symbol table index for the result register
  */
 int emitSubtractExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,"subl");
+	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,MIR_SUB);
 }
 
 /**
@@ -496,7 +613,7 @@ int emitSubtractExpression(DList instList, SymTable symtab, int leftOperand, int
  * @return the symbol table index for the result register
  */
 int emitMultiplyExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,"imull");
+	return emitBinaryExpression(instList,symtab,leftOperand,rightOperand,MIR_IMUL);
 }
 
 /**
@@ -509,153 +626,238 @@ int emitMultiplyExpression(DList instList, SymTable symtab, int leftOperand, int
  * @return the symbol table index for the result register
  */
 int emitDivideExpression(DList instList, SymTable symtab, int leftOperand, int rightOperand) {
-	int leftReg = (int)SymGetFieldByIndex(symtab,leftOperand,SYMTAB_REGISTER_INDEX_FIELD);
-	int rightReg = (int)SymGetFieldByIndex(symtab,rightOperand,SYMTAB_REGISTER_INDEX_FIELD);
-	char *inst = nssave(3,"\tmovl ",(char*)SymGetFieldByIndex(symtab,leftOperand,SYM_NAME_FIELD), ", %eax");
-    dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_MOV,4,regOperand(symtab,leftOperand,4),mirReg(MIR_RAX,4)));
+	append(instList,mirInst(MIR_CDQ,0));
+	append(instList,mirInst1(MIR_IDIV,4,regOperand(symtab,rightOperand,4)));
+	append(instList,mirInst2(MIR_MOV,4,mirReg(MIR_RAX,4),regOperand(symtab,leftOperand,4)));
 
-	inst = ssave("\tcdq");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	return leftOperand;
+}
 
-	inst = nssave(2,"\tidivl ",(char*)SymGetFieldByIndex(symtab,rightOperand,SYM_NAME_FIELD));
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Add the instructions of a multiplication by a constant other than 0 and 1:
+ * a shift for a power of two, a lea for 3, 5 and 9, a lea and a shift for
+ * those times a power of two, a neg for -1 and after the shift of a negative
+ * power of two, and an imul for the rest. All of them wrap as imul does.
+ *
+ * @param instList a DList of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param value the right operand
+ * @return the symbol table index for the result register
+ */
+int emitMultiplyImmediate(DList instList, SymTable symtab, int leftOperand, int value) {
+	MirOperand left = regOperand(symtab,leftOperand,4);
+	int base = regOperand(symtab,leftOperand,8).reg;
+	unsigned int factor = value < 0 ? -(unsigned int)value : (unsigned int)value;
+	int shift = 0;
+
+	while (factor > 1 && factor % 2 == 0) {
+		factor /= 2;
+		shift++;
+	}
 
-	inst = nssave(2,"\tmovl %eax, ", (char *)SymGetFieldByIndex(symtab, leftOperand, SYM_NAME_FIELD)); 
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	if (factor == 1) {
+		if (shift > 0)
+			append(instList,mirInst2(MIR_SHL,4,mirImm(shift),left));
+		if (value < 0)
+			append(instList,mirInst1(MIR_NEG,4,left));
+	} else if (value > 0 && (factor == 3 || factor == 5 || factor == 9)) {
+		append(instList,mirInst2(MIR_LEA,4,mirMem(base,base,factor - 1,0),left));
+		if (shift > 0)
+			append(instList,mirInst2(MIR_SHL,4,mirImm(shift),left));
+	} else
+		append(instList,mirInst2(MIR_IMUL,4,mirImm(value),left));
 
-	freeIntegerRegister(rightReg);
 	return leftOperand;
 }
 
 /**
- * Add an instruction to compute the address of a variable.
+ * Compute the magic number and shift of a signed division by a constant, as
+ * in Hacker's Delight, section 10-4: n / d is the high word of the 64-bit
+ * product of n and the magic number, plus n if d > 0 and the magic number is
+ * negative or less n if d < 0 and it is positive, shifted right arithmetically
+ * by the shift, plus 1 if that is negative.
  *
- * @param instList a Dlist of instructions
- * @param lsymtab a global symbol table
- * @param symtab a symbol table
- * @param varIndex the symbol table index for a variable
- * @return the symbol table index of the result register
+ * @param d the divisor, other than -1, 0, 1 and INT_MIN
+ * @param magic the magic number
+ * @param shift the shift
  */
-int emitComputeVarAddress(DList instList, SymTable lsymtab, SymTable symtab, char* varName) {
-	int regIndex = getFreeIntegerRegisterIndex(symtab);
-	char* regName = (char*)get64bitIntegerRegisterName(symtab, regIndex);
-
-	int offset = 0;
-	int varIndex = SymQueryIndex(symtab,varName);
-	if (varIndex == SYM_INVALID_INDEX) {
-		varIndex = SymQueryIndex(lsymtab,varName);
-		offset = (int)SymGetFieldByIndex(lsymtab,varIndex,SYMTAB_OFFSET_FIELD);
-		char offsetStr[10];
-		snprintf(offsetStr,9,"%d",offset);
-		char *inst = nssave(2,"\tmovq $_gp,", regName);
-		dlinkAppend(instList,dlinkNodeAlloc(inst));
+static void divisionMagic(int d, int *magic, int *shift) {
+	const unsigned int two31 = 0x80000000u;
+	unsigned int ad = d < 0 ? -(unsigned int)d : (unsigned int)d;
+	unsigned int t = two31 + ((unsigned int)d >> 31);
+	unsigned int anc = t - 1 - t % ad;
+	unsigned int q1 = two31 / anc, r1 = two31 - q1 * anc;
+	unsigned int q2 = two31 / ad, r2 = two31 - q2 * ad;
+	unsigned int delta;
+	int p = 31;
+
+	do {
+		p++;
+		q1 *= 2;
+		r1 *= 2;
+		if (r1 >= anc) {
+			q1++;
+			r1 -= anc;
+		}
+		q2 *= 2;
+		r2 *= 2;
+		if (r2 >= ad) {
+			q2++;
+			r2 -= ad;
+		}
+		delta = ad - r2;
+	} while (q1 < delta || (q1 == delta && r1 == 0));
 
-		inst = nssave(4,"\taddq $", offsetStr, ", ", regName);
-		dlinkAppend(instList,dlinkNodeAlloc(inst));
+	*magic = (int)(d < 0 ? -(q2 + 1) : q2 + 1);
+	*shift = p - 32;
+}
 
-		return regIndex;
+/**
+ * Add the instructions of a division by a constant other than 1 without an
+ * idiv. A power of two, or its negative, is an arithmetic shift of the left
+ * operand plus the divisor less 1 if it is negative; any other divisor is a
+ * multiplication by its magic number. A divisor of INT_MIN is a comparison, and
+ * one of 0 or -1 is still an idiv, which traps as before. The quotient is left
+ * in %eax too, as idiv leaves it, since a function without a return statement
+ * returns it; the peephole optimizer removes the copy where no one reads it.
+ *
+ * @param instList a DList of instructions
+ * @param symtab a symbol table
+ * @param leftOperand the symbol table index of the register holding the left operand
+ * @param value the right operand
+ * @return the symbol table index for the result register
+ */
+int emitDivideImmediate(DList instList, SymTable symtab, int leftOperand, int value) {
+	MirOperand left = regOperand(symtab,leftOperand,4);
+	unsigned int divisor = value < 0 ? -(unsigned int)value : (unsigned int)value;
+	int magic, shift, regIndex;
+	MirOperand t, t64;
+
+	if (value == 0 || value == -1)
+		return emitDivideExpression(instList,symtab,leftOperand,emitLoadImmediate(instList,symtab,value));
+
+	if (value == INT_MIN)
+		leftOperand = emitCompareImmediateExpression(instList,symtab,leftOperand,value,MIR_COND_E);
+	else if ((divisor & (divisor - 1)) == 0) {
+		regIndex = getFreeIntegerRegisterIndex(symtab);
+		t = regOperand(symtab,regIndex,4);
+		for (shift = 0; (1u << shift) != divisor; shift++)
+			;
+		/* the bias is divisor - 1 for a negative left operand and 0 otherwise */
+		append(instList,mirInst2(MIR_MOV,4,left,t));
+		if (shift > 1)
+			append(instList,mirInst2(MIR_SAR,4,mirImm(31),t));
+		append(instList,mirInst2(MIR_SHR,4,mirImm(32 - shift),t));
+		append(instList,mirInst2(MIR_ADD,4,t,left));
+		append(instList,mirInst2(MIR_SAR,4,mirImm(shift),left));
+		if (value < 0)
+			append(instList,mirInst1(MIR_NEG,4,left));
 	} else {
-		char *oldRegName = (char*)SymGetFieldByIndex(symtab,varIndex,SYM_NAME_FIELD);
-		offset = (((int)SymGetFieldByIndex(symtab,varIndex,SYMTAB_OFFSET_FIELD) * -1) - 4);
-		char offsetStr[10];
-		snprintf(offsetStr,9,"%d",offset);
-		char *inst = nssave(2,"\tmovq %rbp, ", regName);
-		dlinkAppend(instList,dlinkNodeAlloc(inst));
+		regIndex = getFreeIntegerRegisterIndex(symtab);
+		t = regOperand(symtab,regIndex,4);
+		t64 = regOperand(symtab,regIndex,8);
+		divisionMagic(value,&magic,&shift);
+		append(instList,mirInst2(MIR_MOVSLQ,0,left,t64));
+		append(instList,mirInst2(MIR_IMUL,8,mirImm(magic),t64));
+		if ((value > 0 && magic < 0) || (value < 0 && magic > 0)) {
+			append(instList,mirInst2(MIR_SAR,8,mirImm(32),t64));
+			append(instList,mirInst2(value > 0 ? MIR_ADD : MIR_SUB,4,left,t));
+			if (shift > 0)
+				append(instList,mirInst2(MIR_SAR,4,mirImm(shift),t));
+		} else
+			append(instList,mirInst2(MIR_SAR,8,mirImm(32 + shift),t64));
+		/* round toward zero by adding 1 to a negative quotient */
+		append(instList,mirInst2(MIR_MOV,4,t,left));
+		append(instList,mirInst2(MIR_SHR,4,mirImm(31),left));
+		append(instList,mirInst2(MIR_ADD,4,t,left));
+	}
+	emitQuotient(instList,symtab,leftOperand);
 
-		inst = nssave(4,"\taddq $", offsetStr, ", ", regName);
-		dlinkAppend(instList,dlinkNodeAlloc(inst));
+	return leftOperand;
+}
 
-		return regIndex;
-	}
+/**
+ * Copy the quotient of a division that needs no idiv to %eax, where idiv
+ * leaves it and where a function without a return statement returns it.
+ *
+ * @param instList a DList of instructions
+ * @param symtab a symbol table
+ * @param regIndex the symbol table index of the register holding the quotient
+ */
+void emitQuotient(DList instList, SymTable symtab, int regIndex) {
+	append(instList,mirInst2(MIR_MOV,4,regOperand(symtab,regIndex,4),mirReg(MIR_RAX,4)));
 }
 
 /**
- * Compute the address of an array element and store it in a register.
+ * Compute the memory operand of a variable or of an array element. A global
+ * lives at _gp plus its offset and a local at %rbp less its offset and size,
+ * with the elements of an array laid out upward from there, so an element is
+ * the variable's operand with the subscript, sign extended, as an index
+ * scaled by 4. A constant part of the subscript is added to the displacement.
  *
  * @param instList a list of instructions
- * @param gsymtab global symbol table
+ * @param gsymtab the global symbol table
  * @param symtab a symbol table
- * @param varIndex the symbol table index of the array variable
- * @param subIndex the symbol table index of the register holding the subscript value
- * @return the symbol table index of the register holding the address of the
- * 		   array element.
+ * @param varName the name of the variable
+ * @param subIndex the symbol table index of the register holding the subscript,
+ * 	  or SYM_INVALID_INDEX for a scalar or a constant subscript
+ * @param element the constant element added to the subscript, 0 for a scalar
+ * @return the memory operand
  */
-int emitComputeArrayAddress(DList instList, SymTable gsymtab, SymTable symtab, char *varName, int subIndex) {
-	int regIndex = getFreeIntegerRegisterIndex(symtab);
-	char* regName = get64bitIntegerRegisterName(symtab, regIndex);
-
-	char *inst;
-	int offset = 0;
+MirOperand emitVariableOperand(DList instList, SymTable gsymtab, SymTable symtab, char *varName, int subIndex, int element) {
+	SymTable vsymtab = symtab;
+	MirOperand op;
 
 	/* Checks to see if var index is in the local table otherwise it grabs the address of the global */
 	int varIndex = SymQueryIndex(symtab,varName);
 	if (varIndex == SYM_INVALID_INDEX) {
+		vsymtab = gsymtab;
 		varIndex = SymQueryIndex(gsymtab,varName);
-		int varTypeIndex = (int)SymGetFieldByIndex(gsymtab,varIndex,SYMTAB_TYPE_INDEX_FIELD);
-		if (isArrayType(gsymtab,varTypeIndex)) {
-			offset = (int)SymGetFieldByIndex(gsymtab,varIndex,SYMTAB_OFFSET_FIELD);
-			char offsetStr[10];
-			snprintf(offsetStr,9,"%d",offset);
-
-			inst = nssave(2,"\tmovq $_gp, ", regName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			inst = nssave(4,"\taddq $", offsetStr, ", ", regName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			/* compute offset based on subscript */
-		    char* subReg32Name = (char*)SymGetFieldByIndex(symtab,subIndex,SYM_NAME_FIELD);
-			char* subRegName = get64bitIntegerRegisterName(symtab,subIndex);
-
-			inst = nssave(4,"\tmovslq ", subReg32Name, ", ", subRegName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			inst = nssave(2,"\timulq $4, ", subRegName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			/* compute element address */
-			inst = nssave(4,"\taddq ", subRegName, ", ", regName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-		} else {
-			char msg[80];
-			snprintf(msg,80,"Scalar variable %s used as an array", (char*)SymGetFieldByIndex(gsymtab,varIndex,SYM_NAME_FIELD));
-			Cminus_error(msg);
-		}
+	}
+
+	int offset = (int)(long)SymGetFieldByIndex(vsymtab,varIndex,SYMTAB_OFFSET_FIELD);
+	int varTypeIndex = (int)(long)SymGetFieldByIndex(vsymtab,varIndex,SYMTAB_TYPE_INDEX_FIELD);
+	bool isArray = isArrayType(vsymtab,varTypeIndex);
+	if (!isArray && (subIndex != SYM_INVALID_INDEX || element != 0)) {
+		char msg[80];
+		snprintf(msg,80,"Scalar variable %s used as an array", (char*)SymGetFieldByIndex(vsymtab,varIndex,SYM_NAME_FIELD));
+		codegenErrors++;
+		Cminus_error(msg);
+	}
+
+	if (vsymtab == gsymtab) {
+		op = mirMem(MIR_NO_REG,MIR_NO_REG,1,offset);
+		op.symbol = ssave("_gp");
 	} else {
-		/* Grabs the local address by generating the offset */
-		int varTypeIndex = (int)SymGetFieldByIndex(symtab,varIndex,SYMTAB_TYPE_INDEX_FIELD);
-		if (isArrayType(symtab,varTypeIndex)) {
-			offset = (((int)SymGetFieldByIndex(symtab,varIndex,SYMTAB_OFFSET_FIELD) * -1) - 4);
-			char offsetStr[10];
-			snprintf(offsetStr,9,"%d",offset);
-
-			inst = nssave(2,"\tmovq %rbp, ",regName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			inst = nssave(4,"\taddq $", offsetStr, ", ", regName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			/* compute offset based on subscript */
-		    char* subReg32Name = (char*)SymGetFieldByIndex(symtab,subIndex,SYM_NAME_FIELD);
-			char* subRegName = get64bitIntegerRegisterName(symtab, subIndex);
-
-			inst = nssave(4,"\tmovslq ", subReg32Name, ", ", subRegName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			inst = nssave(2,"\timulq $-4, ", subRegName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-			/* compute element address */
-			inst = nssave(4,"\taddq ", subRegName, ", ", regName);
-			dlinkAppend(instList,dlinkNodeAlloc(inst));
-		} else {
-			char msg[80];
-			snprintf(msg,80,"Scalar variable %s used as an array", (char*)SymGetFieldByIndex(symtab,varIndex,SYM_NAME_FIELD));
-			Cminus_error(msg);
-		}
+		int size = isArray ? (int)(long)SymGetFieldByIndex(symtab,varTypeIndex,SYMTAB_SIZE_FIELD) : INTEGER_SIZE;
+		op = mirMem(MIR_RBP,MIR_NO_REG,1,-(long)(offset + size));
+	}
+	op.value += (long)element * INTEGER_SIZE;
+
+	if (subIndex != SYM_INVALID_INDEX) {
+		int indexIndex = getFreeIntegerRegisterIndex(symtab);
+		append(instList,mirInst2(MIR_MOVSLQ,0,regOperand(symtab,subIndex,4),regOperand(symtab,indexIndex,8)));
+		op.index = regOperand(symtab,indexIndex,8).reg;
+		op.scale = INTEGER_SIZE;
 	}
 
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,subIndex,SYMTAB_REGISTER_INDEX_FIELD));
+	return op;
+}
+
+/**
+ * Add an instruction to compute the address of a variable.
+ *
+ * @param instList a Dlist of instructions
+ * @param symtab a symbol table
+ * @param var the memory operand of the variable
+ * @return the symbol table index of the result register
+ */
+int emitComputeAddress(DList instList, SymTable symtab, MirOperand var) {
+	int regIndex = getFreeIntegerRegisterIndex(symtab);
+
+	append(instList,mirInst2(MIR_LEA,8,var,regOperand(symtab,regIndex,8)));
 	return regIndex;
 }
 
@@ -663,24 +865,59 @@ int emitComputeArrayAddress(DList instList, SymTable gsymtab, SymTable symtab, c
  * Add an instruction to load a variable from memory.
  *
  * @param instList a Dlist of instructions
- * @param lsymtab a global symbol table
  * @param symtab a symbol table
- * @param regIndex the symbol table index for the address of a variable
+ * @param var the memory operand of the variable
  * @return the symbol table index of the result register
  */
-int emitLoadVariable(DList instList, SymTable lsymtab, SymTable symtab, int regIndex) {
+int emitLoadVariable(DList instList, SymTable symtab, MirOperand var) {
 	int newRegIndex = getFreeIntegerRegisterIndex(symtab);
-	char* newRegName = (char*)SymGetFieldByIndex(symtab,newRegIndex,SYM_NAME_FIELD);
-	char* regName = (char*)get64bitIntegerRegisterName(symtab, regIndex);
 
-	if (regName == NULL) {
-		regName = (char*)get64bitIntegerRegisterName(lsymtab, regIndex);
-	}
+	append(instList,mirInst2(MIR_MOV,4,var,regOperand(symtab,newRegIndex,4)));
 
-	char *inst = nssave(4,"\tmovl (",regName,"), ", newRegName);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	return newRegIndex;
+}
+
+/**
+ * Add an instruction to load a variable from memory into a given register,
+ * the register a variable is kept in while it is promoted.
+ *
+ * @param instList a Dlist of instructions
+ * @param lsymtab a global symbol table
+ * @param symtab a symbol table
+ * @param varName the name of the variable
+ * @param regIndex the symbol table index of the register
+ */
+void emitLoadPromotedVariable(DList instList, SymTable lsymtab, SymTable symtab, char *varName, int regIndex) {
+	MirOperand var = emitVariableOperand(instList,lsymtab,symtab,varName,SYM_INVALID_INDEX,0);
+
+	append(instList,mirInst2(MIR_MOV,4,var,regOperand(symtab,regIndex,4)));
+}
+
+/**
+ * Add an instruction to copy one register into another.
+ *
+ * @param instList a Dlist of instructions
+ * @param symtab a symbol table
+ * @param srcIndex the symbol table index of the register copied
+ * @param dstIndex the symbol table index of the register written
+ */
+void emitMoveRegister(DList instList, SymTable symtab, int srcIndex, int dstIndex) {
+	append(instList,mirInst2(MIR_MOV,4,regOperand(symtab,srcIndex,4),regOperand(symtab,dstIndex,4)));
+}
+
+/**
+ * Add an instruction to copy a register into a new one, which the emit
+ * routines may then change.
+ *
+ * @param instList a Dlist of instructions
+ * @param symtab a symbol table
+ * @param regIndex the symbol table index of the register copied
+ * @return the symbol table index of the result register
+ */
+int emitCopyRegister(DList instList, SymTable symtab, int regIndex) {
+	int newRegIndex = getFreeIntegerRegisterIndex(symtab);
 
-	freeIntegerRegister((int)SymGetFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD));
+	emitMoveRegister(instList,symtab,regIndex,newRegIndex);
 	return newRegIndex;
 }
 
@@ -693,49 +930,71 @@ int emitLoadVariable(DList instList, SymTable lsymtab, SymTable symtab, int regI
  * @return the symbol table index of the result register
  */
 int emitLoadIntegerConstant(DList instList, SymTable symtab, int intIndex) {
-	int regIndex = getFreeIntegerRegisterIndex(symtab);
-	char* regName = (char*)SymGetFieldByIndex(symtab,regIndex,SYM_NAME_FIELD);
-	
 	char *intName = SymGetFieldByIndex(symtab,intIndex,SYM_NAME_FIELD);
-	char *inst = nssave(4,"\tmovl $", intName, ", ", regName);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
 
+	return emitLoadImmediate(instList,symtab,strtol(intName,NULL,10));
+}
+
+/**
+ * Add an instruction to load a constant value into a new register.
+ *
+ * @param instList a Dlist of instructions
+ * @param symtab a symbol table
+ * @param value the value
+ * @return the symbol table index of the result register
+ */
+int emitLoadImmediate(DList instList, SymTable symtab, long value) {
+	int regIndex = getFreeIntegerRegisterIndex(symtab);
+
+	emitMoveImmediate(instList,symtab,value,regIndex);
 	return regIndex;
 }
 
+/**
+ * Add an instruction to load a constant value into a register.
+ *
+ * @param instList a Dlist of instructions
+ * @param symtab a symbol table
+ * @param value the value
+ * @param regIndex the symbol table index of the register
+ */
+void emitMoveImmediate(DList instList, SymTable symtab, long value, int regIndex) {
+	append(instList,mirInst2(MIR_MOV,4,mirImm(value),regOperand(symtab,regIndex,4)));
+}
+
 /**
  * Starts each function by pushing necessary registers onto the stack
  * Also figures out the correct starting offset of the stack
  *
+ * Only the callee-saved registers the function names are pushed, below the
+ * local variables and spill slots, and the frame is rounded so that the stack
+ * stays 16-byte aligned at the calls the function makes. A function without
+ * a frame keeps its locals in the red zone below the pushes instead.
+ *
  * @param instList a Dlist of instructions
  * @param offset is the total byte offset that needs to be aligned
+ * @param used the registers the function names, a bit for each register number
+ * @param frame false if the function has no frame and %rbp is not set up
  */
-void emitStartFunction(DList instList, int offset) {
-	/* Generates the necessary offset that is 16 byte aligned */
-	int newOffset = offset + (16 - (offset % 16));
-	char offsetStr[10];
-	snprintf(offsetStr,9,"%d",offset);
-
-	char *inst = nssave(3, "\tsubq $", offsetStr, ", %rsp");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+void emitStartFunction(DList instList, int offset, int used, bool frame) {
+	int i, pushed = 0;
 
-	inst = ssave("\tpushq %rbx");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = ssave("\tpushq %r12");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = ssave("\tpushq %r13");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	for (i = 0; i < NUM_CALLEE_SAVED; i++)
+		if ((used & (1 << calleeSavedRegisters[i])) != 0)
+			pushed += 8;
 
-	inst = ssave("\tpushq %r14");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = ssave("\tpushq %r15");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	if (frame) {
+		/* the return address and %rbp are 16 bytes, so the frame and the pushes must be a multiple of 16 */
+		int newOffset = (offset + pushed + 15) / 16 * 16 - pushed;
 
-	inst = ssave("\tsubq $8, %rsp");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+		append(instList,mirInst1(MIR_PUSH,8,mirReg(MIR_RBP,8)));
+		append(instList,mirInst2(MIR_MOV,8,mirReg(MIR_RSP,8),mirReg(MIR_RBP,8)));
+		if (newOffset > 0)
+			append(instList,mirInst2(MIR_SUB,8,mirImm(newOffset),mirReg(MIR_RSP,8)));
+	}
+	for (i = 0; i < NUM_CALLEE_SAVED; i++)
+		if ((used & (1 << calleeSavedRegisters[i])) != 0)
+			append(instList,mirInst1(MIR_PUSH,8,mirReg(calleeSavedRegisters[i],8)));
 }
 
 /**
@@ -748,14 +1007,9 @@ void emitStartFunction(DList instList, int offset) {
  */
 int emitCallFunction(DList instList, SymTable symtab, char *func) {
 	int newRegIndex = getFreeIntegerRegisterIndex(symtab);
-	char* newRegName = (char*)SymGetFieldByIndex(symtab,newRegIndex,SYM_NAME_FIELD);
-	char *inst;
 	
-	inst = nssave(2,"\tcall ",func);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-
-	inst = nssave(2,"\tmovl %eax, ",newRegName);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst1(MIR_CALL,0,mirSymbol(func)));
+	append(instList,mirInst2(MIR_MOV,4,mirReg(MIR_RAX,4),regOperand(symtab,newRegIndex,4)));
 
 	return newRegIndex;
 }
@@ -769,45 +1023,109 @@ int emitCallFunction(DList instList, SymTable symtab, char *func) {
  * @param funcIndec the index of the return register storing the final value
  */
 void emitReturnFunction(DList instList, SymTable lsymtab, SymTable symtab, int funcIndex) {
-	int test = 1;
-	char *regName = (char*)SymGetFieldByIndex(symtab,funcIndex,SYM_NAME_FIELD);
-	if (regName == NULL) {
-		test = 0;
-		regName = (char*)SymGetFieldByIndex(lsymtab,funcIndex,SYM_NAME_FIELD);
-	}
-
-	char *inst = nssave(3,"\tmovl ",regName,", %eax");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
-	if (test) {
-		freeIntegerRegister((int)SymGetFieldByIndex(symtab,funcIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	} else {
-		freeIntegerRegister((int)SymGetFieldByIndex(lsymtab,funcIndex,SYMTAB_REGISTER_INDEX_FIELD));
-	}
+	append(instList,mirInst2(MIR_MOV,4,regOperand(symtab,funcIndex,4),mirReg(MIR_RAX,4)));
 }
 
 /**
  * Ends each function by popping necessary registers off the stack
  *
  * @param instList a Dlist of instructions
+ * @param used the registers the function names, as for emitStartFunction
+ * @param frame false if the function has no frame
  */
-void emitEndFunction(DList instList) {
-	char *inst = ssave("\taddq $8, %rsp");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+void emitEndFunction(DList instList, int used, bool frame) {
+	int i;
+
+	for (i = NUM_CALLEE_SAVED - 1; i >= 0; i--)
+		if ((used & (1 << calleeSavedRegisters[i])) != 0)
+			append(instList,mirInst1(MIR_POP,8,mirReg(calleeSavedRegisters[i],8)));
+	if (frame)
+		append(instList,mirInst(MIR_LEAVE,0));
+}
 
-	inst = ssave("\tpopq %r15");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Add the start of an entry for on-stack replacement after a function, up to
+ * where its frame is set up by emitStartFunction. The entry is called with
+ * the address of the locals of an interpreted call in %rdi, %eax in %esi and
+ * the loop to continue at in %edx.
+ *
+ * @param instList a Dlist of instructions
+ * @param name the name of the function
+ */
+void emitOsrPrologue(DList instList, char *name) {
+	char *label = nssave(2,name,".osr");
+	append(instList,mirInst1(MIR_LABEL,0,mirSymbol(label)));
+	append(instList,mirInst(MIR_NOP,0));
+	sfree(label);
+}
 
-	inst = ssave("\tpopq %r14");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Add the rest of the entry begun by emitOsrPrologue: it copies the local
+ * variables of the interpreted call into the frame and takes over the value
+ * of %eax. It is followed by the tests of emitOsrDispatch that jump to the
+ * loop.
+ *
+ * @param instList a Dlist of instructions
+ * @param name the name of the function
+ * @param offset the size of the local variables
+ */
+void emitOsrEntry(DList instList, char *name, int offset) {
+	char *label;
+
+	if (offset > 0) {
+		label = nssave(2,name,".osr_copy");
+		append(instList,mirInst2(MIR_MOV,8,mirReg(MIR_RBP,8),mirReg(MIR_RCX,8)));
+		append(instList,mirInst2(MIR_ADD,8,mirImm(-offset),mirReg(MIR_RCX,8)));
+		append(instList,mirInst2(MIR_MOV,4,mirImm(offset / INTEGER_SIZE),mirReg(MIR_R8,4)));
+		append(instList,mirInst1(MIR_LABEL,0,mirSymbol(label)));
+		append(instList,mirInst2(MIR_MOV,4,mirMem(MIR_RDI,MIR_NO_REG,1,0),mirReg(MIR_RAX,4)));
+		append(instList,mirInst2(MIR_MOV,4,mirReg(MIR_RAX,4),mirMem(MIR_RCX,MIR_NO_REG,1,0)));
+		append(instList,mirInst2(MIR_ADD,8,mirImm(4),mirReg(MIR_RDI,8)));
+		append(instList,mirInst2(MIR_ADD,8,mirImm(4),mirReg(MIR_RCX,8)));
+		append(instList,mirInst2(MIR_SUB,4,mirImm(1),mirReg(MIR_R8,4)));
+		append(instList,mirJump(MIR_COND_NE,mirSymbol(label)));
+		sfree(label);
+	}
 
-	inst = ssave("\tpopq %r13");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_MOV,4,mirReg(MIR_RSI,4),mirReg(MIR_RAX,4)));
+}
 
-	inst = ssave("\tpopq %r12");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * Add a test to the entry of emitOsrEntry that skips to the next test unless
+ * %edx holds the number of a while loop. The test is followed by the loads of
+ * the variables the loop keeps in registers and by emitOsrResume.
+ *
+ * @param instList a Dlist of instructions
+ * @param name the name of the function
+ * @param loop the number of the loop
+ */
+void emitOsrDispatch(DList instList, char *name, int loop) {
+	char number[20];
+
+	snprintf(number,20,"%d",loop);
+	char *label = nssave(3,name,".osr",number);
+	append(instList,mirInst2(MIR_CMP,4,mirImm(loop),mirReg(MIR_RDX,4)));
+	append(instList,mirJump(MIR_COND_NE,mirSymbol(label)));
+	sfree(label);
+}
 
-	inst = ssave("\tpopq %rbx");
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+/**
+ * End the test of emitOsrDispatch: jump to the landing pad of the loop.
+ *
+ * @param instList a Dlist of instructions
+ * @param symtab a symbol table
+ * @param name the name of the function
+ * @param loop the number of the loop
+ * @param beginLabelIndex a symbol table index of the label for the while loop landing pad
+ */
+void emitOsrResume(DList instList, SymTable symtab, char *name, int loop, int beginLabelIndex) {
+	char number[20];
+
+	snprintf(number,20,"%d",loop);
+	char *label = nssave(3,name,".osr",number);
+	append(instList,mirJump(MIR_COND_NONE,labelOperand(symtab,beginLabelIndex)));
+	append(instList,mirInst1(MIR_LABEL,0,mirSymbol(label)));
+	sfree(label);
 }
 
 /**
@@ -817,9 +1135,7 @@ void emitEndFunction(DList instList) {
  * @param test is a char array of string to be printed
  */
 void emitTest(DList instList, char *test) {
-	char *inst;
-	inst = nssave(2,"\t",test);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirText(nssave(2,"\t",test)));
 }
 
 /**
@@ -831,10 +1147,9 @@ void emitTest(DList instList, char *test) {
  * @return
  */
 static char* makeDataDeclaration(DList dataList, SymTable symtab, int stringIndex) {
-	static int stringNum = 0;
 	char* string = (char*)SymGetFieldByIndex(symtab,stringIndex,SYM_NAME_FIELD);
-	char* strLabel = (char*)malloc(sizeof(char)*15);
-	snprintf(strLabel,15,".string_const%d",stringNum++);
+	char* strLabel = (char*)malloc(sizeof(char)*32);
+	snprintf(strLabel,32,".string_const%d",stringNum++);
 
 	char* strChars = substr(string,1,strlen(string)-2); /**< the string constant w/o quotes */
 	char* decl = nssave(4,strLabel,": .string \"",strChars,"\"");
@@ -856,10 +1171,8 @@ static char* makeDataDeclaration(DList dataList, SymTable symtab, int stringInde
 int emitLoadStringConstantAddress(DList instList, DList dataList, SymTable symtab, int stringIndex) {
 	char *strLabel = makeDataDeclaration(dataList,symtab,stringIndex);
 	int regIndex = getFreeIntegerRegisterIndex(symtab);
-	char* regName = (char*)SymGetFieldByIndex(symtab,regIndex,SYM_NAME_FIELD);
 
-	char* inst = nssave(4,"\tmovl $", strLabel, ", ", regName);
-	dlinkAppend(instList,dlinkNodeAlloc(inst));
+	append(instList,mirInst2(MIR_MOV,4,mirSymbolImm(strLabel,0),regOperand(symtab,regIndex,4)));
 	free(strLabel);
 
 	return regIndex;
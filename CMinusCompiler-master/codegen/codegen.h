@@ -1,6 +1,8 @@
 #ifndef CODEGEN_H_
 #define CODEGEN_H_
 
+#include "mir.h"
+
 #define PRINT_INTEGER_FMT ".int_wformat"	/**< The printf code for printing an integer */
 #define PRINT_FLOAT_FMT ".float_wformat"	/**< The printf code for printing a float */
 #define PRINT_STRING_FMT ".str_wformat"	/**< The printf code for printing a string */
@@ -23,14 +25,22 @@ typedef struct AddIdType {
 } AddIdStruct, *AddIdStructPtr;
 
 
-EXTERN(void, emitDataPrologue, (DList dataList));
+EXTERN(void, emitProcedurePrologue, (DList instList, SymTable symtab, int index));
+EXTERN(void, emitDataPrologue, (void));
+EXTERN(void, emitDataDeclarations, (DList dataList));
 EXTERN(void, emitInstructions,(DList list));
+EXTERN(void, setLabelNumbers,(int labelNum, int stringNumber));
+
+extern __thread int codegenErrors;	/**< the number of errors reported on this thread */
 
-EXTERN(void, emitAssignment, (DList instList, SymTable lsymtab, SymTable rsymtab, int lhsRegIndex, int rhsRegIndex));
+EXTERN(void, emitAssignment, (DList instList, SymTable symtab, MirOperand lhs, int rhsRegIndex));
 EXTERN(void, emitReadVariable, (DList instList, SymTable symtab, int addrIndex));
 EXTERN(void, emitWriteExpression,(DList instList,SymTable symtab, int index, char *syscallService));
 EXTERN(void, emitWriteString,(DList instList,SymTable symtab, int index, DList dataList));
 EXTERN(int, emitIfTest, (DList instList, SymTable symtab, int regIndex));
+EXTERN(int, emitCompareTest, (DList instList, SymTable symtab, int leftOperand, int rightOperand, MirCondition cond));
+EXTERN(int, emitCompareImmediateTest, (DList instList, SymTable symtab, int leftOperand, int value, MirCondition cond));
+EXTERN(int, emitConstantTest, (DList instList, SymTable symtab, bool value));
 EXTERN(void, emitEndBranchTarget, (DList instList, SymTable symtab, int endLabelIndex));
 EXTERN(int, emitThenBranch, (DList instList, SymTable symtab, int elseLabelIndex));
 EXTERN(int, emitWhileLoopLandingPad, (DList instList,SymTable symtab));
@@ -50,16 +60,32 @@ EXTERN(int, emitAddExpression, (DList instList, SymTable symtab, int leftOperand
 EXTERN(int, emitSubtractExpression, (DList instList, SymTable symtab, int leftOperand, int rightOperand));
 EXTERN(int, emitMultiplyExpression, (DList instList, SymTable symtab, int leftOperand, int rightOperand));
 EXTERN(int, emitDivideExpression, (DList instList, SymTable symtab, int leftOperand, int rightOperand));
+EXTERN(int, emitMultiplyImmediate, (DList instList, SymTable symtab, int leftOperand, int value));
+EXTERN(int, emitDivideImmediate, (DList instList, SymTable symtab, int leftOperand, int value));
+EXTERN(void, emitQuotient, (DList instList, SymTable symtab, int regIndex));
+EXTERN(int, emitImmediateExpression, (DList instList, SymTable symtab, int leftOperand, int value, MirOpcode opcode));
+EXTERN(int, emitCompareImmediateExpression, (DList instList, SymTable symtab, int leftOperand, int value, MirCondition cond));
 
-EXTERN(int, emitComputeArrayAddress, (DList instList, SymTable vsymtab, SymTable symtab, char *varName, int subIndex));
-EXTERN(int, emitComputeVarAddress,(DList instList, SymTable lsymtab, SymTable symtab, char* varName));
-EXTERN(int, emitLoadVariable,(DList instList, SymTable lsymtab, SymTable symtab, int varIndex));
+EXTERN(MirOperand, emitVariableOperand, (DList instList, SymTable gsymtab, SymTable symtab, char *varName, int subIndex, int element));
+EXTERN(int, emitComputeAddress,(DList instList, SymTable symtab, MirOperand var));
+EXTERN(int, emitLoadVariable,(DList instList, SymTable symtab, MirOperand var));
+EXTERN(void, emitLoadPromotedVariable,(DList instList, SymTable lsymtab, SymTable symtab, char *varName, int regIndex));
+EXTERN(void, emitMoveRegister,(DList instList, SymTable symtab, int srcIndex, int dstIndex));
+EXTERN(int, emitCopyRegister,(DList instList, SymTable symtab, int regIndex));
 EXTERN(int, emitLoadIntegerConstant,(DList instList, SymTable symtab, int intIndex));
+EXTERN(int, emitLoadImmediate,(DList instList, SymTable symtab, long value));
+EXTERN(void, emitMoveImmediate,(DList instList, SymTable symtab, long value, int regIndex));
+EXTERN(int, emitLoadStringConstantAddress,(DList instList, DList dataList, SymTable symtab, int stringIndex));
 
-EXTERN(void, emitStartFunction,(DList instList, int offset));
+EXTERN(void, emitStartFunction,(DList instList, int offset, int used, bool frame));
 EXTERN(int, emitCallFunction,(DList instList, SymTable symtab, char *func));
 EXTERN(void, emitReturnFunction, (DList instList, SymTable lsymtab, SymTable symtab, int funcIndex));
-EXTERN(void, emitEndFunction,(DList instList));
+EXTERN(void, emitEndFunction,(DList instList, int used, bool frame));
+EXTERN(void, emitExit,(DList instList));
+EXTERN(void, emitOsrPrologue,(DList instList, char *name));
+EXTERN(void, emitOsrEntry,(DList instList, char *name, int offset));
+EXTERN(void, emitOsrDispatch,(DList instList, char *name, int loop));
+EXTERN(void, emitOsrResume,(DList instList, SymTable symtab, char *name, int loop, int beginLabelIndex));
 
 EXTERN(void, emitTest,(DList instList, char *test));
 
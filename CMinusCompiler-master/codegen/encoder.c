@@ -0,0 +1,1826 @@
+/**
+ * encoder.c
+ *
+ * The built-in assembler.
+ *
+ * Each line is encoded as soon as it is complete, and the machine IR of a
+ * function is encoded as it is handed over, each instruction exactly as the
+ * line it would be printed as but without making and parsing the text. A reference to a symbol is
+ * recorded as a fixup at the position of its 32-bit field, and at the end the
+ * fixups to labels in the same section are patched and the others become
+ * relocations. Jumps and calls always use 32-bit displacements, so the size
+ * of an instruction never depends on where a label lands and one pass over
+ * the text is enough.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <elf.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <util/general.h>
+#include <util/symtab.h>
+#include <util/string_utils.h>
+#include "mir.h"
+#include "encoder.h"
+
+#define MAX_NAME 256			/**< the longest symbol, mnemonic or register name */
+#define SYMBOLS_SIZE 1024		/**< the initial size of the symbol tables */
+#define MIR_KEYS 16			/**< the sizes or conditions the mnemonic of an opcode is kept by */
+
+#define SYM_SECTION_FIELD "section"	/**< the section a symbol is defined in */
+#define SYM_VALUE_FIELD "value"		/**< the offset of a symbol, or the alignment of a common symbol */
+#define SYM_SIZE_FIELD "size"		/**< the size of a common symbol */
+#define SYM_FLAGS_FIELD "flags"		/**< SYMBOL_ flags */
+#define SYM_ADDRESS_FIELD "address"	/**< the address given by encoderBind */
+
+#define SYMBOL_DEFINED 1
+#define SYMBOL_GLOBAL 2
+#define SYMBOL_FUNCTION 4
+#define SYMBOL_OBJECT 8
+#define SYMBOL_COMMON 16
+#define SYMBOL_BOUND 32			/**< given an address by encoderBind */
+
+#define LOCAL_LABEL_PREFIX ".L"		/**< labels left out of the symbol table, as the assembler does */
+
+enum { SECTION_TEXT, SECTION_DATA, SECTION_RODATA, NUM_SECTIONS };
+
+static const char *sectionNames[NUM_SECTIONS] = {".text", ".data", ".rodata"};
+static const uint64_t sectionFlags[NUM_SECTIONS] = {
+	SHF_ALLOC | SHF_EXECINSTR, SHF_ALLOC | SHF_WRITE, SHF_ALLOC
+};
+
+/**
+ * The bytes of one section.
+ */
+typedef struct Section_struct {
+	unsigned char *bytes;
+	size_t length;
+	size_t max;
+	size_t align;
+} Section;
+
+typedef enum { FIXUP_PC32, FIXUP_ABS32, FIXUP_ABS32S } FixupKind;
+
+/**
+ * A 32-bit field that holds the value of a symbol. The field is
+ * symbol + addend for the absolute kinds and symbol + addend - (its own
+ * offset) for FIXUP_PC32, as in an ELF relocation.
+ */
+typedef struct Fixup_struct {
+	int section;
+	size_t offset;
+	int symbol;		/**< the index of the symbol in Encoder symbols */
+	long addend;
+	FixupKind kind;
+} Fixup;
+
+typedef enum {
+	OP_FIXED, OP_MOV, OP_ALU, OP_TEST, OP_IMUL, OP_UNARY, OP_SHIFT, OP_EXTEND,
+	OP_LEA, OP_CMOV, OP_SET, OP_JCC, OP_JMP, OP_CALL, OP_PUSH, OP_POP
+} OpClass;
+
+/**
+ * An instruction the encoder knows.
+ */
+typedef struct Mnemonic_struct {
+	char *name;
+	OpClass opClass;
+	int size;		/**< the operand size given by the suffix, 0 if it comes from the registers */
+	int code;		/**< the opcode, /digit or condition code, depending on the class */
+} Mnemonic;
+
+static Mnemonic mnemonics[] = {
+	{"nop", OP_FIXED, 0, 0x90},
+	{"ret", OP_FIXED, 0, 0xc3},
+	{"leave", OP_FIXED, 0, 0xc9},
+	{"cdq", OP_FIXED, 0, 0x99},
+	{"cltd", OP_FIXED, 0, 0x99},
+	{"cqo", OP_FIXED, 0, 0x4899},
+	{"cqto", OP_FIXED, 0, 0x4899},
+	{"cltq", OP_FIXED, 0, 0x4898},
+	{"movl", OP_MOV, 4, 0}, {"movq", OP_MOV, 8, 0}, {"mov", OP_MOV, 0, 0},
+	{"addl", OP_ALU, 4, 0}, {"addq", OP_ALU, 8, 0}, {"add", OP_ALU, 0, 0},
+	{"orl", OP_ALU, 4, 1}, {"orq", OP_ALU, 8, 1}, {"or", OP_ALU, 0, 1},
+	{"andl", OP_ALU, 4, 4}, {"andq", OP_ALU, 8, 4}, {"and", OP_ALU, 0, 4},
+	{"subl", OP_ALU, 4, 5}, {"subq", OP_ALU, 8, 5}, {"sub", OP_ALU, 0, 5},
+	{"xorl", OP_ALU, 4, 6}, {"xorq", OP_ALU, 8, 6}, {"xor", OP_ALU, 0, 6},
+	{"cmpl", OP_ALU, 4, 7}, {"cmpq", OP_ALU, 8, 7}, {"cmp", OP_ALU, 0, 7},
+	{"testl", OP_TEST, 4, 0}, {"testq", OP_TEST, 8, 0}, {"test", OP_TEST, 0, 0},
+	{"imull", OP_IMUL, 4, 0}, {"imulq", OP_IMUL, 8, 0}, {"imul", OP_IMUL, 0, 0},
+	{"notl", OP_UNARY, 4, 2}, {"notq", OP_UNARY, 8, 2},
+	{"negl", OP_UNARY, 4, 3}, {"negq", OP_UNARY, 8, 3},
+	{"divl", OP_UNARY, 4, 6}, {"divq", OP_UNARY, 8, 6},
+	{"idivl", OP_UNARY, 4, 7}, {"idivq", OP_UNARY, 8, 7},
+	{"shll", OP_SHIFT, 4, 4}, {"shlq", OP_SHIFT, 8, 4},
+	{"sall", OP_SHIFT, 4, 4}, {"salq", OP_SHIFT, 8, 4},
+	{"shrl", OP_SHIFT, 4, 5}, {"shrq", OP_SHIFT, 8, 5},
+	{"sarl", OP_SHIFT, 4, 7}, {"sarq", OP_SHIFT, 8, 7},
+	{"movslq", OP_EXTEND, 8, 0x63},
+	{"movsbl", OP_EXTEND, 4, 0x0fbe}, {"movsbq", OP_EXTEND, 8, 0x0fbe},
+	{"movzbl", OP_EXTEND, 4, 0x0fb6}, {"movzbq", OP_EXTEND, 8, 0x0fb6},
+	{"leal", OP_LEA, 4, 0}, {"leaq", OP_LEA, 8, 0},
+	{"jmp", OP_JMP, 0, 0},
+	{"call", OP_CALL, 0, 0}, {"callq", OP_CALL, 0, 0},
+	{"pushq", OP_PUSH, 8, 0}, {"push", OP_PUSH, 8, 0},
+	{"popq", OP_POP, 8, 0}, {"pop", OP_POP, 8, 0},
+};
+
+#define NUM_MNEMONICS (sizeof(mnemonics) / sizeof(mnemonics[0]))
+
+/**
+ * The condition codes of jcc, cmovcc and setcc.
+ */
+static struct { char *name; int code; } conditions[] = {
+	{"o", 0}, {"no", 1}, {"b", 2}, {"c", 2}, {"nae", 2}, {"ae", 3}, {"nb", 3}, {"nc", 3},
+	{"e", 4}, {"z", 4}, {"ne", 5}, {"nz", 5}, {"be", 6}, {"na", 6}, {"a", 7}, {"nbe", 7},
+	{"s", 8}, {"ns", 9}, {"p", 10}, {"pe", 10}, {"np", 11}, {"po", 11},
+	{"l", 12}, {"nge", 12}, {"ge", 13}, {"nl", 13}, {"le", 14}, {"ng", 14}, {"g", 15}, {"nle", 15},
+};
+
+#define NUM_CONDITIONS (sizeof(conditions) / sizeof(conditions[0]))
+#define MNEMONICS_PER_CONDITION 5	/**< jcc, cmovcc, cmovccl, cmovccq and setcc */
+
+/**
+ * A general purpose register.
+ */
+typedef struct Register_struct {
+	char *name;
+	int number;		/**< 0-15, as in the ModRM byte and REX prefix */
+	int size;		/**< in bytes */
+	bool rex;		/**< a byte register that needs a REX prefix */
+} Register;
+
+static Register registers[] = {
+	{"rax", 0, 8}, {"rcx", 1, 8}, {"rdx", 2, 8}, {"rbx", 3, 8},
+	{"rsp", 4, 8}, {"rbp", 5, 8}, {"rsi", 6, 8}, {"rdi", 7, 8},
+	{"r8", 8, 8}, {"r9", 9, 8}, {"r10", 10, 8}, {"r11", 11, 8},
+	{"r12", 12, 8}, {"r13", 13, 8}, {"r14", 14, 8}, {"r15", 15, 8},
+	{"eax", 0, 4}, {"ecx", 1, 4}, {"edx", 2, 4}, {"ebx", 3, 4},
+	{"esp", 4, 4}, {"ebp", 5, 4}, {"esi", 6, 4}, {"edi", 7, 4},
+	{"r8d", 8, 4}, {"r9d", 9, 4}, {"r10d", 10, 4}, {"r11d", 11, 4},
+	{"r12d", 12, 4}, {"r13d", 13, 4}, {"r14d", 14, 4}, {"r15d", 15, 4},
+	{"al", 0, 1}, {"cl", 1, 1}, {"dl", 2, 1}, {"bl", 3, 1},
+	{"spl", 4, 1, true}, {"bpl", 5, 1, true}, {"sil", 6, 1, true}, {"dil", 7, 1, true},
+	{"r8b", 8, 1}, {"r9b", 9, 1}, {"r10b", 10, 1}, {"r11b", 11, 1},
+	{"r12b", 12, 1}, {"r13b", 13, 1}, {"r14b", 14, 1}, {"r15b", 15, 1},
+};
+
+#define NUM_REGISTERS (sizeof(registers) / sizeof(registers[0]))
+
+typedef enum { OPERAND_REGISTER, OPERAND_IMMEDIATE, OPERAND_MEMORY } OperandKind;
+
+/**
+ * A parsed operand. A memory operand without a base or index register is
+ * also the target of a jump or call.
+ */
+typedef struct Operand_struct {
+	OperandKind kind;
+	Register *reg;		/**< a register operand */
+	Register *base;		/**< the base register of a memory operand, or NULL */
+	Register *index;	/**< the index register of a memory operand, or NULL */
+	int scale;
+	long value;		/**< an immediate, or a displacement added to the symbol */
+	int symbol;		/**< the symbol of the value, or SYM_INVALID_INDEX */
+} Operand;
+
+#define MAX_OPERANDS 3
+
+struct Encoder_struct {
+	Section sections[NUM_SECTIONS];
+	int section;			/**< the section being assembled into */
+	SymTable symbols;		/**< labels and other symbols */
+	SymTable names;			/**< mnemonics and registers, registers with their % */
+	Generic *entries;		/**< the Mnemonic or Register of each name, by its index in names */
+	int maxEntries;
+	Mnemonic *conditional;		/**< the mnemonics made from conditions */
+	Mnemonic **mirMnemonics;	/**< the mnemonic of each MIR opcode, by size or condition */
+	int *labelSymbols;		/**< 1 + the symbol of each label .L<n> of the machine IR by n, 0 until looked up */
+	long maxLabels;
+	Fixup *fixups;
+	int numFixups;
+	int maxFixups;
+	char *line;			/**< a line not yet complete */
+	size_t lineLength;
+	size_t maxLine;
+	int lineNumber;
+	int errors;
+	unsigned char *image;		/**< the memory the code is loaded into by encoderLoad */
+	size_t imageSize;
+	uintptr_t *addresses;		/**< the address of each symbol in the image */
+};
+
+/**
+ * Report a line that cannot be assembled.
+ *
+ * @param encoder an encoder
+ * @param line the line
+ * @param message what is wrong with it
+ */
+static void encoderError(Encoder encoder, const char *line, const char *message) {
+	fprintf(stderr,"Error: Cannot assemble line %d, %s: %s\n",encoder->lineNumber,message,line);
+	encoder->errors++;
+}
+
+/**
+ * Make room for more bytes in the current section.
+ */
+static unsigned char *reserve(Encoder encoder, size_t length) {
+	Section *section = &encoder->sections[encoder->section];
+	if (section->length + length > section->max) {
+		section->max = MAX(2 * section->max, section->length + length + 4096);
+		section->bytes = (unsigned char*)realloc(section->bytes,section->max);
+	}
+	unsigned char *p = section->bytes + section->length;
+	section->length += length;
+	return p;
+}
+
+static void emitByte(Encoder encoder, int byte) {
+	*reserve(encoder,1) = (unsigned char)byte;
+}
+
+/**
+ * Emit a little-endian number.
+ */
+static void emitNumber(Encoder encoder, uint64_t n, int length) {
+	unsigned char *p = reserve(encoder,length);
+	int i;
+
+	for (i = 0; i < length; i++, n >>= 8)
+		p[i] = (unsigned char)n;
+}
+
+/**
+ * Emit a 32-bit field holding the value of an operand, with a fixup if it
+ * names a symbol.
+ *
+ * @param encoder an encoder
+ * @param op an immediate or memory operand
+ * @param kind how the symbol is used
+ */
+static void emitField32(Encoder encoder, Operand *op, FixupKind kind) {
+	if (op->symbol == SYM_INVALID_INDEX) {
+		emitNumber(encoder,(uint64_t)op->value,4);
+		return;
+	}
+
+	if (encoder->numFixups == encoder->maxFixups) {
+		encoder->maxFixups = MAX(2 * encoder->maxFixups,1024);
+		encoder->fixups = (Fixup*)realloc(encoder->fixups,encoder->maxFixups * sizeof(Fixup));
+	}
+	Fixup *fixup = &encoder->fixups[encoder->numFixups++];
+	fixup->section = encoder->section;
+	fixup->offset = encoder->sections[encoder->section].length;
+	fixup->symbol = op->symbol;
+	fixup->addend = kind == FIXUP_PC32 ? op->value - 4 : op->value;
+	fixup->kind = kind;
+	emitNumber(encoder,0,4);
+}
+
+static bool fitsByte(long n) {
+	return n >= -128 && n <= 127;
+}
+
+static bool fitsInt(long n) {
+	return n >= INT32_MIN && n <= INT32_MAX;
+}
+
+/**
+ * Emit an instruction with a ModRM byte: the prefixes, the opcode, the ModRM
+ * byte and whatever SIB byte and displacement the r/m operand needs.
+ *
+ * @param encoder an encoder
+ * @param size the operand size, 8 for a REX.W prefix
+ * @param opcode one opcode byte, or two with the first in the high byte
+ * @param reg the register number or /digit of the reg field
+ * @param rex true if a byte register needs a REX prefix
+ * @param rm a register or memory operand
+ */
+static void emitModRM(Encoder encoder, int size, int opcode, int reg, bool rex, Operand *rm) {
+	int prefix = size == 8 ? 0x48 : rex ? 0x40 : 0;
+
+	if (reg & 8)
+		prefix |= 0x44;
+	if (rm->kind == OPERAND_REGISTER) {
+		if (rm->reg->number & 8)
+			prefix |= 0x41;
+		if (rm->reg->rex)
+			prefix |= 0x40;
+	} else {
+		if (rm->base != NULL && (rm->base->number & 8))
+			prefix |= 0x41;
+		if (rm->index != NULL && (rm->index->number & 8))
+			prefix |= 0x42;
+	}
+	if (prefix != 0)
+		emitByte(encoder,prefix);
+	if (opcode > 0xff)
+		emitByte(encoder,opcode >> 8);
+	emitByte(encoder,opcode & 0xff);
+
+	reg = (reg & 7) << 3;
+	if (rm->kind == OPERAND_REGISTER) {
+		emitByte(encoder,0xc0 | reg | (rm->reg->number & 7));
+		return;
+	}
+
+	/* an absolute address needs a SIB byte; without one it is %rip relative */
+	if (rm->base == NULL) {
+		int index = rm->index == NULL ? 4 : rm->index->number & 7;
+		int scale = rm->scale == 8 ? 3 : rm->scale == 4 ? 2 : rm->scale == 2 ? 1 : 0;
+		emitByte(encoder,reg | 4);
+		emitByte(encoder,(scale << 6) | (index << 3) | 5);
+		emitField32(encoder,rm,FIXUP_ABS32S);
+		return;
+	}
+
+	int base = rm->base->number & 7;
+	int mod;
+	if (rm->symbol != SYM_INVALID_INDEX || !fitsByte(rm->value))
+		mod = 0x80;
+	else if (rm->value != 0 || base == 5)	/* %rbp and %r13 have no form without a displacement */
+		mod = 0x40;
+	else
+		mod = 0;
+
+	if (rm->index == NULL && base != 4)
+		emitByte(encoder,mod | reg | base);
+	else {	/* %rsp and %r12 as a base need a SIB byte */
+		int index = rm->index == NULL ? 4 : rm->index->number & 7;
+		int scale = rm->scale == 8 ? 3 : rm->scale == 4 ? 2 : rm->scale == 2 ? 1 : 0;
+		emitByte(encoder,mod | reg | 4);
+		emitByte(encoder,(scale << 6) | (index << 3) | base);
+	}
+
+	if (mod == 0x40)
+		emitByte(encoder,rm->value);
+	else if (mod == 0x80)
+		emitField32(encoder,rm,FIXUP_ABS32S);
+}
+
+/**
+ * Emit an immediate: one byte if isShort is true, otherwise 32 bits,
+ * sign-extended for 64-bit instructions.
+ */
+static void emitImmediate(Encoder encoder, Operand *op, int size, bool isShort) {
+	if (isShort)
+		emitByte(encoder,op->value);
+	else
+		emitField32(encoder,op,size == 8 ? FIXUP_ABS32S : FIXUP_ABS32);
+}
+
+/**
+ * Return true if an immediate operand is a number that fits in a byte, so an
+ * instruction can use its short form.
+ */
+static bool isByteImmediate(Operand *op) {
+	return op->symbol == SYM_INVALID_INDEX && fitsByte(op->value);
+}
+
+/**
+ * Copy a name into a buffer.
+ *
+ * @return false if the name is empty or too long
+ */
+static bool copyName(char *buffer, const char *start, const char *end) {
+	if (end == start || end - start >= MAX_NAME)
+		return false;
+	memcpy(buffer,start,end - start);
+	buffer[end - start] = '\0';
+	return true;
+}
+
+static const char *skipSpace(const char *p) {
+	while (*p == ' ' || *p == '\t')
+		p++;
+	return p;
+}
+
+static const char *scanName(const char *p) {
+	while (isalnum((unsigned char)*p) || *p == '_' || *p == '.')
+		p++;
+	return p;
+}
+
+/**
+ * Look up a register name following a %.
+ *
+ * @param encoder an encoder
+ * @param pp the position of the %, moved past the name
+ * @return the register or NULL
+ */
+static Register *parseRegister(Encoder encoder, const char **pp) {
+	char name[MAX_NAME];
+	const char *end = scanName(*pp + 1);
+
+	if (!copyName(name,*pp,end))
+		return NULL;
+	*pp = end;
+
+	int index = SymQueryIndex(encoder->names,name);
+	return index == SYM_INVALID_INDEX ? NULL : (Register*)encoder->entries[index];
+}
+
+/**
+ * Parse a number, or a symbol with an optional number added or subtracted.
+ *
+ * @param encoder an encoder
+ * @param pp the position of the expression, moved past it
+ * @param op the operand whose value and symbol are set
+ * @return false if there is no expression
+ */
+static bool parseExpression(Encoder encoder, const char **pp, Operand *op) {
+	const char *p = *pp;
+	char *end;
+
+	if (*p != '-' && *p != '+' && !isdigit((unsigned char)*p)) {
+		char name[MAX_NAME];
+		const char *nameEnd = scanName(p);
+		if (!copyName(name,p,nameEnd))
+			return false;
+		op->symbol = SymIndex(encoder->symbols,name);
+		p = skipSpace(nameEnd);
+		if (*p != '-' && *p != '+') {
+			*pp = p;
+			return true;
+		}
+	}
+
+	op->value = strtol(p,&end,0);
+	if (end == p)
+		return false;
+	*pp = end;
+	return true;
+}
+
+/**
+ * Parse an operand: %reg, $expression, or expression(%base,%index,scale)
+ * with any of the parts of a memory operand left out.
+ *
+ * @param encoder an encoder
+ * @param pp the position of the operand, moved past it and any spaces
+ * @param op the parsed operand
+ * @return false if the operand is not understood
+ */
+static bool parseOperand(Encoder encoder, const char **pp, Operand *op) {
+	const char *p = skipSpace(*pp);
+
+	memset(op,0,sizeof(Operand));
+	op->symbol = SYM_INVALID_INDEX;
+	op->scale = 1;
+
+	if (*p == '%') {
+		op->kind = OPERAND_REGISTER;
+		if ((op->reg = parseRegister(encoder,&p)) == NULL)
+			return false;
+	} else if (*p == '$') {
+		op->kind = OPERAND_IMMEDIATE;
+		p++;
+		if (!parseExpression(encoder,&p,op))
+			return false;
+	} else {
+		op->kind = OPERAND_MEMORY;
+		if (*p != '(' && !parseExpression(encoder,&p,op))
+			return false;
+		p = skipSpace(p);
+		if (*p == '(') {
+			p = skipSpace(p + 1);
+			if (*p == '%' && (op->base = parseRegister(encoder,&p)) == NULL)
+				return false;
+			p = skipSpace(p);
+			if (*p == ',') {
+				p = skipSpace(p + 1);
+				if (*p != '%' || (op->index = parseRegister(encoder,&p)) == NULL)
+					return false;
+				p = skipSpace(p);
+				if (*p == ',') {
+					char *end;
+					op->scale = (int)strtol(p + 1,&end,10);
+					p = skipSpace(end);
+				}
+			}
+			if (*p++ != ')')
+				return false;
+			if ((op->base != NULL && op->base->size != 8) ||
+			    (op->index != NULL && (op->index->size != 8 || op->index->number == 4)) ||
+			    (op->scale != 1 && op->scale != 2 && op->scale != 4 && op->scale != 8))
+				return false;
+		}
+	}
+
+	*pp = skipSpace(p);
+	return true;
+}
+
+/**
+ * Return the size of the first register operand, or 0 if there is none.
+ */
+static int registerSize(Operand *ops, int numOps) {
+	int i;
+
+	for (i = 0; i < numOps; i++)
+		if (ops[i].kind == OPERAND_REGISTER)
+			return ops[i].reg->size;
+	return 0;
+}
+
+/**
+ * Return true if every register operand has the given size.
+ */
+static bool registersHaveSize(Operand *ops, int numOps, int size) {
+	int i;
+
+	for (i = 0; i < numOps; i++)
+		if (ops[i].kind == OPERAND_REGISTER && ops[i].reg->size != size)
+			return false;
+	return true;
+}
+
+/**
+ * Return true if an operand is a register or memory, the r/m of a ModRM byte.
+ */
+static bool isRM(Operand *op) {
+	return op->kind == OPERAND_REGISTER || op->kind == OPERAND_MEMORY;
+}
+
+/**
+ * Return true if an operand is the target of a jump or call.
+ */
+static bool isTarget(Operand *op) {
+	return op->kind == OPERAND_MEMORY && op->base == NULL && op->index == NULL && op->symbol != SYM_INVALID_INDEX;
+}
+
+/**
+ * Encode one instruction.
+ *
+ * @param encoder an encoder
+ * @param m the mnemonic
+ * @param ops the operands in AT&T order, source first
+ * @param numOps the number of operands
+ * @return false if the operands do not fit the instruction
+ */
+static bool encodeInstruction(Encoder encoder, Mnemonic *m, Operand *ops, int numOps) {
+	Operand *src = &ops[0];
+	Operand *dst = &ops[numOps - 1];
+	int size = m->size != 0 ? m->size : registerSize(ops,numOps);
+
+	switch (m->opClass) {
+	case OP_FIXED:
+		if (numOps != 0)
+			return false;
+		if (m->code > 0xff)
+			emitByte(encoder,m->code >> 8);
+		emitByte(encoder,m->code & 0xff);
+		return true;
+
+	case OP_MOV:
+		if (numOps != 2 || (size != 4 && size != 8) || !registersHaveSize(ops,2,size) || !isRM(dst))
+			return false;
+		if (src->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,0x89,src->reg->number,false,dst);
+		else if (src->kind == OPERAND_MEMORY && dst->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,0x8b,dst->reg->number,false,src);
+		else if (src->kind != OPERAND_IMMEDIATE)
+			return false;
+		else if (dst->kind == OPERAND_REGISTER && size == 4) {
+			if (dst->reg->number & 8)
+				emitByte(encoder,0x41);
+			emitByte(encoder,0xb8 | (dst->reg->number & 7));
+			emitField32(encoder,src,FIXUP_ABS32);
+		} else if (size == 8 && dst->kind == OPERAND_REGISTER && src->symbol == SYM_INVALID_INDEX && !fitsInt(src->value)) {
+			emitByte(encoder,0x48 | (dst->reg->number >> 3));
+			emitByte(encoder,0xb8 | (dst->reg->number & 7));
+			emitNumber(encoder,(uint64_t)src->value,8);
+		} else {
+			emitModRM(encoder,size,0xc7,0,false,dst);
+			emitImmediate(encoder,src,size,false);
+		}
+		return true;
+
+	case OP_ALU:
+		if (numOps != 2 || (size != 4 && size != 8) || !registersHaveSize(ops,2,size) || !isRM(dst))
+			return false;
+		if (src->kind == OPERAND_IMMEDIATE) {
+			bool isShort = isByteImmediate(src);
+			emitModRM(encoder,size,isShort ? 0x83 : 0x81,m->code,false,dst);
+			emitImmediate(encoder,src,size,isShort);
+		} else if (src->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,8 * m->code + 1,src->reg->number,false,dst);
+		else if (dst->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,8 * m->code + 3,dst->reg->number,false,src);
+		else
+			return false;
+		return true;
+
+	case OP_TEST:
+		if (numOps != 2 || (size != 4 && size != 8) || !registersHaveSize(ops,2,size) || !isRM(dst))
+			return false;
+		if (src->kind == OPERAND_IMMEDIATE) {
+			emitModRM(encoder,size,0xf7,0,false,dst);
+			emitImmediate(encoder,src,size,false);
+		} else if (src->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,0x85,src->reg->number,false,dst);
+		else if (dst->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,0x85,dst->reg->number,false,src);
+		else
+			return false;
+		return true;
+
+	case OP_IMUL:
+		if ((size != 4 && size != 8) || !registersHaveSize(ops,numOps,size))
+			return false;
+		if (numOps == 1 && isRM(src))
+			emitModRM(encoder,size,0xf7,5,false,src);
+		else if (numOps >= 2 && src->kind == OPERAND_IMMEDIATE && dst->kind == OPERAND_REGISTER) {
+			/* imul $n, %r is imul $n, %r, %r */
+			Operand *rm = numOps == 3 ? &ops[1] : dst;
+			bool isShort = isByteImmediate(src);
+			if (!isRM(rm))
+				return false;
+			emitModRM(encoder,size,isShort ? 0x6b : 0x69,dst->reg->number,false,rm);
+			emitImmediate(encoder,src,size,isShort);
+		} else if (numOps == 2 && isRM(src) && dst->kind == OPERAND_REGISTER)
+			emitModRM(encoder,size,0x0faf,dst->reg->number,false,src);
+		else
+			return false;
+		return true;
+
+	case OP_UNARY:
+		if (numOps != 1 || !isRM(src) || !registersHaveSize(ops,1,size))
+			return false;
+		emitModRM(encoder,size,0xf7,m->code,false,src);
+		return true;
+
+	case OP_SHIFT:
+		if (!isRM(dst) || !registersHaveSize(dst,1,size) || numOps > 2)
+			return false;
+		if (numOps == 1 || (src->kind == OPERAND_IMMEDIATE && src->symbol == SYM_INVALID_INDEX && src->value == 1))
+			emitModRM(encoder,size,0xd1,m->code,false,dst);
+		else if (src->kind == OPERAND_IMMEDIATE && src->symbol == SYM_INVALID_INDEX) {
+			emitModRM(encoder,size,0xc1,m->code,false,dst);
+			emitByte(encoder,src->value);
+		} else if (src->kind == OPERAND_REGISTER && src->reg->size == 1 && src->reg->number == 1)
+			emitModRM(encoder,size,0xd3,m->code,false,dst);
+		else
+			return false;
+		return true;
+
+	case OP_EXTEND:
+		if (numOps != 2 || !isRM(src) || dst->kind != OPERAND_REGISTER || dst->reg->size != size ||
+		    (src->kind == OPERAND_REGISTER && src->reg->size != (m->code == 0x63 ? 4 : 1)))
+			return false;
+		emitModRM(encoder,size,m->code,dst->reg->number,false,src);
+		return true;
+
+	case OP_LEA:
+		if (numOps != 2 || src->kind != OPERAND_MEMORY || dst->kind != OPERAND_REGISTER || dst->reg->size != size)
+			return false;
+		emitModRM(encoder,size,0x8d,dst->reg->number,false,src);
+		return true;
+
+	case OP_CMOV:
+		if (numOps != 2 || (size != 4 && size != 8) || !registersHaveSize(ops,2,size) ||
+		    !isRM(src) || dst->kind != OPERAND_REGISTER)
+			return false;
+		emitModRM(encoder,size,0x0f40 | m->code,dst->reg->number,false,src);
+		return true;
+
+	case OP_SET:
+		if (numOps != 1 || !isRM(src) || !registersHaveSize(ops,1,1))
+			return false;
+		emitModRM(encoder,1,0x0f90 | m->code,0,false,src);
+		return true;
+
+	case OP_JCC:
+	case OP_JMP:
+	case OP_CALL:
+		if (numOps != 1 || !isTarget(src))
+			return false;
+		if (m->opClass == OP_JCC) {
+			emitByte(encoder,0x0f);
+			emitByte(encoder,0x80 | m->code);
+		} else
+			emitByte(encoder,m->opClass == OP_JMP ? 0xe9 : 0xe8);
+		emitField32(encoder,src,FIXUP_PC32);
+		return true;
+
+	case OP_PUSH:
+	case OP_POP:
+		if (numOps != 1 || src->kind != OPERAND_REGISTER || src->reg->size != 8)
+			return false;
+		if (src->reg->number & 8)
+			emitByte(encoder,0x41);
+		emitByte(encoder,(m->opClass == OP_PUSH ? 0x50 : 0x58) | (src->reg->number & 7));
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Assemble an instruction.
+ *
+ * @param encoder an encoder
+ * @param line the whole line, for errors
+ * @param name the mnemonic
+ * @param p the operands
+ */
+static void assembleInstruction(Encoder encoder, const char *line, char *name, const char *p) {
+	Operand ops[MAX_OPERANDS];
+	int numOps = 0;
+
+	int index = SymQueryIndex(encoder->names,name);
+	if (index == SYM_INVALID_INDEX) {
+		encoderError(encoder,line,"unknown instruction");
+		return;
+	}
+	Mnemonic *m = (Mnemonic*)encoder->entries[index];
+
+	p = skipSpace(p);
+	while (*p != '\0') {
+		if (numOps == MAX_OPERANDS || !parseOperand(encoder,&p,&ops[numOps++]) ||
+		    (*p != '\0' && *p++ != ',')) {
+			encoderError(encoder,line,"bad operand");
+			return;
+		}
+	}
+
+	if (!encodeInstruction(encoder,m,ops,numOps))
+		encoderError(encoder,line,"bad operands");
+}
+
+/**
+ * Define a symbol at the current position.
+ *
+ * @return false if it is already defined
+ */
+static bool defineSymbol(Encoder encoder, int index) {
+	int flags = (int)(long)SymGetFieldByIndex(encoder->symbols,index,SYM_FLAGS_FIELD);
+
+	if (flags & (SYMBOL_DEFINED | SYMBOL_COMMON))
+		return false;
+	SymPutFieldByIndex(encoder->symbols,index,SYM_FLAGS_FIELD,(Generic)(long)(flags | SYMBOL_DEFINED));
+	SymPutFieldByIndex(encoder->symbols,index,SYM_SECTION_FIELD,(Generic)(long)encoder->section);
+	SymPutFieldByIndex(encoder->symbols,index,SYM_VALUE_FIELD,(Generic)encoder->sections[encoder->section].length);
+	return true;
+}
+
+/**
+ * Define a label at the current position.
+ */
+static void defineLabel(Encoder encoder, const char *line, char *name) {
+	if (!defineSymbol(encoder,SymIndex(encoder->symbols,name)))
+		encoderError(encoder,line,"symbol already defined");
+}
+
+/**
+ * Add flags to a symbol.
+ */
+static void addFlags(Encoder encoder, int index, int flags) {
+	flags |= (int)(long)SymGetFieldByIndex(encoder->symbols,index,SYM_FLAGS_FIELD);
+	SymPutFieldByIndex(encoder->symbols,index,SYM_FLAGS_FIELD,(Generic)(long)flags);
+}
+
+/**
+ * Add flags to the symbol named at p.
+ *
+ * @param encoder an encoder
+ * @param p the position of the name
+ * @param flags SYMBOL_ flags
+ * @param index receives the index of the symbol
+ * @return the position after the name and any spaces, or NULL if there is no name
+ */
+static const char *flagSymbol(Encoder encoder, const char *p, int flags, int *index) {
+	char name[MAX_NAME];
+	const char *end = scanName(p);
+
+	if (!copyName(name,p,end))
+		return NULL;
+	*index = SymIndex(encoder->symbols,name);
+	addFlags(encoder,*index,flags);
+	return skipSpace(end);
+}
+
+/**
+ * Return true if p holds a word and nothing but spaces after it.
+ */
+static bool isWord(const char *p, const char *word) {
+	size_t length = strlen(word);
+	return strncmp(p,word,length) == 0 && *skipSpace(p + length) == '\0';
+}
+
+/**
+ * Emit the characters of the quoted strings at p, with the escapes of the
+ * assembler, each followed by a NUL if terminate is true.
+ *
+ * @return false if a string is not closed
+ */
+static bool emitStrings(Encoder encoder, const char *p, bool terminate) {
+	do {
+		p = skipSpace(p);
+		if (*p++ != '"')
+			return false;
+		while (*p != '"') {
+			int c = (unsigned char)*p++;
+			if (c == '\0')
+				return false;
+			if (c == '\\') {
+				c = (unsigned char)*p++;
+				if (c >= '0' && c <= '7') {
+					int n = c - '0', digits = 1;
+					for (; digits < 3 && *p >= '0' && *p <= '7'; digits++)
+						n = 8 * n + *p++ - '0';
+					c = n;
+				} else if (c == 'x') {
+					char *end;
+					c = (int)strtol(p,&end,16);
+					p = end;
+				} else if (c == 'n')
+					c = '\n';
+				else if (c == 't')
+					c = '\t';
+				else if (c == 'r')
+					c = '\r';
+				else if (c == 'b')
+					c = '\b';
+				else if (c == 'f')
+					c = '\f';
+				else if (c == '\0')
+					return false;
+			}
+			emitByte(encoder,c);
+		}
+		if (terminate)
+			emitByte(encoder,0);
+		p = skipSpace(p + 1);
+	} while (*p++ == ',');
+	return *--p == '\0';
+}
+
+/**
+ * Emit numbers separated by commas.
+ *
+ * @return false if one is missing
+ */
+static bool emitNumbers(Encoder encoder, const char *p, int length) {
+	char *end;
+
+	do {
+		long n = strtol(p,&end,0);
+		if (end == p)
+			return false;
+		emitNumber(encoder,(uint64_t)n,length);
+		p = skipSpace(end);
+	} while (*p++ == ',');
+	return *--p == '\0';
+}
+
+/**
+ * Assemble a directive.
+ *
+ * @param encoder an encoder
+ * @param line the whole line, for errors
+ * @param name the directive
+ * @param p its arguments
+ */
+static void assembleDirective(Encoder encoder, const char *line, char *name, const char *p) {
+	bool ok = true;
+	int index, i;
+
+	p = skipSpace(p);
+	if (strcmp(name,".section") == 0) {
+		const char *end = scanName(p);
+		for (i = 0; i < NUM_SECTIONS; i++)
+			if (strlen(sectionNames[i]) == (size_t)(end - p) && strncmp(sectionNames[i],p,end - p) == 0)
+				break;
+		if (i < NUM_SECTIONS)
+			encoder->section = i;
+		else
+			ok = false;
+	} else if (strcmp(name,".text") == 0)
+		encoder->section = SECTION_TEXT;
+	else if (strcmp(name,".data") == 0)
+		encoder->section = SECTION_DATA;
+	else if (strcmp(name,".globl") == 0 || strcmp(name,".global") == 0)
+		ok = flagSymbol(encoder,p,SYMBOL_GLOBAL,&index) != NULL;
+	else if (strcmp(name,".type") == 0) {
+		p = flagSymbol(encoder,p,0,&index);
+		if (p == NULL || *p++ != ',')
+			ok = false;
+		else {
+			p = skipSpace(p);
+			if (isWord(p,"@function") || isWord(p,"%function"))
+				addFlags(encoder,index,SYMBOL_FUNCTION);
+			else if (isWord(p,"@object") || isWord(p,"%object"))
+				addFlags(encoder,index,SYMBOL_OBJECT);
+			else
+				ok = false;
+		}
+	} else if (strcmp(name,".comm") == 0) {
+		char *end;
+		p = flagSymbol(encoder,p,SYMBOL_COMMON | SYMBOL_GLOBAL | SYMBOL_OBJECT,&index);
+		if (p == NULL || *p++ != ',')
+			ok = false;
+		else {
+			long size = strtol(p,&end,0), align;
+			p = skipSpace(end);
+			if (*p == ',')
+				align = strtol(p + 1,&end,0);
+			else	/* the assembler's default: the largest power of two up to the size, at most 16 */
+				for (align = 1; align < 16 && 2 * align <= size; align *= 2)
+					;
+			SymPutFieldByIndex(encoder->symbols,index,SYM_SIZE_FIELD,(Generic)size);
+			SymPutFieldByIndex(encoder->symbols,index,SYM_VALUE_FIELD,(Generic)align);
+		}
+	} else if (strcmp(name,".string") == 0 || strcmp(name,".asciz") == 0)
+		ok = emitStrings(encoder,p,true);
+	else if (strcmp(name,".ascii") == 0)
+		ok = emitStrings(encoder,p,false);
+	else if (strcmp(name,".byte") == 0)
+		ok = emitNumbers(encoder,p,1);
+	else if (strcmp(name,".long") == 0 || strcmp(name,".int") == 0)
+		ok = emitNumbers(encoder,p,4);
+	else if (strcmp(name,".quad") == 0)
+		ok = emitNumbers(encoder,p,8);
+	else {
+		encoderError(encoder,line,"unknown directive");
+		return;
+	}
+
+	if (!ok)
+		encoderError(encoder,line,"bad arguments");
+}
+
+/**
+ * Assemble one line: an optional label followed by an optional instruction
+ * or directive.
+ *
+ * @param encoder an encoder
+ * @param line the line without its newline
+ */
+static void assembleLine(Encoder encoder, const char *line) {
+	char name[MAX_NAME];
+	const char *p = skipSpace(line);
+	const char *end;
+
+	encoder->lineNumber++;
+	if (*p == '\0' || *p == '#')
+		return;
+
+	end = scanName(p);
+	if (copyName(name,p,end) && *end == ':') {
+		defineLabel(encoder,line,name);
+		p = skipSpace(end + 1);
+		if (*p == '\0')
+			return;
+		end = scanName(p);
+	}
+
+	if (!copyName(name,p,end) || (*end != '\0' && *end != ' ' && *end != '\t')) {
+		encoderError(encoder,line,"syntax error");
+		return;
+	}
+
+	if (name[0] == '.')
+		assembleDirective(encoder,line,name,end);
+	else
+		assembleInstruction(encoder,line,name,end);
+}
+
+/**
+ * Assemble text. Lines may be split anywhere between calls; the end of a
+ * line that is not complete is kept until the rest arrives.
+ *
+ * @param encoder an encoder
+ * @param text assembly code
+ * @param length the number of characters
+ */
+void encoderText(Encoder encoder, const char *text, size_t length) {
+	const char *end = text + length;
+
+	while (text < end) {
+		const char *newline = (const char*)memchr(text,'\n',end - text);
+		size_t n = (newline == NULL ? end : newline) - text;
+
+		if (encoder->lineLength + n + 1 > encoder->maxLine) {
+			encoder->maxLine = MAX(2 * encoder->maxLine,encoder->lineLength + n + 256);
+			encoder->line = (char*)realloc(encoder->line,encoder->maxLine);
+		}
+		memcpy(encoder->line + encoder->lineLength,text,n);
+		encoder->lineLength += n;
+		if (newline == NULL)
+			return;
+
+		encoder->line[encoder->lineLength] = '\0';
+		assembleLine(encoder,encoder->line);
+		encoder->lineLength = 0;
+		text = newline + 1;
+	}
+}
+
+/**
+ * Assemble the last line if the text did not end with a newline.
+ */
+static void finishText(Encoder encoder) {
+	if (encoder->lineLength > 0) {
+		encoder->line[encoder->lineLength] = '\0';
+		assembleLine(encoder,encoder->line);
+		encoder->lineLength = 0;
+	}
+}
+
+/**
+ * The write function of the stream returned by encoderOpenStream.
+ */
+static ssize_t writeStream(void *cookie, const char *data, size_t length) {
+	encoderText((Encoder)cookie,data,length);
+	return length;
+}
+
+/**
+ * Open a stream whose output is assembled, so that the encoder can stand in
+ * for stdout while code is generated.
+ *
+ * @param encoder an encoder
+ * @return the stream, which must be closed before encoderWriteObject
+ */
+FILE *encoderOpenStream(Encoder encoder) {
+	cookie_io_functions_t functions = {NULL, writeStream, NULL, NULL};
+	return fopencookie(encoder,"w",functions);
+}
+
+/**
+ * Return the register of a register number of the machine IR and a size.
+ *
+ * @return the register, or NULL for a virtual register or a size with no name
+ */
+static Register *registerOf(int reg, int size) {
+	if (reg < 0 || MIR_IS_VIRTUAL(reg))
+		return NULL;
+	/* registers lists the 64-bit registers by number, then the 32-bit ones, then the bytes */
+	switch (size) {
+	case 8: return &registers[reg];
+	case 4: return &registers[MIR_NUM_REGISTERS + reg];
+	case 1: return &registers[2 * MIR_NUM_REGISTERS + reg];
+	}
+	return NULL;
+}
+
+/**
+ * Return the symbol of a label .L<n> of the machine IR, which is looked up by
+ * name only the first time.
+ *
+ * @param encoder an encoder
+ * @param number the number of the label
+ * @return the index of the symbol in the encoder's symbols
+ */
+static int labelSymbol(Encoder encoder, long number) {
+	char name[MAX_NAME];
+
+	if (number < 0) {
+		snprintf(name,MAX_NAME,LOCAL_LABEL_PREFIX "%ld",number);
+		return SymIndex(encoder->symbols,name);
+	}
+	if (number >= encoder->maxLabels) {
+		long max = MAX(2 * encoder->maxLabels,number + 1024);
+		encoder->labelSymbols = (int*)realloc(encoder->labelSymbols,max * sizeof(int));
+		memset(encoder->labelSymbols + encoder->maxLabels,0,(max - encoder->maxLabels) * sizeof(int));
+		encoder->maxLabels = max;
+	}
+	if (encoder->labelSymbols[number] == 0) {
+		snprintf(name,MAX_NAME,LOCAL_LABEL_PREFIX "%ld",number);
+		encoder->labelSymbols[number] = SymIndex(encoder->symbols,name) + 1;
+	}
+	return encoder->labelSymbols[number] - 1;
+}
+
+/**
+ * Return the symbol a label or symbol of the machine IR names.
+ *
+ * @param encoder an encoder
+ * @param op a label operand, or an operand with a symbol
+ * @return the index of the symbol in the encoder's symbols, or SYM_INVALID_INDEX for none
+ */
+static int symbolOf(Encoder encoder, MirOperand *op) {
+	if (op->kind == MIR_OPERAND_LABEL)
+		return labelSymbol(encoder,op->value);
+	return op->symbol == NULL ? SYM_INVALID_INDEX : SymIndex(encoder->symbols,op->symbol);
+}
+
+/**
+ * Make the operand that an operand of the machine IR is parsed as when printed.
+ *
+ * @param encoder an encoder
+ * @param mop an operand of the machine IR
+ * @param op the operand
+ * @return false if the operand names a virtual register
+ */
+static bool operandOf(Encoder encoder, MirOperand *mop, Operand *op) {
+	memset(op,0,sizeof(Operand));
+	op->symbol = SYM_INVALID_INDEX;
+	op->scale = 1;
+
+	switch (mop->kind) {
+	case MIR_OPERAND_REG:
+		op->kind = OPERAND_REGISTER;
+		return (op->reg = registerOf(mop->reg,mop->size)) != NULL;
+	case MIR_OPERAND_IMM:
+		op->kind = OPERAND_IMMEDIATE;
+		op->value = mop->value;
+		op->symbol = symbolOf(encoder,mop);
+		return true;
+	case MIR_OPERAND_MEM:
+		op->kind = OPERAND_MEMORY;
+		op->value = mop->value;
+		op->symbol = symbolOf(encoder,mop);
+		if (mop->reg != MIR_NO_REG && (op->base = registerOf(mop->reg,8)) == NULL)
+			return false;
+		if (mop->index != MIR_NO_REG) {
+			if ((op->index = registerOf(mop->index,8)) == NULL)
+				return false;
+			op->scale = mop->scale;
+		}
+		return true;
+	case MIR_OPERAND_LABEL:
+	case MIR_OPERAND_SYMBOL:
+		op->kind = OPERAND_MEMORY;
+		op->symbol = symbolOf(encoder,mop);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Report an instruction of the machine IR that cannot be encoded.
+ */
+static void instructionError(Encoder encoder, MirInst inst, const char *message) {
+	char line[MAX_NAME];
+
+	mirFormat(inst,line,sizeof(line));
+	encoderError(encoder,line,message);
+}
+
+/**
+ * Encode an instruction of the machine IR: a label, a .globl or .type
+ * directive, code cached as text, which is assembled as text, or an
+ * instruction whose registers are allocated.
+ *
+ * @param encoder an encoder
+ * @param inst the instruction
+ */
+void encoderInstruction(Encoder encoder, MirInst inst) {
+	Operand ops[MAX_OPERANDS];
+	int i;
+
+	if (inst->opcode == MIR_TEXT) {
+		encoderText(encoder,inst->text,strlen(inst->text));
+		encoderText(encoder,"\n",1);
+		return;
+	}
+
+	encoder->lineNumber++;
+	switch (inst->opcode) {
+	case MIR_LABEL:
+		if (!defineSymbol(encoder,symbolOf(encoder,&inst->op[0])))
+			instructionError(encoder,inst,"symbol already defined");
+		return;
+	case MIR_GLOBL:
+		addFlags(encoder,symbolOf(encoder,&inst->op[0]),SYMBOL_GLOBAL);
+		return;
+	case MIR_TYPE:
+		addFlags(encoder,symbolOf(encoder,&inst->op[0]),SYMBOL_FUNCTION);
+		return;
+	default:
+		break;
+	}
+
+	Mnemonic *m = encoder->mirMnemonics[inst->opcode * MIR_KEYS + (inst->cond != MIR_COND_NONE ? inst->cond : inst->size)];
+	if (m == NULL) {
+		instructionError(encoder,inst,"unknown instruction");
+		return;
+	}
+	for (i = 0; i < inst->numOperands; i++)
+		if (!operandOf(encoder,&inst->op[i],&ops[i])) {
+			instructionError(encoder,inst,"bad operand");
+			return;
+		}
+	if (!encodeInstruction(encoder,m,ops,inst->numOperands))
+		instructionError(encoder,inst,"bad operands");
+}
+
+/**
+ * Find the mnemonic of every opcode of the machine IR, by operand size or,
+ * for a conditional opcode, by condition, under the name it is printed with,
+ * so that encoderInstruction looks nothing up by name.
+ */
+static void addMirMnemonics(Encoder encoder) {
+	static const MirCondition mirConditions[] = {
+		MIR_COND_E, MIR_COND_NE, MIR_COND_L, MIR_COND_GE, MIR_COND_LE, MIR_COND_G
+	};
+	MirInstStruct inst;
+	char line[MAX_NAME];
+	int opcode, k;
+
+	encoder->mirMnemonics = (Mnemonic**)calloc(MIR_NUM_OPCODES * MIR_KEYS,sizeof(Mnemonic*));
+	memset(&inst,0,sizeof(inst));
+	for (opcode = 0; opcode < MIR_NUM_OPCODES; opcode++) {
+		if (opcode == MIR_LABEL || opcode == MIR_TYPE || opcode == MIR_TEXT)
+			continue;
+		inst.opcode = (MirOpcode)opcode;
+		for (k = 0; k < MIR_KEYS; k++) {
+			bool conditional = opcode == MIR_JCC || opcode == MIR_CMOVCC || opcode == MIR_SETCC;
+			if (conditional) {
+				size_t c;
+				for (c = 0; c < sizeof(mirConditions) / sizeof(mirConditions[0]) && mirConditions[c] != k; c++)
+					;
+				if (c == sizeof(mirConditions) / sizeof(mirConditions[0]))
+					continue;
+			} else if (k != 0 && k != 1 && k != 2 && k != 4 && k != 8)
+				continue;
+			inst.cond = conditional ? (MirCondition)k : MIR_COND_NONE;
+			inst.size = conditional ? 0 : k;
+			mirFormat(&inst,line,sizeof(line));
+
+			/* the line is the mnemonic after a tab */
+			int index = SymQueryIndex(encoder->names,line + 1);
+			if (index != SYM_INVALID_INDEX)
+				encoder->mirMnemonics[opcode * MIR_KEYS + k] = (Mnemonic*)encoder->entries[index];
+		}
+	}
+}
+
+/**
+ * Add a mnemonic or register to the names an encoder knows.
+ */
+static void addName(Encoder encoder, char *name, Generic entry) {
+	int index = SymIndex(encoder->names,name);
+
+	if (index >= encoder->maxEntries) {
+		encoder->maxEntries = MAX(2 * encoder->maxEntries,index + 256);
+		encoder->entries = (Generic*)realloc(encoder->entries,encoder->maxEntries * sizeof(Generic));
+	}
+	encoder->entries[index] = entry;
+}
+
+/**
+ * Create an encoder with an empty text section.
+ *
+ * @return the encoder
+ */
+Encoder encoderNew() {
+	Encoder encoder = (Encoder)calloc(1,sizeof(struct Encoder_struct));
+	char name[MAX_NAME];
+	int i;
+
+	encoder->section = SECTION_TEXT;
+	for (i = 0; i < NUM_SECTIONS; i++)
+		encoder->sections[i].align = 1;
+
+	encoder->symbols = SymInit(SYMBOLS_SIZE);
+	SymInitField(encoder->symbols,SYM_SECTION_FIELD,(Generic)0,NULL);
+	SymInitField(encoder->symbols,SYM_VALUE_FIELD,(Generic)0,NULL);
+	SymInitField(encoder->symbols,SYM_SIZE_FIELD,(Generic)0,NULL);
+	SymInitField(encoder->symbols,SYM_FLAGS_FIELD,(Generic)0,NULL);
+	SymInitField(encoder->symbols,SYM_ADDRESS_FIELD,(Generic)0,NULL);
+
+	encoder->names = SymInit(SYMBOLS_SIZE);
+	for (i = 0; i < NUM_MNEMONICS; i++)
+		addName(encoder,mnemonics[i].name,(Generic)&mnemonics[i]);
+	for (i = 0; i < NUM_REGISTERS; i++) {
+		snprintf(name,MAX_NAME,"%%%s",registers[i].name);
+		addName(encoder,name,(Generic)&registers[i]);
+	}
+
+	encoder->conditional = (Mnemonic*)malloc(NUM_CONDITIONS * MNEMONICS_PER_CONDITION * sizeof(Mnemonic));
+	for (i = 0; i < NUM_CONDITIONS; i++) {
+		Mnemonic *m = &encoder->conditional[i * MNEMONICS_PER_CONDITION];
+		char *cc = conditions[i].name;
+		int code = conditions[i].code;
+
+		m[0] = (Mnemonic){nssave(2,"j",cc), OP_JCC, 0, code};
+		m[1] = (Mnemonic){nssave(2,"cmov",cc), OP_CMOV, 0, code};
+		m[2] = (Mnemonic){nssave(3,"cmov",cc,"l"), OP_CMOV, 4, code};
+		m[3] = (Mnemonic){nssave(3,"cmov",cc,"q"), OP_CMOV, 8, code};
+		m[4] = (Mnemonic){nssave(2,"set",cc), OP_SET, 1, code};
+	}
+	for (i = 0; i < NUM_CONDITIONS * MNEMONICS_PER_CONDITION; i++)
+		addName(encoder,encoder->conditional[i].name,(Generic)&encoder->conditional[i]);
+	addMirMnemonics(encoder);
+
+	return encoder;
+}
+
+/**
+ * Free an encoder.
+ *
+ * @param encoder an encoder
+ */
+void encoderFree(Encoder encoder) {
+	int i;
+
+	for (i = 0; i < NUM_SECTIONS; i++)
+		free(encoder->sections[i].bytes);
+	for (i = 0; i < NUM_CONDITIONS * MNEMONICS_PER_CONDITION; i++)
+		sfree(encoder->conditional[i].name);
+	free(encoder->conditional);
+	free(encoder->mirMnemonics);
+	free(encoder->labelSymbols);
+	SymKill(encoder->symbols);
+	SymKill(encoder->names);
+	free(encoder->entries);
+	free(encoder->fixups);
+	free(encoder->line);
+	if (encoder->image != NULL)
+		munmap(encoder->image,encoder->imageSize);
+	free(encoder->addresses);
+	free(encoder);
+}
+
+/**
+ * The string table of an object file being built.
+ */
+typedef struct StringTable_struct {
+	char *chars;
+	size_t length;
+	size_t max;
+} StringTable;
+
+/**
+ * Add a string to a string table.
+ *
+ * @return its offset in the table
+ */
+static uint32_t addString(StringTable *table, const char *s) {
+	size_t length = strlen(s) + 1;
+	uint32_t offset = (uint32_t)table->length;
+
+	if (table->length + length > table->max) {
+		table->max = MAX(2 * table->max,table->length + length + 1024);
+		table->chars = (char*)realloc(table->chars,table->max);
+	}
+	memcpy(table->chars + table->length,s,length);
+	table->length += length;
+	return offset;
+}
+
+/**
+ * The symbol table of an object file being built.
+ */
+typedef struct ObjectSymbols_struct {
+	Encoder encoder;
+	int *elfIndex;		/**< the index in syms of each symbol of the encoder, 0 if it is left out */
+	Elf64_Sym *syms;
+	int numSyms;
+	StringTable names;
+	bool globals;		/**< true to add the global symbols, false to add the local ones */
+} ObjectSymbols;
+
+/**
+ * Add a symbol of the encoder to the object file if it belongs to the pass
+ * being made. This function is called by SymForAll.
+ */
+static void addSymbol(SymTable symtab, int index, ObjectSymbols *object) {
+	char *name = (char*)SymGetFieldByIndex(symtab,index,SYM_NAME_FIELD);
+	int flags = (int)(long)SymGetFieldByIndex(symtab,index,SYM_FLAGS_FIELD);
+	bool global = (flags & (SYMBOL_GLOBAL | SYMBOL_COMMON)) || !(flags & SYMBOL_DEFINED);
+
+	if (global != object->globals)
+		return;
+	if (strncmp(name,LOCAL_LABEL_PREFIX,strlen(LOCAL_LABEL_PREFIX)) == 0) {
+		if (!(flags & SYMBOL_DEFINED)) {
+			fprintf(stderr,"Error: Label %s is not defined\n",name);
+			object->encoder->errors++;
+		}
+		return;
+	}
+
+	Elf64_Sym *sym = &object->syms[object->numSyms];
+	int type = (flags & SYMBOL_FUNCTION) ? STT_FUNC : (flags & SYMBOL_OBJECT) ? STT_OBJECT : STT_NOTYPE;
+	sym->st_name = addString(&object->names,name);
+	sym->st_info = ELF64_ST_INFO(global ? STB_GLOBAL : STB_LOCAL,type);
+	sym->st_other = STV_DEFAULT;
+	sym->st_value = (Elf64_Addr)SymGetFieldByIndex(symtab,index,SYM_VALUE_FIELD);
+	sym->st_size = (Elf64_Xword)SymGetFieldByIndex(symtab,index,SYM_SIZE_FIELD);
+	if (flags & SYMBOL_COMMON)
+		sym->st_shndx = SHN_COMMON;
+	else if (flags & SYMBOL_DEFINED)
+		sym->st_shndx = 1 + (long)SymGetFieldByIndex(symtab,index,SYM_SECTION_FIELD);
+	else
+		sym->st_shndx = SHN_UNDEF;
+	object->elfIndex[index] = object->numSyms++;
+}
+
+/**
+ * Patch a fixup to a label in its own section, or turn it into a relocation.
+ *
+ * @param encoder an encoder
+ * @param fixup a fixup
+ * @param object the symbols of the object file
+ * @param rela receives the relocation
+ * @return true if a relocation is needed
+ */
+static bool resolveFixup(Encoder encoder, Fixup *fixup, ObjectSymbols *object, Elf64_Rela *rela) {
+	SymTable symtab = encoder->symbols;
+	int flags = (int)(long)SymGetFieldByIndex(symtab,fixup->symbol,SYM_FLAGS_FIELD);
+	int section = (int)(long)SymGetFieldByIndex(symtab,fixup->symbol,SYM_SECTION_FIELD);
+	long value = (long)SymGetFieldByIndex(symtab,fixup->symbol,SYM_VALUE_FIELD);
+	bool defined = (flags & SYMBOL_DEFINED) != 0;
+
+	if (fixup->kind == FIXUP_PC32 && defined && section == fixup->section) {
+		int32_t field = (int32_t)(value + fixup->addend - (long)fixup->offset);
+		memcpy(encoder->sections[section].bytes + fixup->offset,&field,4);
+		return false;
+	}
+
+	int type = fixup->kind == FIXUP_ABS32 ? R_X86_64_32 :
+		fixup->kind == FIXUP_ABS32S ? R_X86_64_32S :
+		defined ? R_X86_64_PC32 : R_X86_64_PLT32;
+	rela->r_offset = fixup->offset;
+	rela->r_addend = fixup->addend;
+	if (defined && !(flags & SYMBOL_GLOBAL)) {
+		/* a local symbol is reached through its section, as the assembler does */
+		rela->r_info = ELF64_R_INFO(1 + section,type);
+		rela->r_addend += value;
+	} else
+		rela->r_info = ELF64_R_INFO(object->elfIndex[fixup->symbol],type);
+	return true;
+}
+
+/**
+ * Write bytes to an object file after padding it to an alignment.
+ *
+ * @param fp the object file
+ * @param offset the offset in the file, which is advanced
+ * @param align the alignment of the bytes
+ * @param data the bytes
+ * @param length the number of bytes
+ * @return the offset of the bytes
+ */
+static size_t writeAligned(FILE *fp, size_t *offset, size_t align, const void *data, size_t length) {
+	static const char zeros[16];
+
+	size_t padding = (align - *offset % align) % align;
+	fwrite(zeros,1,padding,fp);
+	*offset += padding;
+	size_t start = *offset;
+	if (length > 0)
+		fwrite(data,1,length,fp);
+	*offset += length;
+	return start;
+}
+
+/**
+ * Fill in a section header.
+ */
+static void setSection(Elf64_Shdr *shdr, uint32_t name, uint32_t type, uint64_t flags, size_t offset,
+		size_t size, uint32_t link, uint32_t info, size_t align, size_t entsize) {
+	shdr->sh_name = name;
+	shdr->sh_type = type;
+	shdr->sh_flags = flags;
+	shdr->sh_addr = 0;
+	shdr->sh_offset = offset;
+	shdr->sh_size = size;
+	shdr->sh_link = link;
+	shdr->sh_info = info;
+	shdr->sh_addralign = align;
+	shdr->sh_entsize = entsize;
+}
+
+/**
+ * Write the assembled code as an ELF64 relocatable object file. The
+ * sections are .text, .data and .rodata, then the symbol and string tables,
+ * a .rela section for each section with relocations, and an empty
+ * .note.GNU-stack so that the stack is not made executable.
+ *
+ * @param encoder an encoder that has been given all of the text
+ * @param fileName the object file
+ * @return false if the text had errors or the file could not be written
+ */
+bool encoderWriteObject(Encoder encoder, char *fileName) {
+	enum { SHDR_SYMTAB = 1 + NUM_SECTIONS, SHDR_STRTAB, SHDR_FIRST_RELA };
+	Elf64_Shdr shdrs[SHDR_FIRST_RELA + NUM_SECTIONS + 2];
+	Elf64_Rela *relas[NUM_SECTIONS];
+	int numRelas[NUM_SECTIONS];
+	StringTable sectionNameTable = {NULL, 0, 0};
+	ObjectSymbols object;
+	int i, s;
+
+	finishText(encoder);
+
+	/* the null symbol, a symbol for each section, the local symbols, then the global ones */
+	int numSymbols = SymMaxIndex(encoder->symbols) + 1;
+	memset(&object,0,sizeof(object));
+	object.encoder = encoder;
+	object.elfIndex = (int*)calloc(numSymbols,sizeof(int));
+	object.syms = (Elf64_Sym*)calloc(1 + NUM_SECTIONS + numSymbols,sizeof(Elf64_Sym));
+	addString(&object.names,"");
+	for (object.numSyms = 1; object.numSyms <= NUM_SECTIONS; object.numSyms++) {
+		object.syms[object.numSyms].st_info = ELF64_ST_INFO(STB_LOCAL,STT_SECTION);
+		object.syms[object.numSyms].st_shndx = object.numSyms;
+	}
+	SymForAll(encoder->symbols,(SymIteratorFunc)addSymbol,(Generic)&object);
+	int firstGlobal = object.numSyms;
+	object.globals = true;
+	SymForAll(encoder->symbols,(SymIteratorFunc)addSymbol,(Generic)&object);
+
+	for (s = 0; s < NUM_SECTIONS; s++) {
+		relas[s] = (Elf64_Rela*)malloc(MAX(encoder->numFixups,1) * sizeof(Elf64_Rela));
+		numRelas[s] = 0;
+	}
+	for (i = 0; i < encoder->numFixups; i++) {
+		Fixup *fixup = &encoder->fixups[i];
+		if (resolveFixup(encoder,fixup,&object,&relas[fixup->section][numRelas[fixup->section]]))
+			numRelas[fixup->section]++;
+	}
+
+	bool ok = encoder->errors == 0;
+	FILE *fp = ok ? fopen(fileName,"w") : NULL;
+	if (ok && fp == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",fileName);
+		ok = false;
+	}
+
+	if (ok) {
+		Elf64_Ehdr ehdr;
+		size_t offset = 0;
+		int numShdrs = SHDR_FIRST_RELA;
+
+		/* the header is written again once the section headers are placed */
+		memset(&ehdr,0,sizeof(ehdr));
+		writeAligned(fp,&offset,1,&ehdr,sizeof(ehdr));
+
+		addString(&sectionNameTable,"");
+		memset(&shdrs[0],0,sizeof(Elf64_Shdr));
+		for (s = 0; s < NUM_SECTIONS; s++) {
+			Section *section = &encoder->sections[s];
+			size_t start = writeAligned(fp,&offset,section->align,section->bytes,section->length);
+			setSection(&shdrs[1 + s],addString(&sectionNameTable,sectionNames[s]),SHT_PROGBITS,
+				sectionFlags[s],start,section->length,0,0,section->align,0);
+		}
+
+		size_t start = writeAligned(fp,&offset,8,object.syms,object.numSyms * sizeof(Elf64_Sym));
+		setSection(&shdrs[SHDR_SYMTAB],addString(&sectionNameTable,".symtab"),SHT_SYMTAB,0,start,
+			object.numSyms * sizeof(Elf64_Sym),SHDR_STRTAB,firstGlobal,8,sizeof(Elf64_Sym));
+		start = writeAligned(fp,&offset,1,object.names.chars,object.names.length);
+		setSection(&shdrs[SHDR_STRTAB],addString(&sectionNameTable,".strtab"),SHT_STRTAB,0,start,
+			object.names.length,0,0,1,0);
+
+		for (s = 0; s < NUM_SECTIONS; s++) {
+			if (numRelas[s] == 0)
+				continue;
+			char *name = nssave(2,".rela",sectionNames[s]);
+			start = writeAligned(fp,&offset,8,relas[s],numRelas[s] * sizeof(Elf64_Rela));
+			setSection(&shdrs[numShdrs++],addString(&sectionNameTable,name),SHT_RELA,SHF_INFO_LINK,start,
+				numRelas[s] * sizeof(Elf64_Rela),SHDR_SYMTAB,1 + s,8,sizeof(Elf64_Rela));
+			sfree(name);
+		}
+
+		setSection(&shdrs[numShdrs++],addString(&sectionNameTable,".note.GNU-stack"),SHT_PROGBITS,0,
+			offset,0,0,0,1,0);
+		int shstrndx = numShdrs++;
+		uint32_t name = addString(&sectionNameTable,".shstrtab");
+		start = writeAligned(fp,&offset,1,sectionNameTable.chars,sectionNameTable.length);
+		setSection(&shdrs[shstrndx],name,SHT_STRTAB,0,start,sectionNameTable.length,0,0,1,0);
+
+		start = writeAligned(fp,&offset,8,shdrs,numShdrs * sizeof(Elf64_Shdr));
+
+		memcpy(ehdr.e_ident,ELFMAG,SELFMAG);
+		ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+		ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+		ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+		ehdr.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+		ehdr.e_type = ET_REL;
+		ehdr.e_machine = EM_X86_64;
+		ehdr.e_version = EV_CURRENT;
+		ehdr.e_shoff = start;
+		ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+		ehdr.e_shentsize = sizeof(Elf64_Shdr);
+		ehdr.e_shnum = numShdrs;
+		ehdr.e_shstrndx = shstrndx;
+		rewind(fp);
+		fwrite(&ehdr,sizeof(ehdr),1,fp);
+
+		if (ferror(fp) | fclose(fp)) {
+			fprintf(stderr,"Error: Could not write file %s\n",fileName);
+			ok = false;
+		}
+	}
+
+	for (s = 0; s < NUM_SECTIONS; s++)
+		free(relas[s]);
+	free(object.elfIndex);
+	free(object.syms);
+	free(object.names.chars);
+	free(sectionNameTable.chars);
+	return ok;
+}
+
+#define STUB_SIZE 16		/**< jmp *0(%rip), the address it jumps to, and padding */
+#define LOAD_ALIGN 16		/**< the alignment of each part of a loaded image */
+
+#define ALIGN_UP(n, align) (((n) + (align) - 1) / (align) * (align))
+
+/**
+ * The layout of an image being loaded: the text section followed by a stub
+ * for each undefined symbol, then on separate pages the read-only data, and
+ * the writable data followed by the common symbols.
+ */
+typedef struct LoadLayout_struct {
+	Encoder encoder;
+	size_t *offsets;	/**< the offset of the stub or common block of each symbol that needs one */
+	int numStubs;
+	size_t commonSize;
+	unsigned char *bases[NUM_SECTIONS];	/**< where each section is loaded */
+	unsigned char *stubs;
+	unsigned char *common;
+} LoadLayout;
+
+/**
+ * Give an undefined symbol a stub and a common symbol its storage. This
+ * function is called by SymForAll.
+ */
+static void placeSymbol(SymTable symtab, int index, LoadLayout *layout) {
+	int flags = (int)(long)SymGetFieldByIndex(symtab,index,SYM_FLAGS_FIELD);
+
+	if ((flags & SYMBOL_COMMON) && (flags & SYMBOL_BOUND))
+		return;
+	if (flags & SYMBOL_COMMON) {
+		size_t align = (size_t)SymGetFieldByIndex(symtab,index,SYM_VALUE_FIELD);
+		layout->commonSize = ALIGN_UP(layout->commonSize,MAX(align,1));
+		layout->offsets[index] = layout->commonSize;
+		layout->commonSize += (size_t)SymGetFieldByIndex(symtab,index,SYM_SIZE_FIELD);
+	} else if (!(flags & SYMBOL_DEFINED))
+		layout->offsets[index] = STUB_SIZE * layout->numStubs++;
+}
+
+/**
+ * Find the address of a symbol in a loaded image, writing the stub of an
+ * undefined one, which jumps to the symbol of that name in this process.
+ * This function is called by SymForAll.
+ */
+static void locateSymbol(SymTable symtab, int index, LoadLayout *layout) {
+	Encoder encoder = layout->encoder;
+	int flags = (int)(long)SymGetFieldByIndex(symtab,index,SYM_FLAGS_FIELD);
+	char *name = (char*)SymGetFieldByIndex(symtab,index,SYM_NAME_FIELD);
+
+	if ((flags & SYMBOL_COMMON) && (flags & SYMBOL_BOUND))
+		encoder->addresses[index] = (uintptr_t)SymGetFieldByIndex(symtab,index,SYM_ADDRESS_FIELD);
+	else if (flags & SYMBOL_COMMON)
+		encoder->addresses[index] = (uintptr_t)(layout->common + layout->offsets[index]);
+	else if (flags & SYMBOL_DEFINED) {
+		int section = (int)(long)SymGetFieldByIndex(symtab,index,SYM_SECTION_FIELD);
+		size_t value = (size_t)SymGetFieldByIndex(symtab,index,SYM_VALUE_FIELD);
+		encoder->addresses[index] = (uintptr_t)(layout->bases[section] + value);
+	} else {
+		void *address = (flags & SYMBOL_BOUND) ? SymGetFieldByIndex(symtab,index,SYM_ADDRESS_FIELD) : dlsym(RTLD_DEFAULT,name);
+		unsigned char *stub = layout->stubs + layout->offsets[index];
+
+		if (address == NULL) {
+			fprintf(stderr,"Error: Undefined symbol %s\n",name);
+			encoder->errors++;
+			return;
+		}
+		stub[0] = 0xff;
+		stub[1] = 0x25;
+		memset(stub + 2,0,4);
+		memcpy(stub + 6,&address,sizeof(address));
+		encoder->addresses[index] = (uintptr_t)stub;
+	}
+}
+
+/**
+ * Give a symbol the address of something in this process before the code is
+ * loaded. A call of an undefined function of that name goes to the address,
+ * and a common symbol of that name uses the storage at the address instead of
+ * storage of its own, which must lie in the low 2GB.
+ *
+ * @param encoder an encoder whose code has not been loaded
+ * @param name the name of the symbol
+ * @param address the address
+ */
+void encoderBind(Encoder encoder, char *name, Generic address) {
+	int index = SymIndex(encoder->symbols,name);
+
+	SymPutFieldByIndex(encoder->symbols,index,SYM_ADDRESS_FIELD,address);
+	addFlags(encoder,index,SYMBOL_BOUND);
+}
+
+/**
+ * Patch a fixup in a loaded image.
+ *
+ * @return false if the value does not fit in the field
+ */
+static bool applyFixup(Encoder encoder, Fixup *fixup, LoadLayout *layout) {
+	unsigned char *field = layout->bases[fixup->section] + fixup->offset;
+	int64_t value = (int64_t)encoder->addresses[fixup->symbol] + fixup->addend;
+	bool fits;
+
+	if (fixup->kind == FIXUP_PC32) {
+		value -= (int64_t)(uintptr_t)field;
+		fits = value >= INT32_MIN && value <= INT32_MAX;
+	} else if (fixup->kind == FIXUP_ABS32)
+		fits = value >= 0 && value <= UINT32_MAX;
+	else
+		fits = value >= INT32_MIN && value <= INT32_MAX;
+
+	if (!fits) {
+		fprintf(stderr,"Error: Symbol %s is out of reach of its use\n",
+			(char*)SymGetFieldByIndex(encoder->symbols,fixup->symbol,SYM_NAME_FIELD));
+		return false;
+	}
+	int32_t field32 = (int32_t)value;
+	memcpy(field,&field32,4);
+	return true;
+}
+
+/**
+ * Load the assembled code into memory so that it can be run in this
+ * process. The image is mapped in the low 2GB, where the 32-bit absolute
+ * addresses in the generated code reach it, and calls to functions that are
+ * not defined go through stubs to the functions of this process, such as
+ * printf and scanf of the C library.
+ *
+ * @param encoder an encoder that has been given all of the text
+ * @return false if the text had errors or could not be loaded
+ */
+bool encoderLoad(Encoder encoder) {
+	size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	LoadLayout layout;
+	int i, s;
+
+	finishText(encoder);
+	if (encoder->errors > 0)
+		return false;
+
+	memset(&layout,0,sizeof(layout));
+	layout.encoder = encoder;
+	layout.offsets = (size_t*)calloc(SymMaxIndex(encoder->symbols) + 1,sizeof(size_t));
+	SymForAll(encoder->symbols,(SymIteratorFunc)placeSymbol,(Generic)&layout);
+
+	size_t textSize = ALIGN_UP(encoder->sections[SECTION_TEXT].length,LOAD_ALIGN) + STUB_SIZE * layout.numStubs;
+	size_t rodataSize = encoder->sections[SECTION_RODATA].length;
+	size_t dataSize = ALIGN_UP(encoder->sections[SECTION_DATA].length,LOAD_ALIGN) + layout.commonSize;
+	size_t rodataStart = ALIGN_UP(textSize,pageSize);
+	size_t dataStart = rodataStart + ALIGN_UP(rodataSize,pageSize);
+	encoder->imageSize = MAX(dataStart + ALIGN_UP(dataSize,pageSize),pageSize);
+
+	encoder->image = (unsigned char*)mmap(NULL,encoder->imageSize,PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT,-1,0);
+	if (encoder->image == MAP_FAILED) {
+		encoder->image = NULL;
+		fprintf(stderr,"Error: Could not map memory for the code\n");
+		free(layout.offsets);
+		return false;
+	}
+
+	layout.bases[SECTION_TEXT] = encoder->image;
+	layout.stubs = encoder->image + ALIGN_UP(encoder->sections[SECTION_TEXT].length,LOAD_ALIGN);
+	layout.bases[SECTION_RODATA] = encoder->image + rodataStart;
+	layout.bases[SECTION_DATA] = encoder->image + dataStart;
+	layout.common = encoder->image + dataStart + ALIGN_UP(encoder->sections[SECTION_DATA].length,LOAD_ALIGN);
+	for (s = 0; s < NUM_SECTIONS; s++)
+		if (encoder->sections[s].length > 0)
+			memcpy(layout.bases[s],encoder->sections[s].bytes,encoder->sections[s].length);
+
+	encoder->addresses = (uintptr_t*)calloc(SymMaxIndex(encoder->symbols) + 1,sizeof(uintptr_t));
+	SymForAll(encoder->symbols,(SymIteratorFunc)locateSymbol,(Generic)&layout);
+	bool ok = encoder->errors == 0;
+	for (i = 0; ok && i < encoder->numFixups; i++)
+		ok = applyFixup(encoder,&encoder->fixups[i],&layout);
+	free(layout.offsets);
+
+	if (ok && (mprotect(encoder->image,rodataStart,PROT_READ | PROT_EXEC) != 0 ||
+		   mprotect(encoder->image + rodataStart,dataStart - rodataStart,PROT_READ) != 0)) {
+		fprintf(stderr,"Error: Could not protect the code\n");
+		ok = false;
+	}
+	if (!ok) {
+		munmap(encoder->image,encoder->imageSize);
+		encoder->image = NULL;
+	}
+	return ok;
+}
+
+/**
+ * Return the address of a symbol defined in the loaded code.
+ *
+ * @param encoder an encoder whose code has been loaded by encoderLoad
+ * @param name the name of the symbol
+ * @return the address, or NULL if the symbol is not defined
+ */
+Generic encoderAddress(Encoder encoder, char *name) {
+	int index = SymQueryIndex(encoder->symbols,name);
+
+	if (encoder->image == NULL || index == SYM_INVALID_INDEX ||
+	    !((long)SymGetFieldByIndex(encoder->symbols,index,SYM_FLAGS_FIELD) & SYMBOL_DEFINED))
+		return NULL;
+	return (Generic)encoder->addresses[index];
+}
@@ -0,0 +1,41 @@
+/**
+ * encoder.h
+ *
+ * A built-in assembler for the x86-64 code cmc generates. It encodes the
+ * machine IR of each function as it is generated, and reads the rest, the
+ * directives, data and code cached as text, as the same assembly text that is
+ * printed for a .s file, then writes an ELF64 relocatable object file at the
+ * end, so cmc -c does not need to run the system assembler.
+ *
+ * The code can also be loaded into memory and run in this process, which is
+ * how cmc --run runs a program without an assembler, linker or files, and
+ * how the tiered engine of cmc --tier compiles one hot function at a time
+ * against the globals and functions it already has.
+ *
+ * Only the instructions and directives the code generator uses are known;
+ * any other line is reported as an error and no object file is written.
+ *
+ */
+
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <util/general.h>
+#include "mir.h"
+
+typedef struct Encoder_struct *Encoder;
+
+EXTERN(Encoder, encoderNew, (void));
+EXTERN(void, encoderFree, (Encoder encoder));
+
+EXTERN(void, encoderText, (Encoder encoder, const char *text, size_t length));
+EXTERN(void, encoderInstruction, (Encoder encoder, MirInst inst));
+EXTERN(FILE *, encoderOpenStream, (Encoder encoder));
+EXTERN(bool, encoderWriteObject, (Encoder encoder, char *fileName));
+EXTERN(void, encoderBind, (Encoder encoder, char *name, Generic address));
+EXTERN(bool, encoderLoad, (Encoder encoder));
+EXTERN(Generic, encoderAddress, (Encoder encoder, char *name));
+
+#endif /* ENCODER_H_ */
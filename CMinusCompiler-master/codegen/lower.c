@@ -0,0 +1,1587 @@
+/**
+ * lower.c
+ *
+ * Walk the syntax tree of a program and call the emit routines of codegen.c.
+ * The emit routines are called in exactly the order the parser actions called
+ * them when code was generated during parsing, so labels, string constants and
+ * registers come out the same.
+ *
+ * The emit routines build the machine IR of mir.h with virtual registers,
+ * which the register allocator of reg.c replaces with physical ones, and the
+ * peephole optimizer of peephole.c rewrites the code before the function is
+ * printed. The frame is set up last, once the registers the code names are
+ * known: only the callee-saved ones it uses are saved, and a function that
+ * calls nothing and whose locals fit in the red zone below %rsp has no frame.
+ *
+ * Expressions are folded as they are lowered: an operator whose operands are
+ * constants, or promoted variables last assigned a constant in the same
+ * straight-line code, is computed at compile time exactly as the generated
+ * code would compute it, a constant operand is an immediate, and adding 0,
+ * multiplying by 1 or 0 and subtracting an expression from itself generate
+ * no code for the operator.
+ *
+ * Scalar variables are promoted to virtual registers. C-minus cannot take the
+ * address of a variable, so a scalar local is kept in one register for the
+ * whole function: a read statement reads it in memory and loads it again, and
+ * its frame slot is otherwise only used by on-stack replacement. A global may
+ * be changed by any call, so it is only kept in a register over a region of
+ * statements without calls: the globals a region uses most are loaded before
+ * it and the ones it assigns stored after it and before an exit statement.
+ *
+ * Functions only share the global scope, which is read-only once the global
+ * declarations are entered, so they may be lowered on several threads. Each
+ * function gets its own instruction and data lists and starts numbering its
+ * labels and string constants where the functions before it leave off, and
+ * the lists are printed in source order as soon as they are complete and then
+ * freed, so only the code of functions waiting for an earlier one is held in
+ * memory. The threads take the largest functions of a window of those after
+ * the next one to print first, stealing from each other, and the window moves
+ * on as functions are printed. The output does not depend on the number of
+ * threads.
+ *
+ * With a code cache, each function is first looked up by a hash of its syntax
+ * tree and the layout of the globals it names, and only the functions missing
+ * from the cache are lowered.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <util/general.h>
+#include <util/symtab.h>
+#include <util/symtab_stack.h>
+#include <util/dlink.h>
+#include <util/string_utils.h>
+#include <util/output.h>
+#include <ast/ast.h>
+#include "symfields.h"
+#include "types.h"
+#include "codegen.h"
+#include "mir.h"
+#include "reg.h"
+#include "cache.h"
+#include "peephole.h"
+#include "lower.h"
+
+extern int globalOffset;
+
+__thread int lowerLineno = 0;
+
+/**
+ * The work of lowering one function.
+ */
+typedef struct LowerFunc_struct {
+	AstIndex func;		/**< the AST_FUNCTION node */
+	int size;		/**< the number of nodes in the function */
+	int numLabels;		/**< the number of labels the function needs */
+	int numStrings;		/**< the number of string constants in the function */
+	int labelBase;		/**< the number of the function's first label */
+	int stringBase;		/**< the number of the function's first string constant */
+	DList instList;
+	DList dataList;
+	CacheKey key;		/**< the key of the function in the code cache */
+	bool cached;		/**< the code was found in the code cache */
+	int errors;		/**< the number of errors reported while lowering the function */
+	bool done;		/**< the code is generated and waits to be printed */
+} LowerFuncStruct, *LowerFunc;
+
+/**
+ * The functions one thread has yet to lower, largest first. The owner takes
+ * from the head, other threads steal from the tail.
+ */
+typedef struct LowerQueue_struct {
+	pthread_mutex_t lock;
+	int *tasks;		/**< indices into funcs */
+	int head;
+	int tail;
+} LowerQueueStruct, *LowerQueue;
+
+static Ast lowerAst;
+static SymTable globalSymtab;	/**< the global scope */
+static LowerFunc funcs;
+static int numFuncs;
+static LowerQueue queues;
+static int numQueues;		/**< the number of threads, or 0 when lowering on one */
+static int numDealt;		/**< the number of functions dealt to the queues */
+static int window;		/**< the most functions dealt and not yet printed */
+static int numPrinted;		/**< the number of functions printed */
+static DList programDataList;	/**< the data declarations of the printed functions */
+static pthread_mutex_t takeLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t takeCond = PTHREAD_COND_INITIALIZER;	/**< signalled when functions are dealt */
+static pthread_mutex_t printLock = PTHREAD_MUTEX_INITIALIZER;
+static CodeCache codeCache = NULL;
+static Encoder codeEncoder = NULL;	/**< the encoder the functions are handed to instead of printed */
+static bool usePeephole = true;		/**< run the peephole optimizer on every function */
+static bool usePromotion = true;	/**< keep scalar variables in registers */
+static bool useFolding = true;		/**< fold constants and use immediate operands */
+
+#define LOWER_MAX_REGION_GLOBALS 6	/**< the most globals a region keeps in registers */
+#define LOWER_LOOP_WEIGHT 10		/**< how much more a use inside a while loop counts */
+#define LOWER_MAX_WEIGHT 1000000	/**< the weight of a use in loops nested deeper */
+#define LOWER_MIN_ELEMENT (INT_MIN / 8)	/**< the least constant subscript folded into a displacement */
+#define LOWER_MAX_ELEMENT (INT_MAX / 8)	/**< the greatest constant subscript folded into a displacement */
+#define LOWER_RED_ZONE 128		/**< the bytes below %rsp a function that calls nothing may use */
+#define LOWER_WINDOW_PER_JOB 16		/**< the functions each thread may have dealt and not yet printed */
+
+/**
+ * A scalar variable kept in a register: a local for the whole function or a
+ * global for the current region.
+ */
+typedef struct Promoted_struct {
+	char *name;
+	int regIndex;		/**< the symbol table index of its register */
+	int uses;		/**< the uses of a global in the region, weighted by loop depth */
+	bool stored;		/**< the region assigns the global */
+	bool known;		/**< the register holds a constant known at this point of the code */
+	int value;		/**< the constant */
+} Promoted;
+
+static __thread SymtabStack symstack;	/**< the scopes of the current thread */
+static __thread SymTable symtab;	/**< the innermost scope */
+static __thread DList instList;
+static __thread DList dataList;
+static __thread DList osrList;		/**< the on-stack replacement tests of the function, or NULL for none */
+static __thread char *funcName;		/**< the name of the function being lowered */
+static SymtabStack globalStack;		/**< the global scope of the program being lowered */
+
+static __thread Promoted *promoted;	/**< the promoted locals, then the globals of the current region */
+static __thread int numPromoted;
+static __thread int maxPromoted;
+static __thread int numLocalsPromoted;
+static __thread bool inRegion;		/**< statements are being lowered in a region */
+
+typedef FUNCTION_POINTER(int, BinaryEmitFunc, (DList instList, SymTable symtab, int leftOperand, int rightOperand));
+
+/**
+ * The emit routine for each binary operator kind.
+ */
+static BinaryEmitFunc binaryEmitters[AST_NUM_KINDS] = {
+	[AST_OR] = emitOrExpression,
+	[AST_AND] = emitAndExpression,
+	[AST_EQ] = emitEqualExpression,
+	[AST_NE] = emitNotEqualExpression,
+	[AST_LE] = emitLessEqualExpression,
+	[AST_LT] = emitLessThanExpression,
+	[AST_GE] = emitGreaterEqualExpression,
+	[AST_GT] = emitGreaterThanExpression,
+	[AST_ADD] = emitAddExpression,
+	[AST_SUB] = emitSubtractExpression,
+	[AST_MUL] = emitMultiplyExpression,
+	[AST_DIV] = emitDivideExpression,
+};
+
+/**
+ * The condition under which each comparison operator kind is true.
+ */
+static MirCondition compareConditions[AST_NUM_KINDS] = {
+	[AST_EQ] = MIR_COND_E,
+	[AST_NE] = MIR_COND_NE,
+	[AST_LE] = MIR_COND_LE,
+	[AST_LT] = MIR_COND_L,
+	[AST_GE] = MIR_COND_GE,
+	[AST_GT] = MIR_COND_G,
+};
+
+/**
+ * The instruction of each operator kind that takes a constant right operand.
+ */
+static MirOpcode immediateOpcodes[AST_NUM_KINDS] = {
+	[AST_OR] = MIR_OR,
+	[AST_AND] = MIR_AND,
+	[AST_ADD] = MIR_ADD,
+	[AST_SUB] = MIR_SUB,
+};
+
+/**
+ * Return true if a node is a comparison, AST_EQ to AST_GT.
+ */
+static bool isComparison(AstNode *node) {
+	return node->kind >= AST_EQ && node->kind <= AST_GT;
+}
+
+STATIC(int, lowerExpression, (Ast ast, AstIndex expr));
+STATIC(int, lowerOperand, (Ast ast, AstIndex expr));
+STATIC(MirOperand, lowerVariable, (Ast ast, AstIndex var));
+STATIC(void, lowerStatement, (Ast ast, AstIndex stmt));
+
+/**
+ * Enter a declared variable in the current symbol table.
+ *
+ * @param ast a syntax tree
+ * @param var an AST_VAR or AST_ARRAY node
+ * @return the symbol table index of the variable
+ */
+static int lowerVarDecl(Ast ast, AstIndex var) {
+	if (AST_NODE(ast,var)->kind == AST_VAR)
+		return SymIndex(symtab,AST_NAME(ast,var));
+
+	int symIndex = SymIndex(symtab,AST_NAME(ast,AST_KID(ast,var,0)));
+	char* numElemString = (char*)SymGetFieldByIndex(symtab,symIndex,SYM_NAME_FIELD);
+
+	char* typeString = nssave(4,SYMTAB_VOID_TYPE_STRING,"[",numElemString,"]");
+
+	int typeIndex = SymIndex(symtab,typeString);
+	SymPutFieldByIndex(symtab,typeIndex,SYMTAB_BASIC_TYPE_FIELD,(Generic)VOID_TYPE);
+
+	int numElements = atoi(numElemString);
+	SymPutFieldByIndex(symtab,typeIndex,SYMTAB_SIZE_FIELD,(Generic)(long)(VOID_SIZE*numElements));
+
+	sfree(typeString);
+
+	symIndex = SymIndex(symtab,AST_NAME(ast,var));
+	SymPutFieldByIndex(symtab,symIndex,SYMTAB_TYPE_INDEX_FIELD,(Generic)(long)typeIndex);
+
+	return symIndex;
+}
+
+/**
+ * Enter a list of declarations in the current symbol table and lay out their storage.
+ *
+ * @param ast a syntax tree
+ * @param decl the first AST_DECL of a list
+ * @return the number of bytes used by the declarations
+ */
+static int lowerDeclList(Ast ast, AstIndex decl) {
+	AddIdStruct data;
+	data.offset = 0;
+	data.symtab = symtab;
+
+	for (; decl != AST_NULL; decl = AST_NEXT(ast,decl)) {
+		if (AST_NODE(ast,decl)->type == AST_TYPE_INTEGER)
+			data.typeIndex = SymQueryIndex(symtab,SYMTAB_INTEGER_TYPE_STRING);
+		else
+			data.typeIndex = SymQueryIndex(symtab,SYMTAB_ERROR_TYPE_STRING);
+
+		DList idList = dlinkListAlloc(NULL);
+		AstIndex var;
+		for (var = AST_KID(ast,decl,0); var != AST_NULL; var = AST_NEXT(ast,var))
+			dlinkAppend(idList,dlinkNodeAlloc((Generic)(long)lowerVarDecl(ast,var)));
+
+		dlinkApply1(idList,(DLinkApply1Func)addIdToSymtab,(Generic)&data);
+		dlinkFreeNodes(idList);
+	}
+
+	return data.offset;
+}
+
+/**
+ * Add a variable to the promoted variables.
+ *
+ * @param name the name of the variable
+ * @param regIndex the symbol table index of its register
+ * @return the variable
+ */
+static Promoted *addPromoted(char *name, int regIndex) {
+	if (numPromoted == maxPromoted) {
+		maxPromoted = MAX(2 * maxPromoted,16);
+		promoted = (Promoted*)realloc(promoted,maxPromoted * sizeof(Promoted));
+	}
+
+	Promoted *p = &promoted[numPromoted++];
+	p->name = name;
+	p->regIndex = regIndex;
+	p->uses = 0;
+	p->stored = false;
+	p->known = false;
+	return p;
+}
+
+/**
+ * Return the promoted variable a name refers to. A local hides a global of
+ * the same name.
+ *
+ * @param name the name of a variable
+ * @return the variable, or NULL if it is in memory
+ */
+static Promoted *findPromoted(char *name) {
+	int i, first = 0, last = numLocalsPromoted;
+
+	if (SymQueryIndex(symtab,name) == SYM_INVALID_INDEX) {
+		first = numLocalsPromoted;
+		last = numPromoted;
+	}
+	for (i = first; i < last; i++)
+		if (strcmp(promoted[i].name,name) == 0)
+			return &promoted[i];
+	return NULL;
+}
+
+/**
+ * Return the promoted variable a variable node names.
+ *
+ * @param ast a syntax tree
+ * @param var an AST_VAR_ADDR or AST_ARRAY_ADDR node
+ * @return the variable, or NULL if it is in memory
+ */
+static Promoted *promotedVariable(Ast ast, AstIndex var) {
+	if (AST_NODE(ast,var)->kind != AST_VAR_ADDR)
+		return NULL;
+	return findPromoted(AST_NAME(ast,var));
+}
+
+/**
+ * Give every scalar local of a function a register of its own.
+ *
+ * @param ast a syntax tree
+ * @param decl the first AST_DECL of the function's locals
+ */
+static void promoteLocals(Ast ast, AstIndex decl) {
+	AstIndex var;
+
+	for (; decl != AST_NULL; decl = AST_NEXT(ast,decl)) {
+		if (AST_NODE(ast,decl)->type != AST_TYPE_INTEGER)
+			continue;
+		for (var = AST_KID(ast,decl,0); var != AST_NULL; var = AST_NEXT(ast,var))
+			if (AST_NODE(ast,var)->kind == AST_VAR)
+				addPromoted(AST_NAME(ast,var),getFreeIntegerRegisterIndex(symtab));
+	}
+	numLocalsPromoted = numPromoted;
+}
+
+/**
+ * Compute an operator on two constants as its instructions would: with 32-bit
+ * wrapping, and comparisons and not giving 0 or 1. A division that would trap
+ * is left to run.
+ *
+ * @param kind the kind of an operator node
+ * @param left the left operand
+ * @param right the right operand
+ * @param value set to the result
+ * @return false if the result is not computed
+ */
+static bool foldOperator(int kind, int left, int right, int *value) {
+	unsigned int l = (unsigned int)left, r = (unsigned int)right;
+
+	switch (kind) {
+	case AST_OR: *value = left | right; break;
+	case AST_AND: *value = left & right; break;
+	case AST_EQ: *value = left == right; break;
+	case AST_NE: *value = left != right; break;
+	case AST_LE: *value = left <= right; break;
+	case AST_LT: *value = left < right; break;
+	case AST_GE: *value = left >= right; break;
+	case AST_GT: *value = left > right; break;
+	case AST_ADD: *value = (int)(l + r); break;
+	case AST_SUB: *value = (int)(l - r); break;
+	case AST_MUL: *value = (int)(l * r); break;
+	case AST_DIV:
+		if (right == 0 || (left == INT_MIN && right == -1))
+			return false;
+		*value = left / right;
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Compute the value of an expression if it is known where it is lowered.
+ *
+ * @param ast a syntax tree
+ * @param expr an expression node
+ * @param value set to the value
+ * @return false if the value is not known
+ */
+static bool constantValue(Ast ast, AstIndex expr, int *value) {
+	AstNode *node = AST_NODE(ast,expr);
+	Promoted *p;
+	int left, right;
+	long n;
+	char *end;
+
+	if (!useFolding)
+		return false;
+	switch (node->kind) {
+	case AST_CONST:
+		n = strtol(AST_NAME(ast,expr),&end,10);
+		if (*end != '\0' || n < INT_MIN || n > INT_MAX)
+			return false;
+		*value = (int)n;
+		return true;
+	case AST_LOAD:
+		if ((p = promotedVariable(ast,node->kid[0])) == NULL || !p->known)
+			return false;
+		*value = p->value;
+		return true;
+	case AST_NOT:
+		if (!constantValue(ast,node->kid[0],&left))
+			return false;
+		*value = left ^ 1;
+		return true;
+	case AST_STRING:
+	case AST_CALL:
+		return false;
+	default:
+		return constantValue(ast,node->kid[0],&left) && constantValue(ast,node->kid[1],&right) &&
+		       foldOperator(node->kind,left,right,value);
+	}
+}
+
+/**
+ * Return true if an expression has no effect but its value: it calls
+ * nothing and divides by nothing, which could trap.
+ *
+ * @param ast a syntax tree
+ * @param expr an expression node
+ */
+static bool isPure(Ast ast, AstIndex expr) {
+	AstNode *node = AST_NODE(ast,expr);
+	int i;
+
+	if (node->kind == AST_CALL || node->kind == AST_DIV)
+		return false;
+	for (i = 0; i < 3; i++)
+		if (node->kid[i] != AST_NULL && !isPure(ast,node->kid[i]))
+			return false;
+	return true;
+}
+
+/**
+ * Find the quotient of the division of an expression whose value is known
+ * that would run last, the right operand of an operator running after the left.
+ *
+ * @param ast a syntax tree
+ * @param expr an expression node whose value is known
+ * @param value set to the quotient
+ * @return false if the expression divides by nothing
+ */
+static bool lastQuotient(Ast ast, AstIndex expr, int *value) {
+	AstNode *node = AST_NODE(ast,expr);
+
+	if (node->kind == AST_DIV)
+		return constantValue(ast,expr,value);
+	if (node->kind == AST_CONST || node->kind == AST_LOAD)
+		return false;
+	if (node->kind != AST_NOT && lastQuotient(ast,node->kid[1],value))
+		return true;
+	return lastQuotient(ast,node->kid[0],value);
+}
+
+/**
+ * Leave in %eax the quotient a folded expression would have left there had
+ * its divisions run, since a function without a return statement returns it.
+ *
+ * @param ast a syntax tree
+ * @param expr an expression node whose value is known
+ */
+static void lowerQuotient(Ast ast, AstIndex expr) {
+	int value;
+
+	if (lastQuotient(ast,expr,&value))
+		emitQuotient(instList,symtab,emitLoadImmediate(instList,symtab,value));
+}
+
+/**
+ * Return true if two expressions are spelled the same.
+ *
+ * @param ast a syntax tree
+ * @param a an expression node
+ * @param b an expression node
+ */
+static bool sameExpression(Ast ast, AstIndex a, AstIndex b) {
+	AstNode *m = AST_NODE(ast,a), *n = AST_NODE(ast,b);
+	int i;
+
+	if (m->kind != n->kind || strcmp(AST_NAME(ast,a),AST_NAME(ast,b)) != 0)
+		return false;
+	for (i = 0; i < 3; i++)
+		if ((m->kid[i] == AST_NULL) != (n->kid[i] == AST_NULL) ||
+		    (m->kid[i] != AST_NULL && !sameExpression(ast,m->kid[i],n->kid[i])))
+			return false;
+	return true;
+}
+
+/**
+ * Generate code for a binary operator. A constant operand, or a constant left
+ * operand of an operator that may swap its operands, is an immediate, a
+ * multiplication or division by a constant is reduced to shifts, lea and a
+ * multiplication by a magic number, and the identities x + 0, x - 0, x | 0,
+ * x * 1, x / 1, x * 0, x & 0 and x - x are applied.
+ *
+ * @param ast a syntax tree
+ * @param expr an operator node whose value is not known
+ * @return the symbol table index of the register holding the value
+ */
+static int lowerBinary(Ast ast, AstIndex expr) {
+	AstNode *node = AST_NODE(ast,expr);
+	AstIndex var = node->kid[0];
+	int kind = node->kind, value;
+	bool constant = constantValue(ast,node->kid[1],&value);
+	MirCondition cond = compareConditions[kind];
+
+	if (!constant && (kind == AST_OR || kind == AST_AND || kind == AST_ADD || kind == AST_MUL || isComparison(node)) &&
+	    constantValue(ast,node->kid[0],&value)) {
+		var = node->kid[1];
+		cond = mirSwapCondition(cond);
+		constant = true;
+	}
+
+	if (constant) {
+		int left = SYM_INVALID_INDEX;
+
+		/* the folded operand's divisions leave %eax as if they ran in turn */
+		if (var == node->kid[1])
+			lowerQuotient(ast,node->kid[0]);
+		if (value != 0 || (kind != AST_MUL && kind != AST_AND) || !isPure(ast,var))
+			left = lowerExpression(ast,var);
+		if (var == node->kid[0])
+			lowerQuotient(ast,node->kid[1]);
+
+		if ((value == 0 && (kind == AST_ADD || kind == AST_SUB || kind == AST_OR)) ||
+		    (value == 1 && kind == AST_MUL))
+			return left;
+		if (value == 1 && kind == AST_DIV) {
+			emitQuotient(instList,symtab,left);
+			return left;
+		}
+		if (value == 0 && (kind == AST_MUL || kind == AST_AND))
+			return emitLoadImmediate(instList,symtab,0);
+		if (isComparison(node))
+			return emitCompareImmediateExpression(instList,symtab,left,value,cond);
+		if (kind == AST_MUL)
+			return emitMultiplyImmediate(instList,symtab,left,value);
+		if (kind == AST_DIV)
+			return emitDivideImmediate(instList,symtab,left,value);
+		return emitImmediateExpression(instList,symtab,left,value,immediateOpcodes[kind]);
+	}
+
+	if (useFolding && kind == AST_SUB && isPure(ast,node->kid[0]) && sameExpression(ast,node->kid[0],node->kid[1]))
+		return emitLoadImmediate(instList,symtab,0);
+
+	int left = lowerExpression(ast,node->kid[0]);
+	int right = lowerOperand(ast,node->kid[1]);
+	return binaryEmitters[kind](instList,symtab,left,right);
+}
+
+/**
+ * Generate code for an expression.
+ *
+ * @param ast a syntax tree
+ * @param expr an expression node
+ * @return the symbol table index of the register holding the value, which
+ * 	   the caller may change
+ */
+static int lowerExpression(Ast ast, AstIndex expr) {
+	AstNode *node = AST_NODE(ast,expr);
+	Promoted *p;
+	int value;
+
+	if (constantValue(ast,expr,&value)) {
+		lowerQuotient(ast,expr);
+		return emitLoadImmediate(instList,symtab,value);
+	}
+
+	switch (node->kind) {
+	case AST_NOT:
+		return emitNotExpression(instList,symtab,lowerExpression(ast,node->kid[0]));
+	case AST_LOAD:
+		if ((p = promotedVariable(ast,node->kid[0])) != NULL)
+			return emitCopyRegister(instList,symtab,p->regIndex);
+		return emitLoadVariable(instList,symtab,lowerVariable(ast,node->kid[0]));
+	case AST_CONST:
+		return emitLoadIntegerConstant(instList,symtab,SymIndex(symtab,AST_NAME(ast,expr)));
+	case AST_STRING:
+		return emitLoadStringConstantAddress(instList,dataList,symtab,SymIndex(symtab,AST_NAME(ast,expr)));
+	case AST_CALL:
+		return emitCallFunction(instList,symtab,AST_NAME(ast,expr));
+	default:
+		return lowerBinary(ast,expr);
+	}
+}
+
+/**
+ * Generate code for an expression whose value is only read. A promoted
+ * variable is its own register rather than a copy.
+ *
+ * @param ast a syntax tree
+ * @param expr an expression node
+ * @return the symbol table index of the register holding the value
+ */
+static int lowerOperand(Ast ast, AstIndex expr) {
+	AstNode *node = AST_NODE(ast,expr);
+	Promoted *p;
+
+	if (node->kind == AST_LOAD && (p = promotedVariable(ast,node->kid[0])) != NULL)
+		return p->regIndex;
+	return lowerExpression(ast,expr);
+}
+
+/**
+ * Generate code for the memory operand of a variable. A constant subscript,
+ * or the constant of a subscript that adds or subtracts one, is folded into
+ * the displacement.
+ *
+ * @param ast a syntax tree
+ * @param var an AST_VAR_ADDR or AST_ARRAY_ADDR node
+ * @return the memory operand
+ */
+static MirOperand lowerVariable(Ast ast, AstIndex var) {
+	int subIndex = SYM_INVALID_INDEX, element = 0;
+
+	lowerLineno = AST_NODE(ast,var)->line;
+
+	if (AST_NODE(ast,var)->kind == AST_ARRAY_ADDR) {
+		AstIndex sub = AST_KID(ast,var,0);
+		AstNode *node = AST_NODE(ast,sub);
+		int value;
+
+		if (constantValue(ast,sub,&value) && value >= LOWER_MIN_ELEMENT && value <= LOWER_MAX_ELEMENT) {
+			element = value;
+			lowerQuotient(ast,sub);
+		} else if ((node->kind == AST_ADD || node->kind == AST_SUB) && constantValue(ast,node->kid[1],&value) &&
+			 value >= LOWER_MIN_ELEMENT && value <= LOWER_MAX_ELEMENT) {
+			element = node->kind == AST_ADD ? value : -value;
+			subIndex = lowerOperand(ast,node->kid[0]);
+			lowerQuotient(ast,node->kid[1]);
+		} else if (node->kind == AST_ADD && constantValue(ast,node->kid[0],&value) &&
+			   value >= LOWER_MIN_ELEMENT && value <= LOWER_MAX_ELEMENT) {
+			element = value;
+			lowerQuotient(ast,node->kid[0]);
+			subIndex = lowerOperand(ast,node->kid[1]);
+		} else
+			subIndex = lowerOperand(ast,sub);
+		lowerLineno = AST_NODE(ast,var)->line;
+	}
+
+	return emitVariableOperand(instList,globalSymtab,symtab,AST_NAME(ast,var),subIndex,element);
+}
+
+/**
+ * Generate the test of an if or while statement, which branches to a new
+ * label when the expression is false. A comparison, under any number of
+ * nots, is a compare and a conditional branch on its flags; any other
+ * expression is computed and tested against zero.
+ *
+ * @param ast a syntax tree
+ * @param expr the test expression
+ * @param loop true for the test of a while statement
+ * @return the symbol table index of the label
+ */
+static int lowerTest(Ast ast, AstIndex expr, bool loop) {
+	AstNode *node = AST_NODE(ast,expr);
+	bool negated = false;
+	int left, right, value;
+
+	if (constantValue(ast,expr,&value)) {
+		lowerQuotient(ast,expr);
+		return emitConstantTest(instList,symtab,value != 0);
+	}
+
+	while (node->kind == AST_NOT && isComparison(AST_NODE(ast,node->kid[0]))) {
+		negated = !negated;
+		node = AST_NODE(ast,node->kid[0]);
+	}
+
+	if (isComparison(node)) {
+		MirCondition cond = compareConditions[node->kind];
+		if (negated)
+			cond = mirInvertCondition(cond);
+		if (constantValue(ast,node->kid[1],&value)) {
+			left = lowerOperand(ast,node->kid[0]);
+			lowerQuotient(ast,node->kid[1]);
+			return emitCompareImmediateTest(instList,symtab,left,value,cond);
+		}
+		if (constantValue(ast,node->kid[0],&value)) {
+			lowerQuotient(ast,node->kid[0]);
+			return emitCompareImmediateTest(instList,symtab,lowerOperand(ast,node->kid[1]),value,mirSwapCondition(cond));
+		}
+		left = lowerOperand(ast,node->kid[0]);
+		right = lowerOperand(ast,node->kid[1]);
+		return emitCompareTest(instList,symtab,left,right,cond);
+	}
+
+	if (loop)
+		return emitWhileLoopTest(instList,symtab,lowerOperand(ast,expr));
+	return emitIfTest(instList,symtab,lowerOperand(ast,expr));
+}
+
+/**
+ * Return true if a list of nodes, up to a given node, calls a function of the
+ * program, printf or scanf.
+ *
+ * @param ast a syntax tree
+ * @param node the first node of a list
+ * @param stop the node to stop at, or AST_NULL for the end of the list
+ */
+static bool hasCall(Ast ast, AstIndex node, AstIndex stop) {
+	for (; node != stop; node = AST_NEXT(ast,node)) {
+		AstNode *n = AST_NODE(ast,node);
+
+		if (n->kind == AST_CALL || n->kind == AST_READ || n->kind == AST_WRITE)
+			return true;
+		if (hasCall(ast,n->kid[0],AST_NULL) || hasCall(ast,n->kid[1],AST_NULL) ||
+		    hasCall(ast,n->kid[2],AST_NULL))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Add the uses of scalar globals in a list of nodes, up to a given node, to
+ * the globals of the region, and note the globals assigned.
+ *
+ * @param ast a syntax tree
+ * @param node the first node of a list
+ * @param stop the node to stop at, or AST_NULL for the end of the list
+ * @param weight what a use counts for
+ */
+static void countGlobalUses(Ast ast, AstIndex node, AstIndex stop, int weight) {
+	for (; node != stop; node = AST_NEXT(ast,node)) {
+		AstNode *n = AST_NODE(ast,node);
+		char *name = AST_NAME(ast,node);
+		int varIndex;
+
+		if (n->kind == AST_VAR_ADDR && SymQueryIndex(symtab,name) == SYM_INVALID_INDEX &&
+		    (varIndex = SymQueryIndex(globalSymtab,name)) != SYM_INVALID_INDEX &&
+		    !isArrayType(globalSymtab,(int)(long)SymGetFieldByIndex(globalSymtab,varIndex,SYMTAB_TYPE_INDEX_FIELD))) {
+			Promoted *p = findPromoted(name);
+			if (p == NULL)
+				p = addPromoted(name,SYM_INVALID_INDEX);
+			p->uses += weight;
+		}
+		if (n->kind == AST_ASSIGN && AST_NODE(ast,n->kid[0])->kind == AST_VAR_ADDR) {
+			countGlobalUses(ast,n->kid[0],AST_NULL,weight);
+			Promoted *p = findPromoted(AST_NAME(ast,n->kid[0]));
+			if (p != NULL && p >= promoted + numLocalsPromoted)
+				p->stored = true;
+			countGlobalUses(ast,n->kid[1],AST_NULL,weight);
+			continue;
+		}
+
+		int inner = n->kind == AST_WHILE ? MIN(weight * LOWER_LOOP_WEIGHT,LOWER_MAX_WEIGHT) : weight;
+		countGlobalUses(ast,n->kid[0],AST_NULL,inner);
+		countGlobalUses(ast,n->kid[1],AST_NULL,inner);
+		countGlobalUses(ast,n->kid[2],AST_NULL,inner);
+	}
+}
+
+/**
+ * Keep the globals of the region used at least twice, the most used first,
+ * and load them into registers of their own.
+ */
+static void loadRegionGlobals() {
+	int i, j, n = numLocalsPromoted;
+
+	for (i = numLocalsPromoted; i < numPromoted; i++) {
+		Promoted p = promoted[i];
+		if (p.uses < 2)
+			continue;
+		for (j = n; j > numLocalsPromoted && promoted[j-1].uses < p.uses; j--)
+			promoted[j] = promoted[j-1];
+		promoted[j] = p;
+		n++;
+	}
+	numPromoted = MIN(n,numLocalsPromoted + LOWER_MAX_REGION_GLOBALS);
+
+	for (i = numLocalsPromoted; i < numPromoted; i++) {
+		promoted[i].regIndex = getFreeIntegerRegisterIndex(symtab);
+		emitLoadPromotedVariable(instList,globalSymtab,symtab,promoted[i].name,promoted[i].regIndex);
+	}
+}
+
+/**
+ * Store the globals the current region assigns.
+ */
+static void storeRegionGlobals() {
+	int i;
+
+	for (i = numLocalsPromoted; i < numPromoted; i++)
+		if (promoted[i].stored)
+			emitAssignment(instList,symtab,emitVariableOperand(instList,globalSymtab,symtab,promoted[i].name,
+									    SYM_INVALID_INDEX,0),promoted[i].regIndex);
+}
+
+/**
+ * Generate code for a region of statements without calls, with the globals
+ * it uses most kept in registers.
+ *
+ * @param ast a syntax tree
+ * @param stmt the first statement of the region
+ * @param end the statement after the region, or AST_NULL
+ */
+static void lowerRegion(Ast ast, AstIndex stmt, AstIndex end) {
+	countGlobalUses(ast,stmt,end,1);
+	loadRegionGlobals();
+
+	inRegion = true;
+	for (; stmt != end; stmt = AST_NEXT(ast,stmt))
+		lowerStatement(ast,stmt);
+	inRegion = false;
+
+	storeRegionGlobals();
+	numPromoted = numLocalsPromoted;
+}
+
+/**
+ * Generate code for a list of statements. Outside a region, each run of
+ * statements without calls is a region.
+ *
+ * @param ast a syntax tree
+ * @param stmt the first statement of the list
+ */
+static void lowerStatementList(Ast ast, AstIndex stmt) {
+	AstIndex end;
+
+	while (stmt != AST_NULL) {
+		if (!usePromotion || inRegion) {
+			lowerStatement(ast,stmt);
+			stmt = AST_NEXT(ast,stmt);
+			continue;
+		}
+
+		for (end = stmt; end != AST_NULL && !hasCall(ast,end,AST_NEXT(ast,end)); end = AST_NEXT(ast,end))
+			;
+		if (end == stmt) {
+			lowerStatement(ast,stmt);
+			stmt = AST_NEXT(ast,stmt);
+		} else {
+			lowerRegion(ast,stmt,end);
+			stmt = end;
+		}
+	}
+}
+
+/**
+ * Forget the known constants of the promoted variables a list of nodes
+ * assigns or reads.
+ *
+ * @param ast a syntax tree
+ * @param node the first node of a list
+ */
+static void forgetAssigned(Ast ast, AstIndex node) {
+	Promoted *p;
+
+	for (; node != AST_NULL; node = AST_NEXT(ast,node)) {
+		AstNode *n = AST_NODE(ast,node);
+
+		if ((n->kind == AST_ASSIGN || n->kind == AST_READ) && (p = promotedVariable(ast,n->kid[0])) != NULL)
+			p->known = false;
+		forgetAssigned(ast,n->kid[0]);
+		forgetAssigned(ast,n->kid[1]);
+		forgetAssigned(ast,n->kid[2]);
+	}
+}
+
+/**
+ * Generate code for an if statement. A promoted variable is known after it
+ * only if both branches leave it the same constant.
+ *
+ * @param ast a syntax tree
+ * @param stmt the AST_IF node
+ */
+static void lowerIf(Ast ast, AstIndex stmt) {
+	AstNode *node = AST_NODE(ast,stmt);
+	int i, n = numPromoted;
+	Promoted *before = (Promoted*)malloc(MAX(n,1) * sizeof(Promoted));
+	Promoted *then = (Promoted*)malloc(MAX(n,1) * sizeof(Promoted));
+
+	memcpy(before,promoted,n * sizeof(Promoted));
+	int elseLabel = lowerTest(ast,node->kid[0],false);
+	lowerStatement(ast,node->kid[1]);
+	int endLabel = emitThenBranch(instList,symtab,elseLabel);
+
+	memcpy(then,promoted,n * sizeof(Promoted));
+	memcpy(promoted,before,n * sizeof(Promoted));
+	if (node->kid[2] != AST_NULL)
+		lowerStatement(ast,node->kid[2]);
+	emitEndBranchTarget(instList,symtab,endLabel);
+
+	for (i = 0; i < n; i++)
+		promoted[i].known = promoted[i].known && then[i].known && promoted[i].value == then[i].value;
+	free(before);
+	free(then);
+}
+
+/**
+ * Add a test to the entry for on-stack replacement that continues at a while
+ * loop, loading the variables promoted at the loop from memory.
+ *
+ * @param loop the AST_WHILE node
+ * @param beginLabel the symbol table index of the label of the loop's landing pad
+ */
+static void lowerOsrDispatch(AstIndex loop, int beginLabel) {
+	int i;
+
+	emitOsrDispatch(osrList,funcName,(int)loop);
+	for (i = 0; i < numPromoted; i++)
+		emitLoadPromotedVariable(osrList,globalSymtab,symtab,promoted[i].name,promoted[i].regIndex);
+	emitOsrResume(osrList,symtab,funcName,(int)loop,beginLabel);
+}
+
+/**
+ * Generate code for a statement.
+ *
+ * @param ast a syntax tree
+ * @param stmt a statement node
+ */
+static void lowerStatement(Ast ast, AstIndex stmt) {
+	AstNode *node = AST_NODE(ast,stmt);
+	MirOperand lhs;
+	int rhs, endLabel, beginLabel, value;
+	Promoted *p;
+
+	switch (node->kind) {
+	case AST_ASSIGN:
+		if ((p = promotedVariable(ast,node->kid[0])) != NULL) {
+			if (constantValue(ast,node->kid[1],&value)) {
+				lowerQuotient(ast,node->kid[1]);
+				emitMoveImmediate(instList,symtab,value,p->regIndex);
+				p->known = true;
+				p->value = value;
+				break;
+			}
+			rhs = lowerOperand(ast,node->kid[1]);
+			if (rhs != p->regIndex)
+				emitMoveRegister(instList,symtab,rhs,p->regIndex);
+			p->known = false;
+			break;
+		}
+		lhs = lowerVariable(ast,node->kid[0]);
+		rhs = lowerOperand(ast,node->kid[1]);
+		emitAssignment(instList,symtab,lhs,rhs);
+		break;
+	case AST_IF:
+		lowerIf(ast,stmt);
+		break;
+	case AST_WHILE:
+		/* what the loop assigns is not known at its landing pad, nor after it */
+		forgetAssigned(ast,node->kid[1]);
+		beginLabel = emitWhileLoopLandingPad(instList,symtab);
+		if (osrList != NULL)
+			lowerOsrDispatch(stmt,beginLabel);
+		endLabel = lowerTest(ast,node->kid[0],true);
+		lowerStatement(ast,node->kid[1]);
+		emitWhileLoopBackBranch(instList,symtab,beginLabel,endLabel);
+		forgetAssigned(ast,node->kid[1]);
+		break;
+	case AST_READ:
+		emitReadVariable(instList,symtab,emitComputeAddress(instList,symtab,lowerVariable(ast,node->kid[0])));
+		if ((p = promotedVariable(ast,node->kid[0])) != NULL) {
+			emitLoadPromotedVariable(instList,globalSymtab,symtab,p->name,p->regIndex);
+			p->known = false;
+		}
+		break;
+	case AST_WRITE:
+		if (AST_NODE(ast,node->kid[0])->kind == AST_STRING)
+			emitWriteExpression(instList,symtab,lowerExpression(ast,node->kid[0]),SYSCALL_PRINT_STRING);
+		else
+			emitWriteExpression(instList,symtab,lowerOperand(ast,node->kid[0]),SYSCALL_PRINT_INTEGER);
+		break;
+	case AST_RETURN:
+		emitReturnFunction(instList,globalSymtab,symtab,lowerOperand(ast,node->kid[0]));
+		break;
+	case AST_EXIT:
+		storeRegionGlobals();
+		emitExit(instList);
+		break;
+	case AST_BLOCK:
+		lowerStatementList(ast,node->kid[0]);
+		break;
+	}
+}
+
+/**
+ * Gather the size, labels and string constants of a list of nodes.
+ *
+ * @param ast a syntax tree
+ * @param node the first node of a list
+ * @param f the function containing the list
+ */
+static void countNodes(Ast ast, AstIndex node, LowerFunc f) {
+	for (; node != AST_NULL; node = AST_NEXT(ast,node)) {
+		AstNode *n = AST_NODE(ast,node);
+
+		f->size++;
+		if (n->kind == AST_IF || n->kind == AST_WHILE)
+			f->numLabels += 2;
+		else if (n->kind == AST_STRING)
+			f->numStrings++;
+
+		countNodes(ast,n->kid[0],f);
+		countNodes(ast,n->kid[1],f);
+		countNodes(ast,n->kid[2],f);
+	}
+}
+
+/**
+ * Insert a list of instructions after a node of the instructions of the
+ * function being generated.
+ *
+ * @param after the node
+ * @param list the instructions, which are moved
+ */
+static void insertList(DNode after, DList list) {
+	DNode node;
+
+	while ((node = dlinkPop(list)) != NULL) {
+		dlinkInsertAfter(after,node);
+		after = node;
+	}
+}
+
+/**
+ * Set up the frame of a function once its registers are allocated and its
+ * code is optimized: after the label of the function and of its entry for
+ * on-stack replacement the callee-saved registers the code names are saved,
+ * and before every return they are restored. A function that makes no call,
+ * has no entry for on-stack replacement and whose locals and spill slots fit
+ * in the red zone gets no frame, and its locals are addressed from %rsp.
+ *
+ * @param osr true if the function has an entry for on-stack replacement
+ * @param frameSize the size of the frame
+ */
+static void insertFrame(bool osr, int frameSize) {
+	DList frameList = dlinkListAlloc(NULL);
+	char *osrLabel = nssave(2,funcName,".osr");
+	bool frame = osr || frameSize > LOWER_RED_ZONE;
+	int used = 0, k;
+	DNode node;
+
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node)) {
+		MirInst inst = (MirInst)dlinkNodeAtom(node);
+		if (inst->opcode == MIR_CALL || inst->opcode == MIR_TEXT)
+			frame = true;
+		for (k = 0; k < inst->numOperands; k++) {
+			MirOperand *op = &inst->op[k];
+			if (op->kind == MIR_OPERAND_REG) {
+				used |= 1 << op->reg;
+				/* the address of a local is computed from %rbp */
+				if (op->reg == MIR_RBP)
+					frame = true;
+			} else if (op->kind == MIR_OPERAND_MEM) {
+				if (op->reg != MIR_NO_REG)
+					used |= 1 << op->reg;
+				if (op->index != MIR_NO_REG)
+					used |= 1 << op->index;
+			}
+		}
+	}
+
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node)) {
+		MirInst inst = (MirInst)dlinkNodeAtom(node);
+		if (inst->opcode == MIR_RET) {
+			emitEndFunction(frameList,used,frame);
+			insertList(dlinkPrev(node),frameList);
+		}
+		/* without a frame the locals lie below the pushes, at the same displacements from %rsp */
+		for (k = 0; !frame && k < inst->numOperands; k++)
+			if (inst->op[k].kind == MIR_OPERAND_MEM && inst->op[k].reg == MIR_RBP)
+				inst->op[k].reg = MIR_RSP;
+	}
+
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node)) {
+		MirInst inst = (MirInst)dlinkNodeAtom(node);
+		if (inst->opcode == MIR_LABEL && inst->op[0].kind == MIR_OPERAND_SYMBOL &&
+		    (!strcmp(inst->op[0].symbol,funcName) || !strcmp(inst->op[0].symbol,osrLabel))) {
+			if (dlinkNext(node) != NULL && ((MirInst)dlinkNodeAtom(dlinkNext(node)))->opcode == MIR_NOP)
+				node = dlinkNext(node);
+			emitStartFunction(frameList,frameSize,used,frame);
+			insertList(node,frameList);
+		}
+	}
+	sfree(osrLabel);
+	dlinkListFree(frameList);
+}
+
+/**
+ * Generate code for a function into its own lists. The code is generated
+ * with virtual registers, which are allocated before the frame is set up.
+ *
+ * @param ast a syntax tree
+ * @param f the function
+ */
+static void lowerFunction(Ast ast, LowerFunc f) {
+	AstIndex func = f->func;
+	bool osr = osrList != NULL;
+
+	instList = f->instList;
+	dataList = f->dataList;
+	funcName = AST_NAME(ast,func);
+	setLabelNumbers(f->labelBase,f->stringBase);
+	initRegisters();
+	codegenErrors = 0;
+
+	symtab = beginScope(symstack);
+	int funcIndex = SymIndex(symtab,funcName);
+	int offset = lowerDeclList(ast,AST_KID(ast,func,0));
+
+	emitProcedurePrologue(instList,symtab,funcIndex);
+
+	numPromoted = numLocalsPromoted = 0;
+	if (usePromotion)
+		promoteLocals(ast,AST_KID(ast,func,0));
+	lowerStatementList(ast,AST_KID(ast,func,1));
+
+	emitExit(instList);
+
+	/* the entry for on-stack replacement is allocated with the function, as its tests load promoted variables */
+	if (osr) {
+		DNode node;
+		emitOsrPrologue(instList,funcName);
+		emitOsrEntry(instList,funcName,offset);
+		while ((node = dlinkPop(osrList)) != NULL)
+			dlinkAppend(instList,node);
+	}
+	symtab = endScope(symstack);
+	releaseScope(symtab);
+	numPromoted = numLocalsPromoted = 0;
+
+	int frameSize = allocateRegisters(instList,offset);
+	if (usePeephole)
+		peepholeOptimize(instList);
+	insertFrame(osr,frameSize);
+
+	f->errors = codegenErrors;
+}
+
+/**
+ * Add a list of nodes and their subtrees to a key. Line numbers are left out,
+ * so moving a function in its file does not change its key.
+ *
+ * @param ast a syntax tree
+ * @param node the first node of a list
+ * @param key the key
+ */
+static void hashNodes(Ast ast, AstIndex node, CacheKey *key) {
+	for (; node != AST_NULL; node = AST_NEXT(ast,node)) {
+		AstNode *n = AST_NODE(ast,node);
+
+		cacheKeyAddInt(key,((long)n->kind << 16) | n->type);
+		cacheKeyAddString(key,AST_NAME(ast,node));
+		hashNodes(ast,n->kid[0],key);
+		hashNodes(ast,n->kid[1],key);
+		hashNodes(ast,n->kid[2],key);
+	}
+	cacheKeyAddInt(key,-1);
+}
+
+/**
+ * Add the global layout of every variable named in a list of nodes to a key:
+ * its offset and type, or that there is no such global. A name that is also
+ * declared locally is added as well, which is harmless.
+ *
+ * @param ast a syntax tree
+ * @param node the first node of a list
+ * @param key the key
+ */
+static void hashGlobals(Ast ast, AstIndex node, CacheKey *key) {
+	for (; node != AST_NULL; node = AST_NEXT(ast,node)) {
+		AstNode *n = AST_NODE(ast,node);
+
+		if (n->kind == AST_VAR_ADDR || n->kind == AST_ARRAY_ADDR) {
+			char *name = AST_NAME(ast,node);
+			int varIndex = SymQueryIndex(globalSymtab,name);
+
+			cacheKeyAddString(key,name);
+			if (varIndex == SYM_INVALID_INDEX)
+				cacheKeyAddInt(key,-1);
+			else {
+				int typeIndex = (int)(long)SymGetFieldByIndex(globalSymtab,varIndex,SYMTAB_TYPE_INDEX_FIELD);
+				cacheKeyAddInt(key,(long)SymGetFieldByIndex(globalSymtab,varIndex,SYMTAB_OFFSET_FIELD));
+				cacheKeyAddString(key,(char*)SymGetFieldByIndex(globalSymtab,typeIndex,SYM_NAME_FIELD));
+			}
+		}
+
+		hashGlobals(ast,n->kid[0],key);
+		hashGlobals(ast,n->kid[1],key);
+		hashGlobals(ast,n->kid[2],key);
+	}
+}
+
+/**
+ * Compute the key of a function in the code cache.
+ *
+ * @param ast a syntax tree
+ * @param f the function
+ */
+static void hashFunction(Ast ast, LowerFunc f) {
+	AstIndex func = f->func;
+
+	cacheKeyInit(codeCache,&f->key);
+	cacheKeyAddString(&f->key,AST_NAME(ast,func));
+	hashNodes(ast,AST_KID(ast,func,0),&f->key);
+	hashNodes(ast,AST_KID(ast,func,1),&f->key);
+	hashGlobals(ast,AST_KID(ast,func,1),&f->key);
+}
+
+/**
+ * Deal the functions that have entered the window, in source order, to the
+ * queues of the threads in turn, keeping each queue largest first, and wake
+ * the threads waiting for them.
+ */
+static void dealFunctions() {
+	int i;
+
+	pthread_mutex_lock(&takeLock);
+	while (numDealt < numFuncs && numDealt < numPrinted + window) {
+		LowerQueue q = &queues[numDealt % numQueues];
+
+		pthread_mutex_lock(&q->lock);
+		/* a queue never holds more than the window, so moving it to the front makes room */
+		if (q->tail == window) {
+			memmove(q->tasks,q->tasks + q->head,(q->tail - q->head) * sizeof(int));
+			q->tail -= q->head;
+			q->head = 0;
+		}
+		for (i = q->tail++; i > q->head && funcs[q->tasks[i-1]].size < funcs[numDealt].size; i--)
+			q->tasks[i] = q->tasks[i-1];
+		q->tasks[i] = numDealt++;
+		pthread_mutex_unlock(&q->lock);
+	}
+	pthread_cond_broadcast(&takeCond);
+	pthread_mutex_unlock(&takeLock);
+}
+
+/**
+ * Take the largest function of a thread's own queue or, when it is empty,
+ * steal the smallest of another thread's.
+ *
+ * @param self the queue of the calling thread
+ * @return an index into funcs or -1 when every queue is empty
+ */
+static int stealFunction(int self) {
+	int i, task = -1;
+
+	for (i = 0; i < numQueues && task == -1; i++) {
+		LowerQueue q = &queues[(self + i) % numQueues];
+
+		pthread_mutex_lock(&q->lock);
+		if (q->head < q->tail)
+			task = (i == 0) ? q->tasks[q->head++] : q->tasks[--q->tail];
+		pthread_mutex_unlock(&q->lock);
+	}
+
+	return task;
+}
+
+/**
+ * Take the next function to lower, waiting for the window to move on when
+ * every function in it is taken.
+ *
+ * @param self the queue of the calling thread
+ * @return an index into funcs or -1 when all functions are taken
+ */
+static int takeFunction(int self) {
+	int task = stealFunction(self);
+
+	if (task != -1)
+		return task;
+
+	/* functions are dealt with takeLock held, so none is dealt between the look and the wait */
+	pthread_mutex_lock(&takeLock);
+	while ((task = stealFunction(self)) == -1 && numDealt < numFuncs)
+		pthread_cond_wait(&takeCond,&takeLock);
+	pthread_mutex_unlock(&takeLock);
+
+	return task;
+}
+
+/**
+ * Print the code of a function, or encode it with the encoder of
+ * lowerUseEncoder, and free it. Its data declarations are kept
+ * for the end of the program.
+ *
+ * @param f the function
+ */
+static void printFunction(LowerFunc f) {
+	DNode node;
+
+	if (codeEncoder == NULL)
+		emitInstructions(f->instList);
+	else {
+		/* what was printed before the function is assembled first */
+		outputFlush();
+		fflush(stdout);
+		for (node = dlinkHead(f->instList); node != NULL; node = dlinkNext(node))
+			encoderInstruction(codeEncoder,(MirInst)dlinkNodeAtom(node));
+	}
+	while ((node = dlinkPop(f->dataList)) != NULL)
+		dlinkAppend(programDataList,node);
+
+	mirFreeList(f->instList);
+	dlinkListFree(f->instList);
+	dlinkListFree(f->dataList);
+	f->instList = f->dataList = NULL;
+}
+
+/**
+ * Mark a function as generated, print every generated function whose turn
+ * has come, and deal the functions that the window then takes in.
+ *
+ * @param f the function
+ */
+static void finishFunction(LowerFunc f) {
+	pthread_mutex_lock(&printLock);
+	f->done = true;
+	while (numPrinted < numFuncs && funcs[numPrinted].done)
+		printFunction(&funcs[numPrinted++]);
+	if (numQueues > 0)
+		dealFunctions();
+	pthread_mutex_unlock(&printLock);
+}
+
+/**
+ * Generate the code of a function, or take it from the code cache, and print
+ * it once the functions before it are printed.
+ *
+ * @param ast a syntax tree
+ * @param f the function
+ */
+static void generateFunction(Ast ast, LowerFunc f) {
+	f->instList = dlinkListAlloc(NULL);
+	f->dataList = dlinkListAlloc(NULL);
+
+	if (codeCache != NULL) {
+		hashFunction(ast,f);
+		f->cached = cacheLoad(codeCache,&f->key,f->labelBase,f->stringBase,f->instList,f->dataList);
+	}
+
+	if (!f->cached) {
+		lowerFunction(ast,f);
+		/* code that reported errors is not stored, so that the errors are reported again */
+		if (codeCache != NULL && f->errors == 0)
+			cacheStore(codeCache,&f->key,f->labelBase,f->stringBase,f->instList,f->dataList);
+	}
+
+	finishFunction(f);
+}
+
+/**
+ * Generate functions until none are left.
+ *
+ * @param arg the number of the thread and of its queue, 0 for the main thread
+ * @return NULL
+ */
+static void *lowerWorker(void *arg) {
+	int self = (int)(long)arg;
+	int task;
+
+	symstack = symtabStackInit();
+	while ((task = takeFunction(self)) != -1)
+		generateFunction(lowerAst,&funcs[task]);
+	if (self != 0)
+		freeRecycledScopes();
+	free(promoted);
+	promoted = NULL;
+	maxPromoted = 0;
+	free(dlinkListAtom(symstack));
+	dlinkListFree(symstack);
+
+	return NULL;
+}
+
+/**
+ * Generate all functions on a number of threads. Only a window of functions
+ * after the next one to print is dealt out at a time, so at most that many
+ * wait to be printed; within it the largest functions are taken first so that
+ * no thread is left with a big one at the end.
+ *
+ * @param jobs the number of threads
+ */
+static void lowerFunctionsInParallel(int jobs) {
+	int i;
+	pthread_t *threads = (pthread_t*)malloc(jobs * sizeof(pthread_t));
+
+	window = jobs * LOWER_WINDOW_PER_JOB;
+	numQueues = jobs;
+	queues = (LowerQueue)malloc(jobs * sizeof(LowerQueueStruct));
+	for (i = 0; i < jobs; i++) {
+		pthread_mutex_init(&queues[i].lock,NULL);
+		queues[i].tasks = (int*)malloc(window * sizeof(int));
+		queues[i].head = queues[i].tail = 0;
+	}
+	numDealt = 0;
+	dealFunctions();
+
+	for (i = 1; i < jobs; i++)
+		pthread_create(&threads[i],NULL,lowerWorker,(void*)(long)i);
+	lowerWorker((void*)0);
+	for (i = 1; i < jobs; i++)
+		pthread_join(threads[i],NULL);
+
+	for (i = 0; i < jobs; i++) {
+		pthread_mutex_destroy(&queues[i].lock);
+		free(queues[i].tasks);
+	}
+	free(queues);
+	queues = NULL;
+	numQueues = 0;
+	free(threads);
+}
+
+/**
+ * Use a code cache in all later compiles.
+ *
+ * @param cache a code cache or NULL for none
+ */
+void lowerUseCache(CodeCache cache) {
+	codeCache = cache;
+}
+
+/**
+ * Hand the code of every function to an encoder in all later compiles, while
+ * stdout is the encoder's stream, instead of printing it for the encoder to
+ * parse.
+ *
+ * @param encoder an encoder or NULL to print the code
+ */
+void lowerUseEncoder(Encoder encoder) {
+	codeEncoder = encoder;
+}
+
+/**
+ * Turn the peephole optimizer on or off in all later compiles. It is on
+ * unless turned off.
+ *
+ * @param on true to optimize the code of every function
+ */
+void lowerUsePeephole(bool on) {
+	usePeephole = on;
+}
+
+/**
+ * Turn the promotion of scalar variables to registers on or off in all later
+ * compiles. It is on unless turned off.
+ *
+ * @param on true to keep scalar variables in registers
+ */
+void lowerUsePromotion(bool on) {
+	usePromotion = on;
+}
+
+/**
+ * Turn constant folding and immediate operands on or off in all later
+ * compiles. It is on unless turned off.
+ *
+ * @param on true to fold constants
+ */
+void lowerUseFolding(bool on) {
+	useFolding = on;
+}
+
+/**
+ * Enter the global declarations of a program and lay out its functions. The
+ * functions can then be generated by lowerProgram or one at a time by
+ * lowerSingleFunction until lowerEndProgram.
+ *
+ * @param ast the syntax tree of a program
+ */
+void lowerBeginProgram(Ast ast) {
+	int i;
+	AstIndex func;
+
+	globalStack = symtabStackInit();
+	globalSymtab = symtab = beginScope(globalStack);
+	globalOffset = lowerDeclList(ast,AST_KID(ast,ast->root,0));
+
+	/* make sure every field exists so that reading the global scope never changes it */
+	int intIndex = SymQueryIndex(globalSymtab,SYMTAB_INTEGER_TYPE_STRING);
+	SymGetFieldByIndex(globalSymtab,intIndex,SYMTAB_TYPE_INDEX_FIELD);
+
+	numFuncs = 0;
+	for (func = AST_KID(ast,ast->root,1); func != AST_NULL; func = AST_NEXT(ast,func))
+		numFuncs++;
+
+	lowerAst = ast;
+	funcs = (LowerFunc)calloc(numFuncs + 1,sizeof(LowerFuncStruct));
+	for (i = 0, func = AST_KID(ast,ast->root,1); func != AST_NULL; i++, func = AST_NEXT(ast,func)) {
+		LowerFunc f = &funcs[i];
+		f->func = func;
+		countNodes(ast,AST_KID(ast,func,0),f);
+		countNodes(ast,AST_KID(ast,func,1),f);
+		if (i > 0) {
+			f->labelBase = funcs[i-1].labelBase + funcs[i-1].numLabels;
+			f->stringBase = funcs[i-1].stringBase + funcs[i-1].numStrings;
+		}
+	}
+
+	numPrinted = 0;
+	programDataList = dlinkListAlloc(NULL);
+}
+
+/**
+ * Generate and print the assembly code for one function of the program begun
+ * by lowerBeginProgram, as a program of its own: the data prologue, the
+ * function and its string constants. The code cache is not used. With
+ * on-stack replacement, the function is followed by the entry of
+ * emitOsrEntry, which continues an interpreted call at any of its while loops
+ * given by the index of the loop's AST_WHILE node.
+ *
+ * @param index the number of the function in source order
+ * @param osr true to add an entry for on-stack replacement
+ * @return false if errors were reported
+ */
+bool lowerSingleFunction(int index, bool osr) {
+	LowerFunc f = &funcs[index];
+
+	symstack = globalStack;
+	emitDataPrologue();
+	f->instList = dlinkListAlloc(NULL);
+	f->dataList = dlinkListAlloc(NULL);
+	osrList = osr ? dlinkListAlloc(NULL) : NULL;
+
+	lowerFunction(lowerAst,f);
+	printFunction(f);
+	emitDataDeclarations(programDataList);
+	outputFlush();
+
+	if (osrList != NULL) {
+		dlinkListFree(osrList);
+		osrList = NULL;
+	}
+	dlinkFreeNodesAndAtoms(programDataList);
+	lowerLineno = 0;
+	return f->errors == 0;
+}
+
+/**
+ * Release the global scope and layout of the program begun by
+ * lowerBeginProgram.
+ */
+void lowerEndProgram() {
+	while (stackSize(globalStack) > 0) {
+		symtab = endScope(globalStack);
+		releaseScope(symtab);
+	}
+
+	free(dlinkListAtom(globalStack));
+	dlinkListFree(globalStack);
+
+	dlinkFreeNodesAndAtoms(programDataList);
+	dlinkListFree(programDataList);
+	free(funcs);
+	lowerLineno = 0;
+}
+
+/**
+ * Generate and print the assembly code for a program. Each function is
+ * printed and freed as soon as it and the functions before it are generated,
+ * and the string constants are printed at the end.
+ *
+ * @param ast the syntax tree of a program
+ * @param jobs the number of threads to generate code on
+ */
+void lowerProgram(Ast ast, int jobs) {
+	int i;
+
+	lowerBeginProgram(ast);
+	emitDataPrologue();
+
+	if (jobs > numFuncs)
+		jobs = numFuncs;
+	if (jobs > 1)
+		lowerFunctionsInParallel(jobs);
+	else {
+		symstack = globalStack;
+		for (i = 0; i < numFuncs; i++)
+			generateFunction(ast,&funcs[i]);
+	}
+
+	emitDataDeclarations(programDataList);
+	outputFlush();
+	lowerEndProgram();
+}
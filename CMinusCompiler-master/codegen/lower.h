@@ -0,0 +1,28 @@
+/**
+ * lower.h
+ *
+ * Code generation as a pass over the syntax tree built by the parser.
+ *
+ */
+
+#ifndef LOWER_H_
+#define LOWER_H_
+
+#include <util/general.h>
+#include <ast/ast.h>
+#include "cache.h"
+#include "encoder.h"
+
+extern __thread int lowerLineno;	/**< the source line of the code being generated, 0 outside code generation */
+
+EXTERN(void, lowerUseCache, (CodeCache cache));
+EXTERN(void, lowerUseEncoder, (Encoder encoder));
+EXTERN(void, lowerUsePeephole, (bool on));
+EXTERN(void, lowerUsePromotion, (bool on));
+EXTERN(void, lowerUseFolding, (bool on));
+EXTERN(void, lowerProgram, (Ast ast, int jobs));
+EXTERN(void, lowerBeginProgram, (Ast ast));
+EXTERN(bool, lowerSingleFunction, (int index, bool osr));
+EXTERN(void, lowerEndProgram, (void));
+
+#endif /* LOWER_H_ */
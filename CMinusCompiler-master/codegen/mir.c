@@ -0,0 +1,497 @@
+/**
+ * mir.c
+ *
+ * Building, dividing into basic blocks and printing the machine IR.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/general.h>
+#include <util/dlink.h>
+#include <util/string_utils.h>
+#include <util/output.h>
+#include "mir.h"
+
+#define MIR_MAX_LINE 256	/**< longer than any instruction but code cached as text */
+
+#define MIR_OPCODE_NAME(name, mnemonic, sized) mnemonic,
+const char *mirOpcodeNames[] = { MIR_OPCODES(MIR_OPCODE_NAME) };
+#undef MIR_OPCODE_NAME
+
+#define MIR_OPCODE_SIZED(name, mnemonic, sized) sized,
+static const bool mirOpcodeSized[] = { MIR_OPCODES(MIR_OPCODE_SIZED) };
+#undef MIR_OPCODE_SIZED
+
+static const char *registerNames8[MIR_NUM_REGISTERS] = {
+	"%al", "%cl", "%dl", "%bl", "%spl", "%bpl", "%sil", "%dil",
+	"%r8b", "%r9b", "%r10b", "%r11b", "%r12b", "%r13b", "%r14b", "%r15b"
+};
+static const char *registerNames32[MIR_NUM_REGISTERS] = {
+	"%eax", "%ecx", "%edx", "%ebx", "%esp", "%ebp", "%esi", "%edi",
+	"%r8d", "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"
+};
+static const char *registerNames64[MIR_NUM_REGISTERS] = {
+	"%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+	"%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"
+};
+
+/**
+ * The suffixes of the conditions, by condition code.
+ */
+static const char *conditionNames[16] = {
+	[MIR_COND_E] = "e", [MIR_COND_NE] = "ne", [MIR_COND_L] = "l",
+	[MIR_COND_GE] = "ge", [MIR_COND_LE] = "le", [MIR_COND_G] = "g"
+};
+
+/**
+ * Return a register operand.
+ *
+ * @param reg a register number or MIR_NO_REG
+ * @param size 1, 4 or 8 bytes
+ */
+MirOperand mirReg(int reg, int size) {
+	MirOperand op = { .kind = MIR_OPERAND_REG, .size = size, .reg = reg };
+
+	return op;
+}
+
+/**
+ * Return an immediate operand.
+ */
+MirOperand mirImm(long value) {
+	MirOperand op = { .kind = MIR_OPERAND_IMM, .value = value };
+
+	return op;
+}
+
+/**
+ * Return an immediate operand holding the address of a symbol plus a value.
+ *
+ * @param symbol the name of the symbol, which is copied
+ * @param value the value added to the address
+ */
+MirOperand mirSymbolImm(char *symbol, long value) {
+	MirOperand op = mirImm(value);
+
+	op.symbol = ssave(symbol);
+	return op;
+}
+
+/**
+ * Return a memory operand at disp(base,index,scale).
+ *
+ * @param base the base register or MIR_NO_REG
+ * @param index the index register or MIR_NO_REG
+ * @param scale the scale of the index
+ * @param disp the displacement
+ */
+MirOperand mirMem(int base, int index, int scale, long disp) {
+	MirOperand op = { .kind = MIR_OPERAND_MEM, .reg = base, .index = index, .scale = scale, .value = disp };
+
+	return op;
+}
+
+/**
+ * Return a local label operand.
+ *
+ * @param number the number of the label
+ */
+MirOperand mirLabel(int number) {
+	MirOperand op = { .kind = MIR_OPERAND_LABEL, .value = number };
+
+	return op;
+}
+
+/**
+ * Return a symbol operand.
+ *
+ * @param symbol the name of the symbol, which is copied
+ */
+MirOperand mirSymbol(char *symbol) {
+	MirOperand op = { .kind = MIR_OPERAND_SYMBOL, .symbol = ssave(symbol) };
+
+	return op;
+}
+
+/**
+ * Return an instruction without operands.
+ *
+ * @param opcode the opcode
+ * @param size the operand size of a sized opcode, else 0
+ */
+MirInst mirInst(MirOpcode opcode, int size) {
+	MirInst inst = (MirInst)calloc(1,sizeof(MirInstStruct));
+
+	inst->opcode = opcode;
+	inst->size = size;
+	inst->cond = MIR_COND_NONE;
+	return inst;
+}
+
+/**
+ * Return an instruction with one operand, which it takes over.
+ */
+MirInst mirInst1(MirOpcode opcode, int size, MirOperand op) {
+	MirInst inst = mirInst(opcode,size);
+
+	inst->numOperands = 1;
+	inst->op[0] = op;
+	return inst;
+}
+
+/**
+ * Return an instruction with two operands, which it takes over.
+ */
+MirInst mirInst2(MirOpcode opcode, int size, MirOperand src, MirOperand dst) {
+	MirInst inst = mirInst(opcode,size);
+
+	inst->numOperands = 2;
+	inst->op[0] = src;
+	inst->op[1] = dst;
+	return inst;
+}
+
+/**
+ * Return a jump, which is conditional unless the condition is MIR_COND_NONE.
+ *
+ * @param cond the condition
+ * @param target a label or symbol operand
+ */
+MirInst mirJump(MirCondition cond, MirOperand target) {
+	MirInst inst = mirInst1(cond == MIR_COND_NONE ? MIR_JMP : MIR_JCC,0,target);
+
+	inst->cond = cond;
+	return inst;
+}
+
+/**
+ * Return a conditional move.
+ */
+MirInst mirCmov(MirCondition cond, MirOperand src, MirOperand dst) {
+	MirInst inst = mirInst2(MIR_CMOVCC,0,src,dst);
+
+	inst->cond = cond;
+	return inst;
+}
+
+/**
+ * Return an instruction that sets a byte register to 1 if a condition holds
+ * and to 0 if it does not.
+ *
+ * @param cond the condition
+ * @param dst a byte register
+ */
+MirInst mirSet(MirCondition cond, MirOperand dst) {
+	MirInst inst = mirInst1(MIR_SETCC,0,dst);
+
+	inst->cond = cond;
+	return inst;
+}
+
+/**
+ * Return code that is already text, such as code taken from the code cache.
+ *
+ * @param text the lines of assembly code, which the instruction takes over
+ */
+MirInst mirText(char *text) {
+	MirInst inst = mirInst(MIR_TEXT,0);
+
+	inst->text = text;
+	return inst;
+}
+
+/**
+ * Free an instruction and its symbols.
+ */
+void mirFree(MirInst inst) {
+	int i;
+
+	for (i = 0; i < inst->numOperands; i++)
+		sfree(inst->op[i].symbol);
+	free(inst->text);
+	free(inst);
+}
+
+/**
+ * Free the instructions of a list and its nodes, but not the list.
+ */
+void mirFreeList(DList instList) {
+	DNode node;
+
+	while ((node = dlinkPop(instList)) != NULL) {
+		mirFree((MirInst)dlinkNodeAtom(node));
+		dlinkFreeNode(node);
+	}
+}
+
+/**
+ * Return the condition that holds exactly when a condition does not.
+ */
+MirCondition mirInvertCondition(MirCondition cond) {
+	return (MirCondition)(cond ^ 1);
+}
+
+/**
+ * Return the condition that holds for the operands of a comparison swapped
+ * exactly when a condition holds for them in order.
+ */
+MirCondition mirSwapCondition(MirCondition cond) {
+	switch (cond) {
+	case MIR_COND_L:
+		return MIR_COND_G;
+	case MIR_COND_G:
+		return MIR_COND_L;
+	case MIR_COND_LE:
+		return MIR_COND_GE;
+	case MIR_COND_GE:
+		return MIR_COND_LE;
+	default:
+		return cond;
+	}
+}
+
+/**
+ * Return how an instruction accesses its operand k when the operand is a
+ * register. The base and index of a memory operand are only read.
+ *
+ * @param inst an instruction
+ * @param k the number of the operand
+ * @return MIR_READ, MIR_WRITE or both
+ */
+int mirRegisterAccess(MirInst inst, int k) {
+	switch (inst->opcode) {
+	case MIR_MOV:
+	case MIR_MOVSLQ:
+	case MIR_MOVZBL:
+	case MIR_LEA:
+		return k == 0 ? MIR_READ : MIR_WRITE;
+	case MIR_ADD:
+	case MIR_SUB:
+	case MIR_IMUL:
+	case MIR_SHL:
+	case MIR_SAR:
+	case MIR_SHR:
+	case MIR_AND:
+	case MIR_OR:
+	case MIR_XOR:
+	case MIR_CMOVCC:
+		return k == 0 ? MIR_READ : MIR_READ | MIR_WRITE;
+	case MIR_NEG:
+		return MIR_READ | MIR_WRITE;
+	case MIR_SETCC:
+		/* only the low byte is written, so the rest of the register is kept */
+		return MIR_READ | MIR_WRITE;
+	case MIR_POP:
+		return MIR_WRITE;
+	default:
+		return MIR_READ;
+	}
+}
+
+/**
+ * Return true if control never goes on to the next instruction after an
+ * instruction, or may go elsewhere.
+ */
+bool mirEndsBlock(MirInst inst) {
+	return inst->opcode == MIR_JMP || inst->opcode == MIR_JCC || inst->opcode == MIR_RET;
+}
+
+/**
+ * Return true if an instruction is code rather than a label or directive.
+ */
+static bool isCode(MirInst inst) {
+	return inst->opcode != MIR_LABEL && inst->opcode != MIR_GLOBL && inst->opcode != MIR_TYPE;
+}
+
+/**
+ * Number the basic blocks of a list of instructions from 0. A block starts
+ * after an instruction that ends one, and at a label that follows code of
+ * the block before it; labels and directives that follow one another begin
+ * the same block.
+ *
+ * @param instList a list of instructions
+ */
+void mirNumberBlocks(DList instList) {
+	DNode node;
+	int block = 0;
+	bool hasCode = false, ended = false;
+
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node)) {
+		MirInst inst = (MirInst)dlinkNodeAtom(node);
+
+		if (ended || (inst->opcode == MIR_LABEL && hasCode)) {
+			block++;
+			hasCode = false;
+		}
+		inst->block = block;
+		hasCode = hasCode || isCode(inst);
+		ended = mirEndsBlock(inst);
+	}
+}
+
+/**
+ * A line being formatted. Characters past the end of the buffer are counted
+ * but not stored.
+ */
+typedef struct MirLine_struct {
+	char *buf;
+	size_t size;
+	size_t length;
+} MirLine;
+
+/**
+ * Append a string to a line.
+ */
+static void put(MirLine *line, const char *s) {
+	size_t n = strlen(s);
+
+	if (line->length < line->size)
+		memcpy(line->buf + line->length,s,MIN(n,line->size - line->length));
+	line->length += n;
+}
+
+/**
+ * Append a number to a line, with a sign if asked for.
+ */
+static void putLong(MirLine *line, long n, bool sign) {
+	char digits[24], *p = digits + sizeof(digits);
+	unsigned long u = n < 0 ? -(unsigned long)n : (unsigned long)n;
+
+	*--p = '\0';
+	do {
+		*--p = '0' + u % 10;
+		u /= 10;
+	} while (u != 0);
+	if (n < 0)
+		*--p = '-';
+	else if (sign)
+		*--p = '+';
+	put(line,p);
+}
+
+/**
+ * Append the name of a register to a line; a virtual register n is %vn.
+ */
+static void putRegister(MirLine *line, int reg, const char **names) {
+	if (MIR_IS_VIRTUAL(reg)) {
+		put(line,"%v");
+		putLong(line,reg - MIR_NUM_REGISTERS,false);
+	} else
+		put(line,names[reg]);
+}
+
+/**
+ * Append an operand to a line.
+ */
+static void putOperand(MirLine *line, MirOperand *op) {
+	const char **names = op->size == 8 ? registerNames64 : op->size == 1 ? registerNames8 : registerNames32;
+
+	switch (op->kind) {
+	case MIR_OPERAND_REG:
+		putRegister(line,op->reg,names);
+		break;
+	case MIR_OPERAND_IMM:
+		put(line,"$");
+		if (op->symbol == NULL)
+			putLong(line,op->value,false);
+		else {
+			put(line,op->symbol);
+			if (op->value != 0)
+				putLong(line,op->value,true);
+		}
+		break;
+	case MIR_OPERAND_MEM:
+		if (op->symbol != NULL) {
+			put(line,op->symbol);
+			if (op->value != 0)
+				putLong(line,op->value,true);
+		} else if (op->value != 0 || (op->reg == MIR_NO_REG && op->index == MIR_NO_REG))
+			putLong(line,op->value,false);
+		if (op->reg == MIR_NO_REG && op->index == MIR_NO_REG)
+			break;
+		put(line,"(");
+		if (op->reg != MIR_NO_REG)
+			putRegister(line,op->reg,registerNames64);
+		if (op->index != MIR_NO_REG) {
+			put(line,",");
+			putRegister(line,op->index,registerNames64);
+			put(line,",");
+			putLong(line,op->scale,false);
+		}
+		put(line,")");
+		break;
+	case MIR_OPERAND_LABEL:
+		put(line,".L");
+		putLong(line,op->value,false);
+		break;
+	case MIR_OPERAND_SYMBOL:
+		put(line,op->symbol);
+		break;
+	default:
+		put(line,"?");
+		break;
+	}
+}
+
+/**
+ * Format an instruction as a line of assembly code without the newline.
+ *
+ * @param inst an instruction
+ * @param buf the buffer
+ * @param size the size of the buffer
+ * @return the number of characters the line needs, as snprintf returns
+ */
+size_t mirFormat(MirInst inst, char *buf, size_t size) {
+	static const char *suffixes[] = { "", "b", "w", "", "l", "", "", "", "q" };
+	MirLine line = { buf, size, 0 };
+	int i;
+
+	switch (inst->opcode) {
+	case MIR_TEXT:
+		put(&line,inst->text);
+		break;
+	case MIR_LABEL:
+		putOperand(&line,&inst->op[0]);
+		put(&line,":");
+		break;
+	case MIR_TYPE:
+		put(&line,"\t.type ");
+		putOperand(&line,&inst->op[0]);
+		put(&line,",@function");
+		break;
+	default:
+		put(&line,"\t");
+		put(&line,mirOpcodeNames[inst->opcode]);
+		if (inst->cond != MIR_COND_NONE)
+			put(&line,conditionNames[inst->cond]);
+		else if (mirOpcodeSized[inst->opcode])
+			put(&line,suffixes[inst->size]);
+		for (i = 0; i < inst->numOperands; i++) {
+			put(&line,i == 0 ? " " : ", ");
+			putOperand(&line,&inst->op[i]);
+		}
+		break;
+	}
+
+	if (size > 0)
+		buf[MIN(line.length,size - 1)] = '\0';
+	return line.length;
+}
+
+/**
+ * Print an instruction as a line of assembly code through the output buffer.
+ *
+ * @param inst an instruction
+ */
+void mirPrint(MirInst inst) {
+	char line[MIR_MAX_LINE];
+
+	if (inst->opcode == MIR_TEXT)
+		outputLine(inst->text);
+	else {
+		mirFormat(inst,line,sizeof(line));
+		outputLine(line);
+	}
+}
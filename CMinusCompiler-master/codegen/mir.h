@@ -0,0 +1,184 @@
+/**
+ * mir.h
+ *
+ * The machine IR of the x86-64 code generator. The emit routines of
+ * codegen.c build a list of typed instructions instead of lines of text: an
+ * opcode, an operand size, a condition, and up to two operands in the order
+ * of AT&T syntax, each a register, an immediate, a memory reference of a base,
+ * a scaled index and a displacement, a label or a symbol. The text is only
+ * made when the instructions are printed, so passes between the emit
+ * routines and the printer can inspect and change the code.
+ *
+ * Labels, directives and code cached as text are instructions of their own,
+ * and a pass that works on basic blocks calls mirNumberBlocks to divide the
+ * instructions of a function into them.
+ *
+ */
+
+#ifndef MIR_H_
+#define MIR_H_
+
+#include <stddef.h>
+#include <util/general.h>
+#include <util/dlink.h>
+
+/**
+ * The x86-64 integer registers, numbered as in the instruction encoding.
+ */
+#define MIR_RAX 0
+#define MIR_RCX 1
+#define MIR_RDX 2
+#define MIR_RBX 3
+#define MIR_RSP 4
+#define MIR_RBP 5
+#define MIR_RSI 6
+#define MIR_RDI 7
+#define MIR_R8 8
+#define MIR_R9 9
+#define MIR_R10 10
+#define MIR_R11 11
+#define MIR_R12 12
+#define MIR_R13 13
+#define MIR_R14 14
+#define MIR_R15 15
+#define MIR_NUM_REGISTERS 16
+#define MIR_NO_REG (-1)		/**< no base or index register */
+
+/**
+ * Registers numbered from MIR_NUM_REGISTERS up are virtual: the emit routines
+ * use a new one for every value, and the register allocator of reg.c replaces
+ * them with physical registers and spill slots.
+ */
+#define MIR_VIRTUAL_REG(n) (MIR_NUM_REGISTERS + (n))
+#define MIR_IS_VIRTUAL(reg) ((reg) >= MIR_NUM_REGISTERS)
+
+/**
+ * How an instruction accesses a register operand.
+ */
+#define MIR_READ 1
+#define MIR_WRITE 2
+
+/**
+ * The opcodes: OP(name, mnemonic, sized), where a sized mnemonic takes the
+ * suffix of the operand size. JCC, CMOVCC and SETCC take the suffix of their
+ * condition.
+ */
+#define MIR_OPCODES(OP) \
+	OP(LABEL, "", false) \
+	OP(GLOBL, ".globl", false) \
+	OP(TYPE, ".type", false) \
+	OP(TEXT, "", false) \
+	OP(NOP, "nop", false) \
+	OP(MOV, "mov", true) \
+	OP(MOVSLQ, "movslq", false) \
+	OP(MOVZBL, "movzbl", false) \
+	OP(LEA, "lea", true) \
+	OP(ADD, "add", true) \
+	OP(SUB, "sub", true) \
+	OP(IMUL, "imul", true) \
+	OP(IDIV, "idiv", true) \
+	OP(NEG, "neg", true) \
+	OP(SHL, "shl", true) \
+	OP(SAR, "sar", true) \
+	OP(SHR, "shr", true) \
+	OP(AND, "and", true) \
+	OP(OR, "or", true) \
+	OP(XOR, "xor", true) \
+	OP(CMP, "cmp", true) \
+	OP(TEST, "test", true) \
+	OP(CDQ, "cdq", false) \
+	OP(CMOVCC, "cmov", false) \
+	OP(SETCC, "set", false) \
+	OP(JMP, "jmp", false) \
+	OP(JCC, "j", false) \
+	OP(CALL, "call", false) \
+	OP(PUSH, "push", true) \
+	OP(POP, "pop", true) \
+	OP(LEAVE, "leave", false) \
+	OP(RET, "ret", false)
+
+#define MIR_OPCODE_ENUM(name, mnemonic, sized) MIR_##name,
+typedef enum {
+	MIR_OPCODES(MIR_OPCODE_ENUM)
+	MIR_NUM_OPCODES
+} MirOpcode;
+#undef MIR_OPCODE_ENUM
+
+/**
+ * The conditions of JCC, CMOVCC and SETCC, numbered as the x86 condition
+ * codes, in which a condition and its inverse differ in the lowest bit.
+ */
+typedef enum {
+	MIR_COND_NONE = -1,
+	MIR_COND_E = 4,
+	MIR_COND_NE = 5,
+	MIR_COND_L = 12,
+	MIR_COND_GE = 13,
+	MIR_COND_LE = 14,
+	MIR_COND_G = 15
+} MirCondition;
+
+typedef enum {
+	MIR_OPERAND_NONE,
+	MIR_OPERAND_REG,	/**< a physical or virtual register */
+	MIR_OPERAND_IMM,	/**< an immediate: a value, or the address of a symbol plus a value */
+	MIR_OPERAND_MEM,	/**< memory at a symbol plus disp(base,index,scale) */
+	MIR_OPERAND_LABEL,	/**< a local label .L<value> */
+	MIR_OPERAND_SYMBOL	/**< a named symbol, as the target of a call or jump */
+} MirOperandKind;
+
+/**
+ * An operand. Only the fields of its kind are used.
+ */
+typedef struct MirOperand_struct {
+	MirOperandKind kind;
+	int size;		/**< of a register: 1, 4 or 8 bytes */
+	int reg;		/**< a register, or the base register of a memory reference */
+	int index;		/**< the index register of a memory reference */
+	int scale;		/**< 1, 2, 4 or 8 */
+	long value;		/**< an immediate, a displacement or the number of a label */
+	char *symbol;		/**< a symbol, owned by the operand, or NULL */
+} MirOperand;
+
+/**
+ * An instruction.
+ */
+typedef struct MirInst_struct {
+	MirOpcode opcode;
+	int size;		/**< the operand size of a sized mnemonic in bytes */
+	MirCondition cond;	/**< the condition of JCC, CMOVCC and SETCC */
+	int numOperands;
+	MirOperand op[2];	/**< source before destination */
+	int block;		/**< the number of the basic block, set by mirNumberBlocks */
+	char *text;		/**< the lines of TEXT */
+} MirInstStruct, *MirInst;
+
+extern const char *mirOpcodeNames[];
+
+EXTERN(MirOperand, mirReg, (int reg, int size));
+EXTERN(MirOperand, mirImm, (long value));
+EXTERN(MirOperand, mirSymbolImm, (char *symbol, long value));
+EXTERN(MirOperand, mirMem, (int base, int index, int scale, long disp));
+EXTERN(MirOperand, mirLabel, (int number));
+EXTERN(MirOperand, mirSymbol, (char *symbol));
+
+EXTERN(MirInst, mirInst, (MirOpcode opcode, int size));
+EXTERN(MirInst, mirInst1, (MirOpcode opcode, int size, MirOperand op));
+EXTERN(MirInst, mirInst2, (MirOpcode opcode, int size, MirOperand src, MirOperand dst));
+EXTERN(MirInst, mirJump, (MirCondition cond, MirOperand target));
+EXTERN(MirInst, mirCmov, (MirCondition cond, MirOperand src, MirOperand dst));
+EXTERN(MirInst, mirSet, (MirCondition cond, MirOperand dst));
+EXTERN(MirInst, mirText, (char *text));
+EXTERN(void, mirFree, (MirInst inst));
+EXTERN(void, mirFreeList, (DList instList));
+
+EXTERN(MirCondition, mirInvertCondition, (MirCondition cond));
+EXTERN(MirCondition, mirSwapCondition, (MirCondition cond));
+EXTERN(int, mirRegisterAccess, (MirInst inst, int k));
+EXTERN(bool, mirEndsBlock, (MirInst inst));
+EXTERN(void, mirNumberBlocks, (DList instList));
+
+EXTERN(size_t, mirFormat, (MirInst inst, char *buf, size_t size));
+EXTERN(void, mirPrint, (MirInst inst));
+
+#endif /* MIR_H_ */
@@ -0,0 +1,707 @@
+/**
+ * peephole.c
+ *
+ * The peephole optimizer. The instructions of a function are taken into an
+ * array, and each round computes which registers and flags are live after
+ * every instruction and then tries every pattern of the library at every
+ * instruction. A pattern only removes uses and definitions or moves a use next
+ * to the instruction it was taken from, so the liveness of a round stays true,
+ * if not exact, while the round changes the code. Rounds are repeated until
+ * nothing changes, since one rewrite often makes room for another.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/general.h>
+#include <util/dlink.h>
+#include <util/string_utils.h>
+#include "mir.h"
+#include "peephole.h"
+
+#define PEEP_MAX_ROUNDS 8	/**< more than the code generator's code ever needs */
+
+#define REG_BIT(r) (1u << (r))
+#define PEEP_FLAGS (1u << MIR_NUM_REGISTERS)		/**< the flags, as one more register */
+#define PEEP_ALL ((1u << (MIR_NUM_REGISTERS + 1)) - 1)	/**< every register and the flags */
+
+/** the registers the code generator never allocates: the stack, frame and the fixed registers of calls and division */
+#define PEEP_RESERVED (REG_BIT(MIR_RSP) | REG_BIT(MIR_RBP) | REG_BIT(MIR_RAX) | REG_BIT(MIR_RDX) | \
+		       REG_BIT(MIR_RSI) | REG_BIT(MIR_RDI))
+
+/** the registers a call may change */
+#define PEEP_CALLER_SAVED (REG_BIT(MIR_RAX) | REG_BIT(MIR_RCX) | REG_BIT(MIR_RDX) | REG_BIT(MIR_RSI) | \
+			   REG_BIT(MIR_RDI) | REG_BIT(MIR_R8) | REG_BIT(MIR_R9) | REG_BIT(MIR_R10) | REG_BIT(MIR_R11))
+
+typedef unsigned int RegSet;	/**< a set of registers, with PEEP_FLAGS for the flags */
+
+/**
+ * A function being optimized. A removed instruction is NULL until the end of
+ * the round.
+ */
+typedef struct Peephole_struct {
+	MirInst *code;
+	DNode *nodes;		/**< the list node of each instruction */
+	int length;
+	RegSet *liveIn;		/**< the registers live before each instruction */
+	RegSet *liveOut;	/**< the registers live after each instruction */
+	int *labels;		/**< the index of each local label from minLabel */
+	int minLabel;
+	int numLabels;
+	bool changed;
+} Peephole;
+
+typedef FUNCTION_POINTER(bool, PeepholePattern, (Peephole *p, int i));
+
+/**
+ * Return the registers an operand reads: a register, or the base and index
+ * of a memory reference.
+ */
+static RegSet operandRegs(MirOperand *op) {
+	RegSet regs = 0;
+
+	if (op->kind == MIR_OPERAND_REG || op->kind == MIR_OPERAND_MEM) {
+		if (op->reg != MIR_NO_REG)
+			regs |= REG_BIT(op->reg);
+		if (op->kind == MIR_OPERAND_MEM && op->index != MIR_NO_REG)
+			regs |= REG_BIT(op->index);
+	}
+	return regs;
+}
+
+/**
+ * Return true if an operand is a register and not memory.
+ */
+static bool isReg(MirOperand *op) {
+	return op->kind == MIR_OPERAND_REG && op->reg != MIR_NO_REG;
+}
+
+/**
+ * Find the registers an instruction reads and writes. A call writes the
+ * caller-saved registers, which the register allocator keeps no value in
+ * across a call.
+ *
+ * @param inst an instruction
+ * @param use set to the registers read
+ * @param def set to the registers written
+ */
+static void useDef(MirInst inst, RegSet *use, RegSet *def) {
+	MirOperand *src = &inst->op[0], *dst = &inst->op[1];
+
+	*use = *def = 0;
+	switch (inst->opcode) {
+	case MIR_MOV:
+	case MIR_MOVSLQ:
+	case MIR_MOVZBL:
+	case MIR_LEA:
+		*use = operandRegs(src);
+		if (isReg(dst))
+			*def = REG_BIT(dst->reg);
+		else
+			*use |= operandRegs(dst);
+		break;
+	case MIR_ADD:
+	case MIR_SUB:
+	case MIR_IMUL:
+	case MIR_SHL:
+	case MIR_SAR:
+	case MIR_SHR:
+	case MIR_AND:
+	case MIR_OR:
+	case MIR_XOR:
+		*use = operandRegs(src) | operandRegs(dst);
+		*def = PEEP_FLAGS | (isReg(dst) ? REG_BIT(dst->reg) : 0);
+		break;
+	case MIR_NEG:
+		*use = operandRegs(src);
+		*def = PEEP_FLAGS | (isReg(src) ? REG_BIT(src->reg) : 0);
+		break;
+	case MIR_CMP:
+	case MIR_TEST:
+		*use = operandRegs(src) | operandRegs(dst);
+		*def = PEEP_FLAGS;
+		break;
+	case MIR_CMOVCC:
+		*use = operandRegs(src) | operandRegs(dst) | PEEP_FLAGS;
+		*def = REG_BIT(dst->reg);
+		break;
+	case MIR_SETCC:
+		/* only the low byte is written, so the rest of the register is read */
+		*use = PEEP_FLAGS | REG_BIT(src->reg);
+		*def = REG_BIT(src->reg);
+		break;
+	case MIR_CDQ:
+		*use = REG_BIT(MIR_RAX);
+		*def = REG_BIT(MIR_RDX);
+		break;
+	case MIR_IDIV:
+		*use = operandRegs(src) | REG_BIT(MIR_RAX) | REG_BIT(MIR_RDX);
+		*def = REG_BIT(MIR_RAX) | REG_BIT(MIR_RDX) | PEEP_FLAGS;
+		break;
+	case MIR_JCC:
+		*use = PEEP_FLAGS;
+		break;
+	case MIR_CALL:
+		*use = REG_BIT(MIR_RDI) | REG_BIT(MIR_RSI) | REG_BIT(MIR_RAX) | REG_BIT(MIR_RSP);
+		*def = PEEP_CALLER_SAVED | PEEP_FLAGS;
+		break;
+	case MIR_PUSH:
+		*use = operandRegs(src) | REG_BIT(MIR_RSP);
+		*def = REG_BIT(MIR_RSP);
+		break;
+	case MIR_POP:
+		*use = REG_BIT(MIR_RSP);
+		*def = REG_BIT(src->reg) | REG_BIT(MIR_RSP);
+		break;
+	case MIR_LEAVE:
+		*use = REG_BIT(MIR_RBP);
+		*def = REG_BIT(MIR_RSP) | REG_BIT(MIR_RBP);
+		break;
+	case MIR_RET:
+		/* the return value, the stack and what the caller expects to be kept */
+		*use = (PEEP_ALL & ~PEEP_FLAGS & ~PEEP_CALLER_SAVED) | REG_BIT(MIR_RAX);
+		break;
+	case MIR_TEXT:
+		*use = PEEP_ALL & ~PEEP_FLAGS;
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Return the index of the label a jump goes to, or -1 if it is not in the
+ * function.
+ */
+static int findLabel(Peephole *p, MirOperand *target) {
+	int i;
+
+	if (target->kind == MIR_OPERAND_LABEL) {
+		long n = target->value - p->minLabel;
+		return (n >= 0 && n < p->numLabels) ? p->labels[n] : -1;
+	}
+
+	for (i = 0; i < p->length; i++)
+		if (p->code[i]->opcode == MIR_LABEL && p->code[i]->op[0].kind == MIR_OPERAND_SYMBOL &&
+		    strcmp(p->code[i]->op[0].symbol,target->symbol) == 0)
+			return i;
+	return -1;
+}
+
+/**
+ * Drop the instructions removed in the last round from the arrays.
+ */
+static void compact(Peephole *p) {
+	int i, n = 0;
+
+	for (i = 0; i < p->length; i++)
+		if (p->code[i] != NULL) {
+			p->code[n] = p->code[i];
+			p->nodes[n++] = p->nodes[i];
+		}
+	p->length = n;
+}
+
+/**
+ * Index the local labels of the function.
+ */
+static void findLabels(Peephole *p) {
+	int i, maxLabel = -1;
+
+	p->minLabel = -1;
+	for (i = 0; i < p->length; i++)
+		if (p->code[i]->opcode == MIR_LABEL && p->code[i]->op[0].kind == MIR_OPERAND_LABEL) {
+			int n = (int)p->code[i]->op[0].value;
+			if (p->minLabel < 0 || n < p->minLabel)
+				p->minLabel = n;
+			maxLabel = MAX(maxLabel,n);
+		}
+
+	p->numLabels = maxLabel < 0 ? 0 : maxLabel - p->minLabel + 1;
+	p->labels = (int*)realloc(p->labels,MAX(p->numLabels,1) * sizeof(int));
+	for (i = 0; i < p->numLabels; i++)
+		p->labels[i] = -1;
+	for (i = 0; i < p->length; i++)
+		if (p->code[i]->opcode == MIR_LABEL && p->code[i]->op[0].kind == MIR_OPERAND_LABEL)
+			p->labels[p->code[i]->op[0].value - p->minLabel] = i;
+}
+
+/**
+ * Compute the registers live before and after every instruction, sweeping
+ * backwards until nothing changes. Everything is live where control leaves
+ * the function other than by ret.
+ */
+static void computeLiveness(Peephole *p) {
+	int i, n = p->length;
+	int *targets = (int*)malloc(MAX(n,1) * sizeof(int));
+	RegSet *use = (RegSet*)malloc(MAX(n,1) * sizeof(RegSet));
+	RegSet *def = (RegSet*)malloc(MAX(n,1) * sizeof(RegSet));
+	bool changed = true;
+
+	findLabels(p);
+	for (i = 0; i < n; i++) {
+		MirInst inst = p->code[i];
+		useDef(inst,&use[i],&def[i]);
+		targets[i] = (inst->opcode == MIR_JMP || inst->opcode == MIR_JCC) ? findLabel(p,&inst->op[0]) : -1;
+		p->liveIn[i] = p->liveOut[i] = 0;
+	}
+
+	while (changed) {
+		changed = false;
+		for (i = n - 1; i >= 0; i--) {
+			MirInst inst = p->code[i];
+			RegSet out = 0, in;
+
+			if (inst->opcode != MIR_JMP && inst->opcode != MIR_RET)
+				out |= i + 1 < n ? p->liveIn[i + 1] : PEEP_ALL;
+			if (inst->opcode == MIR_JMP || inst->opcode == MIR_JCC)
+				out |= targets[i] >= 0 ? p->liveIn[targets[i]] : PEEP_ALL;
+			in = use[i] | (out & ~def[i]);
+
+			if (in != p->liveIn[i] || out != p->liveOut[i]) {
+				p->liveIn[i] = in;
+				p->liveOut[i] = out;
+				changed = true;
+			}
+		}
+	}
+
+	free(targets);
+	free(use);
+	free(def);
+}
+
+/**
+ * Return the index of the next instruction not yet removed, or the length of
+ * the function.
+ */
+static int nextInst(Peephole *p, int i) {
+	for (i++; i < p->length && p->code[i] == NULL; i++)
+		;
+	return i;
+}
+
+/**
+ * Remove an instruction.
+ */
+static void removeInst(Peephole *p, int i) {
+	mirFree(p->code[i]);
+	dlinkFreeNode(p->nodes[i]);
+	p->code[i] = NULL;
+	p->changed = true;
+}
+
+/**
+ * Return true if an instruction is a label or directive rather than code.
+ */
+static bool isLabel(MirInst inst) {
+	return inst->opcode == MIR_LABEL || inst->opcode == MIR_GLOBL || inst->opcode == MIR_TYPE;
+}
+
+/**
+ * nop: a nop. Labels no longer need an instruction to name.
+ */
+static bool removeNop(Peephole *p, int i) {
+	if (p->code[i]->opcode != MIR_NOP)
+		return false;
+	removeInst(p,i);
+	return true;
+}
+
+/**
+ * jmp or ret, code: the code up to the next label, which nothing reaches.
+ */
+static bool removeUnreachable(Peephole *p, int i) {
+	int j;
+	bool removed = false;
+
+	if (p->code[i]->opcode != MIR_JMP && p->code[i]->opcode != MIR_RET)
+		return false;
+	for (j = nextInst(p,i); j < p->length && !isLabel(p->code[j]); j = nextInst(p,j)) {
+		removeInst(p,j);
+		removed = true;
+	}
+	return removed;
+}
+
+/**
+ * Return true if only labels come between an instruction and a label.
+ *
+ * @param p a function
+ * @param i the index of the instruction
+ * @param target a label operand
+ */
+static bool fallsThroughTo(Peephole *p, int i, MirOperand *target) {
+	int j;
+
+	for (j = nextInst(p,i); j < p->length && p->code[j]->opcode == MIR_LABEL; j = nextInst(p,j)) {
+		MirOperand *label = &p->code[j]->op[0];
+		if (label->kind == target->kind && (label->kind == MIR_OPERAND_LABEL ?
+		    label->value == target->value : strcmp(label->symbol,target->symbol) == 0))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * jmp L; L: -> L:
+ */
+static bool removeJumpToNext(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+
+	if ((inst->opcode != MIR_JMP && inst->opcode != MIR_JCC) || !fallsThroughTo(p,i,&inst->op[0]))
+		return false;
+	removeInst(p,i);
+	return true;
+}
+
+/**
+ * jcc L1; jmp L2; L1: -> jncc L2; L1:
+ */
+static bool invertBranchOverJump(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	int j = nextInst(p,i);
+	MirOperand target;
+
+	if (inst->opcode != MIR_JCC || j == p->length || p->code[j]->opcode != MIR_JMP ||
+	    !fallsThroughTo(p,j,&inst->op[0]))
+		return false;
+
+	inst->cond = mirInvertCondition(inst->cond);
+	target = inst->op[0];
+	inst->op[0] = p->code[j]->op[0];
+	p->code[j]->op[0] = target;
+	removeInst(p,j);
+	return true;
+}
+
+/**
+ * An instruction whose only effect is a register or the flags no one reads.
+ */
+static bool removeDeadCode(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	RegSet use, def;
+
+	switch (inst->opcode) {
+	case MIR_MOV:
+	case MIR_MOVSLQ:
+	case MIR_MOVZBL:
+	case MIR_LEA:
+	case MIR_ADD:
+	case MIR_SUB:
+	case MIR_IMUL:
+	case MIR_SHL:
+	case MIR_SAR:
+	case MIR_SHR:
+	case MIR_AND:
+	case MIR_OR:
+	case MIR_XOR:
+	case MIR_CMOVCC:
+		if (!isReg(&inst->op[1]))
+			return false;
+		break;
+	case MIR_NEG:
+	case MIR_SETCC:
+		if (!isReg(&inst->op[0]))
+			return false;
+		break;
+	case MIR_CMP:
+	case MIR_TEST:
+		break;
+	default:
+		return false;
+	}
+
+	useDef(inst,&use,&def);
+	if ((def & (REG_BIT(MIR_RSP) | REG_BIT(MIR_RBP))) != 0 || (def & p->liveOut[i]) != 0)
+		return false;
+	removeInst(p,i);
+	return true;
+}
+
+/**
+ * movq R, R -> nothing, and add $0 or sub $0 when the flags are not read.
+ * movl R, R clears the upper half of R, which the code generator never reads
+ * once a value is written as 32 bits, so it goes too.
+ */
+static bool removeRedundantMove(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	MirOperand *src = &inst->op[0], *dst = &inst->op[1];
+
+	if (inst->opcode == MIR_MOV && (inst->size == 8 || inst->size == 4) && isReg(src) && isReg(dst) &&
+	    src->reg == dst->reg && src->reg != MIR_RSP && src->reg != MIR_RBP) {
+		removeInst(p,i);
+		return true;
+	}
+	if ((inst->opcode == MIR_ADD || inst->opcode == MIR_SUB) && src->kind == MIR_OPERAND_IMM &&
+	    src->symbol == NULL && src->value == 0 && (p->liveOut[i] & PEEP_FLAGS) == 0) {
+		removeInst(p,i);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * mov S, R; mov R, D -> mov S, D when R dies and S and D are not both memory.
+ */
+static bool forwardCopy(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	int j = nextInst(p,i);
+	int r;
+
+	if (inst->opcode != MIR_MOV || !isReg(&inst->op[1]) || j == p->length)
+		return false;
+
+	MirInst next = p->code[j];
+	r = inst->op[1].reg;
+	if (next->opcode != MIR_MOV || next->size != inst->size || !isReg(&next->op[0]) ||
+	    next->op[0].reg != r || (operandRegs(&next->op[1]) & REG_BIT(r)) != 0 ||
+	    (p->liveOut[j] & REG_BIT(r)) != 0 || (REG_BIT(r) & PEEP_RESERVED) != 0 ||
+	    (inst->op[0].kind == MIR_OPERAND_MEM && next->op[1].kind == MIR_OPERAND_MEM))
+		return false;
+
+	next->op[0] = inst->op[0];
+	inst->op[0].symbol = NULL;
+	removeInst(p,i);
+	return true;
+}
+
+/**
+ * movl R, T; movslq T, T -> movslq R, T
+ */
+static bool extendCopy(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	int j = nextInst(p,i);
+
+	if (inst->opcode != MIR_MOV || inst->size != 4 || !isReg(&inst->op[0]) || !isReg(&inst->op[1]) ||
+	    j == p->length)
+		return false;
+
+	MirInst next = p->code[j];
+	if (next->opcode != MIR_MOVSLQ || !isReg(&next->op[0]) || next->op[0].reg != inst->op[1].reg ||
+	    !isReg(&next->op[1]) || next->op[1].reg != inst->op[1].reg)
+		return false;
+
+	next->op[0].reg = inst->op[0].reg;
+	removeInst(p,i);
+	return true;
+}
+
+/**
+ * mov R, T; op S, T; mov T, R -> op S, R when T dies, for an operation that
+ * reads and writes its second operand. The instructions between the copy and
+ * the operation may not name R or T.
+ */
+static bool operateInPlace(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	int j, k, m, r, t;
+
+	if (inst->opcode != MIR_MOV || !isReg(&inst->op[0]) || !isReg(&inst->op[1]))
+		return false;
+	r = inst->op[0].reg;
+	t = inst->op[1].reg;
+	if (r == t || ((REG_BIT(r) | REG_BIT(t)) & PEEP_RESERVED) != 0)
+		return false;
+
+	for (j = nextInst(p,i); j < p->length; j = nextInst(p,j)) {
+		MirInst mid = p->code[j];
+		RegSet use, def;
+
+		if (isLabel(mid) || mid->opcode == MIR_TEXT || mirEndsBlock(mid))
+			return false;
+		useDef(mid,&use,&def);
+		if (((use | def) & (REG_BIT(r) | REG_BIT(t))) != 0)
+			break;
+	}
+	if (j == p->length)
+		return false;
+
+	MirInst op = p->code[j];
+	switch (op->opcode) {
+	case MIR_ADD:
+	case MIR_SUB:
+	case MIR_IMUL:
+	case MIR_SHL:
+	case MIR_SAR:
+	case MIR_SHR:
+	case MIR_AND:
+	case MIR_OR:
+	case MIR_XOR:
+		break;
+	default:
+		return false;
+	}
+	if (op->size != inst->size || !isReg(&op->op[1]) || op->op[1].reg != t ||
+	    (operandRegs(&op->op[0]) & REG_BIT(t)) != 0 || (k = nextInst(p,j)) == p->length)
+		return false;
+
+	MirInst back = p->code[k];
+	if (back->opcode != MIR_MOV || back->size != inst->size || !isReg(&back->op[0]) || back->op[0].reg != t ||
+	    !isReg(&back->op[1]) || back->op[1].reg != r || (p->liveOut[k] & REG_BIT(t)) != 0)
+		return false;
+
+	/* R now lives on through the operation */
+	for (m = i; m <= j; m = nextInst(p,m)) {
+		p->liveIn[m] |= REG_BIT(r);
+		p->liveOut[m] |= REG_BIT(r);
+	}
+	op->op[1].reg = r;
+	removeInst(p,i);
+	removeInst(p,k);
+	return true;
+}
+
+/**
+ * movq %rbp, R; addq $k, R; ... (R) ... -> ... k(%rbp) ...
+ * movq $sym, R; addq $k, R; ... (R) ... -> ... sym+k ...
+ *
+ * The address is folded into every later instruction of the block that uses
+ * R as the base of a memory reference, up to where R dies or is written
+ * again. Any other use of R, or R living on past the block, leaves the code
+ * alone.
+ */
+static bool foldAddress(Peephole *p, int i) {
+	MirInst inst = p->code[i];
+	MirOperand *src = &inst->op[0];
+	int j, m, r;
+	long disp = 0;
+	RegSet flagsUse = 0;
+
+	if (inst->opcode != MIR_MOV || inst->size != 8 || !isReg(&inst->op[1]) ||
+	    (REG_BIT(inst->op[1].reg) & PEEP_RESERVED) != 0)
+		return false;
+	if (!(isReg(src) && src->reg == MIR_RBP) && !(src->kind == MIR_OPERAND_IMM && src->symbol != NULL))
+		return false;
+	r = inst->op[1].reg;
+
+	/* an optional addq $k, R */
+	j = nextInst(p,i);
+	if (j < p->length && p->code[j]->opcode == MIR_ADD && p->code[j]->size == 8 &&
+	    isReg(&p->code[j]->op[1]) && p->code[j]->op[1].reg == r &&
+	    p->code[j]->op[0].kind == MIR_OPERAND_IMM && p->code[j]->op[0].symbol == NULL) {
+		disp = p->code[j]->op[0].value;
+		flagsUse = p->liveOut[j] & PEEP_FLAGS;
+	} else
+		j = i;
+	if (flagsUse != 0 || (p->liveOut[j] & REG_BIT(r)) == 0)
+		return false;
+
+	/* check the uses of R up to where it dies */
+	for (m = nextInst(p,j); m < p->length; m = nextInst(p,m)) {
+		MirInst use = p->code[m];
+		RegSet uses, defs;
+		int k;
+
+		if (isLabel(use) || use->opcode == MIR_TEXT)
+			return false;
+		useDef(use,&uses,&defs);
+		if ((defs & REG_BIT(MIR_RBP)) != 0)
+			return false;
+		if ((uses & REG_BIT(r)) != 0)
+			for (k = 0; k < use->numOperands; k++)
+				if ((operandRegs(&use->op[k]) & REG_BIT(r)) != 0 &&
+				    (use->op[k].kind != MIR_OPERAND_MEM || use->op[k].reg != r || use->op[k].index != MIR_NO_REG) &&
+				    (use->op[k].kind != MIR_OPERAND_REG || mirRegisterAccess(use,k) != MIR_WRITE))
+					return false;
+		if ((p->liveOut[m] & REG_BIT(r)) == 0 || (defs & REG_BIT(r)) != 0)
+			break;
+		if (mirEndsBlock(use))
+			return false;
+	}
+	if (m == p->length)
+		return false;
+
+	/* rewrite them */
+	for (m = nextInst(p,j); ; m = nextInst(p,m)) {
+		MirInst use = p->code[m];
+		RegSet uses, defs;
+		int k;
+
+		for (k = 0; k < use->numOperands; k++)
+			if (use->op[k].kind == MIR_OPERAND_MEM && use->op[k].reg == r) {
+				use->op[k].value += disp + (src->kind == MIR_OPERAND_IMM ? src->value : 0);
+				if (src->kind == MIR_OPERAND_IMM) {
+					use->op[k].reg = MIR_NO_REG;
+					use->op[k].symbol = ssave(src->symbol);
+				} else
+					use->op[k].reg = MIR_RBP;
+			}
+		useDef(use,&uses,&defs);
+		if ((p->liveOut[m] & REG_BIT(r)) == 0 || (defs & REG_BIT(r)) != 0)
+			break;
+	}
+
+	if (j != i)
+		removeInst(p,j);
+	removeInst(p,i);
+	return true;
+}
+
+/**
+ * The pattern library, tried in order at every instruction.
+ */
+static PeepholePattern patterns[] = {
+	removeNop,
+	removeUnreachable,
+	foldAddress,
+	forwardCopy,
+	operateInPlace,
+	extendCopy,
+	removeRedundantMove,
+	removeDeadCode,
+	invertBranchOverJump,
+	removeJumpToNext,
+};
+
+#define NUM_PATTERNS (sizeof(patterns) / sizeof(patterns[0]))
+
+/**
+ * Optimize the instructions of a function in place. A function that holds
+ * code as text, such as code from the code cache, is left as it is.
+ *
+ * @param instList the instructions of a function
+ */
+void peepholeOptimize(DList instList) {
+	Peephole p;
+	DNode node;
+	int i, n = 0, round;
+	size_t k;
+
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node)) {
+		if (((MirInst)dlinkNodeAtom(node))->opcode == MIR_TEXT)
+			return;
+		n++;
+	}
+
+	memset(&p,0,sizeof(p));
+	p.code = (MirInst*)malloc(MAX(n,1) * sizeof(MirInst));
+	p.nodes = (DNode*)malloc(MAX(n,1) * sizeof(DNode));
+	p.liveIn = (RegSet*)malloc(MAX(n,1) * sizeof(RegSet));
+	p.liveOut = (RegSet*)malloc(MAX(n,1) * sizeof(RegSet));
+	while ((node = dlinkPop(instList)) != NULL) {
+		p.nodes[p.length] = node;
+		p.code[p.length++] = (MirInst)dlinkNodeAtom(node);
+	}
+
+	for (round = 0; round < PEEP_MAX_ROUNDS; round++) {
+		compact(&p);
+		computeLiveness(&p);
+		p.changed = false;
+		for (i = 0; i < p.length; i++)
+			for (k = 0; k < NUM_PATTERNS && p.code[i] != NULL; k++)
+				patterns[k](&p,i);
+		if (!p.changed)
+			break;
+	}
+
+	for (i = 0; i < p.length; i++)
+		if (p.code[i] != NULL)
+			dlinkAppend(instList,p.nodes[i]);
+
+	free(p.code);
+	free(p.nodes);
+	free(p.liveIn);
+	free(p.liveOut);
+	free(p.labels);
+}
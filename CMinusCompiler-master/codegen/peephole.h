@@ -0,0 +1,22 @@
+/**
+ * peephole.h
+ *
+ * A peephole optimizer over the machine IR of a function. A library of
+ * patterns rewrites short sequences of instructions: an address computed into
+ * a register and used only to reach memory is folded into the addressing mode
+ * of the instructions that use it, copies through a register that dies are
+ * made directly, and moves, jumps and code that do nothing are removed. The
+ * patterns ask a liveness analysis of the registers and flags over the whole
+ * function whether a register or the flags are still needed.
+ *
+ */
+
+#ifndef PEEPHOLE_H_
+#define PEEPHOLE_H_
+
+#include <util/general.h>
+#include <util/dlink.h>
+
+EXTERN(void, peepholeOptimize, (DList instList));
+
+#endif /* PEEPHOLE_H_ */
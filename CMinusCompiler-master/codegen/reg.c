@@ -1,180 +1,594 @@
 /**
  * reg.c
  *
- * A set of routines to handle the allocation of registers in the Cminus Compiler
+ * Register allocation for the Cminus Compiler. The emit routines of codegen.c
+ * take a new virtual register for every value they compute, and once the code
+ * of a function is generated a linear scan allocator replaces the virtual
+ * registers with physical ones.
+ *
+ * The live interval of a virtual register runs from the first to the last
+ * instruction at which it is live, found by a liveness analysis over the
+ * basic blocks of the function. The intervals are visited in the order they
+ * start, and each takes a register that no interval still live holds, the
+ * caller-saved %rcx and %r8-%r11 first. An interval that is live across a
+ * call may only take one of the callee-saved %rbx and %r12-%r15, since printf,
+ * scanf and the functions of the program change the others. When no register
+ * is left, the interval that ends last is spilled to a slot in the frame below
+ * the local variables: it is loaded into a scratch register before every
+ * instruction that reads it and stored after every instruction that writes
+ * it. Scratch registers are only set aside in a function whose first
+ * allocation spills, which is then allocated again without them.
  *
  */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include <util/general.h>
 #include <util/string_utils.h>
 #include <util/symtab.h>
+#include <util/dlink.h>
 #include <codegen/symfields.h>
 #include <string.h>
 #include "reg.h"
+#include "mir.h"
 #include "types.h"
 
+#define NUM_CALLER_SAVED 5	/**< the caller-saved registers come first in allocatableRegisters */
+#define MAX_REFS 4		/**< the most registers the two operands of an instruction name */
+
 /**
- * The assembly language names of the Mips registers
+ * The registers that may be allocated, in the order they are preferred: the
+ * caller-saved ones, which the function need not save, then the callee-saved
+ * ones, which keep their values across calls. Scratch registers are taken
+ * from the end of the caller-saved ones.
  */
-static char* integerRegisterNames[] = {"%ebx","%ecx", 
-				       "%r8d", "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d",
-				       "bogus"};
-static char* integer64bitRegisterNames[] = {"%rbx","%rcx",
-					    "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15",
-				       "bogus"};
-static bool *allocatedIntegerRegisters; /**< vector of bools indicated whether register is allocated or not */
+static const int allocatableRegisters[NUM_INTEGER_REGISTERS] = {
+	MIR_RCX, MIR_R8, MIR_R9, MIR_R10, MIR_R11,
+	MIR_RBX, MIR_R12, MIR_R13, MIR_R14, MIR_R15
+};
+
+static __thread int numVirtualRegisters;	/**< the virtual registers of the function being generated, one count per thread */
 
 /**
- * Initialize the allocated registers vector
+ * The live interval of a virtual register.
  */
-void initRegisters() {
+typedef struct Interval_struct {
+	int start;		/**< the first instruction at which the register is live, or INT_MAX */
+	int end;		/**< the last instruction at which it is live */
+	bool acrossCall;	/**< a call comes between start and end */
+	int reg;		/**< the physical register, or MIR_NO_REG if spilled */
+	int slot;		/**< the spill slot, or -1 */
+} Interval;
 
-	int i;
+/**
+ * A virtual register named by an instruction.
+ */
+typedef struct Ref_struct {
+	int reg;		/**< the number of the virtual register from 0 */
+	int access;		/**< MIR_READ, MIR_WRITE or both */
+	int size;		/**< the largest size it is named with, 8 as an address */
+	int phys;		/**< the register it is replaced with */
+} Ref;
 
-	allocatedIntegerRegisters = (bool*)malloc(NUM_INTEGER_REGISTERS*sizeof(bool));
-	for (i = 0; i < NUM_INTEGER_REGISTERS; i++)
-		allocatedIntegerRegisters[i] = false;
+/**
+ * A function being allocated.
+ */
+typedef struct Allocator_struct {
+	MirInst *code;
+	DNode *nodes;		/**< the list node of each instruction */
+	int length;
+	int numVirtual;
+	Interval *intervals;	/**< the interval of each virtual register */
+	int *order;		/**< the live virtual registers by the start of their intervals */
+	int numLive;
+	int maxRefs;		/**< the most virtual registers an instruction names */
+	int *slotEnd;		/**< the end of the last interval in each spill slot */
+	int numSlots;
+} Allocator;
+
+typedef unsigned long Word;	/**< a word of a set of virtual registers */
+
+#define WORD_BITS ((int)(8 * sizeof(Word)))
+#define SET_HAS(set, v) (((set)[(v) / WORD_BITS] >> ((v) % WORD_BITS)) & 1)
+#define SET_ADD(set, v) ((set)[(v) / WORD_BITS] |= (Word)1 << ((v) % WORD_BITS))
+
+/**
+ * Start the virtual registers of a new function.
+ */
+void initRegisters() {
+	numVirtualRegisters = 0;
 }
 
-bool isAllocatedIntegerRegister(int reg) {
-	return allocatedIntegerRegisters[reg];
+/**
+ * Allocate a new virtual register.
+ *
+ * @return the number of the virtual register, from 0 in each function
+ */
+int allocateIntegerRegister() {
+	return numVirtualRegisters++;
 }
 
+/**
+ * Return the number of virtual registers allocated in the current function.
+ */
+int getNumVirtualRegisters() {
+	return numVirtualRegisters;
+}
 
 /**
- * Return the next free register, return -1 if none available (shouldn't happen in the simple examples)
+ * Return the machine IR number of a virtual register.
  *
- * @param registers the vector indicating which registers are allocated.
+ * @param reg the number of a virtual register from 0
  * @return see above
  */
-static int getFreeRegister(bool *allocRegisters, int numRegisters) {
+int getIntegerRegisterNumber(int reg) {
+	return MIR_VIRTUAL_REG(reg);
+}
+
+/**
+ * Get the symbol table index of a new virtual register, named %v<n>.
+ *
+ * @param symtab a symbol table
+ * @return the symbol table index of the register
+ */
+int getFreeIntegerRegisterIndex(SymTable symtab) {
+	int reg = allocateIntegerRegister();
+	char symReg[16];
+	int regIndex;
+
+	snprintf(symReg,sizeof(symReg),"%%v%d",reg);
+	regIndex = SymIndex(symtab,symReg);
+	SymPutFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD,(Generic)(long)reg);
+	SymPutFieldByIndex(symtab,regIndex,SYMTAB_TYPE_INDEX_FIELD,
+			(Generic)(long)SymQueryIndex(symtab,SYMTAB_INTEGER_TYPE_STRING));
+
+	return regIndex;
+}
+
+/**
+ * Add a register to the virtual registers of an instruction, unless it is
+ * physical or already there.
+ *
+ * @return the new number of registers
+ */
+static int addRef(Ref *refs, int n, int reg, int access, int size) {
 	int i;
-	
-	for (i = 0; i < numRegisters; i++) 
-		if (!allocRegisters[i])
-			return i;
- 	
-	return -1;
+
+	if (reg == MIR_NO_REG || !MIR_IS_VIRTUAL(reg))
+		return n;
+	reg -= MIR_NUM_REGISTERS;
+	for (i = 0; i < n; i++)
+		if (refs[i].reg == reg) {
+			refs[i].access |= access;
+			refs[i].size = MAX(refs[i].size,size);
+			return n;
+		}
+	refs[n].reg = reg;
+	refs[n].access = access;
+	refs[n].size = size;
+	return n + 1;
 }
 
 /**
- * Allocate a free  register. Set the allocated vector entry to true. Fail if none available
+ * Find the virtual registers an instruction names and how it accesses them.
  *
- * @return the register that has been allocated
- */
-static int allocateRegister(bool *allocatedRegisters,int numRegisters) {
-	
-	int reg = getFreeRegister(allocatedRegisters,numRegisters);
-	
-	if (reg != -1)
-		allocatedRegisters[reg] = true;
-	else {
-		fprintf(stderr,"Register allocation error\n");
-	//	exit(-1);
-		reg = numRegisters;
+ * @param inst an instruction
+ * @param refs set to the registers
+ * @return the number of registers
+ */
+static int findRefs(MirInst inst, Ref refs[MAX_REFS]) {
+	int k, n = 0;
+
+	for (k = 0; k < inst->numOperands; k++) {
+		MirOperand *op = &inst->op[k];
+
+		if (op->kind == MIR_OPERAND_REG)
+			n = addRef(refs,n,op->reg,mirRegisterAccess(inst,k),op->size);
+		else if (op->kind == MIR_OPERAND_MEM) {
+			n = addRef(refs,n,op->reg,MIR_READ,8);
+			n = addRef(refs,n,op->index,MIR_READ,8);
+		}
 	}
-	
-	return reg;
+	return n;
 }
 
 /**
- * Allocate a free integer register.
+ * Return the index of the instruction defining the label a jump goes to, or
+ * -1 if it is not in the function.
  *
- * @return the register that has been allocated
+ * @param a a function
+ * @param labels the index of each local label from minLabel
+ * @param minLabel the number of the first local label
+ * @param numLabels the number of local labels
+ * @param target the target of the jump
  */
-int allocateIntegerRegister() {
-	return allocateRegister(allocatedIntegerRegisters,NUM_INTEGER_REGISTERS);
+static int findLabel(Allocator *a, int *labels, int minLabel, int numLabels, MirOperand *target) {
+	int i;
+
+	if (target->kind == MIR_OPERAND_LABEL) {
+		long n = target->value - minLabel;
+		return (n >= 0 && n < numLabels) ? labels[n] : -1;
+	}
+
+	for (i = 0; i < a->length; i++)
+		if (a->code[i]->opcode == MIR_LABEL && a->code[i]->op[0].kind == MIR_OPERAND_SYMBOL &&
+		    strcmp(a->code[i]->op[0].symbol,target->symbol) == 0)
+			return i;
+	return -1;
 }
 
 /**
- * Reserve a specific integer Register
+ * Find the successors of every basic block.
  *
- * @param reg register id to reserve
+ * @param a a function
+ * @param first the first instruction of each block
+ * @param last the last instruction of each block
+ * @param succ set to the two successors of each block, -1 for none
+ * @param numBlocks the number of blocks
  */
-void reserveIntegerRegister(int reg) {
-        allocatedIntegerRegisters[reg] = true;
+static void findSuccessors(Allocator *a, int *first, int *last, int (*succ)[2], int numBlocks) {
+	int i, b, minLabel = -1, maxLabel = -1, numLabels;
+	int *labels;
+
+	for (i = 0; i < a->length; i++)
+		if (a->code[i]->opcode == MIR_LABEL && a->code[i]->op[0].kind == MIR_OPERAND_LABEL) {
+			int n = (int)a->code[i]->op[0].value;
+			if (minLabel < 0 || n < minLabel)
+				minLabel = n;
+			maxLabel = MAX(maxLabel,n);
+		}
+	numLabels = maxLabel < 0 ? 0 : maxLabel - minLabel + 1;
+	labels = (int*)malloc(MAX(numLabels,1) * sizeof(int));
+	for (i = 0; i < numLabels; i++)
+		labels[i] = -1;
+	for (i = 0; i < a->length; i++)
+		if (a->code[i]->opcode == MIR_LABEL && a->code[i]->op[0].kind == MIR_OPERAND_LABEL)
+			labels[a->code[i]->op[0].value - minLabel] = i;
+
+	for (b = 0; b < numBlocks; b++) {
+		MirInst inst = a->code[last[b]];
+		int target;
+
+		succ[b][0] = succ[b][1] = -1;
+		if (inst->opcode != MIR_JMP && inst->opcode != MIR_RET && b + 1 < numBlocks)
+			succ[b][0] = b + 1;
+		if (inst->opcode == MIR_JMP || inst->opcode == MIR_JCC) {
+			target = findLabel(a,labels,minLabel,numLabels,&inst->op[0]);
+			if (target >= 0)
+				succ[b][1] = a->code[target]->block;
+		}
+	}
+	free(labels);
 }
- 
+
 /**
- * Free the space for the allocated vector.
+ * Extend the interval of a virtual register to an instruction.
  */
-void cleanupRegisters() {
-	free(allocatedIntegerRegisters);
+static void extendInterval(Allocator *a, int reg, int i) {
+	Interval *it = &a->intervals[reg];
+
+	it->start = MIN(it->start,i);
+	it->end = MAX(it->end,i);
 }
 
 /**
- * Free a register by setting is entry in the allocated vector to false.
- *
- * @param reg the register to free
+ * Extend the intervals of the virtual registers of a set to an instruction.
  */
-static void freeRegister(bool *allocatedRegisters, int reg, int size) {
-	if (reg >= 0 && reg < size)
-		allocatedRegisters[reg] = false;
-	else
-		fprintf(stderr,"Error trying to free invalid register #%d\n",reg);
+static void extendIntervals(Allocator *a, Word *set, int words, int i) {
+	int w, bit;
+
+	for (w = 0; w < words; w++)
+		if (set[w] != 0)
+			for (bit = 0; bit < WORD_BITS; bit++)
+				if ((set[w] >> bit) & 1)
+					extendInterval(a,w * WORD_BITS + bit,i);
 }
 
 /**
- * Free an integer register by setting is entry in the allocated vector to false.
- *
- * @param reg the register to free
+ * Compute the live interval of every virtual register: the virtual registers
+ * live into and out of each basic block, sweeping backwards until nothing
+ * changes, and then the first and last instruction at which each is live.
+ * A virtual register is never live where control leaves the function.
  */
-void freeIntegerRegister(int reg) {
-	freeRegister(allocatedIntegerRegisters,reg,NUM_INTEGER_REGISTERS);
+static void computeIntervals(Allocator *a) {
+	int numBlocks = a->code[a->length - 1]->block + 1;
+	int words = (a->numVirtual + WORD_BITS - 1) / WORD_BITS;
+	int *first = (int*)malloc(numBlocks * sizeof(int));
+	int *last = (int*)malloc(numBlocks * sizeof(int));
+	int (*succ)[2] = malloc(numBlocks * sizeof(*succ));
+	int *callsBefore = (int*)malloc((a->length + 1) * sizeof(int));
+	Word *use = (Word*)calloc((size_t)numBlocks * words,sizeof(Word));
+	Word *def = (Word*)calloc((size_t)numBlocks * words,sizeof(Word));
+	Word *in = (Word*)calloc((size_t)numBlocks * words,sizeof(Word));
+	Word *out = (Word*)calloc((size_t)numBlocks * words,sizeof(Word));
+	bool changed = true;
+	int i, j, b, w, n;
+
+	for (i = 0; i < a->length; i++) {
+		b = a->code[i]->block;
+		if (i == 0 || a->code[i - 1]->block != b)
+			first[b] = i;
+		last[b] = i;
+	}
+	findSuccessors(a,first,last,succ,numBlocks);
+
+	a->maxRefs = 0;
+	callsBefore[0] = 0;
+	for (i = 0; i < a->length; i++) {
+		Ref refs[MAX_REFS];
+		Word *bdef = def + (size_t)a->code[i]->block * words;
+		Word *buse = use + (size_t)a->code[i]->block * words;
+
+		n = findRefs(a->code[i],refs);
+		for (j = 0; j < n; j++) {
+			if ((refs[j].access & MIR_READ) && !SET_HAS(bdef,refs[j].reg))
+				SET_ADD(buse,refs[j].reg);
+			extendInterval(a,refs[j].reg,i);
+		}
+		for (j = 0; j < n; j++)
+			if (refs[j].access & MIR_WRITE)
+				SET_ADD(bdef,refs[j].reg);
+		a->maxRefs = MAX(a->maxRefs,n);
+		callsBefore[i + 1] = callsBefore[i] + (a->code[i]->opcode == MIR_CALL);
+	}
+
+	while (changed) {
+		changed = false;
+		for (b = numBlocks - 1; b >= 0; b--) {
+			Word *bin = in + (size_t)b * words, *bout = out + (size_t)b * words;
+			Word *buse = use + (size_t)b * words, *bdef = def + (size_t)b * words;
+
+			for (w = 0; w < words; w++) {
+				Word o = 0, x;
+				for (j = 0; j < 2; j++)
+					if (succ[b][j] >= 0)
+						o |= in[(size_t)succ[b][j] * words + w];
+				x = buse[w] | (o & ~bdef[w]);
+				if (o != bout[w] || x != bin[w]) {
+					bout[w] = o;
+					bin[w] = x;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	for (b = 0; b < numBlocks; b++) {
+		extendIntervals(a,in + (size_t)b * words,words,first[b]);
+		extendIntervals(a,out + (size_t)b * words,words,last[b]);
+	}
+	for (i = 0; i < a->numVirtual; i++) {
+		Interval *it = &a->intervals[i];
+		it->acrossCall = it->start < it->end && callsBefore[it->end] - callsBefore[it->start + 1] > 0;
+	}
+
+	free(first);
+	free(last);
+	free(succ);
+	free(callsBefore);
+	free(use);
+	free(def);
+	free(in);
+	free(out);
 }
 
 /**
- * Return the Mips assembler name for a register.
- *
- * @param reg a mips register number
- * @return see above
+ * Order the live virtual registers by the start of their intervals.
+ */
+static void sortIntervals(Allocator *a) {
+	int *count = (int*)calloc(a->length + 1,sizeof(int));
+	int i;
+
+	for (i = 0; i < a->numVirtual; i++)
+		if (a->intervals[i].start <= a->intervals[i].end)
+			count[a->intervals[i].start + 1]++;
+	for (i = 0; i < a->length; i++)
+		count[i + 1] += count[i];
+	a->numLive = count[a->length];
+	for (i = 0; i < a->numVirtual; i++)
+		if (a->intervals[i].start <= a->intervals[i].end)
+			a->order[count[a->intervals[i].start]++] = i;
+	free(count);
+}
+
+/**
+ * Spill an interval to a slot that no interval overlapping it uses.
  */
-char* getIntegerRegisterName(int reg) {
-	return integerRegisterNames[reg];
+static void spillInterval(Allocator *a, Interval *it) {
+	int s;
+
+	for (s = 0; s < a->numSlots && a->slotEnd[s] >= it->start; s++)
+		;
+	if (s == a->numSlots)
+		a->numSlots++;
+	a->slotEnd[s] = it->end;
+	it->reg = MIR_NO_REG;
+	it->slot = s;
 }
 
 /**
- * Return the Mips assembler name for a register.
+ * Return true if a register keeps its value across a call.
+ */
+static bool isCalleeSaved(int reg) {
+	return reg == MIR_RBX || (reg >= MIR_R12 && reg <= MIR_R15);
+}
+
+/**
+ * Assign every live interval a register or a spill slot.
  *
- * @param reg a mips register number
- * @return see above
+ * @param a a function
+ * @param numScratch the number of caller-saved registers set aside as scratch registers
+ * @return true if an interval was spilled
  */
-char* get64bitIntegerRegisterName(SymTable symtab, int reg) {
-  int regIndex = (int)SymGetFieldByIndex(symtab,reg,SYMTAB_REGISTER_INDEX_FIELD);
-  return integer64bitRegisterNames[regIndex];
+static bool linearScan(Allocator *a, int numScratch) {
+	int regs[NUM_INTEGER_REGISTERS], numRegs = 0, firstCalleeSaved;
+	int active[NUM_INTEGER_REGISTERS], numActive = 0;
+	bool spilled = false;
+	int i, j, k, n;
+
+	for (i = 0; i < NUM_CALLER_SAVED - numScratch; i++)
+		regs[numRegs++] = allocatableRegisters[i];
+	firstCalleeSaved = numRegs;
+	for (i = NUM_CALLER_SAVED; i < NUM_INTEGER_REGISTERS; i++)
+		regs[numRegs++] = allocatableRegisters[i];
+
+	a->numSlots = 0;
+	for (k = 0; k < a->numLive; k++) {
+		Interval *cur = &a->intervals[a->order[k]];
+		Interval *victim = NULL;
+		int victimIndex = -1;
+
+		for (i = 0, n = 0; i < numActive; i++)
+			if (a->intervals[active[i]].end > cur->start)
+				active[n++] = active[i];
+		numActive = n;
+
+		cur->reg = MIR_NO_REG;
+		cur->slot = -1;
+		for (j = cur->acrossCall ? firstCalleeSaved : 0; j < numRegs && cur->reg == MIR_NO_REG; j++) {
+			for (i = 0; i < numActive && a->intervals[active[i]].reg != regs[j]; i++)
+				;
+			if (i == numActive)
+				cur->reg = regs[j];
+		}
+		if (cur->reg != MIR_NO_REG) {
+			active[numActive++] = a->order[k];
+			continue;
+		}
+
+		for (i = 0; i < numActive; i++) {
+			Interval *it = &a->intervals[active[i]];
+			if ((!cur->acrossCall || isCalleeSaved(it->reg)) && (victim == NULL || it->end > victim->end)) {
+				victim = it;
+				victimIndex = i;
+			}
+		}
+		spilled = true;
+		if (victim != NULL && victim->end > cur->end) {
+			cur->reg = victim->reg;
+			spillInterval(a,victim);
+			active[victimIndex] = a->order[k];
+		} else
+			spillInterval(a,cur);
+	}
+	return spilled;
+}
+
+/**
+ * Return the displacement from %rbp of a spill slot.
+ */
+static long slotDisp(int frameSize, int slot) {
+	return -(long)(frameSize + SPILL_SLOT_SIZE * (slot + 1));
 }
 
 /**
- * Return the Mips assembler name for a register.
+ * Replace a virtual register with the physical register of its reference.
+ */
+static void replaceRegister(int *reg, Ref *refs, int n) {
+	int i;
+
+	if (*reg == MIR_NO_REG || !MIR_IS_VIRTUAL(*reg))
+		return;
+	for (i = 0; i < n && refs[i].reg != *reg - MIR_NUM_REGISTERS; i++)
+		;
+	*reg = refs[i].phys;
+}
+
+/**
+ * Replace the virtual registers of every instruction with their registers,
+ * loading a spilled register into a scratch register before an instruction
+ * that reads it and storing it after an instruction that writes it.
  *
- * @param reg a mips register number
- * @return see above
+ * @param a a function
+ * @param numScratch the number of scratch registers set aside
+ * @param frameSize the size of the frame above the spill slots
  */
-char* get64bitIntegerRegisterNamebyIndex(int reg) {
-  return integer64bitRegisterNames[reg];
+static void rewrite(Allocator *a, int numScratch, int frameSize) {
+	int i, j, k, n;
+
+	for (i = 0; i < a->length; i++) {
+		MirInst inst = a->code[i];
+		Ref refs[MAX_REFS];
+		int scratch = NUM_CALLER_SAVED - numScratch;
+
+		n = findRefs(inst,refs);
+		for (j = 0; j < n; j++) {
+			Interval *it = &a->intervals[refs[j].reg];
+			MirOperand slot;
+
+			if (it->reg != MIR_NO_REG) {
+				refs[j].phys = it->reg;
+				continue;
+			}
+			refs[j].phys = allocatableRegisters[scratch++];
+			slot = mirMem(MIR_RBP,MIR_NO_REG,1,slotDisp(frameSize,it->slot));
+			/* a register named only as 32 bits is loaded as 32 bits, so that the load can forward into a copy */
+			if ((refs[j].access & MIR_READ) && refs[j].size == 4)
+				dlinkInsertBefore(dlinkNodeAlloc((Generic)mirInst2(MIR_MOV,4,slot,mirReg(refs[j].phys,4))),a->nodes[i]);
+			else if (refs[j].access & MIR_READ)
+				dlinkInsertBefore(dlinkNodeAlloc((Generic)mirInst2(MIR_MOV,8,slot,mirReg(refs[j].phys,8))),a->nodes[i]);
+			if (refs[j].access & MIR_WRITE)
+				dlinkInsertAfter(a->nodes[i],dlinkNodeAlloc((Generic)mirInst2(MIR_MOV,8,mirReg(refs[j].phys,8),slot)));
+		}
+
+		for (k = 0; k < inst->numOperands; k++) {
+			MirOperand *op = &inst->op[k];
+			if (op->kind == MIR_OPERAND_REG || op->kind == MIR_OPERAND_MEM)
+				replaceRegister(&op->reg,refs,n);
+			if (op->kind == MIR_OPERAND_MEM)
+				replaceRegister(&op->index,refs,n);
+		}
+	}
 }
 
 /**
- * Get the symbol table index of a free integer register
+ * Allocate registers for the virtual registers of a function by linear scan.
  *
- * @param symtab a symbol table
- * @return the symbol table index of a free integer register
+ * @param instList the instructions of the function, without its prologue
+ * @param frameSize the size of the local variables
+ * @return the size of the frame, with the spill slots below the local
+ * 	   variables, rounded so that spilling keeps the alignment of the stack
  */
-int getFreeIntegerRegisterIndex(SymTable symtab) {
-	int reg = allocateIntegerRegister();
-	char* symReg = getIntegerRegisterName(reg);
-	int regIndex;
+int allocateRegisters(DList instList, int frameSize) {
+	Allocator a;
+	DNode node;
+	int i, numScratch = 0;
 
-	if ((regIndex = SymQueryIndex(symtab,symReg)) == SYM_INVALID_INDEX) {
-		regIndex = SymIndex(symtab,symReg);
-		SymPutFieldByIndex(symtab,regIndex,SYMTAB_REGISTER_INDEX_FIELD,(Generic)reg);
-		SymPutFieldByIndex(symtab,regIndex,SYMTAB_TYPE_INDEX_FIELD,
-				(Generic)SymQueryIndex(symtab,SYMTAB_INTEGER_TYPE_STRING));
+	a.numVirtual = numVirtualRegisters;
+	a.length = 0;
+	for (node = dlinkHead(instList); node != NULL; node = dlinkNext(node))
+		a.length++;
+	if (a.numVirtual == 0 || a.length == 0)
+		return frameSize;
+
+	a.code = (MirInst*)malloc(a.length * sizeof(MirInst));
+	a.nodes = (DNode*)malloc(a.length * sizeof(DNode));
+	a.intervals = (Interval*)malloc(a.numVirtual * sizeof(Interval));
+	a.order = (int*)malloc(a.numVirtual * sizeof(int));
+	a.slotEnd = (int*)malloc(a.numVirtual * sizeof(int));
+	for (i = 0, node = dlinkHead(instList); node != NULL; node = dlinkNext(node), i++) {
+		a.nodes[i] = node;
+		a.code[i] = (MirInst)dlinkNodeAtom(node);
+	}
+	for (i = 0; i < a.numVirtual; i++) {
+		a.intervals[i].start = INT_MAX;
+		a.intervals[i].end = -1;
 	}
 
-	return regIndex;
+	mirNumberBlocks(instList);
+	computeIntervals(&a);
+	sortIntervals(&a);
+	if (linearScan(&a,0)) {
+		numScratch = MIN(a.maxRefs,NUM_CALLER_SAVED);
+		linearScan(&a,numScratch);
+	}
+	rewrite(&a,numScratch,frameSize);
 
+	free(a.code);
+	free(a.nodes);
+	free(a.intervals);
+	free(a.order);
+	free(a.slotEnd);
+	return frameSize + (a.numSlots * SPILL_SLOT_SIZE + 15) / 16 * 16;
 }
-
@@ -0,0 +1,652 @@
+/**
+ * tier.c
+ *
+ * The tiered engine. The interpreter walks the syntax tree of a function,
+ * with each variable, constant and call resolved once before the program
+ * starts. Variables live where the compiled code keeps them: the globals in
+ * one block in the layout of _gp, and the locals of a call in a frame laid
+ * out as the function's activation record, so a native function and an
+ * interpreted one see the same globals and an interpreted frame can be
+ * copied into a native one. The value of %eax, which the compiled code
+ * leaves in place across statements and returns at the end of a function, is
+ * kept in one variable that passes into and out of native code with every
+ * call.
+ *
+ * Each function counts its calls and the iterations of its loops. When the
+ * count reaches the threshold, the function alone is lowered and loaded
+ * against the globals block, with its calls of other functions bound to
+ * their native code or to a trampoline back into the interpreter, and with
+ * an entry for on-stack replacement at each of its while loops.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <util/general.h>
+#include <util/symtab.h>
+#include <util/string_utils.h>
+#include <ast/ast.h>
+#include "types.h"
+#include "encoder.h"
+#include "lower.h"
+#include "tier.h"
+
+#define TIER_OFFSET_FIELD "offset"	/**< the offset of a variable */
+#define TIER_ARRAY_FIELD "array"	/**< true if a variable is an array */
+#define TIER_SIZE_FIELD "size"		/**< the size of a variable in bytes */
+#define TIER_INDEX_FIELD "index"	/**< the number of a function in source order */
+#define TIER_STACK_WORDS (1 << 22)	/**< the size of the stack of interpreted frames */
+#define TIER_NAME_SIZE 300
+
+EXTERN(void,Cminus_error,(char*));
+
+typedef FUNCTION_POINTER(int, NativeCall, (Generic code, int eax));
+typedef FUNCTION_POINTER(int, OsrEntry, (int *locals, int eax, int loop));
+
+/**
+ * A function of the program.
+ */
+typedef struct TierFunc_struct {
+	AstIndex func;		/**< the AST_FUNCTION node */
+	char *name;
+	int words;		/**< the size of the local variables in words */
+	int count;		/**< calls plus loop iterations while interpreted */
+	bool failed;		/**< the function could not be compiled */
+	Generic native;		/**< the compiled function, or NULL */
+	OsrEntry osr;		/**< its entry for on-stack replacement */
+	Generic trampoline;	/**< the code native callers use while the function is interpreted */
+} TierFuncStruct, *TierFunc;
+
+/**
+ * What a node is resolved to: the offset in bytes of a global or the index in
+ * its frame of a local, the value of a constant, the index of a string, or
+ * the number of the function a call calls, less than 0 for a function of
+ * this process.
+ */
+typedef struct TierNode_struct {
+	int value;
+	bool global;
+} TierNode;
+
+static Ast tierAst;
+static TierFunc funcs;
+static int numFuncs;
+static TierNode *nodes;
+static SymTable functionTable;	/**< the functions by name */
+static unsigned char *globals;	/**< the storage of _gp */
+static size_t globalsSize;
+static int *stack;		/**< the frames of interpreted calls */
+static int *stackTop;
+static int eax;			/**< the value %eax would hold in the compiled program */
+static int threshold;
+static char **strings;
+static int numStrings;
+static Generic *externals;	/**< the functions of this process the program calls */
+static int numExternals;
+static bool lowering;		/**< lowerBeginProgram has been called */
+static Encoder *encoders;	/**< the loaded code, freed at the end */
+static int numEncoders;
+static NativeCall callNative;	/**< calls native code with a value for %eax */
+static int numCompiled;
+static int numReplaced;
+
+STATIC(int, evaluate, (int *frame, AstIndex expr));
+STATIC(int, callFunction, (int index));
+
+/**
+ * Create a table of variables.
+ */
+static SymTable newVariableTable() {
+	SymTable table = SymInit(64);
+	SymInitField(table,TIER_OFFSET_FIELD,(Generic)0,NULL);
+	SymInitField(table,TIER_ARRAY_FIELD,(Generic)0,NULL);
+	SymInitField(table,TIER_SIZE_FIELD,(Generic)0,NULL);
+	return table;
+}
+
+/**
+ * Enter a list of declarations in a table of variables with the offsets
+ * lowerDeclList gives them.
+ *
+ * @param table a table of variables
+ * @param decl the first AST_DECL of a list
+ * @return the number of bytes used by the declarations
+ */
+static int layOutDeclList(SymTable table, AstIndex decl) {
+	int offset = 0;
+
+	for (; decl != AST_NULL; decl = AST_NEXT(tierAst,decl)) {
+		AstIndex var;
+		for (var = AST_KID(tierAst,decl,0); var != AST_NULL; var = AST_NEXT(tierAst,var)) {
+			bool isArray = AST_NODE(tierAst,var)->kind == AST_ARRAY;
+			int index = SymIndex(table,AST_NAME(tierAst,var));
+
+			int size = 0;
+
+			if (isArray)
+				size = VOID_SIZE * atoi(AST_NAME(tierAst,AST_KID(tierAst,var,0)));
+			else if (AST_NODE(tierAst,decl)->type == AST_TYPE_INTEGER)
+				size = INTEGER_SIZE;
+			SymPutFieldByIndex(table,index,TIER_OFFSET_FIELD,(Generic)(long)offset);
+			SymPutFieldByIndex(table,index,TIER_ARRAY_FIELD,(Generic)(long)isArray);
+			SymPutFieldByIndex(table,index,TIER_SIZE_FIELD,(Generic)(long)size);
+			offset += size;
+		}
+	}
+
+	return offset;
+}
+
+/**
+ * Add a string constant with its quotes removed and its escapes replaced as
+ * the assembler replaces them in a .string directive.
+ *
+ * @param spelling the spelling of the constant, quotes included
+ * @return the index of the string
+ */
+static int addString(char *spelling) {
+	strings = (char**)realloc(strings,(numStrings + 1) * sizeof(char*));
+	strings[numStrings] = sunquote(spelling);
+	return numStrings++;
+}
+
+/**
+ * Report an error at the line of a node.
+ */
+static void reportError(AstIndex node, char *format, char *name) {
+	char msg[TIER_NAME_SIZE];
+
+	snprintf(msg,TIER_NAME_SIZE,format,name);
+	lowerLineno = AST_NODE(tierAst,node)->line;
+	Cminus_error(msg);
+	lowerLineno = 0;
+}
+
+/**
+ * Resolve a variable to its place in the globals or in the frame of a
+ * function, looking in the local scope first as the code generator does.
+ *
+ * @return false if the variable is not declared or is a scalar used as an array
+ */
+static bool resolveVariable(TierFunc f, SymTable locals, SymTable globalTable, AstIndex var) {
+	char *name = AST_NAME(tierAst,var);
+	SymTable table = locals;
+	int index = SymQueryIndex(locals,name);
+
+	if (index == SYM_INVALID_INDEX) {
+		table = globalTable;
+		index = SymQueryIndex(globalTable,name);
+	}
+	if (index == SYM_INVALID_INDEX) {
+		reportError(var,"Undeclared variable %s",name);
+		return false;
+	}
+	if (AST_NODE(tierAst,var)->kind == AST_ARRAY_ADDR && !SymGetFieldByIndex(table,index,TIER_ARRAY_FIELD)) {
+		reportError(var,"Scalar variable %s used as an array",name);
+		return false;
+	}
+
+	/* a local ends its offset below the frame pointer, with element 0 lowest */
+	int offset = (int)(long)SymGetFieldByIndex(table,index,TIER_OFFSET_FIELD);
+	int size = (int)(long)SymGetFieldByIndex(table,index,TIER_SIZE_FIELD);
+	nodes[var].global = table == globalTable;
+	nodes[var].value = nodes[var].global ? offset : f->words - (offset + size) / INTEGER_SIZE;
+	return true;
+}
+
+/**
+ * Resolve a call to a function of the program or, as the loader does, to a
+ * function of this process.
+ *
+ * @return false if there is no such function
+ */
+static bool resolveCall(AstIndex call) {
+	char *name = AST_NAME(tierAst,call);
+	int index = SymQueryIndex(functionTable,name);
+
+	if (index != SYM_INVALID_INDEX) {
+		nodes[call].value = (int)(long)SymGetFieldByIndex(functionTable,index,TIER_INDEX_FIELD);
+		return true;
+	}
+
+	void *address = dlsym(RTLD_DEFAULT,name);
+	if (address == NULL) {
+		fprintf(stderr,"Error: Undefined symbol %s\n",name);
+		return false;
+	}
+	externals = (Generic*)realloc(externals,(numExternals + 1) * sizeof(Generic));
+	externals[numExternals] = address;
+	nodes[call].value = -1 - numExternals++;
+	return true;
+}
+
+/**
+ * Resolve the variables, constants and calls in a list of nodes.
+ *
+ * @return false if errors were reported
+ */
+static bool resolveNodes(TierFunc f, SymTable locals, SymTable globalTable, AstIndex node) {
+	bool ok = true;
+
+	for (; node != AST_NULL; node = AST_NEXT(tierAst,node)) {
+		AstNode *n = AST_NODE(tierAst,node);
+
+		if (n->kind == AST_VAR_ADDR || n->kind == AST_ARRAY_ADDR)
+			ok = resolveVariable(f,locals,globalTable,node) && ok;
+		else if (n->kind == AST_CONST)
+			nodes[node].value = (int)strtol(AST_NAME(tierAst,node),NULL,10);
+		else if (n->kind == AST_STRING)
+			nodes[node].value = addString(AST_NAME(tierAst,node));
+		else if (n->kind == AST_CALL)
+			ok = resolveCall(node) && ok;
+
+		ok = resolveNodes(f,locals,globalTable,n->kid[0]) && ok;
+		ok = resolveNodes(f,locals,globalTable,n->kid[1]) && ok;
+		ok = resolveNodes(f,locals,globalTable,n->kid[2]) && ok;
+	}
+
+	return ok;
+}
+
+/**
+ * Lay out the globals and the frame of every function and resolve every
+ * function's body.
+ *
+ * @return false if errors were reported
+ */
+static bool prepareProgram() {
+	SymTable globalTable = newVariableTable();
+	AstIndex func;
+	bool ok = true;
+	int i;
+
+	globalsSize = layOutDeclList(globalTable,AST_KID(tierAst,tierAst->root,0));
+
+	numFuncs = 0;
+	for (func = AST_KID(tierAst,tierAst->root,1); func != AST_NULL; func = AST_NEXT(tierAst,func))
+		numFuncs++;
+	funcs = (TierFunc)calloc(numFuncs + 1,sizeof(TierFuncStruct));
+	nodes = (TierNode*)calloc(tierAst->numNodes,sizeof(TierNode));
+
+	functionTable = SymInit(64);
+	SymInitField(functionTable,TIER_INDEX_FIELD,(Generic)0,NULL);
+	for (i = 0, func = AST_KID(tierAst,tierAst->root,1); func != AST_NULL; i++, func = AST_NEXT(tierAst,func)) {
+		funcs[i].func = func;
+		funcs[i].name = AST_NAME(tierAst,func);
+		if (SymQueryIndex(functionTable,funcs[i].name) == SYM_INVALID_INDEX)
+			SymPutField(functionTable,funcs[i].name,TIER_INDEX_FIELD,(Generic)(long)i);
+	}
+
+	for (i = 0; i < numFuncs; i++) {
+		SymTable locals = newVariableTable();
+		funcs[i].words = layOutDeclList(locals,AST_KID(tierAst,funcs[i].func,0)) / INTEGER_SIZE;
+		ok = resolveNodes(&funcs[i],locals,globalTable,AST_KID(tierAst,funcs[i].func,1)) && ok;
+		SymKill(locals);
+	}
+
+	SymKill(globalTable);
+	return ok;
+}
+
+/**
+ * Enter an interpreted function from native code. The trampolines call this
+ * function with the stack aligned for C.
+ *
+ * @param index the number of the function
+ * @param value the value of %eax at the call
+ * @return the value of %eax at the return
+ */
+static int enterFunction(int index, int value) {
+	eax = value;
+	return callFunction(index);
+}
+
+/**
+ * Load the trampolines: one for each function, which native code calls while
+ * the function is interpreted, and tier.call, which jumps to native code with
+ * a value in %eax, using the return to jump so that the native code returns
+ * straight to the caller.
+ *
+ * @return false if they could not be loaded
+ */
+static bool loadTrampolines() {
+	Encoder encoder = encoderNew();
+	FILE *fp = encoderOpenStream(encoder);
+	char name[TIER_NAME_SIZE];
+	int i;
+
+	fprintf(fp,"\t.text\ntier.call:\tpushq %%rdi\n\tmovl %%esi, %%eax\n\tret\n");
+	for (i = 0; i < numFuncs; i++)
+		fprintf(fp,"%s.tier:\tpushq %%rbp\n\tmovq %%rsp, %%rbp\n\tandq $-16, %%rsp\n"
+			"\tmovl %%eax, %%esi\n\tmovl $%d, %%edi\n\tcall tier.enter\n\tleave\n\tret\n",
+			funcs[i].name,i);
+	fclose(fp);
+
+	encoderBind(encoder,"tier.enter",(Generic)enterFunction);
+	encoders = (Encoder*)realloc(encoders,(numEncoders + 1) * sizeof(Encoder));
+	encoders[numEncoders++] = encoder;
+	if (!encoderLoad(encoder))
+		return false;
+
+	callNative = (NativeCall)encoderAddress(encoder,"tier.call");
+	for (i = 0; i < numFuncs; i++) {
+		snprintf(name,TIER_NAME_SIZE,"%s.tier",funcs[i].name);
+		funcs[i].trampoline = encoderAddress(encoder,name);
+	}
+	return true;
+}
+
+/**
+ * Bind the functions of the program called in a list of nodes to their
+ * native code, or to their trampolines while they are interpreted.
+ */
+static void bindCalls(Encoder encoder, int self, AstIndex node) {
+	for (; node != AST_NULL; node = AST_NEXT(tierAst,node)) {
+		AstNode *n = AST_NODE(tierAst,node);
+
+		if (n->kind == AST_CALL && nodes[node].value >= 0 && nodes[node].value != self) {
+			TierFunc callee = &funcs[nodes[node].value];
+			encoderBind(encoder,callee->name,callee->native != NULL ? callee->native : callee->trampoline);
+		}
+
+		bindCalls(encoder,self,n->kid[0]);
+		bindCalls(encoder,self,n->kid[1]);
+		bindCalls(encoder,self,n->kid[2]);
+	}
+}
+
+/**
+ * Compile a function to native code with an entry for on-stack replacement.
+ * A function that cannot be compiled stays interpreted.
+ *
+ * @param index the number of the function
+ */
+static void compileFunction(int index) {
+	TierFunc f = &funcs[index];
+	FILE *savedStdout = stdout;
+	char name[TIER_NAME_SIZE];
+
+	f->failed = true;
+	if (!lowering) {
+		lowerBeginProgram(tierAst);
+		lowering = true;
+	}
+	if (callNative == NULL && !loadTrampolines())
+		return;
+
+	Encoder encoder = encoderNew();
+	stdout = encoderOpenStream(encoder);
+	lowerUseEncoder(encoder);
+	bool ok = lowerSingleFunction(index,true);
+	lowerUseEncoder(NULL);
+	fclose(stdout);
+	stdout = savedStdout;
+
+	encoderBind(encoder,"_gp",(Generic)globals);
+	bindCalls(encoder,index,AST_KID(tierAst,f->func,1));
+	if (!ok || !encoderLoad(encoder)) {
+		encoderFree(encoder);
+		return;
+	}
+
+	encoders = (Encoder*)realloc(encoders,(numEncoders + 1) * sizeof(Encoder));
+	encoders[numEncoders++] = encoder;
+	snprintf(name,TIER_NAME_SIZE,"%s.osr",f->name);
+	f->native = encoderAddress(encoder,f->name);
+	f->osr = (OsrEntry)encoderAddress(encoder,name);
+	f->failed = false;
+	numCompiled++;
+}
+
+/**
+ * Count a call or a loop iteration of an interpreted function and compile
+ * the function when the count reaches the threshold.
+ *
+ * @return true if the function has native code
+ */
+static bool countAndCompile(TierFunc f) {
+	if (!f->failed && ++f->count >= threshold)
+		compileFunction(f - funcs);
+	return f->native != NULL;
+}
+
+/**
+ * Return the address of a variable.
+ *
+ * @param frame the locals of the current call
+ * @param var an AST_VAR_ADDR or AST_ARRAY_ADDR node
+ */
+static int *variableAddress(int *frame, AstIndex var) {
+	TierNode *n = &nodes[var];
+	int *base = n->global ? (int*)(globals + n->value) : frame + n->value;
+
+	if (AST_NODE(tierAst,var)->kind != AST_ARRAY_ADDR)
+		return base;
+	return base + evaluate(frame,AST_KID(tierAst,var,0));
+}
+
+/**
+ * Evaluate an expression with the 32-bit arithmetic of the compiled code.
+ *
+ * @param frame the locals of the current call
+ * @param expr an expression node
+ * @return the value
+ */
+static int evaluate(int *frame, AstIndex expr) {
+	AstNode *node = AST_NODE(tierAst,expr);
+	unsigned int left, right;
+
+	switch (node->kind) {
+	case AST_NOT:
+		return evaluate(frame,node->kid[0]) ^ 1;
+	case AST_LOAD:
+		return *variableAddress(frame,node->kid[0]);
+	case AST_CONST:
+		return nodes[expr].value;
+	case AST_STRING:
+		return (int)(long)strings[nodes[expr].value];
+	case AST_CALL:
+		if (nodes[expr].value < 0)
+			return eax = callNative(externals[-1 - nodes[expr].value],eax);
+		return callFunction(nodes[expr].value);
+	}
+
+	left = (unsigned int)evaluate(frame,node->kid[0]);
+	right = (unsigned int)evaluate(frame,node->kid[1]);
+	switch (node->kind) {
+	case AST_OR:
+		return (int)(left | right);
+	case AST_AND:
+		return (int)(left & right);
+	case AST_EQ:
+		return (int)left == (int)right;
+	case AST_NE:
+		return (int)left != (int)right;
+	case AST_LE:
+		return (int)left <= (int)right;
+	case AST_LT:
+		return (int)left < (int)right;
+	case AST_GE:
+		return (int)left >= (int)right;
+	case AST_GT:
+		return (int)left > (int)right;
+	case AST_ADD:
+		return (int)(left + right);
+	case AST_SUB:
+		return (int)(left - right);
+	case AST_MUL:
+		return (int)(left * right);
+	case AST_DIV:
+		/* the quotient is left in %eax, and dividing by 0 traps as idivl does */
+		return eax = (int)left / (int)right;
+	}
+
+	return 0;
+}
+
+/**
+ * Execute a statement of an interpreted function.
+ *
+ * @param f the function
+ * @param frame the locals of the current call
+ * @param stmt a statement node
+ * @return true if the call is over: the statement was exit, or the rest of
+ * 	   the call ran as native code after on-stack replacement
+ */
+static bool execute(TierFunc f, int *frame, AstIndex stmt) {
+	AstNode *node = AST_NODE(tierAst,stmt);
+	int *address;
+
+	switch (node->kind) {
+	case AST_ASSIGN:
+		address = variableAddress(frame,node->kid[0]);
+		*address = evaluate(frame,node->kid[1]);
+		break;
+	case AST_IF:
+		if (evaluate(frame,node->kid[0]) != 0)
+			return execute(f,frame,node->kid[1]);
+		if (node->kid[2] != AST_NULL)
+			return execute(f,frame,node->kid[2]);
+		break;
+	case AST_WHILE:
+		while (evaluate(frame,node->kid[0]) != 0) {
+			if (execute(f,frame,node->kid[1]))
+				return true;
+			if (countAndCompile(f)) {
+				numReplaced++;
+				eax = f->osr(frame,eax,(int)stmt);
+				return true;
+			}
+		}
+		break;
+	case AST_READ:
+		address = variableAddress(frame,node->kid[0]);
+		eax = scanf("%d",address);
+		break;
+	case AST_WRITE:
+		if (AST_NODE(tierAst,node->kid[0])->kind == AST_STRING)
+			eax = printf("%s\n",strings[nodes[node->kid[0]].value]);
+		else
+			eax = printf("%d\n",evaluate(frame,node->kid[0]));
+		break;
+	case AST_RETURN:
+		/* as in the compiled code, return sets the result and goes on */
+		eax = evaluate(frame,node->kid[0]);
+		break;
+	case AST_EXIT:
+		return true;
+	case AST_BLOCK:
+		for (stmt = node->kid[0]; stmt != AST_NULL; stmt = AST_NEXT(tierAst,stmt))
+			if (execute(f,frame,stmt))
+				return true;
+		break;
+	}
+
+	return false;
+}
+
+/**
+ * Call a function of the program, natively once it is compiled.
+ *
+ * @param index the number of the function
+ * @return the value of %eax at the return
+ */
+static int callFunction(int index) {
+	TierFunc f = &funcs[index];
+	AstIndex stmt;
+
+	if (f->native != NULL || countAndCompile(f))
+		return eax = callNative(f->native,eax);
+
+	int *frame = stackTop;
+	if (frame + f->words > stack + TIER_STACK_WORDS) {
+		fprintf(stderr,"Error: Stack overflow in %s\n",f->name);
+		exit(-1);
+	}
+	stackTop += f->words;
+	for (stmt = AST_KID(tierAst,f->func,1); stmt != AST_NULL; stmt = AST_NEXT(tierAst,stmt))
+		if (execute(f,frame,stmt))
+			break;
+	stackTop = frame;
+
+	return eax;
+}
+
+/**
+ * Free everything the engine allocated.
+ */
+static void freeEngine() {
+	int i;
+
+	if (lowering)
+		lowerEndProgram();
+	for (i = 0; i < numEncoders; i++)
+		encoderFree(encoders[i]);
+	for (i = 0; i < numStrings; i++)
+		free(strings[i]);
+	free(encoders);
+	free(strings);
+	free(externals);
+	free(funcs);
+	free(nodes);
+	free(stack);
+	SymKill(functionTable);
+	if (globals != NULL)
+		munmap(globals,globalsSize);
+
+	encoders = NULL;
+	strings = NULL;
+	externals = NULL;
+	globals = NULL;
+	callNative = NULL;
+	numEncoders = numStrings = numExternals = numCompiled = numReplaced = 0;
+	lowering = false;
+}
+
+/**
+ * Run a parsed program in the tiered engine.
+ *
+ * @param ast the syntax tree of a program
+ * @param name the name of the program used in diagnostics
+ * @param hot the calls plus loop iterations after which a function is compiled
+ * @param stats true to print how many functions were compiled
+ * @return the value main returns, or -1 if the program could not be run
+ */
+int tierRun(Ast ast, char *name, int hot, bool stats) {
+	int result = -1;
+
+	tierAst = ast;
+	threshold = hot;
+	eax = 0;
+	if (!prepareProgram()) {
+		freeEngine();
+		return -1;
+	}
+
+	int mainIndex = SymQueryIndex(functionTable,"main");
+	/* the globals are in the low 2GB, where the 32-bit addresses of _gp reach them */
+	globalsSize = MAX(globalsSize,1);
+	globals = (unsigned char*)mmap(NULL,globalsSize,PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT,-1,0);
+	stack = (int*)calloc(TIER_STACK_WORDS,sizeof(int));
+	stackTop = stack;
+
+	if (globals == MAP_FAILED) {
+		globals = NULL;
+		fprintf(stderr,"Error: Could not map memory for the globals\n");
+	} else if (mainIndex == SYM_INVALID_INDEX)
+		fprintf(stderr,"Error: %s has no main function\n",name);
+	else if (numExternals == 0 || loadTrampolines()) {
+		result = callFunction((int)(long)SymGetFieldByIndex(functionTable,mainIndex,TIER_INDEX_FIELD));
+		fflush(stdout);
+	}
+
+	if (stats)
+		fprintf(stderr,"%d of %d functions compiled, %d loops continued by on-stack replacement\n",
+			numCompiled,numFuncs,numReplaced);
+	freeEngine();
+	return result;
+}
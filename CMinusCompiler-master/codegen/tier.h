@@ -0,0 +1,23 @@
+/**
+ * tier.h
+ *
+ * A tiered engine for running a program in this process. Every function
+ * starts out interpreted from the syntax tree, which costs nothing to start,
+ * and a function that is called often or loops long is compiled to native
+ * code with the built-in encoder. Later calls run the native code, and an
+ * interpreted call still in a loop of the function moves into the native
+ * code at the loop's next iteration by on-stack replacement.
+ *
+ */
+
+#ifndef TIER_H_
+#define TIER_H_
+
+#include <util/general.h>
+#include <ast/ast.h>
+
+#define TIER_THRESHOLD 1000	/**< the calls plus loop iterations after which a function is compiled */
+
+EXTERN(int, tierRun, (Ast ast, char *name, int hot, bool stats));
+
+#endif /* TIER_H_ */
@@ -0,0 +1,401 @@
+/**
+ * CminusLexer.c
+ *
+ * A hand-written replacement for the flex scanner. The whole source file is
+ * read into one buffer and scanned in place. Whitespace, identifier runs and
+ * string constants are scanned 16 bytes at a time with SSE2 when available.
+ *
+ * The token stream (token codes, lexemes and line numbers) is identical to the
+ * one produced by CminusScanner.l, including flex's longest-match and trailing
+ * context rules for numeric constants. "make lexcheck" verifies this.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/general.h>
+#include <util/string_utils.h>
+#include <util/dlink.h>
+#include "CminusParser.h"
+#include "CminusLexer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define IS_DIGIT(c) ((unsigned char)((c) - '0') < 10)
+#define IS_ALPHA(c) ((unsigned char)(((c) | 0x20) - 'a') < 26)
+#define IS_ALNUM(c) (IS_ALPHA(c) || IS_DIGIT(c))
+
+/**
+ * Set up a lexer over a copy of a source buffer.
+ *
+ * @param lexer the lexer to initialize
+ * @param src the source text
+ * @param len the number of bytes in src
+ */
+void CminusLexerInit(CminusLexerPtr lexer, const char *src, size_t len) {
+	lexer->buf = (char*)malloc(len + CMINUS_LEXER_PAD);
+	memcpy(lexer->buf,src,len);
+	memset(lexer->buf + len,0,CMINUS_LEXER_PAD);
+
+	lexer->cur = lexer->buf;
+	lexer->end = lexer->buf + len;
+	lexer->text = lexer->buf;
+	lexer->leng = 0;
+	lexer->lineno = 1;
+}
+
+/**
+ * Set up a lexer over the remaining contents of an open file.
+ *
+ * @param lexer the lexer to initialize
+ * @param fp the file to read
+ * @return false if the file could not be read
+ */
+bool CminusLexerReadFile(CminusLexerPtr lexer, FILE *fp) {
+	size_t cap = 64 * 1024, len = 0, n;
+	char *src = (char*)malloc(cap);
+
+	while ((n = fread(src + len,1,cap - len,fp)) > 0) {
+		len += n;
+		if (len == cap) {
+			cap *= 2;
+			src = (char*)realloc(src,cap);
+		}
+	}
+
+	CminusLexerInit(lexer,src,len);
+	free(src);
+	return (bool)!ferror(fp);
+}
+
+/**
+ * Release the buffer owned by a lexer.
+ *
+ * @param lexer a lexer
+ */
+void CminusLexerFree(CminusLexerPtr lexer) {
+	free(lexer->buf);
+	lexer->buf = NULL;
+}
+
+/**
+ * Skip blanks, tabs and newlines, counting the newlines.
+ *
+ * @param p the first character to examine
+ * @param lineno the line counter to advance
+ * @return the first character that is not whitespace
+ */
+static const char* skipWhitespace(const char *p, int *lineno) {
+#ifdef __SSE2__
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i newline = _mm_set1_epi8('\n');
+
+	for (;;) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)p);
+		unsigned nlMask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk,newline));
+		unsigned wsMask = nlMask | _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk,space),
+									  _mm_cmpeq_epi8(chunk,tab)));
+		if (wsMask != 0xffff) {
+			int n = __builtin_ctz(~wsMask);
+			*lineno += __builtin_popcount(nlMask & ((1u << n) - 1));
+			return p + n;
+		}
+		*lineno += __builtin_popcount(nlMask);
+		p += 16;
+	}
+#else
+	for (;; p++) {
+		if (*p == '\n')
+			(*lineno)++;
+		else if (*p != ' ' && *p != '\t')
+			return p;
+	}
+#endif
+}
+
+/**
+ * Find the end of a run of letters and digits.
+ *
+ * @param p the first character of the run
+ * @return one past the last letter or digit
+ */
+static const char* scanIdentifierRun(const char *p) {
+#ifdef __SSE2__
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	const __m128i lowerA = _mm_set1_epi8('a');
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i letterSpan = _mm_set1_epi8(25);
+	const __m128i digitSpan = _mm_set1_epi8(9);
+
+	for (;;) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)p);
+		__m128i letter = _mm_sub_epi8(_mm_or_si128(chunk,caseBit),lowerA);
+		__m128i digit = _mm_sub_epi8(chunk,zero);
+		__m128i isAlnum = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(letter,letterSpan),letter),
+					       _mm_cmpeq_epi8(_mm_min_epu8(digit,digitSpan),digit));
+		unsigned mask = _mm_movemask_epi8(isAlnum);
+		if (mask != 0xffff)
+			return p + __builtin_ctz(~mask);
+		p += 16;
+	}
+#else
+	while (IS_ALNUM(*p))
+		p++;
+	return p;
+#endif
+}
+
+/**
+ * Find the closing quote of a string constant.
+ *
+ * @param p the first character after the opening quote
+ * @param end one past the last input character
+ * @return the closing quote or NULL if the string is not terminated
+ */
+static const char* findClosingQuote(const char *p, const char *end) {
+#ifdef __SSE2__
+	const __m128i quote = _mm_set1_epi8('\'');
+
+	for (; p < end; p += 16) {
+		unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p),quote));
+		if (mask != 0) {
+			p += __builtin_ctz(mask);
+			return (p < end) ? p : NULL;
+		}
+	}
+	return NULL;
+#else
+	const char *q = memchr(p,'\'',end - p);
+	return q;
+#endif
+}
+
+/**
+ * Flex rules of the form head/[^.$] match only if some character other than '.'
+ * or '$' follows the head. Given the shortest and longest heads a rule can match,
+ * return the longest head that has such a trailing character.
+ *
+ * @param first the end of the shortest head
+ * @param last the end of the longest head
+ * @param end one past the last input character
+ * @return the end of the matched head or NULL
+ */
+static const char* trailingContextEnd(const char *first, const char *last, const char *end) {
+	for (; last >= first; last--)
+		if (last < end && *last != '.' && *last != '$')
+			return last;
+	return NULL;
+}
+
+/**
+ * Scan a numeric constant starting with a digit or a '.'.
+ *
+ * @param p the first character of the constant
+ * @param end one past the last input character
+ * @param token the token code of the constant
+ * @return one past the last character of the constant, or p if nothing matched
+ */
+static const char* scanNumber(const char *p, const char *end, int *token) {
+	const char *q = p, *last, *head = NULL;
+
+	while (IS_DIGIT(*q))
+		q++;
+	const char *digits = q;
+
+	if (*q == '.' && IS_DIGIT(q[1])) {
+		/* [0-9]*(\.)[0-9]+((e|E)(\+|\-)?[0-9]*)?/[^.$] */
+		last = q + 1;
+		while (IS_DIGIT(*last))
+			last++;
+		if (*last == 'e' || *last == 'E') {
+			last++;
+			if (*last == '+' || *last == '-')
+				last++;
+			while (IS_DIGIT(*last))
+				last++;
+		}
+		head = trailingContextEnd(q + 2,last,end);
+	} else if (digits > p && (*q == 'e' || *q == 'E')) {
+		/* [0-9]+((e|E)(\+|\-)?[0-9]*)/[^.$] */
+		last = q + 1;
+		if (*last == '+' || *last == '-')
+			last++;
+		while (IS_DIGIT(*last))
+			last++;
+		head = trailingContextEnd(q + 1,last,end);
+	}
+
+	if (head != NULL) {
+		*token = FLOATCON;
+		return head;
+	}
+
+	*token = INTCON;
+	return digits;
+}
+
+/**
+ * Return the keyword token for an identifier, or IDENTIFIER.
+ *
+ * @param s the identifier
+ * @param n the length of the identifier
+ * @return see above
+ */
+static int keywordToken(const char *s, int n) {
+	switch (n) {
+	case 2:
+		if (s[0] == 'i' && s[1] == 'f') return IF;
+		break;
+	case 3:
+		if (memcmp(s,"int",3) == 0) return INTEGER;
+		break;
+	case 4:
+		if (memcmp(s,"else",4) == 0) return ELSE;
+		if (memcmp(s,"exit",4) == 0) return EXIT;
+		if (memcmp(s,"read",4) == 0) return READ;
+		break;
+	case 5:
+		if (memcmp(s,"while",5) == 0) return WHILE;
+		if (memcmp(s,"float",5) == 0) return FLOAT;
+		if (memcmp(s,"write",5) == 0) return WRITE;
+		break;
+	case 6:
+		if (memcmp(s,"return",6) == 0) return RETURN;
+		break;
+	}
+	return IDENTIFIER;
+}
+
+/**
+ * Return the next token of the input.
+ *
+ * @param lexer a lexer
+ * @param name set to a copy of the lexeme for identifiers, strings and constants
+ * @return the token code, 0 at the end of the input
+ */
+int CminusLexerNext(CminusLexerPtr lexer, char **name) {
+	const char *p, *end = lexer->end;
+	int token;
+
+	for (;;) {
+		p = skipWhitespace(lexer->cur,&lexer->lineno);
+		lexer->text = p;
+		if (p >= end) {
+			lexer->cur = end;
+			lexer->leng = 0;
+			return 0;
+		}
+
+		const char *next = p + 1;
+		token = 0;
+
+		switch (*p) {
+		case '!':
+			if (*next == '=') { next++; token = NE; }
+			else token = NOT;
+			break;
+		case '|':
+			if (*next == '|') { next++; token = OR; }
+			break;
+		case '&':
+			if (*next == '&') { next++; token = AND; }
+			break;
+		case '<':
+			if (*next == '=') { next++; token = LE; }
+			else token = LT;
+			break;
+		case '>':
+			if (*next == '=') { next++; token = GE; }
+			else token = GT;
+			break;
+		case '=':
+			if (*next == '=') { next++; token = EQ; }
+			else token = ASSIGN;
+			break;
+		case ';': token = SEMICOLON; break;
+		case '{': token = LBRACE; break;
+		case '}': token = RBRACE; break;
+		case '[': token = LBRACKET; break;
+		case ']': token = RBRACKET; break;
+		case '(': token = LPAREN; break;
+		case ')': token = RPAREN; break;
+		case '+': token = PLUS; break;
+		case '-': token = MINUS; break;
+		case '*': token = TIMES; break;
+		case '/': token = DIVIDE; break;
+		case ',': token = COMMA; break;
+		case '\'': {
+			const char *quote = findClosingQuote(next,end);
+			if (quote != NULL) {
+				next = quote + 1;
+				token = STRING;
+			}
+			break;
+		}
+		default:
+			if (IS_ALPHA(*p)) {
+				next = scanIdentifierRun(next);
+				token = keywordToken(p,next - p);
+			} else if (IS_DIGIT(*p) || *p == '.') {
+				const char *numEnd = scanNumber(p,end,&token);
+				if (numEnd > p)
+					next = numEnd;
+				else
+					token = 0;
+			}
+			break;
+		}
+
+		lexer->cur = next;
+		lexer->leng = next - p;
+
+		if (token != 0)
+			break;
+
+		fprintf(stderr, "Scanner: lexical error '%.*s'.\n", lexer->leng, p);
+	}
+
+	if (token == IDENTIFIER || token == STRING || token == INTCON || token == FLOATCON) {
+		char *lexeme = (char*)malloc(lexer->leng + 1);
+		memcpy(lexeme,p,lexer->leng);
+		lexeme[lexer->leng] = '\0';
+		*name = lexeme;
+	}
+
+	return token;
+}
+
+#ifdef CMINUS_HAND_LEXER
+
+/*
+ * The interface the bison parser expects from a flex scanner.
+ */
+
+int Cminus_lineno = 1;
+
+static CminusLexer inputLexer;
+static bool inputLoaded = false;
+
+int Cminus_lex(void) {
+	if (!inputLoaded) {
+		CminusLexerReadFile(&inputLexer,stdin);
+		inputLoaded = true;
+	}
+
+	int token = CminusLexerNext(&inputLexer,&Cminus_lval.name);
+	Cminus_lineno = inputLexer.lineno;
+	return token;
+}
+
+void Cminus_restart(FILE *input) {
+	if (inputLoaded)
+		CminusLexerFree(&inputLexer);
+	CminusLexerReadFile(&inputLexer,input);
+	inputLoaded = true;
+}
+
+#endif
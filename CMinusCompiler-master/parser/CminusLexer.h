@@ -0,0 +1,35 @@
+/**
+ * CminusLexer.h
+ *
+ * A hand-written scanner for Cminus that produces the same token stream as the
+ * flex specification in CminusScanner.l. Selected with "make LEXER=hand".
+ *
+ */
+
+#ifndef CMINUSLEXER_H_
+#define CMINUSLEXER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <util/general.h>
+
+#define CMINUS_LEXER_PAD 32	/**< zero bytes kept past the input so 16-byte loads never leave the buffer */
+
+/**
+ * The state of one scan over an in-memory copy of a source file.
+ */
+typedef struct CminusLexer_struct {
+	char *buf;		/**< the input followed by CMINUS_LEXER_PAD zero bytes */
+	const char *cur;	/**< the next unscanned character */
+	const char *end;	/**< one past the last input character */
+	const char *text;	/**< the first character of the last token */
+	int leng;		/**< the length of the last token */
+	int lineno;		/**< the current line number */
+} CminusLexer, *CminusLexerPtr;
+
+EXTERN(void, CminusLexerInit, (CminusLexerPtr lexer, const char *src, size_t len));
+EXTERN(bool, CminusLexerReadFile, (CminusLexerPtr lexer, FILE *fp));
+EXTERN(void, CminusLexerFree, (CminusLexerPtr lexer));
+EXTERN(int, CminusLexerNext, (CminusLexerPtr lexer, char **name));
+
+#endif /* CMINUSLEXER_H_ */
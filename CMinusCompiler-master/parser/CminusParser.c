@@ -1,23 +1,22 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* A Bison parser, made by GNU Bison 2.4.1.  */
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-   
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -28,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -42,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.4.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -60,191 +63,274 @@
 /* Pull parsers.  */
 #define YYPULL 1
 
-/* Using locations.  */
-#define YYLSP_NEEDED 0
 
 /* Substitute the variable and function names.  */
 #define yyparse         Cminus_parse
 #define yylex           Cminus_lex
 #define yyerror         Cminus_error
-#define yylval          Cminus_lval
-#define yychar          Cminus_char
 #define yydebug         Cminus_debug
 #define yynerrs         Cminus_nerrs
+#define yylval          Cminus_lval
+#define yychar          Cminus_char
 
-
-/* Copy the first part of user declarations.  */
-
-/* Line 189 of yacc.c  */
+/* First part of user prologue.  */
 #line 7 "CminusParser.y"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
 #include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
+#include <time.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <util/general.h>
 #include <util/symtab.h>
-#include <util/symtab_stack.h>
 #include <util/dlink.h>
 #include <util/string_utils.h>
-#include <codegen/symfields.h>
-#include <codegen/types.h>
-#include <codegen/codegen.h>
-#include <codegen/reg.h>
-
-#define SYMTABLE_SIZE 100
+#include <ast/ast.h>
+#include <codegen/lower.h>
+#include <codegen/encoder.h>
+#include <codegen/tier.h>
+#include <vm/vm.h>
+#include "CminusServer.h"
 
 /*********************EXTERNAL DECLARATIONS***********************/
 
 EXTERN(void,Cminus_error,(char*));
 
 EXTERN(int,Cminus_lex,(void));
+EXTERN(void,Cminus_restart,(FILE*));
 
-SymTable symtab;
-SymtabStack symstack;
-
-static DList instList;
-static DList dataList;
+Ast programAst;
 
 char *fileName;
 
-static int functionOffset;
+#define ASSEMBLER "as"	/**< the assembler run by -c --as, looked up in PATH */
+
+extern char **environ;
+
+static bool emitObject = false;		/**< -c: write an object file */
+static bool useAssembler = false;	/**< --as: make the object file with the system assembler */
+static char *outputName = NULL;		/**< -o: the output file, "-" for stdout */
+static bool runProgram = false;		/**< --run: run the program in this process instead */
+static bool tierProgram = false;	/**< --tier: run the program in the tiered engine instead */
+static int hotCount = TIER_THRESHOLD;	/**< --hot: when the tiered engine compiles a function */
+static bool tierStats = false;		/**< --tier-stats: print what the tiered engine compiled */
+static bool interpProgram = false;	/**< --interp: run the program in the bytecode interpreter instead */
+static bool interpFuse = true;		/**< --no-super turns off the interpreter's superinstructions */
+static bool interpStats = false;	/**< --interp-stats: print the interpreter's load time and dispatches */
+static char *interpProfile = NULL;	/**< --interp-profile: the file to add instruction pair counts to */
+static bool interpBatch = false;	/**< --batch: run the program once for each input file instead */
+static char *bytecodeImage = NULL;	/**< --emit-bytecode: the bytecode image to write instead */
+static bool usePeephole = true;		/**< --no-peephole turns off the peephole optimizer */
+static bool usePromotion = true;	/**< --no-promote keeps every variable in memory */
+static bool useFolding = true;		/**< --no-fold turns off constant folding */
+static CodeCache codeCache = NULL;	/**< the code cache given with --cache */
+static bool cacheStats = false;		/**< print the use of the code cache at exit */
+
 int globalOffset = 0;
 
-static char* functionName;
 extern union YYSTYPE yylval;
 extern int Cminus_lineno;
 
+#define NODE(kind,name,kid0,kid1,kid2) astNode(programAst,(kind),Cminus_lineno,(name),(kid0),(kid1),(kid2))
 
 
-/* Line 189 of yacc.c  */
-#line 122 "CminusParser.c"
-
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
-
-
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     AND = 258,
-     ELSE = 259,
-     EXIT = 260,
-     FLOAT = 261,
-     FOR = 262,
-     IF = 263,
-     INTEGER = 264,
-     NOT = 265,
-     OR = 266,
-     READ = 267,
-     WHILE = 268,
-     WRITE = 269,
-     LBRACE = 270,
-     RBRACE = 271,
-     LE = 272,
-     LT = 273,
-     GE = 274,
-     GT = 275,
-     EQ = 276,
-     NE = 277,
-     ASSIGN = 278,
-     COMMA = 279,
-     SEMICOLON = 280,
-     LBRACKET = 281,
-     RBRACKET = 282,
-     LPAREN = 283,
-     RPAREN = 284,
-     PLUS = 285,
-     TIMES = 286,
-     IDENTIFIER = 287,
-     DIVIDE = 288,
-     RETURN = 289,
-     STRING = 290,
-     INTCON = 291,
-     FLOATCON = 292,
-     MINUS = 293,
-     DIVDE = 294
-   };
-#endif
-
+#line 144 "CminusParser.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+#include "CminusParser.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_AND = 3,                        /* AND  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_EXIT = 5,                       /* EXIT  */
+  YYSYMBOL_FLOAT = 6,                      /* FLOAT  */
+  YYSYMBOL_FOR = 7,                        /* FOR  */
+  YYSYMBOL_IF = 8,                         /* IF  */
+  YYSYMBOL_INTEGER = 9,                    /* INTEGER  */
+  YYSYMBOL_NOT = 10,                       /* NOT  */
+  YYSYMBOL_OR = 11,                        /* OR  */
+  YYSYMBOL_READ = 12,                      /* READ  */
+  YYSYMBOL_WHILE = 13,                     /* WHILE  */
+  YYSYMBOL_WRITE = 14,                     /* WRITE  */
+  YYSYMBOL_LBRACE = 15,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 16,                    /* RBRACE  */
+  YYSYMBOL_LE = 17,                        /* LE  */
+  YYSYMBOL_LT = 18,                        /* LT  */
+  YYSYMBOL_GE = 19,                        /* GE  */
+  YYSYMBOL_GT = 20,                        /* GT  */
+  YYSYMBOL_EQ = 21,                        /* EQ  */
+  YYSYMBOL_NE = 22,                        /* NE  */
+  YYSYMBOL_ASSIGN = 23,                    /* ASSIGN  */
+  YYSYMBOL_COMMA = 24,                     /* COMMA  */
+  YYSYMBOL_SEMICOLON = 25,                 /* SEMICOLON  */
+  YYSYMBOL_LBRACKET = 26,                  /* LBRACKET  */
+  YYSYMBOL_RBRACKET = 27,                  /* RBRACKET  */
+  YYSYMBOL_LPAREN = 28,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 29,                    /* RPAREN  */
+  YYSYMBOL_PLUS = 30,                      /* PLUS  */
+  YYSYMBOL_TIMES = 31,                     /* TIMES  */
+  YYSYMBOL_IDENTIFIER = 32,                /* IDENTIFIER  */
+  YYSYMBOL_DIVIDE = 33,                    /* DIVIDE  */
+  YYSYMBOL_RETURN = 34,                    /* RETURN  */
+  YYSYMBOL_STRING = 35,                    /* STRING  */
+  YYSYMBOL_INTCON = 36,                    /* INTCON  */
+  YYSYMBOL_FLOATCON = 37,                  /* FLOATCON  */
+  YYSYMBOL_MINUS = 38,                     /* MINUS  */
+  YYSYMBOL_DIVDE = 39,                     /* DIVDE  */
+  YYSYMBOL_YYACCEPT = 40,                  /* $accept  */
+  YYSYMBOL_Program = 41,                   /* Program  */
+  YYSYMBOL_Procedures = 42,                /* Procedures  */
+  YYSYMBOL_ProcedureDecl = 43,             /* ProcedureDecl  */
+  YYSYMBOL_ProcedureHead = 44,             /* ProcedureHead  */
+  YYSYMBOL_FunctionDecl = 45,              /* FunctionDecl  */
+  YYSYMBOL_ProcedureBody = 46,             /* ProcedureBody  */
+  YYSYMBOL_DeclList = 47,                  /* DeclList  */
+  YYSYMBOL_IdentifierList = 48,            /* IdentifierList  */
+  YYSYMBOL_VarDecl = 49,                   /* VarDecl  */
+  YYSYMBOL_Type = 50,                      /* Type  */
+  YYSYMBOL_Statement = 51,                 /* Statement  */
+  YYSYMBOL_Assignment = 52,                /* Assignment  */
+  YYSYMBOL_IfStatement = 53,               /* IfStatement  */
+  YYSYMBOL_TestAndThen = 54,               /* TestAndThen  */
+  YYSYMBOL_Test = 55,                      /* Test  */
+  YYSYMBOL_WhileStatement = 56,            /* WhileStatement  */
+  YYSYMBOL_WhileExpr = 57,                 /* WhileExpr  */
+  YYSYMBOL_WhileToken = 58,                /* WhileToken  */
+  YYSYMBOL_IOStatement = 59,               /* IOStatement  */
+  YYSYMBOL_ReturnStatement = 60,           /* ReturnStatement  */
+  YYSYMBOL_ExitStatement = 61,             /* ExitStatement  */
+  YYSYMBOL_CompoundStatement = 62,         /* CompoundStatement  */
+  YYSYMBOL_StatementList = 63,             /* StatementList  */
+  YYSYMBOL_Expr = 64,                      /* Expr  */
+  YYSYMBOL_SimpleExpr = 65,                /* SimpleExpr  */
+  YYSYMBOL_AddExpr = 66,                   /* AddExpr  */
+  YYSYMBOL_MulExpr = 67,                   /* MulExpr  */
+  YYSYMBOL_Factor = 68,                    /* Factor  */
+  YYSYMBOL_Variable = 69,                  /* Variable  */
+  YYSYMBOL_StringConstant = 70,            /* StringConstant  */
+  YYSYMBOL_Constant = 71                   /* Constant  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Line 214 of yacc.c  */
-#line 96 "CminusParser.y"
-
-	char*	name;
-	int     symIndex;
-	DList	idList;
-	int 	offset;
 
 
 
-/* Line 214 of yacc.c  */
-#line 206 "CminusParser.c"
-} YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+#ifdef short
+# undef short
 #endif
 
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
-
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-/* Line 264 of yacc.c  */
-#line 218 "CminusParser.c"
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-typedef signed char yytype_int8;
-#else
-typedef short int yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -252,55 +338,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
-# if YYENABLE_NLS
+# if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -317,11 +454,11 @@ YYID (yyi)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
 #     endif
 #    endif
 #   endif
@@ -329,8 +466,8 @@ YYID (yyi)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -344,111 +481,117 @@ YYID (yyi)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  10
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   145
+#define YYLAST   146
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  40
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  32
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  66
-/* YYNRULES -- Number of states.  */
+#define YYNRULES  68
+/* YYNSTATES -- Number of states.  */
 #define YYNSTATES  131
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   294
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -483,224 +626,169 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     5,     8,    11,    12,    15,    18,    20,
-      26,    29,    33,    38,    40,    44,    46,    51,    53,    55,
-      57,    59,    61,    63,    65,    67,    69,    74,    79,    82,
-      85,    89,    93,    97,    99,   105,   111,   117,   121,   124,
-     128,   130,   133,   135,   139,   143,   146,   148,   152,   156,
-     160,   164,   168,   172,   174,   178,   182,   184,   188,   192,
-     194,   196,   200,   204,   206,   211,   213
+       0,   143,   143,   145,   147,   149,   154,   156,   160,   165,
+     168,   172,   177,   181,   185,   191,   193,   197,   200,   207,
+     209,   213,   215,   217,   219,   221,   223,   225,   229,   233,
+     236,   240,   244,   248,   252,   256,   260,   262,   264,   268,
+     272,   276,   280,   282,   286,   288,   290,   292,   296,   298,
+     300,   302,   304,   306,   308,   312,   314,   316,   320,   322,
+     324,   328,   330,   332,   335,   339,   342,   347,   352
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      41,     0,    -1,    42,    -1,    47,    42,    -1,    43,    42,
-      -1,    -1,    44,    46,    -1,    45,    47,    -1,    45,    -1,
-      50,    32,    28,    29,    15,    -1,    63,    16,    -1,    50,
-      48,    25,    -1,    47,    50,    48,    25,    -1,    49,    -1,
-      48,    24,    49,    -1,    32,    -1,    32,    26,    36,    27,
-      -1,     9,    -1,     6,    -1,    52,    -1,    53,    -1,    56,
-      -1,    59,    -1,    60,    -1,    61,    -1,    62,    -1,    69,
-      23,    64,    25,    -1,     8,    54,     4,    62,    -1,     8,
-      54,    -1,    55,    62,    -1,    28,    64,    29,    -1,    58,
-      57,    51,    -1,    28,    64,    29,    -1,    13,    -1,    12,
-      28,    69,    29,    25,    -1,    14,    28,    64,    29,    25,
-      -1,    14,    28,    70,    29,    25,    -1,    34,    64,    25,
-      -1,     5,    25,    -1,    15,    63,    16,    -1,    51,    -1,
-      63,    51,    -1,    65,    -1,    64,    11,    65,    -1,    64,
-       3,    65,    -1,    10,    65,    -1,    66,    -1,    65,    21,
-      66,    -1,    65,    22,    66,    -1,    65,    17,    66,    -1,
-      65,    18,    66,    -1,    65,    19,    66,    -1,    65,    20,
-      66,    -1,    67,    -1,    66,    30,    67,    -1,    66,    38,
-      67,    -1,    68,    -1,    67,    31,    68,    -1,    67,    33,
-      68,    -1,    69,    -1,    71,    -1,    32,    28,    29,    -1,
-      28,    64,    29,    -1,    32,    -1,    32,    26,    64,    27,
-      -1,    35,    -1,    36,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,   111,   111,   114,   120,   122,   126,   136,   142,   149,
-     154,   158,   167,   178,   181,   186,   188,   208,   210,   212,
-     214,   216,   218,   220,   222,   224,   228,   232,   234,   238,
-     242,   246,   250,   254,   258,   260,   262,   266,   270,   274,
-     278,   280,   284,   286,   288,   290,   294,   296,   298,   300,
-     302,   304,   306,   310,   312,   314,   318,   320,   322,   326,
-     328,   330,   332,   336,   338,   342,   347
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "AND", "ELSE", "EXIT", "FLOAT", "FOR",
-  "IF", "INTEGER", "NOT", "OR", "READ", "WHILE", "WRITE", "LBRACE",
-  "RBRACE", "LE", "LT", "GE", "GT", "EQ", "NE", "ASSIGN", "COMMA",
-  "SEMICOLON", "LBRACKET", "RBRACKET", "LPAREN", "RPAREN", "PLUS", "TIMES",
-  "IDENTIFIER", "DIVIDE", "RETURN", "STRING", "INTCON", "FLOATCON",
-  "MINUS", "DIVDE", "$accept", "Program", "Procedures", "ProcedureDecl",
-  "ProcedureHead", "FunctionDecl", "ProcedureBody", "DeclList",
-  "IdentifierList", "VarDecl", "Type", "Statement", "Assignment",
-  "IfStatement", "TestAndThen", "Test", "WhileStatement", "WhileExpr",
-  "WhileToken", "IOStatement", "ReturnStatement", "ExitStatement",
-  "CompoundStatement", "StatementList", "Expr", "SimpleExpr", "AddExpr",
-  "MulExpr", "Factor", "Variable", "StringConstant", "Constant", 0
+  "\"end of file\"", "error", "\"invalid token\"", "AND", "ELSE", "EXIT",
+  "FLOAT", "FOR", "IF", "INTEGER", "NOT", "OR", "READ", "WHILE", "WRITE",
+  "LBRACE", "RBRACE", "LE", "LT", "GE", "GT", "EQ", "NE", "ASSIGN",
+  "COMMA", "SEMICOLON", "LBRACKET", "RBRACKET", "LPAREN", "RPAREN", "PLUS",
+  "TIMES", "IDENTIFIER", "DIVIDE", "RETURN", "STRING", "INTCON",
+  "FLOATCON", "MINUS", "DIVDE", "$accept", "Program", "Procedures",
+  "ProcedureDecl", "ProcedureHead", "FunctionDecl", "ProcedureBody",
+  "DeclList", "IdentifierList", "VarDecl", "Type", "Statement",
+  "Assignment", "IfStatement", "TestAndThen", "Test", "WhileStatement",
+  "WhileExpr", "WhileToken", "IOStatement", "ReturnStatement",
+  "ExitStatement", "CompoundStatement", "StatementList", "Expr",
+  "SimpleExpr", "AddExpr", "MulExpr", "Factor", "Variable",
+  "StringConstant", "Constant", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    40,    41,    41,    42,    42,    43,    44,    44,    45,
-      46,    47,    47,    48,    48,    49,    49,    50,    50,    51,
-      51,    51,    51,    51,    51,    51,    52,    53,    53,    54,
-      55,    56,    57,    58,    59,    59,    59,    60,    61,    62,
-      63,    63,    64,    64,    64,    64,    65,    65,    65,    65,
-      65,    65,    65,    66,    66,    66,    67,    67,    67,    68,
-      68,    68,    68,    69,    69,    70,    71
-};
+#define YYPACT_NINF (-49)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
-{
-       0,     2,     1,     2,     2,     0,     2,     2,     1,     5,
-       2,     3,     4,     1,     3,     1,     4,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     4,     4,     2,     2,
-       3,     3,     3,     1,     5,     5,     5,     3,     2,     3,
-       1,     2,     1,     3,     3,     2,     1,     3,     3,     3,
-       3,     3,     3,     1,     3,     3,     1,     3,     3,     1,
-       1,     3,     3,     1,     4,     1,     1
-};
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
-{
-       5,    18,    17,     0,     2,     5,     0,     8,     5,     0,
-       1,     4,     0,     0,     0,     0,    33,     0,     0,    63,
-       0,     6,    40,    19,    20,    21,     0,    22,    23,    24,
-      25,     0,     0,     7,     0,     3,     0,    15,     0,    13,
-       0,    38,     0,    28,     0,     0,     0,     0,     0,     0,
-       0,    63,    66,     0,    42,    46,    53,    56,    59,    60,
-       0,     0,    10,    41,     0,     0,    15,     0,     0,     0,
-       0,    11,     0,     0,    29,     0,    65,     0,     0,    39,
-       0,    45,     0,     0,     0,     0,    37,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,    31,     0,
-      12,     0,     0,    14,    30,    27,     0,     0,     0,    64,
-      62,    61,    44,    43,    49,    50,    51,    52,    47,    48,
-      54,    55,    57,    58,    32,    26,    16,     9,    34,    35,
-      36
-};
+#define YYTABLE_NINF (-1)
 
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
-{
-      -1,     3,     4,     5,     6,     7,    21,     8,    38,    39,
-       9,    22,    23,    24,    43,    44,    25,    61,    26,    27,
-      28,    29,    30,    31,    53,    54,    55,    56,    57,    58,
-      78,    59
-};
+#define yytable_value_is_error(Yyn) \
+  0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-#define YYPACT_NINF -49
 static const yytype_int8 yypact[] =
 {
-      -2,   -49,   -49,     3,   -49,    -2,    37,    -2,    -2,   -12,
-     -49,   -49,     6,    18,    46,    64,   -49,    80,    37,    52,
-      34,   -49,   -49,   -49,   -49,   -49,    95,   -49,   -49,   -49,
-     -49,     1,    40,    -2,    72,   -49,   -12,   -18,    76,   -49,
-      98,   -49,    34,   125,   115,    99,    48,    14,    34,    66,
-      34,    71,   -49,    78,    94,    35,    44,   -49,   -49,   -49,
-      34,    37,   -49,   -49,    34,    72,   106,    82,    97,   105,
-      72,   -49,    50,   115,   -49,   107,   -49,    56,   108,   -49,
-      20,    94,    57,   109,    66,    66,   -49,    66,    66,    66,
-      66,    66,    66,    66,    66,    66,    66,    61,   -49,    85,
-     -49,   112,   120,   -49,   -49,   -49,   116,   117,   118,   -49,
-     -49,   -49,    94,    94,    35,    35,    35,    35,    35,    35,
-      44,    44,   -49,   -49,   -49,   -49,   -49,   -49,   -49,   -49,
+      38,   -49,   -49,     5,    38,   -49,    49,    38,    38,   -12,
+     -49,   -49,    -9,    18,    28,    31,   -49,    44,    49,    51,
+      48,   -49,   -49,   -49,   -49,   -49,    67,   -49,   -49,   -49,
+     -49,    14,    92,    38,    58,    38,   -12,   -10,    89,   -49,
+      71,   -49,    48,   123,   115,   100,    50,    37,    48,   -15,
+      48,    42,   -49,    76,    86,    59,    78,   -49,   -49,   -49,
+      48,    49,   -49,   -49,    48,    58,   105,    99,    97,   106,
+      58,   -49,     3,   115,   -49,   107,   -49,    62,   108,   -49,
+       4,    86,    63,   109,   -15,   -15,   -49,   -15,   -15,   -15,
+     -15,   -15,   -15,   -15,   -15,   -15,   -15,    64,   -49,    85,
+     -49,   112,   119,   -49,   -49,   -49,   116,   117,   118,   -49,
+     -49,   -49,    86,    86,    59,    59,    59,    59,    59,    59,
+      78,    78,   -49,   -49,   -49,   -49,   -49,   -49,   -49,   -49,
      -49
 };
 
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       5,    20,    19,     0,     2,     6,     0,    10,     4,     0,
+       1,     7,     0,     0,     0,     0,    35,     0,     0,    65,
+       0,     8,    42,    21,    22,    23,     0,    24,    25,    26,
+      27,     0,     0,     9,     0,     3,     0,    17,     0,    15,
+       0,    40,     0,    30,     0,     0,     0,     0,     0,     0,
+       0,    65,    68,     0,    44,    48,    55,    58,    61,    62,
+       0,     0,    12,    43,     0,     0,    17,     0,     0,     0,
+       0,    13,     0,     0,    31,     0,    67,     0,     0,    41,
+       0,    47,     0,     0,     0,     0,    39,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    33,     0,
+      14,     0,     0,    16,    32,    29,     0,     0,     0,    66,
+      64,    63,    46,    45,    51,    52,    53,    54,    49,    50,
+      56,    57,    59,    60,    34,    28,    18,    11,    36,    37,
+      38
+};
+
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -49,   -49,    16,   -49,   -49,   -49,   -49,   133,   -31,    74,
-      49,   -29,   -49,   -49,   -49,   -49,   -49,   -49,   -49,   -49,
-     -49,   -49,   -33,   127,    45,   -48,    30,    31,    32,    -6,
+     -49,   -49,   132,    -1,   -49,   -49,   -49,   137,   -32,    75,
+       2,   -23,   -49,   -49,   -49,   -49,   -49,   -49,   -49,   -49,
+     -49,   -49,   -33,   128,    52,   -48,    30,    32,    33,    -6,
      -49,   -49
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     3,     4,     5,     6,     7,    21,     8,    38,    39,
+      12,    22,    23,    24,    43,    44,    25,    61,    26,    27,
+      28,    29,    30,    31,    53,    54,    55,    56,    57,    58,
+      78,    59
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      32,    81,    63,    10,     1,    67,    13,     2,    68,    14,
-      69,    74,    32,    15,    16,    17,    18,    62,    63,    13,
-      37,    11,    14,    84,    35,    32,    15,    16,    17,    18,
-      79,    85,    98,    19,    67,    20,   112,   113,    40,    75,
-     105,    32,    13,    41,    49,    14,    19,   109,    20,    15,
-      16,    17,    18,    84,    12,    32,    34,    36,    49,    84,
-      84,    85,    50,    64,    84,    93,    51,    85,    85,    19,
-      52,    20,    85,    94,    42,    95,    50,    96,    48,   104,
-      51,    84,    65,    76,    52,   107,   110,    72,    84,    85,
-     124,    77,    45,    80,    50,    82,    85,    48,    51,    83,
-      70,    71,    52,    86,    66,    97,    70,   100,    46,    99,
-     125,    87,    88,    89,    90,    91,    92,   114,   115,   116,
-     117,   118,   119,    60,   120,   121,    69,   122,   123,    73,
-      18,    19,    68,   101,   102,   127,   106,   108,   111,   126,
-      33,   128,   129,   130,   103,    47
+      32,    81,     9,    11,    67,    10,    84,    84,    63,    34,
+      36,    74,    32,    50,    85,    85,    68,    51,    69,    13,
+      37,    52,    14,    40,    63,    32,    15,    16,    17,    18,
+      62,   109,   104,    67,    11,    65,   112,   113,    98,    75,
+     105,    32,    13,    41,     1,    14,    19,     2,    20,    15,
+      16,    17,    18,    79,    13,    32,    42,    14,    49,    45,
+      49,    15,    16,    17,    18,    84,    84,    84,    48,    19,
+      83,    20,    46,    85,    85,    85,    50,    48,    50,    84,
+      51,    19,    51,    20,    52,    76,    52,    85,    84,    93,
+      66,   107,   110,   124,    72,    60,    85,    94,    77,    69,
+      80,    86,    82,    87,    88,    89,    90,    91,    92,    95,
+     125,    96,    97,    70,    71,    64,    99,   114,   115,   116,
+     117,   118,   119,    70,   100,   120,   121,    73,   122,   123,
+      18,    68,    19,   101,   127,   102,   106,   108,   111,   126,
+      35,   128,   129,   130,    33,   103,    47
 };
 
-static const yytype_uint8 yycheck[] =
+static const yytype_int8 yycheck[] =
 {
-       6,    49,    31,     0,     6,    36,     5,     9,    26,     8,
-      28,    44,    18,    12,    13,    14,    15,    16,    47,     5,
-      32,     5,     8,     3,     8,    31,    12,    13,    14,    15,
-      16,    11,    61,    32,    65,    34,    84,    85,    32,    45,
-      73,    47,     5,    25,    10,     8,    32,    27,    34,    12,
-      13,    14,    15,     3,     5,    61,     7,     8,    10,     3,
-       3,    11,    28,    23,     3,    30,    32,    11,    11,    32,
-      36,    34,    11,    38,    28,    31,    28,    33,    26,    29,
-      32,     3,    33,    35,    36,    29,    29,    42,     3,    11,
-      29,    46,    28,    48,    28,    50,    11,    26,    32,    28,
-      24,    25,    36,    25,    32,    60,    24,    25,    28,    64,
-      25,    17,    18,    19,    20,    21,    22,    87,    88,    89,
-      90,    91,    92,    28,    93,    94,    28,    95,    96,     4,
-      15,    32,    26,    36,    29,    15,    29,    29,    29,    27,
-       7,    25,    25,    25,    70,    18
+       6,    49,     0,     4,    36,     0,     3,     3,    31,     7,
+       8,    44,    18,    28,    11,    11,    26,    32,    28,     5,
+      32,    36,     8,    32,    47,    31,    12,    13,    14,    15,
+      16,    27,    29,    65,    35,    33,    84,    85,    61,    45,
+      73,    47,     5,    25,     6,     8,    32,     9,    34,    12,
+      13,    14,    15,    16,     5,    61,    28,     8,    10,    28,
+      10,    12,    13,    14,    15,     3,     3,     3,    26,    32,
+      28,    34,    28,    11,    11,    11,    28,    26,    28,     3,
+      32,    32,    32,    34,    36,    35,    36,    11,     3,    30,
+      32,    29,    29,    29,    42,    28,    11,    38,    46,    28,
+      48,    25,    50,    17,    18,    19,    20,    21,    22,    31,
+      25,    33,    60,    24,    25,    23,    64,    87,    88,    89,
+      90,    91,    92,    24,    25,    93,    94,     4,    95,    96,
+      15,    26,    32,    36,    15,    29,    29,    29,    29,    27,
+       8,    25,    25,    25,     7,    70,    18
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     6,     9,    41,    42,    43,    44,    45,    47,    50,
-       0,    42,    50,     5,     8,    12,    13,    14,    15,    32,
+       0,    43,    50,     5,     8,    12,    13,    14,    15,    32,
       34,    46,    51,    52,    53,    56,    58,    59,    60,    61,
       62,    63,    69,    47,    50,    42,    50,    32,    48,    49,
       32,    25,    28,    54,    55,    28,    28,    63,    26,    10,
@@ -715,95 +803,65 @@ static const yytype_uint8 yystos[] =
       25
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    40,    41,    41,    41,    41,    42,    42,    43,    44,
+      44,    45,    46,    47,    47,    48,    48,    49,    49,    50,
+      50,    51,    51,    51,    51,    51,    51,    51,    52,    53,
+      53,    54,    55,    56,    57,    58,    59,    59,    59,    60,
+      61,    62,    63,    63,    64,    64,    64,    64,    65,    65,
+      65,    65,    65,    65,    65,    66,    66,    66,    67,    67,
+      67,    68,    68,    68,    68,    69,    69,    70,    71
+};
 
-#define YYFAIL		goto yyerrlab
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     0,     1,     2,     2,     2,
+       1,     5,     2,     3,     4,     1,     3,     1,     4,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     4,     4,
+       2,     2,     3,     3,     3,     1,     5,     5,     5,     3,
+       2,     3,     1,     2,     1,     3,     3,     2,     1,     3,
+       3,     3,     3,     3,     3,     1,     3,     3,     1,     3,
+       3,     1,     1,     3,     3,     1,     4,     1,     1
+};
 
-#define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#ifndef YY_LOCATION_PRINT
-# if YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
 
+#define YYRECOVERING()  (!!yyerrstatus)
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -813,80 +871,58 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -894,16 +930,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
 static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -914,63 +942,56 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -985,342 +1006,78 @@ int yydebug;
 # define YYMAXDEPTH 10000
 #endif
 
-
-
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
 
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
 
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
 
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
-/* Prevent warnings from -Wmissing-prototypes.  */
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
-
 
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
 YYSTYPE yylval;
-
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
 
-/*-------------------------.
-| yyparse or yypush_parse.  |
-`-------------------------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/*----------.
+| yyparse.  |
+`----------*/
+
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-
-
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks thru separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1328,133 +1085,140 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yytoken = 0;
-  yyss = yyssa;
-  yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-  yyssp = yyss;
-  yyvsp = yyvs;
-
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
   /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1469,8 +1233,8 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
@@ -1482,13 +1246,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1503,14 +1267,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1523,726 +1287,627 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-
-/* Line 1455 of yacc.c  */
-#line 111 "CminusParser.y"
-    {
-	emitDataPrologue(dataList);
-	emitInstructions(instList);
-;}
+  case 2: /* Program: Procedures  */
+#line 143 "CminusParser.y"
+                     {
+	programAst->root = NODE(AST_PROGRAM,NULL,AST_NULL,(yyvsp[0].list).head,AST_NULL);
+}
+#line 1296 "CminusParser.c"
     break;
 
-  case 3:
-
-/* Line 1455 of yacc.c  */
-#line 114 "CminusParser.y"
-    {
-	globalOffset = (yyvsp[(1) - (2)].offset);
-	emitDataPrologue(dataList);
-	emitInstructions(instList);
-;}
+  case 3: /* Program: DeclList Procedures  */
+#line 145 "CminusParser.y"
+                        {
+	programAst->root = NODE(AST_PROGRAM,NULL,(yyvsp[-1].list).head,(yyvsp[0].list).head,AST_NULL);
+}
+#line 1304 "CminusParser.c"
     break;
 
-  case 4:
-
-/* Line 1455 of yacc.c  */
-#line 120 "CminusParser.y"
-    {
-
-;}
-    break;
-
-  case 5:
-
-/* Line 1455 of yacc.c  */
-#line 122 "CminusParser.y"
-    {
-
-;}
+  case 4: /* Program: DeclList  */
+#line 147 "CminusParser.y"
+             {
+	programAst->root = NODE(AST_PROGRAM,NULL,(yyvsp[0].list).head,AST_NULL,AST_NULL);
+}
+#line 1312 "CminusParser.c"
     break;
 
-  case 6:
-
-/* Line 1455 of yacc.c  */
-#line 126 "CminusParser.y"
+  case 5: /* Program: %empty  */
+#line 149 "CminusParser.y"
     {
-	emitEndFunction(instList);
-	symtab = endScope(symstack);
-	SymKillField(symtab,SYMTAB_REGISTER_INDEX_FIELD);
-    SymKillField(symtab,SYMTAB_OFFSET_FIELD);
-    SymKill(symtab);
-	symtab = currentSymtab(symstack);
-	emitExit(instList);
-;}
+	programAst->root = NODE(AST_PROGRAM,NULL,AST_NULL,AST_NULL,AST_NULL);
+}
+#line 1320 "CminusParser.c"
     break;
 
-  case 7:
-
-/* Line 1455 of yacc.c  */
-#line 136 "CminusParser.y"
-    {
-	emitProcedurePrologue(instList,symtab,(yyvsp[(1) - (2)].symIndex));
-	emitStartFunction(instList, (yyvsp[(2) - (2)].offset));
-	functionOffset = (yyvsp[(2) - (2)].offset);
-	(yyval.symIndex) = (yyvsp[(1) - (2)].symIndex);
-	
-;}
+  case 6: /* Procedures: ProcedureDecl  */
+#line 154 "CminusParser.y"
+                                {
+	(yyval.list) = astListStart(programAst,(yyvsp[0].node));
+}
+#line 1328 "CminusParser.c"
     break;
 
-  case 8:
-
-/* Line 1455 of yacc.c  */
-#line 142 "CminusParser.y"
-    {
-	emitProcedurePrologue(instList,symtab,(yyvsp[(1) - (1)].symIndex));
-	emitStartFunction(instList, 0);
-	functionOffset = 0;
-	(yyval.symIndex) = (yyvsp[(1) - (1)].symIndex);
-;}
+  case 7: /* Procedures: Procedures ProcedureDecl  */
+#line 156 "CminusParser.y"
+                             {
+	(yyval.list) = astListAppend(programAst,(yyvsp[-1].list),(yyvsp[0].node));
+}
+#line 1336 "CminusParser.c"
     break;
 
-  case 9:
-
-/* Line 1455 of yacc.c  */
-#line 149 "CminusParser.y"
-    {
-	symtab = beginScope(symstack);
-	(yyval.symIndex) = SymIndex(symtab,(yyvsp[(2) - (5)].name));
-;}
+  case 8: /* ProcedureDecl: ProcedureHead ProcedureBody  */
+#line 160 "CminusParser.y"
+                                            {
+	AST_KID(programAst,(yyvsp[-1].node),1) = (yyvsp[0].node);
+	(yyval.node) = (yyvsp[-1].node);
+}
+#line 1345 "CminusParser.c"
     break;
 
-  case 10:
-
-/* Line 1455 of yacc.c  */
-#line 154 "CminusParser.y"
-    {
-	
-;}
+  case 9: /* ProcedureHead: FunctionDecl DeclList  */
+#line 165 "CminusParser.y"
+                                      {
+	AST_KID(programAst,(yyvsp[-1].node),0) = (yyvsp[0].list).head;
+	(yyval.node) = (yyvsp[-1].node);
+}
+#line 1354 "CminusParser.c"
     break;
 
-  case 11:
-
-/* Line 1455 of yacc.c  */
-#line 158 "CminusParser.y"
-    {
-	AddIdStructPtr data = (AddIdStructPtr)malloc(sizeof(AddIdStruct));
-	data->offset = 0;
-	data->symtab = symtab;
-    data->typeIndex = (yyvsp[(1) - (3)].symIndex);
-	dlinkApply1((yyvsp[(2) - (3)].idList),(DLinkApply1Func)addIdToSymtab,(Generic)data);
-	(yyval.offset) = data->offset;
-	dlinkFreeNodes((yyvsp[(2) - (3)].idList));
-	free(data);
-;}
+  case 10: /* ProcedureHead: FunctionDecl  */
+#line 168 "CminusParser.y"
+                 {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1362 "CminusParser.c"
     break;
 
-  case 12:
-
-/* Line 1455 of yacc.c  */
-#line 167 "CminusParser.y"
-    {
-	AddIdStructPtr data = (AddIdStructPtr)malloc(sizeof(AddIdStruct));
-	data->offset = (yyvsp[(1) - (4)].offset);
-	data->typeIndex = (yyvsp[(2) - (4)].symIndex);
-	data->symtab = symtab;
-	dlinkApply1((yyvsp[(3) - (4)].idList),(DLinkApply1Func)addIdToSymtab,(Generic)data);
-	(yyval.offset) = data->offset;
-	dlinkFreeNodes((yyvsp[(3) - (4)].idList));
-	free(data);
-;}
+  case 11: /* FunctionDecl: Type IDENTIFIER LPAREN RPAREN LBRACE  */
+#line 172 "CminusParser.y"
+                                                    {
+	(yyval.node) = NODE(AST_FUNCTION,(yyvsp[-3].name),AST_NULL,AST_NULL,AST_NULL);
+	free((yyvsp[-3].name));
+}
+#line 1371 "CminusParser.c"
     break;
 
-  case 13:
-
-/* Line 1455 of yacc.c  */
-#line 178 "CminusParser.y"
-    {
-	(yyval.idList) = dlinkListAlloc(NULL);
-	dlinkAppend((yyval.idList),dlinkNodeAlloc((Generic)(yyvsp[(1) - (1)].symIndex)));
-;}
+  case 12: /* ProcedureBody: StatementList RBRACE  */
+#line 177 "CminusParser.y"
+                                     {
+	(yyval.node) = (yyvsp[-1].list).head;
+}
+#line 1379 "CminusParser.c"
     break;
 
-  case 14:
-
-/* Line 1455 of yacc.c  */
+  case 13: /* DeclList: Type IdentifierList SEMICOLON  */
 #line 181 "CminusParser.y"
-    {
-	dlinkAppend((yyvsp[(1) - (3)].idList),dlinkNodeAlloc((Generic)(yyvsp[(3) - (3)].symIndex)));
-	(yyval.idList) = (yyvsp[(1) - (3)].idList);
-;}
+                                         {
+	AstIndex decl = NODE(AST_DECL,NULL,(yyvsp[-1].list).head,AST_NULL,AST_NULL);
+	AST_NODE(programAst,decl)->type = (yyvsp[-2].type);
+	(yyval.list) = astListStart(programAst,decl);
+}
+#line 1389 "CminusParser.c"
     break;
 
-  case 15:
-
-/* Line 1455 of yacc.c  */
-#line 186 "CminusParser.y"
-    {
-	(yyval.symIndex) = SymIndex(symtab,(yyvsp[(1) - (1)].name));
-;}
+  case 14: /* DeclList: DeclList Type IdentifierList SEMICOLON  */
+#line 185 "CminusParser.y"
+                                           {
+	AstIndex decl = NODE(AST_DECL,NULL,(yyvsp[-1].list).head,AST_NULL,AST_NULL);
+	AST_NODE(programAst,decl)->type = (yyvsp[-2].type);
+	(yyval.list) = astListAppend(programAst,(yyvsp[-3].list),decl);
+}
+#line 1399 "CminusParser.c"
     break;
 
-  case 16:
-
-/* Line 1455 of yacc.c  */
-#line 188 "CminusParser.y"
-    {
-	int symIndex = SymIndex(symtab,(yyvsp[(3) - (4)].name));
-	char* numElemString = (char*)SymGetFieldByIndex(symtab,symIndex,SYM_NAME_FIELD);
-		
-	char* typeString = nssave(4,SYMTAB_VOID_TYPE_STRING,"[",numElemString,"]");
-		
-	int typeIndex = SymIndex(symtab,typeString);
-	SymPutFieldByIndex(symtab,typeIndex,SYMTAB_BASIC_TYPE_FIELD,(Generic)VOID_TYPE);
-	
-	int numElements = atoi(numElemString);
-	SymPutFieldByIndex(symtab,typeIndex,SYMTAB_SIZE_FIELD,(Generic)(VOID_SIZE*numElements));
-					   
-	sfree(typeString);
-
-	symIndex = SymIndex(symtab,(yyvsp[(1) - (4)].name));
-    SymPutFieldByIndex(symtab,symIndex,SYMTAB_TYPE_INDEX_FIELD,(Generic)typeIndex);
-
-	(yyval.symIndex) = symIndex;		  
-;}
-    break;
-
-  case 17:
-
-/* Line 1455 of yacc.c  */
-#line 208 "CminusParser.y"
-    {
-    (yyval.symIndex) = SymQueryIndex(symtab,SYMTAB_INTEGER_TYPE_STRING);
-;}
+  case 15: /* IdentifierList: VarDecl  */
+#line 191 "CminusParser.y"
+                         {
+	(yyval.list) = astListStart(programAst,(yyvsp[0].node));
+}
+#line 1407 "CminusParser.c"
     break;
 
-  case 19:
-
-/* Line 1455 of yacc.c  */
-#line 212 "CminusParser.y"
-    {
-	
-;}
+  case 16: /* IdentifierList: IdentifierList COMMA VarDecl  */
+#line 193 "CminusParser.y"
+                                 {
+	(yyval.list) = astListAppend(programAst,(yyvsp[-2].list),(yyvsp[0].node));
+}
+#line 1415 "CminusParser.c"
     break;
 
-  case 20:
-
-/* Line 1455 of yacc.c  */
-#line 214 "CminusParser.y"
-    {
-	
-;}
+  case 17: /* VarDecl: IDENTIFIER  */
+#line 197 "CminusParser.y"
+                     {
+	(yyval.node) = NODE(AST_VAR,(yyvsp[0].name),AST_NULL,AST_NULL,AST_NULL);
+	free((yyvsp[0].name));
+}
+#line 1424 "CminusParser.c"
     break;
 
-  case 21:
-
-/* Line 1455 of yacc.c  */
-#line 216 "CminusParser.y"
-    {
-	
-;}
+  case 18: /* VarDecl: IDENTIFIER LBRACKET INTCON RBRACKET  */
+#line 200 "CminusParser.y"
+                                        {
+	AstIndex size = NODE(AST_CONST,(yyvsp[-1].name),AST_NULL,AST_NULL,AST_NULL);
+	(yyval.node) = NODE(AST_ARRAY,(yyvsp[-3].name),size,AST_NULL,AST_NULL);
+	free((yyvsp[-3].name));
+	free((yyvsp[-1].name));
+}
+#line 1435 "CminusParser.c"
     break;
 
-  case 22:
-
-/* Line 1455 of yacc.c  */
-#line 218 "CminusParser.y"
-    {
-	
-;}
+  case 19: /* Type: INTEGER  */
+#line 207 "CminusParser.y"
+               {
+	(yyval.type) = AST_TYPE_INTEGER;
+}
+#line 1443 "CminusParser.c"
     break;
 
-  case 23:
-
-/* Line 1455 of yacc.c  */
-#line 220 "CminusParser.y"
-    {
-	emitReturnFunction(instList, lastSymtab(symstack), symtab, (yyvsp[(1) - (1)].symIndex));
-;}
+  case 20: /* Type: FLOAT  */
+#line 209 "CminusParser.y"
+          {
+	(yyval.type) = AST_TYPE_FLOAT;
+}
+#line 1451 "CminusParser.c"
     break;
 
-  case 24:
-
-/* Line 1455 of yacc.c  */
-#line 222 "CminusParser.y"
-    {
-	
-;}
+  case 21: /* Statement: Assignment  */
+#line 213 "CminusParser.y"
+                       {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1459 "CminusParser.c"
     break;
 
-  case 25:
-
-/* Line 1455 of yacc.c  */
-#line 224 "CminusParser.y"
-    {
-	
-;}
+  case 22: /* Statement: IfStatement  */
+#line 215 "CminusParser.y"
+                {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1467 "CminusParser.c"
     break;
 
-  case 26:
-
-/* Line 1455 of yacc.c  */
-#line 228 "CminusParser.y"
-    {
-	emitAssignment(instList,lastSymtab(symstack),symtab,(yyvsp[(1) - (4)].symIndex),(yyvsp[(3) - (4)].symIndex));
-;}
+  case 23: /* Statement: WhileStatement  */
+#line 217 "CminusParser.y"
+                   {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1475 "CminusParser.c"
     break;
 
-  case 27:
-
-/* Line 1455 of yacc.c  */
-#line 232 "CminusParser.y"
-    {
-	emitEndBranchTarget(instList,symtab,(yyvsp[(2) - (4)].symIndex));
-;}
+  case 24: /* Statement: IOStatement  */
+#line 219 "CminusParser.y"
+                {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1483 "CminusParser.c"
     break;
 
-  case 28:
-
-/* Line 1455 of yacc.c  */
-#line 234 "CminusParser.y"
-    {
-	emitEndBranchTarget(instList,symtab,(yyvsp[(2) - (2)].symIndex));
-;}
+  case 25: /* Statement: ReturnStatement  */
+#line 221 "CminusParser.y"
+                    {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1491 "CminusParser.c"
     break;
 
-  case 29:
-
-/* Line 1455 of yacc.c  */
-#line 238 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitThenBranch(instList,symtab,(yyvsp[(1) - (2)].symIndex));
-;}
+  case 26: /* Statement: ExitStatement  */
+#line 223 "CminusParser.y"
+                  {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1499 "CminusParser.c"
     break;
 
-  case 30:
+  case 27: /* Statement: CompoundStatement  */
+#line 225 "CminusParser.y"
+                      {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1507 "CminusParser.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 242 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitIfTest(instList,symtab,(yyvsp[(2) - (3)].symIndex));
-;}
+  case 28: /* Assignment: Variable ASSIGN Expr SEMICOLON  */
+#line 229 "CminusParser.y"
+                                            {
+	(yyval.node) = NODE(AST_ASSIGN,NULL,(yyvsp[-3].node),(yyvsp[-1].node),AST_NULL);
+}
+#line 1515 "CminusParser.c"
     break;
 
-  case 31:
+  case 29: /* IfStatement: IF TestAndThen ELSE CompoundStatement  */
+#line 233 "CminusParser.y"
+                                                        {
+	AST_KID(programAst,(yyvsp[-2].node),2) = (yyvsp[0].node);
+	(yyval.node) = (yyvsp[-2].node);
+}
+#line 1524 "CminusParser.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 246 "CminusParser.y"
-    {
-	emitWhileLoopBackBranch(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(2) - (3)].symIndex));
-;}
+  case 30: /* IfStatement: IF TestAndThen  */
+#line 236 "CminusParser.y"
+                   {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1532 "CminusParser.c"
     break;
 
-  case 32:
+  case 31: /* TestAndThen: Test CompoundStatement  */
+#line 240 "CminusParser.y"
+                                         {
+	(yyval.node) = NODE(AST_IF,NULL,(yyvsp[-1].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1540 "CminusParser.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 250 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitWhileLoopTest(instList,symtab,(yyvsp[(2) - (3)].symIndex));
-;}
+  case 32: /* Test: LPAREN Expr RPAREN  */
+#line 244 "CminusParser.y"
+                          {
+	(yyval.node) = (yyvsp[-1].node);
+}
+#line 1548 "CminusParser.c"
     break;
 
-  case 33:
+  case 33: /* WhileStatement: WhileToken WhileExpr Statement  */
+#line 248 "CminusParser.y"
+                                                {
+	(yyval.node) = NODE(AST_WHILE,NULL,(yyvsp[-1].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1556 "CminusParser.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 254 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitWhileLoopLandingPad(instList,symtab);
-;}
+  case 34: /* WhileExpr: LPAREN Expr RPAREN  */
+#line 252 "CminusParser.y"
+                               {
+	(yyval.node) = (yyvsp[-1].node);
+}
+#line 1564 "CminusParser.c"
     break;
 
-  case 34:
+  case 35: /* WhileToken: WHILE  */
+#line 256 "CminusParser.y"
+                   {
 
-/* Line 1455 of yacc.c  */
-#line 258 "CminusParser.y"
-    {
-	emitReadVariable(instList,symtab,(yyvsp[(3) - (5)].symIndex));
-;}
+}
+#line 1572 "CminusParser.c"
     break;
 
-  case 35:
-
-/* Line 1455 of yacc.c  */
+  case 36: /* IOStatement: READ LPAREN Variable RPAREN SEMICOLON  */
 #line 260 "CminusParser.y"
-    {
-	emitWriteExpression(instList,symtab,(yyvsp[(3) - (5)].symIndex),SYSCALL_PRINT_INTEGER);
-;}
+                                                    {
+	(yyval.node) = NODE(AST_READ,NULL,(yyvsp[-2].node),AST_NULL,AST_NULL);
+}
+#line 1580 "CminusParser.c"
     break;
 
-  case 36:
-
-/* Line 1455 of yacc.c  */
+  case 37: /* IOStatement: WRITE LPAREN Expr RPAREN SEMICOLON  */
 #line 262 "CminusParser.y"
-    {
-	emitWriteExpression(instList,symtab,(yyvsp[(3) - (5)].symIndex),SYSCALL_PRINT_STRING);
-;}
+                                       {
+	(yyval.node) = NODE(AST_WRITE,NULL,(yyvsp[-2].node),AST_NULL,AST_NULL);
+}
+#line 1588 "CminusParser.c"
     break;
 
-  case 37:
-
-/* Line 1455 of yacc.c  */
-#line 266 "CminusParser.y"
-    {
-	(yyval.symIndex) = (yyvsp[(2) - (3)].symIndex);
-;}
+  case 38: /* IOStatement: WRITE LPAREN StringConstant RPAREN SEMICOLON  */
+#line 264 "CminusParser.y"
+                                                 {
+	(yyval.node) = NODE(AST_WRITE,NULL,(yyvsp[-2].node),AST_NULL,AST_NULL);
+}
+#line 1596 "CminusParser.c"
     break;
 
-  case 38:
-
-/* Line 1455 of yacc.c  */
-#line 270 "CminusParser.y"
-    {
-	emitExit(instList);
-;}
+  case 39: /* ReturnStatement: RETURN Expr SEMICOLON  */
+#line 268 "CminusParser.y"
+                                        {
+	(yyval.node) = NODE(AST_RETURN,NULL,(yyvsp[-1].node),AST_NULL,AST_NULL);
+}
+#line 1604 "CminusParser.c"
     break;
 
-  case 39:
-
-/* Line 1455 of yacc.c  */
-#line 274 "CminusParser.y"
-    {
-	
-;}
+  case 40: /* ExitStatement: EXIT SEMICOLON  */
+#line 272 "CminusParser.y"
+                               {
+	(yyval.node) = NODE(AST_EXIT,NULL,AST_NULL,AST_NULL,AST_NULL);
+}
+#line 1612 "CminusParser.c"
     break;
 
-  case 40:
-
-/* Line 1455 of yacc.c  */
-#line 278 "CminusParser.y"
-    {
-	
-;}
+  case 41: /* CompoundStatement: LBRACE StatementList RBRACE  */
+#line 276 "CminusParser.y"
+                                                {
+	(yyval.node) = NODE(AST_BLOCK,NULL,(yyvsp[-1].list).head,AST_NULL,AST_NULL);
+}
+#line 1620 "CminusParser.c"
     break;
 
-  case 41:
-
-/* Line 1455 of yacc.c  */
+  case 42: /* StatementList: Statement  */
 #line 280 "CminusParser.y"
-    {
-
-;}
+                          {
+	(yyval.list) = astListStart(programAst,(yyvsp[0].node));
+}
+#line 1628 "CminusParser.c"
     break;
 
-  case 42:
-
-/* Line 1455 of yacc.c  */
-#line 284 "CminusParser.y"
-    {
-	(yyval.symIndex) = (yyvsp[(1) - (1)].symIndex);
-;}
+  case 43: /* StatementList: StatementList Statement  */
+#line 282 "CminusParser.y"
+                            {
+	(yyval.list) = astListAppend(programAst,(yyvsp[-1].list),(yyvsp[0].node));
+}
+#line 1636 "CminusParser.c"
     break;
 
-  case 43:
-
-/* Line 1455 of yacc.c  */
+  case 44: /* Expr: SimpleExpr  */
 #line 286 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitOrExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                  {
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1644 "CminusParser.c"
     break;
 
-  case 44:
-
-/* Line 1455 of yacc.c  */
+  case 45: /* Expr: Expr OR SimpleExpr  */
 #line 288 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitAndExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                       {
+	(yyval.node) = NODE(AST_OR,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1652 "CminusParser.c"
     break;
 
-  case 45:
-
-/* Line 1455 of yacc.c  */
+  case 46: /* Expr: Expr AND SimpleExpr  */
 #line 290 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitNotExpression(instList,symtab,(yyvsp[(2) - (2)].symIndex));
-;}
+                        {
+	(yyval.node) = NODE(AST_AND,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1660 "CminusParser.c"
     break;
 
-  case 46:
-
-/* Line 1455 of yacc.c  */
-#line 294 "CminusParser.y"
-    {
-	(yyval.symIndex) = (yyvsp[(1) - (1)].symIndex); 
-;}
+  case 47: /* Expr: NOT SimpleExpr  */
+#line 292 "CminusParser.y"
+                   {
+	(yyval.node) = NODE(AST_NOT,NULL,(yyvsp[0].node),AST_NULL,AST_NULL);
+}
+#line 1668 "CminusParser.c"
     break;
 
-  case 47:
-
-/* Line 1455 of yacc.c  */
+  case 48: /* SimpleExpr: AddExpr  */
 #line 296 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitEqualExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                     {
+	(yyval.node) = (yyvsp[0].node); 
+}
+#line 1676 "CminusParser.c"
     break;
 
-  case 48:
-
-/* Line 1455 of yacc.c  */
+  case 49: /* SimpleExpr: SimpleExpr EQ AddExpr  */
 #line 298 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitNotEqualExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_EQ,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1684 "CminusParser.c"
     break;
 
-  case 49:
-
-/* Line 1455 of yacc.c  */
+  case 50: /* SimpleExpr: SimpleExpr NE AddExpr  */
 #line 300 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitLessEqualExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_NE,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1692 "CminusParser.c"
     break;
 
-  case 50:
-
-/* Line 1455 of yacc.c  */
+  case 51: /* SimpleExpr: SimpleExpr LE AddExpr  */
 #line 302 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitLessThanExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_LE,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1700 "CminusParser.c"
     break;
 
-  case 51:
-
-/* Line 1455 of yacc.c  */
+  case 52: /* SimpleExpr: SimpleExpr LT AddExpr  */
 #line 304 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitGreaterEqualExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_LT,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1708 "CminusParser.c"
     break;
 
-  case 52:
-
-/* Line 1455 of yacc.c  */
+  case 53: /* SimpleExpr: SimpleExpr GE AddExpr  */
 #line 306 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitGreaterThanExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_GE,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1716 "CminusParser.c"
     break;
 
-  case 53:
-
-/* Line 1455 of yacc.c  */
-#line 310 "CminusParser.y"
-    {
-	(yyval.symIndex) = (yyvsp[(1) - (1)].symIndex); 
-;}
+  case 54: /* SimpleExpr: SimpleExpr GT AddExpr  */
+#line 308 "CminusParser.y"
+                          {
+	(yyval.node) = NODE(AST_GT,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1724 "CminusParser.c"
     break;
 
-  case 54:
-
-/* Line 1455 of yacc.c  */
+  case 55: /* AddExpr: MulExpr  */
 #line 312 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitAddExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                  {
+	(yyval.node) = (yyvsp[0].node); 
+}
+#line 1732 "CminusParser.c"
     break;
 
-  case 55:
-
-/* Line 1455 of yacc.c  */
+  case 56: /* AddExpr: AddExpr PLUS MulExpr  */
 #line 314 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitSubtractExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_ADD,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1740 "CminusParser.c"
     break;
 
-  case 56:
-
-/* Line 1455 of yacc.c  */
-#line 318 "CminusParser.y"
-    {
-	(yyval.symIndex) = (yyvsp[(1) - (1)].symIndex); 
-;}
+  case 57: /* AddExpr: AddExpr MINUS MulExpr  */
+#line 316 "CminusParser.y"
+                           {
+	(yyval.node) = NODE(AST_SUB,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1748 "CminusParser.c"
     break;
 
-  case 57:
-
-/* Line 1455 of yacc.c  */
+  case 58: /* MulExpr: Factor  */
 #line 320 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitMultiplyExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                 {
+	(yyval.node) = (yyvsp[0].node); 
+}
+#line 1756 "CminusParser.c"
     break;
 
-  case 58:
-
-/* Line 1455 of yacc.c  */
+  case 59: /* MulExpr: MulExpr TIMES Factor  */
 #line 322 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitDivideExpression(instList,symtab,(yyvsp[(1) - (3)].symIndex),(yyvsp[(3) - (3)].symIndex));
-;}
+                          {
+	(yyval.node) = NODE(AST_MUL,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1764 "CminusParser.c"
     break;
 
-  case 59:
-
-/* Line 1455 of yacc.c  */
-#line 326 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitLoadVariable(instList, lastSymtab(symstack), symtab, (yyvsp[(1) - (1)].symIndex));
-;}
+  case 60: /* MulExpr: MulExpr DIVIDE Factor  */
+#line 324 "CminusParser.y"
+                           {
+	(yyval.node) = NODE(AST_DIV,NULL,(yyvsp[-2].node),(yyvsp[0].node),AST_NULL);
+}
+#line 1772 "CminusParser.c"
     break;
 
-  case 60:
-
-/* Line 1455 of yacc.c  */
+  case 61: /* Factor: Variable  */
 #line 328 "CminusParser.y"
-    { 
-	(yyval.symIndex) = (yyvsp[(1) - (1)].symIndex);
-;}
+                  {
+	(yyval.node) = NODE(AST_LOAD,NULL,(yyvsp[0].node),AST_NULL,AST_NULL);
+}
+#line 1780 "CminusParser.c"
     break;
 
-  case 61:
-
-/* Line 1455 of yacc.c  */
+  case 62: /* Factor: Constant  */
 #line 330 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitCallFunction(instList,symtab,(yyvsp[(1) - (3)].name));
-;}
+             { 
+	(yyval.node) = (yyvsp[0].node);
+}
+#line 1788 "CminusParser.c"
     break;
 
-  case 62:
-
-/* Line 1455 of yacc.c  */
+  case 63: /* Factor: IDENTIFIER LPAREN RPAREN  */
 #line 332 "CminusParser.y"
-    {
-	(yyval.symIndex) = (yyvsp[(2) - (3)].symIndex);
-;}
+                             {
+	(yyval.node) = NODE(AST_CALL,(yyvsp[-2].name),AST_NULL,AST_NULL,AST_NULL);
+	free((yyvsp[-2].name));
+}
+#line 1797 "CminusParser.c"
     break;
 
-  case 63:
-
-/* Line 1455 of yacc.c  */
-#line 336 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitComputeVarAddress(instList,lastSymtab(symstack), symtab, (yyvsp[(1) - (1)].name));
-;}
+  case 64: /* Factor: LPAREN Expr RPAREN  */
+#line 335 "CminusParser.y"
+                       {
+	(yyval.node) = (yyvsp[-1].node);
+}
+#line 1805 "CminusParser.c"
     break;
 
-  case 64:
-
-/* Line 1455 of yacc.c  */
-#line 338 "CminusParser.y"
-    {
-	(yyval.symIndex) = emitComputeArrayAddress(instList,lastSymtab(symstack),symtab,(yyvsp[(1) - (4)].name),(yyvsp[(3) - (4)].symIndex));
-;}
+  case 65: /* Variable: IDENTIFIER  */
+#line 339 "CminusParser.y"
+                      {
+	(yyval.node) = NODE(AST_VAR_ADDR,(yyvsp[0].name),AST_NULL,AST_NULL,AST_NULL);
+	free((yyvsp[0].name));
+}
+#line 1814 "CminusParser.c"
     break;
 
-  case 65:
-
-/* Line 1455 of yacc.c  */
+  case 66: /* Variable: IDENTIFIER LBRACKET Expr RBRACKET  */
 #line 342 "CminusParser.y"
-    {
-	int symIndex = SymIndex(symtab,(yyvsp[(1) - (1)].name));
-	(yyval.symIndex) = emitLoadStringConstantAddress(instList,dataList,symtab,symIndex);
-;}
+                                      {
+	(yyval.node) = NODE(AST_ARRAY_ADDR,(yyvsp[-3].name),(yyvsp[-1].node),AST_NULL,AST_NULL);
+	free((yyvsp[-3].name));
+}
+#line 1823 "CminusParser.c"
     break;
 
-  case 66:
-
-/* Line 1455 of yacc.c  */
+  case 67: /* StringConstant: STRING  */
 #line 347 "CminusParser.y"
-    { 
-	int symIndex = SymIndex(symtab,(yyvsp[(1) - (1)].name));
-	(yyval.symIndex) = emitLoadIntegerConstant(instList,symtab,symIndex);
-;}
+                        {
+	(yyval.node) = NODE(AST_STRING,(yyvsp[0].name),AST_NULL,AST_NULL,AST_NULL);
+	free((yyvsp[0].name));
+}
+#line 1832 "CminusParser.c"
+    break;
+
+  case 68: /* Constant: INTCON  */
+#line 352 "CminusParser.y"
+                  { 
+	(yyval.node) = NODE(AST_CONST,(yyvsp[0].name),AST_NULL,AST_NULL,AST_NULL);
+	free((yyvsp[0].name));
+}
+#line 1841 "CminusParser.c"
     break;
 
 
+#line 1845 "CminusParser.c"
 
-/* Line 1455 of yacc.c  */
-#line 2157 "CminusParser.c"
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -2254,14 +1919,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2274,39 +1938,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2317,126 +1984,578 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined(yyoverflow) || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval);
-  /* Do not reclaim the symbols of the rule which action triggered
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
-
 
+  return yyresult;
+}
 
-/* Line 1675 of yacc.c  */
-#line 352 "CminusParser.y"
+#line 357 "CminusParser.y"
 
 
 
 /********************C ROUTINES *********************************/
 
 void Cminus_error(char *s) {
-  fprintf(stderr,"%s: line %d: %s\n",fileName,Cminus_lineno,s);
+  fprintf(stderr,"%s: line %d: %s\n",fileName,lowerLineno ? lowerLineno : Cminus_lineno,s);
 }
 
 int Cminus_wrap() {
 	return 1;
 }
 
-static void initSymStack() {
-	symstack = symtabStackInit();
+/**
+ * Compile a program, printing its assembly code to stdout. The state of the
+ * compiler is reset so that any number of programs can be compiled in turn.
+ *
+ * @param name the name of the program used in diagnostics
+ * @param input the source of the program
+ * @param jobs the number of threads to generate code on
+ * @return the result of the parse
+ */
+static int compileStream(char *name, FILE *input, int jobs) {
+	fileName = name;
+	Cminus_lineno = 1;
+	Cminus_restart(input);
+	astReset(programAst);
+
+	int status = Cminus_parse();
+	if (status == 0)
+		lowerProgram(programAst,jobs);
+
+	return status;
+}
+
+/**
+ * Start the assembler reading from a pipe.
+ *
+ * @param objectFileName the object file the assembler writes
+ * @param pid receives the process id of the assembler
+ * @return a stream feeding the assembler, or NULL if it could not be started
+ */
+static FILE *startAssembler(char *objectFileName, pid_t *pid) {
+	char *argv[] = {ASSEMBLER, "--64", "-o", objectFileName, NULL};
+	posix_spawn_file_actions_t actions;
+	int fds[2];
+
+	if (pipe(fds) != 0) {
+		fprintf(stderr,"Error: Could not create a pipe: %s\n",strerror(errno));
+		return NULL;
+	}
+
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions,fds[0],0);
+	posix_spawn_file_actions_addclose(&actions,fds[0]);
+	posix_spawn_file_actions_addclose(&actions,fds[1]);
+	int error = posix_spawnp(pid,ASSEMBLER,&actions,NULL,argv,environ);
+	posix_spawn_file_actions_destroy(&actions);
+	close(fds[0]);
+
+	if (error != 0) {
+		fprintf(stderr,"Error: Could not run %s: %s\n",ASSEMBLER,strerror(error));
+		close(fds[1]);
+		return NULL;
+	}
+
+	return fdopen(fds[1],"w");
+}
+
+/**
+ * Compile one file and assemble it with the built-in encoder, which encodes
+ * each function as it is generated and takes the place of stdout for the
+ * rest.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param input the open file
+ * @param objectFileName the object file to write
+ * @param jobs the number of threads to generate code on
+ * @return false if the file could not be parsed, or the code could not be
+ * 	   assembled or written; no object file is written if it does not parse
+ */
+static bool compileToObjectBuiltin(char *inputFileName, FILE *input, char *objectFileName, int jobs) {
+	FILE *savedStdout = stdout;
+	Encoder encoder = encoderNew();
+
+	stdout = encoderOpenStream(encoder);
+	lowerUseEncoder(encoder);
+	int status = compileStream(inputFileName,input,jobs);
+	lowerUseEncoder(NULL);
+	fclose(stdout);
+	stdout = savedStdout;
+
+	bool ok = status == 0 && encoderWriteObject(encoder,objectFileName);
+	encoderFree(encoder);
+	return ok;
+}
+
+/**
+ * Compile one file into memory and call its main function in this process,
+ * without an assembler, a linker or any files. The program's output goes to
+ * stdout and its input comes from stdin.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param jobs the number of threads to generate code on
+ * @return the value main returns, or -1 if the program could not be compiled or loaded
+ */
+static int runFile(char *inputFileName, int jobs) {
+	FILE *input = fopen(inputFileName,"r");
+	if (input == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
+		return -1;
+	}
+
+	FILE *savedStdout = stdout;
+	Encoder encoder = encoderNew();
+	stdout = encoderOpenStream(encoder);
+	lowerUseEncoder(encoder);
+	int status = compileStream(inputFileName,input,jobs);
+	lowerUseEncoder(NULL);
+	fclose(stdout);
+	stdout = savedStdout;
+	fclose(input);
+
+	int result = -1;
+	if (status == 0 && encoderLoad(encoder)) {
+		FUNCTION_POINTER(int, entry, (void)) = (int(*)(void))encoderAddress(encoder,"main");
+		if (entry == NULL)
+			fprintf(stderr,"Error: %s has no main function\n",inputFileName);
+		else {
+			result = entry();
+			fflush(stdout);
+		}
+	}
+
+	encoderFree(encoder);
+	return result;
+}
+
+/**
+ * Parse one file and run it in the tiered engine, which interprets each
+ * function until it is hot and only then compiles it.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @return the value main returns, or -1 if the program could not be parsed or run
+ */
+static int tierFile(char *inputFileName) {
+	FILE *input = fopen(inputFileName,"r");
+	if (input == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
+		return -1;
+	}
+
+	fileName = inputFileName;
+	Cminus_lineno = 1;
+	Cminus_restart(input);
+	astReset(programAst);
+	int status = Cminus_parse();
+	fclose(input);
+
+	return status == 0 ? tierRun(programAst,inputFileName,hotCount,tierStats) : -1;
 }
 
-static void initSymTable() {
-	symtab = beginScope(symstack);
+/**
+ * Parse one file and compile it to bytecode.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @return the program, or NULL if it could not be parsed or compiled
+ */
+static VmProgram compileBytecode(char *inputFileName) {
+	FILE *input = fopen(inputFileName,"r");
+	if (input == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
+		return NULL;
+	}
+
+	fileName = inputFileName;
+	Cminus_lineno = 1;
+	Cminus_restart(input);
+	astReset(programAst);
+	int status = Cminus_parse();
+	fclose(input);
+
+	return status == 0 ? vmCompile(programAst) : NULL;
 }
 
-static void deleteSymTable() {
-	while (stackSize(symstack) > 0) {
-		symtab = endScope(symstack);
-	    SymKillField(symtab,SYMTAB_REGISTER_INDEX_FIELD);
-	    SymKillField(symtab,SYMTAB_OFFSET_FIELD);
-	    SymKill(symtab);
+/**
+ * Run a program in the bytecode interpreter, which needs no assembler and
+ * generates no native code. A .cmb file is a bytecode image, which is
+ * mapped and run without the front end; any other file is a Cminus file.
+ * With --batch the program is loaded once and run for each input file on
+ * a number of threads.
+ *
+ * @param inputFileName the name of a Cminus file or a bytecode image
+ * @param inputs the input files of a batch
+ * @param numInputs the number of input files
+ * @param jobs the number of threads to run a batch on
+ * @return the value main returns, or -1 if the program could not be compiled or run
+ */
+static int interpFile(char *inputFileName, char **inputs, int numInputs, int jobs) {
+	char *dotChar = rindex(inputFileName,'.');
+	bool isImage = dotChar != NULL && strcmp(dotChar,".cmb") == 0;
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC,&start);
+	VmProgram program = isImage ? vmMapImage(inputFileName) : compileBytecode(inputFileName);
+	if (program == NULL)
+		return -1;
+	clock_gettime(CLOCK_MONOTONIC,&end);
+	if (interpStats)
+		fprintf(stderr,"%s loaded in %ld us\n",inputFileName,
+			(end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000);
+	int result = interpBatch ? vmRunBatch(program,inputFileName,inputs,numInputs,jobs,interpFuse,interpStats) :
+		vmRun(program,inputFileName,interpFuse,interpStats,interpProfile);
+	vmFree(program);
+	return result;
+}
+
+/**
+ * Compile one file to bytecode and write it as a bytecode image for
+ * cmc --interp to run.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param imageFileName the image to write
+ * @return 0, or -1 if the file could not be compiled or the image written
+ */
+static int emitBytecodeFile(char *inputFileName, char *imageFileName) {
+	VmProgram program = compileBytecode(inputFileName);
+	if (program == NULL)
+		return -1;
+	bool ok = vmWriteImage(program,imageFileName);
+	vmFree(program);
+	return ok ? 0 : -1;
+}
+
+/**
+ * Compile one file and assemble it in a pipe, so that the assembler works on
+ * each function while the next one is generated and no .s file is written.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param input the open file
+ * @param objectFileName the object file to write
+ * @param jobs the number of threads to generate code on
+ * @return false if the file could not be parsed, or the assembler could not
+ * 	   be run or failed; the object file is then removed
+ */
+static bool compileToObject(char *inputFileName, FILE *input, char *objectFileName, int jobs) {
+	FILE *savedStdout = stdout;
+	pid_t pid;
+	int status;
+
+	FILE *assembler = startAssembler(objectFileName,&pid);
+	if (assembler == NULL)
+		return false;
+
+	stdout = assembler;
+	int parseStatus = compileStream(inputFileName,input,jobs);
+	fclose(assembler);
+	stdout = savedStdout;
+
+	if (waitpid(pid,&status,0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr,"Error: %s failed on the code for %s\n",ASSEMBLER,inputFileName);
+		unlink(objectFileName);
+		return false;
+	}
+	if (parseStatus != 0) {
+		unlink(objectFileName);
+		return false;
 	}
+	return true;
 }
 
-static void initialize(char* inputFileName) {
-	stdin = freopen(inputFileName,"r", stdin);
-    if (stdin == NULL) {
+/**
+ * Compile one file. Without -o the output goes to a .s or, with -c, a .o file
+ * of the same name as the input.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param jobs the number of threads to generate code on
+ * @return false if the file could not be opened, parsed or assembled
+ */
+static bool compileFile(char* inputFileName, int jobs) {
+	FILE *input = fopen(inputFileName,"r");
+    if (input == NULL) {
     	fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
-    	exit(-1);
+    	return false;
     }
 
-	char* dotChar = rindex(inputFileName,'.');
-	int endIndex = strlen(inputFileName) - strlen(dotChar);
-	char *outputFileName = nssave(2,substr(inputFileName,0,endIndex),".s");
-	stdout = freopen(outputFileName,"w", stdout);
-    if (stdout == NULL) {
-    	fprintf(stderr,"Error: Could not open file %s\n",outputFileName);
-    	exit(-1);
-	} 
+	char *outputFileName;
+	if (outputName != NULL)
+		outputFileName = ssave(outputName);
+	else {
+		char* dotChar = rindex(inputFileName,'.');
+		int endIndex = strlen(inputFileName) - strlen(dotChar);
+		char *baseName = substr(inputFileName,0,endIndex);
+		outputFileName = nssave(2,baseName,emitObject ? ".o" : ".s");
+		sfree(baseName);
+	}
+
+	bool ok = true;
+	if (emitObject && useAssembler)
+		ok = compileToObject(inputFileName,input,outputFileName,jobs);
+	else if (emitObject)
+		ok = compileToObjectBuiltin(inputFileName,input,outputFileName,jobs);
+	else {
+		if (strcmp(outputFileName,"-") != 0) {
+			stdout = freopen(outputFileName,"w", stdout);
+			if (stdout == NULL) {
+				fprintf(stderr,"Error: Could not open file %s\n",outputFileName);
+				exit(-1);
+			}
+		}
+		ok = compileStream(inputFileName,input,jobs) == 0;
+	}
 
-    initSymStack();
-	initSymTable();
-	initRegisters();
+	sfree(outputFileName);
+	fclose(input);
+	return ok;
+}
 
-	instList = dlinkListAlloc(NULL);
-	dataList = dlinkListAlloc(NULL);
+/**
+ * Compile every workers-th file, starting with the first.
+ *
+ * @param files the names of the files
+ * @param numFiles the number of files
+ * @param first the first file to compile
+ * @param workers the distance between files
+ * @param jobs the number of threads to generate code on
+ * @return 0 if all files could be compiled
+ */
+static int compileFiles(char **files, int numFiles, int first, int workers, int jobs) {
+	int i, status = 0;
+
+	for (i = first; i < numFiles; i += workers)
+		if (!compileFile(files[i],jobs))
+			status = -1;
+
+	return status;
 }
 
-static void finalize() {
-    fclose(stdin);
+/**
+ * Compile files in forked worker processes. The parser and scanner keep their
+ * state in globals, so workers are processes rather than threads.
+ *
+ * @param files the names of the files
+ * @param numFiles the number of files
+ * @param workers the number of processes
+ * @param jobs the number of threads to generate code on in each process
+ * @return 0 if all workers succeeded
+ */
+static int compileFilesInWorkers(char **files, int numFiles, int workers, int jobs) {
+	int i, status = 0, childStatus;
+
+	fflush(stdout);
+	fflush(stderr);
+	for (i = 0; i < workers; i++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			status = compileFiles(files,numFiles,i,workers,jobs);
+			if (codeCache != NULL && cacheStats)
+				cachePrintStatistics(codeCache);
+			exit(status == 0 ? 0 : 1);
+		}
+		if (pid < 0) {
+			fprintf(stderr,"Error: Could not start worker %d\n",i);
+			status = -1;
+			workers = i;
+		}
+	}
+
+	for (i = 0; i < workers; i++)
+		if (wait(&childStatus) < 0 || !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0)
+			status = -1;
 
-    deleteSymTable();
-    cleanupRegisters();
-    
-    dlinkFreeNodesAndAtoms(instList);
-    dlinkFreeNodesAndAtoms(dataList);
+	return status;
+}
+
+static void usage(char *progName) {
+	fprintf(stderr,"Usage: %s [-S | -c [--as]] [-o output] [-j jobs] [-w workers] [--no-peephole] [--no-promote] [--no-fold] [--cache dir [--cache-stats]] file.cm ...\n",progName);
+	fprintf(stderr,"       %s [-j jobs] [--no-peephole] [--no-promote] [--no-fold] --run file.cm\n",progName);
+	fprintf(stderr,"       %s --tier [--hot count] [--tier-stats] [--no-peephole] [--no-promote] [--no-fold] file.cm\n",progName);
+	fprintf(stderr,"       %s --interp [--no-super] [--interp-stats] [--interp-profile file] file.cm | file.cmb\n",progName);
+	fprintf(stderr,"       %s --interp --batch [-j jobs] [--no-super] [--interp-stats] file.cm | file.cmb input ...\n",progName);
+	fprintf(stderr,"       %s --emit-bytecode file.cmb file.cm\n",progName);
+	fprintf(stderr,"       %s [-j jobs] [--no-peephole] [--no-promote] [--no-fold] [--cache dir [--cache-stats]] --server socket\n",progName);
+	exit(-1);
 }
 
 int main(int argc, char** argv) {	
-	fileName = argv[1];
-	initialize(fileName);
-    Cminus_parse();
-  	finalize();
+	static struct option longOptions[] = {
+		{"server", required_argument, NULL, 's'},
+		{"cache", required_argument, NULL, 'C'},
+		{"cache-stats", no_argument, NULL, 'T'},
+		{"as", no_argument, NULL, 'A'},
+		{"run", no_argument, NULL, 'R'},
+		{"tier", no_argument, NULL, 'I'},
+		{"hot", required_argument, NULL, 'H'},
+		{"tier-stats", no_argument, NULL, 'U'},
+		{"interp", no_argument, NULL, 'P'},
+		{"no-super", no_argument, NULL, 'F'},
+		{"interp-stats", no_argument, NULL, 'X'},
+		{"interp-profile", required_argument, NULL, 'Y'},
+		{"emit-bytecode", required_argument, NULL, 'E'},
+		{"batch", no_argument, NULL, 'B'},
+		{"no-peephole", no_argument, NULL, 'N'},
+		{"no-promote", no_argument, NULL, 'M'},
+		{"no-fold", no_argument, NULL, 'K'},
+		{NULL, 0, NULL, 0}
+	};
+	int jobs = 1;
+	int workers = 1;
+	char *socketPath = NULL;
+	char *cacheDir = NULL;
+	int opt, status;
+
+	while ((opt = getopt_long(argc,argv,"cSo:j:w:",longOptions,NULL)) != -1) {
+		if (opt == 'c')
+			emitObject = true;
+		else if (opt == 'S')
+			emitObject = false;
+		else if (opt == 'o')
+			outputName = optarg;
+		else if (opt == 'j' && atoi(optarg) > 0)
+			jobs = atoi(optarg);
+		else if (opt == 'w' && atoi(optarg) > 0)
+			workers = atoi(optarg);
+		else if (opt == 's')
+			socketPath = optarg;
+		else if (opt == 'C')
+			cacheDir = optarg;
+		else if (opt == 'T')
+			cacheStats = true;
+		else if (opt == 'A')
+			useAssembler = true;
+		else if (opt == 'R')
+			runProgram = true;
+		else if (opt == 'I')
+			tierProgram = true;
+		else if (opt == 'H' && atoi(optarg) >= 0)
+			hotCount = atoi(optarg);
+		else if (opt == 'U')
+			tierStats = true;
+		else if (opt == 'P')
+			interpProgram = true;
+		else if (opt == 'F')
+			interpFuse = false;
+		else if (opt == 'X')
+			interpStats = true;
+		else if (opt == 'Y')
+			interpProfile = optarg;
+		else if (opt == 'E')
+			bytecodeImage = optarg;
+		else if (opt == 'B')
+			interpBatch = true;
+		else if (opt == 'N')
+			usePeephole = false;
+		else if (opt == 'M')
+			usePromotion = false;
+		else if (opt == 'K')
+			useFolding = false;
+		else
+			usage(argv[0]);
+	}
+	if (optind >= argc && socketPath == NULL)
+		usage(argv[0]);
+	if (socketPath != NULL && (emitObject || outputName != NULL))
+		usage(argv[0]);
+	if (outputName != NULL && argc - optind > 1) {
+		fprintf(stderr,"Error: -o names the output of a single file\n");
+		return -1;
+	}
+	if (interpBatch && (!interpProgram || interpProfile != NULL || argc - optind < 2))
+		usage(argv[0]);
+	if ((runProgram || tierProgram || interpProgram || bytecodeImage != NULL) &&
+	    ((argc - optind != 1 && !interpBatch) || socketPath != NULL || emitObject || outputName != NULL))
+		usage(argv[0]);
+	if (runProgram + tierProgram + interpProgram + (bytecodeImage != NULL) > 1)
+		usage(argv[0]);
+	if (emitObject && outputName != NULL && strcmp(outputName,"-") == 0) {
+		fprintf(stderr,"Error: Cannot write an object file to stdout\n");
+		return -1;
+	}
+
+	int numFiles = argc - optind;
+	if (workers > numFiles)
+		workers = numFiles;
+
+	lowerUsePeephole(usePeephole);
+	lowerUsePromotion(usePromotion);
+	lowerUseFolding(useFolding);
+	if (cacheDir != NULL) {
+		char options[48];
+		snprintf(options,48,"%s%s%s",usePeephole ? "" : "--no-peephole ",usePromotion ? "" : "--no-promote ",
+			 useFolding ? "" : "--no-fold");
+		codeCache = cacheOpen(cacheDir,options);
+		if (codeCache == NULL)
+			return -1;
+		lowerUseCache(codeCache);
+	}
+
+	programAst = astAlloc();
+	if (socketPath != NULL)
+		status = runServer(socketPath,compileStream,jobs);
+	else if (runProgram)
+		status = runFile(argv[optind],jobs);
+	else if (tierProgram)
+		status = tierFile(argv[optind]);
+	else if (interpProgram)
+		status = interpFile(argv[optind],argv + optind + 1,argc - optind - 1,jobs);
+	else if (bytecodeImage != NULL)
+		status = emitBytecodeFile(argv[optind],bytecodeImage);
+	else if (workers > 1)
+		status = compileFilesInWorkers(argv + optind,numFiles,workers,jobs);
+	else
+		status = compileFiles(argv + optind,numFiles,0,1,jobs);
+	astFree(programAst);
+
+	if (codeCache != NULL) {
+		if (cacheStats && workers <= 1)
+			cachePrintStatistics(codeCache);
+		cacheClose(codeCache);
+	}
   
-  	return 0;
+  	return status;
 }
 /******************END OF C ROUTINES**********************/
-
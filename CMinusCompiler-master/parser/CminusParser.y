@@ -9,41 +9,71 @@
 #include <stdlib.h>
 #include <strings.h>
 #include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <errno.h>
+#include <time.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <util/general.h>
 #include <util/symtab.h>
-#include <util/symtab_stack.h>
 #include <util/dlink.h>
 #include <util/string_utils.h>
-#include <codegen/symfields.h>
-#include <codegen/types.h>
-#include <codegen/codegen.h>
-#include <codegen/reg.h>
-
-#define SYMTABLE_SIZE 100
+#include <ast/ast.h>
+#include <codegen/lower.h>
+#include <codegen/encoder.h>
+#include <codegen/tier.h>
+#include <vm/vm.h>
+#include "CminusServer.h"
 
 /*********************EXTERNAL DECLARATIONS***********************/
 
 EXTERN(void,Cminus_error,(char*));
 
 EXTERN(int,Cminus_lex,(void));
+EXTERN(void,Cminus_restart,(FILE*));
 
-SymTable symtab;
-SymtabStack symstack;
-
-static DList instList;
-static DList dataList;
+Ast programAst;
 
 char *fileName;
 
-static int functionOffset;
+#define ASSEMBLER "as"	/**< the assembler run by -c --as, looked up in PATH */
+
+extern char **environ;
+
+static bool emitObject = false;		/**< -c: write an object file */
+static bool useAssembler = false;	/**< --as: make the object file with the system assembler */
+static char *outputName = NULL;		/**< -o: the output file, "-" for stdout */
+static bool runProgram = false;		/**< --run: run the program in this process instead */
+static bool tierProgram = false;	/**< --tier: run the program in the tiered engine instead */
+static int hotCount = TIER_THRESHOLD;	/**< --hot: when the tiered engine compiles a function */
+static bool tierStats = false;		/**< --tier-stats: print what the tiered engine compiled */
+static bool interpProgram = false;	/**< --interp: run the program in the bytecode interpreter instead */
+static bool interpFuse = true;		/**< --no-super turns off the interpreter's superinstructions */
+static bool interpStats = false;	/**< --interp-stats: print the interpreter's load time and dispatches */
+static char *interpProfile = NULL;	/**< --interp-profile: the file to add instruction pair counts to */
+static bool interpBatch = false;	/**< --batch: run the program once for each input file instead */
+static char *bytecodeImage = NULL;	/**< --emit-bytecode: the bytecode image to write instead */
+static bool usePeephole = true;		/**< --no-peephole turns off the peephole optimizer */
+static bool usePromotion = true;	/**< --no-promote keeps every variable in memory */
+static bool useFolding = true;		/**< --no-fold turns off constant folding */
+static CodeCache codeCache = NULL;	/**< the code cache given with --cache */
+static bool cacheStats = false;		/**< print the use of the code cache at exit */
+
 int globalOffset = 0;
 
-static char* functionName;
 extern union YYSTYPE yylval;
 extern int Cminus_lineno;
 
+#define NODE(kind,name,kid0,kid1,kid2) astNode(programAst,(kind),Cminus_lineno,(name),(kid0),(kid1),(kid2))
+
 %}
 
+%code requires {
+#include <ast/ast.h>
+}
+
 %name-prefix="Cminus_"
 %defines
 
@@ -95,258 +125,233 @@ extern int Cminus_lineno;
 
 %union {
 	char*	name;
-	int     symIndex;
-	DList	idList;
-	int 	offset;
+	int	type;
+	AstIndex node;
+	AstList	list;
 }
 
-%type <idList> IdentifierList
-%type <symIndex> Type TestAndThen Test WhileExpr WhileToken Expr SimpleExpr AddExpr
-%type <symIndex> MulExpr Factor Variable StringConstant Constant VarDecl FunctionDecl ProcedureHead ReturnStatement
-%type <offset> DeclList
+%type <list> IdentifierList DeclList StatementList Procedures
+%type <node> ProcedureDecl ProcedureHead FunctionDecl ProcedureBody VarDecl
+%type <node> Statement Assignment IfStatement TestAndThen Test WhileStatement WhileExpr
+%type <node> IOStatement ReturnStatement ExitStatement CompoundStatement
+%type <node> Expr SimpleExpr AddExpr MulExpr Factor Variable StringConstant Constant
+%type <type> Type
 %type <name> IDENTIFIER STRING FLOATCON INTCON 
 
 /***********************PRODUCTIONS****************************/
 %%
 Program	: Procedures {
-	emitDataPrologue(dataList);
-	emitInstructions(instList);
+	programAst->root = NODE(AST_PROGRAM,NULL,AST_NULL,$1.head,AST_NULL);
 } | DeclList Procedures {
-	globalOffset = $1;
-	emitDataPrologue(dataList);
-	emitInstructions(instList);
-};
-
-Procedures 	: ProcedureDecl Procedures {
-
+	programAst->root = NODE(AST_PROGRAM,NULL,$1.head,$2.head,AST_NULL);
+} | DeclList {
+	programAst->root = NODE(AST_PROGRAM,NULL,$1.head,AST_NULL,AST_NULL);
 } | {
+	programAst->root = NODE(AST_PROGRAM,NULL,AST_NULL,AST_NULL,AST_NULL);
+};
 
+/* left recursive, so that the parser stack does not grow with the number of functions */
+Procedures 	: ProcedureDecl {
+	$$ = astListStart(programAst,$1);
+} | Procedures ProcedureDecl {
+	$$ = astListAppend(programAst,$1,$2);
 };
 
 ProcedureDecl : ProcedureHead ProcedureBody {
-	emitEndFunction(instList);
-	symtab = endScope(symstack);
-	SymKillField(symtab,SYMTAB_REGISTER_INDEX_FIELD);
-    SymKillField(symtab,SYMTAB_OFFSET_FIELD);
-    SymKill(symtab);
-	symtab = currentSymtab(symstack);
-	emitExit(instList);
+	AST_KID(programAst,$1,1) = $2;
+	$$ = $1;
 };
 
 ProcedureHead : FunctionDecl DeclList {
-	emitProcedurePrologue(instList,symtab,$1);
-	emitStartFunction(instList, $2);
-	functionOffset = $2;
+	AST_KID(programAst,$1,0) = $2.head;
 	$$ = $1;
-	
 } | FunctionDecl {
-	emitProcedurePrologue(instList,symtab,$1);
-	emitStartFunction(instList, 0);
-	functionOffset = 0;
 	$$ = $1;
 };
 
 FunctionDecl : Type IDENTIFIER LPAREN RPAREN LBRACE {
-	symtab = beginScope(symstack);
-	$$ = SymIndex(symtab,$2);
+	$$ = NODE(AST_FUNCTION,$2,AST_NULL,AST_NULL,AST_NULL);
+	free($2);
 };
 
 ProcedureBody : StatementList RBRACE {
-	
+	$$ = $1.head;
 };
 
 DeclList : Type IdentifierList SEMICOLON {
-	AddIdStructPtr data = (AddIdStructPtr)malloc(sizeof(AddIdStruct));
-	data->offset = 0;
-	data->symtab = symtab;
-    data->typeIndex = $1;
-	dlinkApply1($2,(DLinkApply1Func)addIdToSymtab,(Generic)data);
-	$$ = data->offset;
-	dlinkFreeNodes($2);
-	free(data);
+	AstIndex decl = NODE(AST_DECL,NULL,$2.head,AST_NULL,AST_NULL);
+	AST_NODE(programAst,decl)->type = $1;
+	$$ = astListStart(programAst,decl);
 } | DeclList Type IdentifierList SEMICOLON {
-	AddIdStructPtr data = (AddIdStructPtr)malloc(sizeof(AddIdStruct));
-	data->offset = $1;
-	data->typeIndex = $2;
-	data->symtab = symtab;
-	dlinkApply1($3,(DLinkApply1Func)addIdToSymtab,(Generic)data);
-	$$ = data->offset;
-	dlinkFreeNodes($3);
-	free(data);
+	AstIndex decl = NODE(AST_DECL,NULL,$3.head,AST_NULL,AST_NULL);
+	AST_NODE(programAst,decl)->type = $2;
+	$$ = astListAppend(programAst,$1,decl);
 };
 
 IdentifierList : VarDecl {
-	$$ = dlinkListAlloc(NULL);
-	dlinkAppend($$,dlinkNodeAlloc((Generic)$1));
+	$$ = astListStart(programAst,$1);
 } | IdentifierList COMMA VarDecl {
-	dlinkAppend($1,dlinkNodeAlloc((Generic)$3));
-	$$ = $1;
+	$$ = astListAppend(programAst,$1,$3);
 };
 
 VarDecl : IDENTIFIER {
-	$$ = SymIndex(symtab,$1);
+	$$ = NODE(AST_VAR,$1,AST_NULL,AST_NULL,AST_NULL);
+	free($1);
 } | IDENTIFIER LBRACKET INTCON RBRACKET {
-	int symIndex = SymIndex(symtab,$3);
-	char* numElemString = (char*)SymGetFieldByIndex(symtab,symIndex,SYM_NAME_FIELD);
-		
-	char* typeString = nssave(4,SYMTAB_VOID_TYPE_STRING,"[",numElemString,"]");
-		
-	int typeIndex = SymIndex(symtab,typeString);
-	SymPutFieldByIndex(symtab,typeIndex,SYMTAB_BASIC_TYPE_FIELD,(Generic)VOID_TYPE);
-	
-	int numElements = atoi(numElemString);
-	SymPutFieldByIndex(symtab,typeIndex,SYMTAB_SIZE_FIELD,(Generic)(VOID_SIZE*numElements));
-					   
-	sfree(typeString);
-
-	symIndex = SymIndex(symtab,$1);
-    SymPutFieldByIndex(symtab,symIndex,SYMTAB_TYPE_INDEX_FIELD,(Generic)typeIndex);
-
-	$$ = symIndex;		  
+	AstIndex size = NODE(AST_CONST,$3,AST_NULL,AST_NULL,AST_NULL);
+	$$ = NODE(AST_ARRAY,$1,size,AST_NULL,AST_NULL);
+	free($1);
+	free($3);
 };
 
 Type : INTEGER {
-    $$ = SymQueryIndex(symtab,SYMTAB_INTEGER_TYPE_STRING);
-} | FLOAT;
+	$$ = AST_TYPE_INTEGER;
+} | FLOAT {
+	$$ = AST_TYPE_FLOAT;
+};
 
 Statement : Assignment {
-	
+	$$ = $1;
 } | IfStatement {
-	
+	$$ = $1;
 } | WhileStatement {
-	
+	$$ = $1;
 } | IOStatement {
-	
+	$$ = $1;
 } | ReturnStatement {
-	emitReturnFunction(instList, lastSymtab(symstack), symtab, $1);
+	$$ = $1;
 } | ExitStatement {
-	
+	$$ = $1;
 } | CompoundStatement {
-	
+	$$ = $1;
 };
 
 Assignment : Variable ASSIGN Expr SEMICOLON {
-	emitAssignment(instList,lastSymtab(symstack),symtab,$1,$3);
+	$$ = NODE(AST_ASSIGN,NULL,$1,$3,AST_NULL);
 };
 
 IfStatement	: IF TestAndThen ELSE CompoundStatement {
-	emitEndBranchTarget(instList,symtab,$2);
+	AST_KID(programAst,$2,2) = $4;
+	$$ = $2;
 } | IF TestAndThen {
-	emitEndBranchTarget(instList,symtab,$2);
+	$$ = $2;
 };
 	
 TestAndThen	: Test CompoundStatement {
-	$$ = emitThenBranch(instList,symtab,$1);
+	$$ = NODE(AST_IF,NULL,$1,$2,AST_NULL);
 };
 				
 Test : LPAREN Expr RPAREN {
-	$$ = emitIfTest(instList,symtab,$2);
+	$$ = $2;
 };
 
 WhileStatement : WhileToken WhileExpr Statement {
-	emitWhileLoopBackBranch(instList,symtab,$1,$2);
+	$$ = NODE(AST_WHILE,NULL,$2,$3,AST_NULL);
 };
                 
 WhileExpr : LPAREN Expr RPAREN {
-	$$ = emitWhileLoopTest(instList,symtab,$2);
+	$$ = $2;
 };
 				
 WhileToken : WHILE {
-	$$ = emitWhileLoopLandingPad(instList,symtab);
+
 };
 				
 IOStatement : READ LPAREN Variable RPAREN SEMICOLON {
-	emitReadVariable(instList,symtab,$3);
+	$$ = NODE(AST_READ,NULL,$3,AST_NULL,AST_NULL);
 } | WRITE LPAREN Expr RPAREN SEMICOLON {
-	emitWriteExpression(instList,symtab,$3,SYSCALL_PRINT_INTEGER);
+	$$ = NODE(AST_WRITE,NULL,$3,AST_NULL,AST_NULL);
 } | WRITE LPAREN StringConstant RPAREN SEMICOLON {
-	emitWriteExpression(instList,symtab,$3,SYSCALL_PRINT_STRING);
+	$$ = NODE(AST_WRITE,NULL,$3,AST_NULL,AST_NULL);
 };
 
 ReturnStatement : RETURN Expr SEMICOLON {
-	$$ = $2;
+	$$ = NODE(AST_RETURN,NULL,$2,AST_NULL,AST_NULL);
 };
 
 ExitStatement : EXIT SEMICOLON {
-	emitExit(instList);
+	$$ = NODE(AST_EXIT,NULL,AST_NULL,AST_NULL,AST_NULL);
 };
 
 CompoundStatement : LBRACE StatementList RBRACE {
-	
+	$$ = NODE(AST_BLOCK,NULL,$2.head,AST_NULL,AST_NULL);
 };
 
 StatementList : Statement {
-	
+	$$ = astListStart(programAst,$1);
 } | StatementList Statement {
-
+	$$ = astListAppend(programAst,$1,$2);
 };
 
 Expr : SimpleExpr {
 	$$ = $1;
 } | Expr OR SimpleExpr {
-	$$ = emitOrExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_OR,NULL,$1,$3,AST_NULL);
 } | Expr AND SimpleExpr {
-	$$ = emitAndExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_AND,NULL,$1,$3,AST_NULL);
 } | NOT SimpleExpr {
-	$$ = emitNotExpression(instList,symtab,$2);
+	$$ = NODE(AST_NOT,NULL,$2,AST_NULL,AST_NULL);
 };
 
 SimpleExpr : AddExpr {
 	$$ = $1; 
 } | SimpleExpr EQ AddExpr {
-	$$ = emitEqualExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_EQ,NULL,$1,$3,AST_NULL);
 } | SimpleExpr NE AddExpr {
-	$$ = emitNotEqualExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_NE,NULL,$1,$3,AST_NULL);
 } | SimpleExpr LE AddExpr {
-	$$ = emitLessEqualExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_LE,NULL,$1,$3,AST_NULL);
 } | SimpleExpr LT AddExpr {
-	$$ = emitLessThanExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_LT,NULL,$1,$3,AST_NULL);
 } | SimpleExpr GE AddExpr {
-	$$ = emitGreaterEqualExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_GE,NULL,$1,$3,AST_NULL);
 } | SimpleExpr GT AddExpr {
-	$$ = emitGreaterThanExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_GT,NULL,$1,$3,AST_NULL);
 };
 
 AddExpr	: MulExpr {
 	$$ = $1; 
 } |  AddExpr PLUS MulExpr {
-	$$ = emitAddExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_ADD,NULL,$1,$3,AST_NULL);
 } |  AddExpr MINUS MulExpr {
-	$$ = emitSubtractExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_SUB,NULL,$1,$3,AST_NULL);
 };
 
 MulExpr	: Factor {
 	$$ = $1; 
 } |  MulExpr TIMES Factor {
-	$$ = emitMultiplyExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_MUL,NULL,$1,$3,AST_NULL);
 } |  MulExpr DIVIDE Factor {
-	$$ = emitDivideExpression(instList,symtab,$1,$3);
+	$$ = NODE(AST_DIV,NULL,$1,$3,AST_NULL);
 };
 				
 Factor : Variable {
-	$$ = emitLoadVariable(instList, lastSymtab(symstack), symtab, $1);
+	$$ = NODE(AST_LOAD,NULL,$1,AST_NULL,AST_NULL);
 } | Constant { 
 	$$ = $1;
 } | IDENTIFIER LPAREN RPAREN {
-	$$ = emitCallFunction(instList,symtab,$1);
+	$$ = NODE(AST_CALL,$1,AST_NULL,AST_NULL,AST_NULL);
+	free($1);
 } | LPAREN Expr RPAREN {
 	$$ = $2;
 };
 
 Variable : IDENTIFIER {
-	$$ = emitComputeVarAddress(instList,lastSymtab(symstack), symtab, $1);
+	$$ = NODE(AST_VAR_ADDR,$1,AST_NULL,AST_NULL,AST_NULL);
+	free($1);
 } | IDENTIFIER LBRACKET Expr RBRACKET {
-	$$ = emitComputeArrayAddress(instList,lastSymtab(symstack),symtab,$1,$3);
+	$$ = NODE(AST_ARRAY_ADDR,$1,$3,AST_NULL,AST_NULL);
+	free($1);
 };			       
 
 StringConstant : STRING {
-	int symIndex = SymIndex(symtab,$1);
-	$$ = emitLoadStringConstantAddress(instList,dataList,symtab,symIndex);
+	$$ = NODE(AST_STRING,$1,AST_NULL,AST_NULL,AST_NULL);
+	free($1);
 };
 
 Constant : INTCON { 
-	int symIndex = SymIndex(symtab,$1);
-	$$ = emitLoadIntegerConstant(instList,symtab,symIndex);
+	$$ = NODE(AST_CONST,$1,AST_NULL,AST_NULL,AST_NULL);
+	free($1);
 };
 
 %%
@@ -355,70 +360,521 @@ Constant : INTCON {
 /********************C ROUTINES *********************************/
 
 void Cminus_error(char *s) {
-  fprintf(stderr,"%s: line %d: %s\n",fileName,Cminus_lineno,s);
+  fprintf(stderr,"%s: line %d: %s\n",fileName,lowerLineno ? lowerLineno : Cminus_lineno,s);
 }
 
 int Cminus_wrap() {
 	return 1;
 }
 
-static void initSymStack() {
-	symstack = symtabStackInit();
+/**
+ * Compile a program, printing its assembly code to stdout. The state of the
+ * compiler is reset so that any number of programs can be compiled in turn.
+ *
+ * @param name the name of the program used in diagnostics
+ * @param input the source of the program
+ * @param jobs the number of threads to generate code on
+ * @return the result of the parse
+ */
+static int compileStream(char *name, FILE *input, int jobs) {
+	fileName = name;
+	Cminus_lineno = 1;
+	Cminus_restart(input);
+	astReset(programAst);
+
+	int status = Cminus_parse();
+	if (status == 0)
+		lowerProgram(programAst,jobs);
+
+	return status;
+}
+
+/**
+ * Start the assembler reading from a pipe.
+ *
+ * @param objectFileName the object file the assembler writes
+ * @param pid receives the process id of the assembler
+ * @return a stream feeding the assembler, or NULL if it could not be started
+ */
+static FILE *startAssembler(char *objectFileName, pid_t *pid) {
+	char *argv[] = {ASSEMBLER, "--64", "-o", objectFileName, NULL};
+	posix_spawn_file_actions_t actions;
+	int fds[2];
+
+	if (pipe(fds) != 0) {
+		fprintf(stderr,"Error: Could not create a pipe: %s\n",strerror(errno));
+		return NULL;
+	}
+
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions,fds[0],0);
+	posix_spawn_file_actions_addclose(&actions,fds[0]);
+	posix_spawn_file_actions_addclose(&actions,fds[1]);
+	int error = posix_spawnp(pid,ASSEMBLER,&actions,NULL,argv,environ);
+	posix_spawn_file_actions_destroy(&actions);
+	close(fds[0]);
+
+	if (error != 0) {
+		fprintf(stderr,"Error: Could not run %s: %s\n",ASSEMBLER,strerror(error));
+		close(fds[1]);
+		return NULL;
+	}
+
+	return fdopen(fds[1],"w");
+}
+
+/**
+ * Compile one file and assemble it with the built-in encoder, which encodes
+ * each function as it is generated and takes the place of stdout for the
+ * rest.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param input the open file
+ * @param objectFileName the object file to write
+ * @param jobs the number of threads to generate code on
+ * @return false if the file could not be parsed, or the code could not be
+ * 	   assembled or written; no object file is written if it does not parse
+ */
+static bool compileToObjectBuiltin(char *inputFileName, FILE *input, char *objectFileName, int jobs) {
+	FILE *savedStdout = stdout;
+	Encoder encoder = encoderNew();
+
+	stdout = encoderOpenStream(encoder);
+	lowerUseEncoder(encoder);
+	int status = compileStream(inputFileName,input,jobs);
+	lowerUseEncoder(NULL);
+	fclose(stdout);
+	stdout = savedStdout;
+
+	bool ok = status == 0 && encoderWriteObject(encoder,objectFileName);
+	encoderFree(encoder);
+	return ok;
+}
+
+/**
+ * Compile one file into memory and call its main function in this process,
+ * without an assembler, a linker or any files. The program's output goes to
+ * stdout and its input comes from stdin.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param jobs the number of threads to generate code on
+ * @return the value main returns, or -1 if the program could not be compiled or loaded
+ */
+static int runFile(char *inputFileName, int jobs) {
+	FILE *input = fopen(inputFileName,"r");
+	if (input == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
+		return -1;
+	}
+
+	FILE *savedStdout = stdout;
+	Encoder encoder = encoderNew();
+	stdout = encoderOpenStream(encoder);
+	lowerUseEncoder(encoder);
+	int status = compileStream(inputFileName,input,jobs);
+	lowerUseEncoder(NULL);
+	fclose(stdout);
+	stdout = savedStdout;
+	fclose(input);
+
+	int result = -1;
+	if (status == 0 && encoderLoad(encoder)) {
+		FUNCTION_POINTER(int, entry, (void)) = (int(*)(void))encoderAddress(encoder,"main");
+		if (entry == NULL)
+			fprintf(stderr,"Error: %s has no main function\n",inputFileName);
+		else {
+			result = entry();
+			fflush(stdout);
+		}
+	}
+
+	encoderFree(encoder);
+	return result;
+}
+
+/**
+ * Parse one file and run it in the tiered engine, which interprets each
+ * function until it is hot and only then compiles it.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @return the value main returns, or -1 if the program could not be parsed or run
+ */
+static int tierFile(char *inputFileName) {
+	FILE *input = fopen(inputFileName,"r");
+	if (input == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
+		return -1;
+	}
+
+	fileName = inputFileName;
+	Cminus_lineno = 1;
+	Cminus_restart(input);
+	astReset(programAst);
+	int status = Cminus_parse();
+	fclose(input);
+
+	return status == 0 ? tierRun(programAst,inputFileName,hotCount,tierStats) : -1;
+}
+
+/**
+ * Parse one file and compile it to bytecode.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @return the program, or NULL if it could not be parsed or compiled
+ */
+static VmProgram compileBytecode(char *inputFileName) {
+	FILE *input = fopen(inputFileName,"r");
+	if (input == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
+		return NULL;
+	}
+
+	fileName = inputFileName;
+	Cminus_lineno = 1;
+	Cminus_restart(input);
+	astReset(programAst);
+	int status = Cminus_parse();
+	fclose(input);
+
+	return status == 0 ? vmCompile(programAst) : NULL;
+}
+
+/**
+ * Run a program in the bytecode interpreter, which needs no assembler and
+ * generates no native code. A .cmb file is a bytecode image, which is
+ * mapped and run without the front end; any other file is a Cminus file.
+ * With --batch the program is loaded once and run for each input file on
+ * a number of threads.
+ *
+ * @param inputFileName the name of a Cminus file or a bytecode image
+ * @param inputs the input files of a batch
+ * @param numInputs the number of input files
+ * @param jobs the number of threads to run a batch on
+ * @return the value main returns, or -1 if the program could not be compiled or run
+ */
+static int interpFile(char *inputFileName, char **inputs, int numInputs, int jobs) {
+	char *dotChar = rindex(inputFileName,'.');
+	bool isImage = dotChar != NULL && strcmp(dotChar,".cmb") == 0;
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC,&start);
+	VmProgram program = isImage ? vmMapImage(inputFileName) : compileBytecode(inputFileName);
+	if (program == NULL)
+		return -1;
+	clock_gettime(CLOCK_MONOTONIC,&end);
+	if (interpStats)
+		fprintf(stderr,"%s loaded in %ld us\n",inputFileName,
+			(end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000);
+	int result = interpBatch ? vmRunBatch(program,inputFileName,inputs,numInputs,jobs,interpFuse,interpStats) :
+		vmRun(program,inputFileName,interpFuse,interpStats,interpProfile);
+	vmFree(program);
+	return result;
 }
 
-static void initSymTable() {
-	symtab = beginScope(symstack);
+/**
+ * Compile one file to bytecode and write it as a bytecode image for
+ * cmc --interp to run.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param imageFileName the image to write
+ * @return 0, or -1 if the file could not be compiled or the image written
+ */
+static int emitBytecodeFile(char *inputFileName, char *imageFileName) {
+	VmProgram program = compileBytecode(inputFileName);
+	if (program == NULL)
+		return -1;
+	bool ok = vmWriteImage(program,imageFileName);
+	vmFree(program);
+	return ok ? 0 : -1;
 }
 
-static void deleteSymTable() {
-	while (stackSize(symstack) > 0) {
-		symtab = endScope(symstack);
-	    SymKillField(symtab,SYMTAB_REGISTER_INDEX_FIELD);
-	    SymKillField(symtab,SYMTAB_OFFSET_FIELD);
-	    SymKill(symtab);
+/**
+ * Compile one file and assemble it in a pipe, so that the assembler works on
+ * each function while the next one is generated and no .s file is written.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param input the open file
+ * @param objectFileName the object file to write
+ * @param jobs the number of threads to generate code on
+ * @return false if the file could not be parsed, or the assembler could not
+ * 	   be run or failed; the object file is then removed
+ */
+static bool compileToObject(char *inputFileName, FILE *input, char *objectFileName, int jobs) {
+	FILE *savedStdout = stdout;
+	pid_t pid;
+	int status;
+
+	FILE *assembler = startAssembler(objectFileName,&pid);
+	if (assembler == NULL)
+		return false;
+
+	stdout = assembler;
+	int parseStatus = compileStream(inputFileName,input,jobs);
+	fclose(assembler);
+	stdout = savedStdout;
+
+	if (waitpid(pid,&status,0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr,"Error: %s failed on the code for %s\n",ASSEMBLER,inputFileName);
+		unlink(objectFileName);
+		return false;
 	}
+	if (parseStatus != 0) {
+		unlink(objectFileName);
+		return false;
+	}
+	return true;
 }
 
-static void initialize(char* inputFileName) {
-	stdin = freopen(inputFileName,"r", stdin);
-    if (stdin == NULL) {
+/**
+ * Compile one file. Without -o the output goes to a .s or, with -c, a .o file
+ * of the same name as the input.
+ *
+ * @param inputFileName the name of a Cminus file
+ * @param jobs the number of threads to generate code on
+ * @return false if the file could not be opened, parsed or assembled
+ */
+static bool compileFile(char* inputFileName, int jobs) {
+	FILE *input = fopen(inputFileName,"r");
+    if (input == NULL) {
     	fprintf(stderr,"Error: Could not open file %s\n",inputFileName);
-    	exit(-1);
+    	return false;
     }
 
-	char* dotChar = rindex(inputFileName,'.');
-	int endIndex = strlen(inputFileName) - strlen(dotChar);
-	char *outputFileName = nssave(2,substr(inputFileName,0,endIndex),".s");
-	stdout = freopen(outputFileName,"w", stdout);
-    if (stdout == NULL) {
-    	fprintf(stderr,"Error: Could not open file %s\n",outputFileName);
-    	exit(-1);
-	} 
-
-    initSymStack();
-	initSymTable();
-	initRegisters();
-
-	instList = dlinkListAlloc(NULL);
-	dataList = dlinkListAlloc(NULL);
+	char *outputFileName;
+	if (outputName != NULL)
+		outputFileName = ssave(outputName);
+	else {
+		char* dotChar = rindex(inputFileName,'.');
+		int endIndex = strlen(inputFileName) - strlen(dotChar);
+		char *baseName = substr(inputFileName,0,endIndex);
+		outputFileName = nssave(2,baseName,emitObject ? ".o" : ".s");
+		sfree(baseName);
+	}
+
+	bool ok = true;
+	if (emitObject && useAssembler)
+		ok = compileToObject(inputFileName,input,outputFileName,jobs);
+	else if (emitObject)
+		ok = compileToObjectBuiltin(inputFileName,input,outputFileName,jobs);
+	else {
+		if (strcmp(outputFileName,"-") != 0) {
+			stdout = freopen(outputFileName,"w", stdout);
+			if (stdout == NULL) {
+				fprintf(stderr,"Error: Could not open file %s\n",outputFileName);
+				exit(-1);
+			}
+		}
+		ok = compileStream(inputFileName,input,jobs) == 0;
+	}
+
+	sfree(outputFileName);
+	fclose(input);
+	return ok;
 }
 
-static void finalize() {
-    fclose(stdin);
+/**
+ * Compile every workers-th file, starting with the first.
+ *
+ * @param files the names of the files
+ * @param numFiles the number of files
+ * @param first the first file to compile
+ * @param workers the distance between files
+ * @param jobs the number of threads to generate code on
+ * @return 0 if all files could be compiled
+ */
+static int compileFiles(char **files, int numFiles, int first, int workers, int jobs) {
+	int i, status = 0;
+
+	for (i = first; i < numFiles; i += workers)
+		if (!compileFile(files[i],jobs))
+			status = -1;
+
+	return status;
+}
+
+/**
+ * Compile files in forked worker processes. The parser and scanner keep their
+ * state in globals, so workers are processes rather than threads.
+ *
+ * @param files the names of the files
+ * @param numFiles the number of files
+ * @param workers the number of processes
+ * @param jobs the number of threads to generate code on in each process
+ * @return 0 if all workers succeeded
+ */
+static int compileFilesInWorkers(char **files, int numFiles, int workers, int jobs) {
+	int i, status = 0, childStatus;
+
+	fflush(stdout);
+	fflush(stderr);
+	for (i = 0; i < workers; i++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			status = compileFiles(files,numFiles,i,workers,jobs);
+			if (codeCache != NULL && cacheStats)
+				cachePrintStatistics(codeCache);
+			exit(status == 0 ? 0 : 1);
+		}
+		if (pid < 0) {
+			fprintf(stderr,"Error: Could not start worker %d\n",i);
+			status = -1;
+			workers = i;
+		}
+	}
 
-    deleteSymTable();
-    cleanupRegisters();
-    
-    dlinkFreeNodesAndAtoms(instList);
-    dlinkFreeNodesAndAtoms(dataList);
+	for (i = 0; i < workers; i++)
+		if (wait(&childStatus) < 0 || !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0)
+			status = -1;
+
+	return status;
+}
+
+static void usage(char *progName) {
+	fprintf(stderr,"Usage: %s [-S | -c [--as]] [-o output] [-j jobs] [-w workers] [--no-peephole] [--no-promote] [--no-fold] [--cache dir [--cache-stats]] file.cm ...\n",progName);
+	fprintf(stderr,"       %s [-j jobs] [--no-peephole] [--no-promote] [--no-fold] --run file.cm\n",progName);
+	fprintf(stderr,"       %s --tier [--hot count] [--tier-stats] [--no-peephole] [--no-promote] [--no-fold] file.cm\n",progName);
+	fprintf(stderr,"       %s --interp [--no-super] [--interp-stats] [--interp-profile file] file.cm | file.cmb\n",progName);
+	fprintf(stderr,"       %s --interp --batch [-j jobs] [--no-super] [--interp-stats] file.cm | file.cmb input ...\n",progName);
+	fprintf(stderr,"       %s --emit-bytecode file.cmb file.cm\n",progName);
+	fprintf(stderr,"       %s [-j jobs] [--no-peephole] [--no-promote] [--no-fold] [--cache dir [--cache-stats]] --server socket\n",progName);
+	exit(-1);
 }
 
 int main(int argc, char** argv) {	
-	fileName = argv[1];
-	initialize(fileName);
-    Cminus_parse();
-  	finalize();
+	static struct option longOptions[] = {
+		{"server", required_argument, NULL, 's'},
+		{"cache", required_argument, NULL, 'C'},
+		{"cache-stats", no_argument, NULL, 'T'},
+		{"as", no_argument, NULL, 'A'},
+		{"run", no_argument, NULL, 'R'},
+		{"tier", no_argument, NULL, 'I'},
+		{"hot", required_argument, NULL, 'H'},
+		{"tier-stats", no_argument, NULL, 'U'},
+		{"interp", no_argument, NULL, 'P'},
+		{"no-super", no_argument, NULL, 'F'},
+		{"interp-stats", no_argument, NULL, 'X'},
+		{"interp-profile", required_argument, NULL, 'Y'},
+		{"emit-bytecode", required_argument, NULL, 'E'},
+		{"batch", no_argument, NULL, 'B'},
+		{"no-peephole", no_argument, NULL, 'N'},
+		{"no-promote", no_argument, NULL, 'M'},
+		{"no-fold", no_argument, NULL, 'K'},
+		{NULL, 0, NULL, 0}
+	};
+	int jobs = 1;
+	int workers = 1;
+	char *socketPath = NULL;
+	char *cacheDir = NULL;
+	int opt, status;
+
+	while ((opt = getopt_long(argc,argv,"cSo:j:w:",longOptions,NULL)) != -1) {
+		if (opt == 'c')
+			emitObject = true;
+		else if (opt == 'S')
+			emitObject = false;
+		else if (opt == 'o')
+			outputName = optarg;
+		else if (opt == 'j' && atoi(optarg) > 0)
+			jobs = atoi(optarg);
+		else if (opt == 'w' && atoi(optarg) > 0)
+			workers = atoi(optarg);
+		else if (opt == 's')
+			socketPath = optarg;
+		else if (opt == 'C')
+			cacheDir = optarg;
+		else if (opt == 'T')
+			cacheStats = true;
+		else if (opt == 'A')
+			useAssembler = true;
+		else if (opt == 'R')
+			runProgram = true;
+		else if (opt == 'I')
+			tierProgram = true;
+		else if (opt == 'H' && atoi(optarg) >= 0)
+			hotCount = atoi(optarg);
+		else if (opt == 'U')
+			tierStats = true;
+		else if (opt == 'P')
+			interpProgram = true;
+		else if (opt == 'F')
+			interpFuse = false;
+		else if (opt == 'X')
+			interpStats = true;
+		else if (opt == 'Y')
+			interpProfile = optarg;
+		else if (opt == 'E')
+			bytecodeImage = optarg;
+		else if (opt == 'B')
+			interpBatch = true;
+		else if (opt == 'N')
+			usePeephole = false;
+		else if (opt == 'M')
+			usePromotion = false;
+		else if (opt == 'K')
+			useFolding = false;
+		else
+			usage(argv[0]);
+	}
+	if (optind >= argc && socketPath == NULL)
+		usage(argv[0]);
+	if (socketPath != NULL && (emitObject || outputName != NULL))
+		usage(argv[0]);
+	if (outputName != NULL && argc - optind > 1) {
+		fprintf(stderr,"Error: -o names the output of a single file\n");
+		return -1;
+	}
+	if (interpBatch && (!interpProgram || interpProfile != NULL || argc - optind < 2))
+		usage(argv[0]);
+	if ((runProgram || tierProgram || interpProgram || bytecodeImage != NULL) &&
+	    ((argc - optind != 1 && !interpBatch) || socketPath != NULL || emitObject || outputName != NULL))
+		usage(argv[0]);
+	if (runProgram + tierProgram + interpProgram + (bytecodeImage != NULL) > 1)
+		usage(argv[0]);
+	if (emitObject && outputName != NULL && strcmp(outputName,"-") == 0) {
+		fprintf(stderr,"Error: Cannot write an object file to stdout\n");
+		return -1;
+	}
+
+	int numFiles = argc - optind;
+	if (workers > numFiles)
+		workers = numFiles;
+
+	lowerUsePeephole(usePeephole);
+	lowerUsePromotion(usePromotion);
+	lowerUseFolding(useFolding);
+	if (cacheDir != NULL) {
+		char options[48];
+		snprintf(options,48,"%s%s%s",usePeephole ? "" : "--no-peephole ",usePromotion ? "" : "--no-promote ",
+			 useFolding ? "" : "--no-fold");
+		codeCache = cacheOpen(cacheDir,options);
+		if (codeCache == NULL)
+			return -1;
+		lowerUseCache(codeCache);
+	}
+
+	programAst = astAlloc();
+	if (socketPath != NULL)
+		status = runServer(socketPath,compileStream,jobs);
+	else if (runProgram)
+		status = runFile(argv[optind],jobs);
+	else if (tierProgram)
+		status = tierFile(argv[optind]);
+	else if (interpProgram)
+		status = interpFile(argv[optind],argv + optind + 1,argc - optind - 1,jobs);
+	else if (bytecodeImage != NULL)
+		status = emitBytecodeFile(argv[optind],bytecodeImage);
+	else if (workers > 1)
+		status = compileFilesInWorkers(argv + optind,numFiles,workers,jobs);
+	else
+		status = compileFiles(argv + optind,numFiles,0,1,jobs);
+	astFree(programAst);
+
+	if (codeCache != NULL) {
+		if (cacheStats && workers <= 1)
+			cachePrintStatistics(codeCache);
+		cacheClose(codeCache);
+	}
   
-  	return 0;
+  	return status;
 }
 /******************END OF C ROUTINES**********************/
@@ -0,0 +1,230 @@
+/**
+ * CminusServer.c
+ *
+ * The compile server and the message routines shared with its clients.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <util/general.h>
+#include "CminusServer.h"
+
+static volatile sig_atomic_t stopServer = 0;	/**< set by SIGINT and SIGTERM */
+
+/**
+ * Write all of a buffer to a socket.
+ *
+ * @param fd a connected socket
+ * @param data the bytes to write
+ * @param length the number of bytes
+ * @return false if the connection failed
+ */
+static bool writeFully(int fd, const char *data, size_t length) {
+	while (length > 0) {
+		ssize_t n = send(fd,data,length,MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		length -= n;
+	}
+	return true;
+}
+
+/**
+ * Read a number of bytes from a socket.
+ *
+ * @param fd a connected socket
+ * @param data where to store the bytes
+ * @param length the number of bytes
+ * @return false if the connection was closed or failed first
+ */
+static bool readFully(int fd, char *data, size_t length) {
+	while (length > 0) {
+		ssize_t n = read(fd,data,length);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		length -= n;
+	}
+	return true;
+}
+
+/**
+ * Send one message.
+ *
+ * @param fd a connected socket
+ * @param data the message
+ * @param length the length of the message
+ * @return false if the connection failed
+ */
+bool sendMessage(int fd, const char *data, uint32_t length) {
+	return writeFully(fd,(const char*)&length,sizeof(length)) && writeFully(fd,data,length);
+}
+
+/**
+ * Receive one message, growing the buffer if it is too short.
+ *
+ * @param fd a connected socket
+ * @param message the buffer to receive into
+ * @return false if the connection was closed or failed, or the message is too long
+ */
+bool receiveMessage(int fd, ServerMessage *message) {
+	uint32_t length;
+
+	if (!readFully(fd,(char*)&length,sizeof(length)) || length > MAX_MESSAGE_LENGTH)
+		return false;
+
+	if (length + 1 > message->max) {
+		message->max = length + 1;
+		message->data = (char*)realloc(message->data,message->max);
+	}
+	if (!readFully(fd,message->data,length))
+		return false;
+
+	message->data[length] = '\0';
+	message->length = length;
+	return true;
+}
+
+/**
+ * Connect to a compile server.
+ *
+ * @param socketPath the path of the server's socket
+ * @return a connected socket or -1
+ */
+int connectToServer(char *socketPath) {
+	struct sockaddr_un addr;
+	int fd = socket(AF_UNIX,SOCK_STREAM,0);
+
+	if (fd < 0)
+		return -1;
+
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path,socketPath,sizeof(addr.sun_path) - 1);
+	if (connect(fd,(struct sockaddr*)&addr,sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/**
+ * Compile one request and send the reply. The compiler prints to stdout and
+ * stderr, so both are pointed at memory for the duration of the compile.
+ *
+ * @param fd a connected socket
+ * @param name the name of the program
+ * @param source the source of the program
+ * @param compile the routine that compiles a program
+ * @param jobs the number of threads to generate code on
+ * @return false if the reply could not be sent
+ */
+static bool serveRequest(int fd, ServerMessage *name, ServerMessage *source, ServerCompileFunc compile, int jobs) {
+	char *code = NULL, *diagnostics = NULL;
+	size_t codeLength = 0, diagnosticsLength = 0;
+	FILE *savedStdout = stdout;
+	FILE *savedStderr = stderr;
+
+	FILE *input = (source->length > 0) ? fmemopen(source->data,source->length,"r") : fopen("/dev/null","r");
+	if (input == NULL)
+		return false;
+
+	stdout = open_memstream(&code,&codeLength);
+	stderr = open_memstream(&diagnostics,&diagnosticsLength);
+
+	compile(name->data,input,jobs);
+
+	fclose(stdout);
+	fclose(stderr);
+	stdout = savedStdout;
+	stderr = savedStderr;
+	fclose(input);
+
+	bool sent = sendMessage(fd,code,codeLength) && sendMessage(fd,diagnostics,diagnosticsLength);
+
+	free(code);
+	free(diagnostics);
+	return sent;
+}
+
+/**
+ * Stop accepting connections.
+ *
+ * @param sig the signal received
+ */
+static void handleStop(int sig) {
+	stopServer = 1;
+}
+
+/**
+ * Serve compile requests until SIGINT or SIGTERM. Connections are served one
+ * at a time, since the parser keeps its state in globals; the syntax tree and
+ * symbol tables are reused from one request to the next.
+ *
+ * @param socketPath the path at which to create the socket
+ * @param compile the routine that compiles a program
+ * @param jobs the number of threads to generate code on
+ * @return 0 when stopped by a signal, -1 if the socket could not be set up
+ */
+int runServer(char *socketPath, ServerCompileFunc compile, int jobs) {
+	struct sockaddr_un addr;
+	struct sigaction stop;
+	ServerMessage name = {NULL,0,0};
+	ServerMessage source = {NULL,0,0};
+
+	if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+		fprintf(stderr,"Error: Socket path %s is too long\n",socketPath);
+		return -1;
+	}
+
+	int listenFd = socket(AF_UNIX,SOCK_STREAM,0);
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path,socketPath);
+	unlink(socketPath);
+	if (listenFd < 0 || bind(listenFd,(struct sockaddr*)&addr,sizeof(addr)) < 0 || listen(listenFd,64) < 0) {
+		fprintf(stderr,"Error: Could not listen on %s: %s\n",socketPath,strerror(errno));
+		return -1;
+	}
+
+	/* no SA_RESTART, so that a signal interrupts accept */
+	memset(&stop,0,sizeof(stop));
+	stop.sa_handler = handleStop;
+	sigaction(SIGINT,&stop,NULL);
+	sigaction(SIGTERM,&stop,NULL);
+
+	while (!stopServer) {
+		int fd = accept(listenFd,NULL,NULL);
+		if (fd < 0 && errno == EINTR)
+			continue;
+		if (fd < 0) {
+			fprintf(stderr,"Error: Could not accept a connection: %s\n",strerror(errno));
+			break;
+		}
+
+		while (!stopServer && receiveMessage(fd,&name) && receiveMessage(fd,&source))
+			if (!serveRequest(fd,&name,&source,compile,jobs))
+				break;
+		close(fd);
+	}
+
+	close(listenFd);
+	unlink(socketPath);
+	free(name.data);
+	free(source.data);
+	return 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * CminusServer.h
+ *
+ * A compile server: a cmc process that stays up and compiles programs sent to
+ * it over a Unix domain socket, so a request does not pay for starting a
+ * process.
+ *
+ * Every message is a 32-bit length in host byte order followed by that many
+ * bytes. A request is two messages, the name of the program, which is used in
+ * diagnostics, and its source. The reply is two messages, the assembly code
+ * and the diagnostics. A connection may carry any number of requests.
+ *
+ */
+
+#ifndef CMINUSSERVER_H_
+#define CMINUSSERVER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <util/general.h>
+
+#define MAX_MESSAGE_LENGTH (64 * 1024 * 1024)	/**< the longest message a server or client accepts */
+
+/**
+ * Compile the program read from input, printing assembly code to stdout and
+ * diagnostics to stderr.
+ */
+typedef FUNCTION_POINTER(int, ServerCompileFunc, (char *name, FILE *input, int jobs));
+
+/**
+ * A message buffer that grows to the longest message received into it.
+ */
+typedef struct ServerMessage_struct {
+	char *data;		/**< the message followed by a NUL */
+	uint32_t length;	/**< the length of the message */
+	uint32_t max;		/**< the size of data */
+} ServerMessage;
+
+EXTERN(int, runServer, (char *socketPath, ServerCompileFunc compile, int jobs));
+EXTERN(int, connectToServer, (char *socketPath));
+EXTERN(bool, sendMessage, (int fd, const char *data, uint32_t length));
+EXTERN(bool, receiveMessage, (int fd, ServerMessage *message));
+
+#endif /* CMINUSSERVER_H_ */
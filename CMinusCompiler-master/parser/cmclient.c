@@ -0,0 +1,236 @@
+/**
+ * cmclient.c
+ *
+ * A client for the compile server started with "cmc --server socket".
+ *
+ *   cmclient socket file.cm...     compile each file on the server into a .s
+ *                                  file of the same name, as cmc would
+ *   cmclient -b count [-c cmc] socket file.cm
+ *                                  compile the file count times on the server,
+ *                                  with a new connection each time, then run
+ *                                  cmc on it count times, and report the
+ *                                  median and 99th percentile times of both
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <util/general.h>
+#include "CminusServer.h"
+
+/**
+ * Read a whole file.
+ *
+ * @param fileName the name of the file
+ * @param message the buffer to read into
+ * @return false if the file could not be read
+ */
+static bool readFile(char *fileName, ServerMessage *message) {
+	FILE *fp = fopen(fileName,"r");
+	size_t n;
+
+	if (fp == NULL)
+		return false;
+
+	message->length = 0;
+	do {
+		if (message->length + 4096 + 1 > message->max) {
+			message->max = 2 * message->max + 4096 + 1;
+			message->data = (char*)realloc(message->data,message->max);
+		}
+		n = fread(message->data + message->length,1,4096,fp);
+		message->length += n;
+	} while (n > 0);
+
+	fclose(fp);
+	return true;
+}
+
+/**
+ * Send a program to the server and wait for the reply.
+ *
+ * @param socketPath the path of the server's socket
+ * @param fileName the name of the program
+ * @param source the source of the program
+ * @param code receives the assembly code
+ * @param diagnostics receives the diagnostics
+ * @return false if the server could not be reached
+ */
+static bool compileOnServer(char *socketPath, char *fileName, ServerMessage *source, ServerMessage *code, ServerMessage *diagnostics) {
+	int fd = connectToServer(socketPath);
+
+	if (fd < 0)
+		return false;
+
+	bool ok = sendMessage(fd,fileName,strlen(fileName)) &&
+		  sendMessage(fd,source->data,source->length) &&
+		  receiveMessage(fd,code) &&
+		  receiveMessage(fd,diagnostics);
+
+	close(fd);
+	return ok;
+}
+
+/**
+ * Compile files on the server, writing each .s file and printing the
+ * diagnostics to stderr.
+ *
+ * @param socketPath the path of the server's socket
+ * @param files the names of the files
+ * @param numFiles the number of files
+ * @return 0 if every file was compiled
+ */
+static int compileFiles(char *socketPath, char **files, int numFiles) {
+	ServerMessage source = {NULL,0,0}, code = {NULL,0,0}, diagnostics = {NULL,0,0};
+	int i, status = 0;
+
+	for (i = 0; i < numFiles; i++) {
+		if (!readFile(files[i],&source)) {
+			fprintf(stderr,"Error: Could not open file %s\n",files[i]);
+			status = -1;
+			continue;
+		}
+		if (!compileOnServer(socketPath,files[i],&source,&code,&diagnostics)) {
+			fprintf(stderr,"Error: Could not reach the server at %s\n",socketPath);
+			return -1;
+		}
+
+		fwrite(diagnostics.data,1,diagnostics.length,stderr);
+
+		char *dotChar = strrchr(files[i],'.');
+		int endIndex = (dotChar != NULL) ? dotChar - files[i] : strlen(files[i]);
+		char *outputFileName = (char*)malloc(endIndex + 3);
+		sprintf(outputFileName,"%.*s.s",endIndex,files[i]);
+
+		FILE *output = fopen(outputFileName,"w");
+		if (output == NULL) {
+			fprintf(stderr,"Error: Could not open file %s\n",outputFileName);
+			status = -1;
+		} else {
+			fwrite(code.data,1,code.length,output);
+			fclose(output);
+		}
+		free(outputFileName);
+	}
+
+	free(source.data);
+	free(code.data);
+	free(diagnostics.data);
+	return status;
+}
+
+/**
+ * Return the time in microseconds.
+ */
+static double now() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+/**
+ * Order times for qsort.
+ *
+ * @param a a pointer to a time
+ * @param b a pointer to a time
+ * @return see above
+ */
+static int compareTimes(const void *a, const void *b) {
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * Print the median and 99th percentile of a set of times.
+ *
+ * @param label what was timed
+ * @param times the times in microseconds
+ * @param count the number of times
+ */
+static void reportTimes(char *label, double *times, int count) {
+	qsort(times,count,sizeof(double),compareTimes);
+	printf("%-8s p50 %8.1f us   p99 %8.1f us\n",label,times[count / 2],times[(count * 99) / 100]);
+}
+
+/**
+ * Compare the time to compile a file on the server with the time to run cmc on it.
+ *
+ * @param socketPath the path of the server's socket
+ * @param cmc the path of cmc
+ * @param fileName the file to compile
+ * @param count the number of compiles of each kind
+ * @return 0 if every compile succeeded
+ */
+static int benchmark(char *socketPath, char *cmc, char *fileName, int count) {
+	ServerMessage source = {NULL,0,0}, code = {NULL,0,0}, diagnostics = {NULL,0,0};
+	double *times = (double*)malloc(count * sizeof(double));
+	int i, status;
+
+	if (!readFile(fileName,&source)) {
+		fprintf(stderr,"Error: Could not open file %s\n",fileName);
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		double start = now();
+		if (!compileOnServer(socketPath,fileName,&source,&code,&diagnostics)) {
+			fprintf(stderr,"Error: Could not reach the server at %s\n",socketPath);
+			return -1;
+		}
+		times[i] = now() - start;
+	}
+	reportTimes("server",times,count);
+
+	for (i = 0; i < count; i++) {
+		double start = now();
+		pid_t pid = fork();
+		if (pid == 0) {
+			execl(cmc,cmc,fileName,(char*)NULL);
+			_exit(127);
+		}
+		if (pid < 0 || waitpid(pid,&status,0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr,"Error: Could not run %s\n",cmc);
+			return -1;
+		}
+		times[i] = now() - start;
+	}
+	reportTimes("cmc",times,count);
+
+	free(times);
+	free(source.data);
+	free(code.data);
+	free(diagnostics.data);
+	return 0;
+}
+
+static void usage(char *progName) {
+	fprintf(stderr,"Usage: %s socket file.cm ...\n",progName);
+	fprintf(stderr,"       %s -b count [-c cmc] socket file.cm\n",progName);
+	exit(-1);
+}
+
+int main(int argc, char **argv) {
+	int count = 0;
+	char *cmc = "./cmc";
+	int opt;
+
+	while ((opt = getopt(argc,argv,"b:c:")) != -1) {
+		if (opt == 'b' && atoi(optarg) > 0)
+			count = atoi(optarg);
+		else if (opt == 'c')
+			cmc = optarg;
+		else
+			usage(argv[0]);
+	}
+	if (argc - optind < 2)
+		usage(argv[0]);
+
+	if (count > 0)
+		return benchmark(argv[optind],cmc,argv[optind + 1],count);
+	return compileFiles(argv[optind],argv + optind + 1,argc - optind - 1);
+}
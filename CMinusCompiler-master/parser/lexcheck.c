@@ -0,0 +1,175 @@
+/**
+ * lexcheck.c
+ *
+ * Differential test and benchmark for the two Cminus scanners.
+ *
+ *   lexcheck file...     scan each file with the flex scanner and with the
+ *                        hand-written lexer and report the first difference in
+ *                        token code, lexeme or line number
+ *   lexcheck -b file...  report the scanning throughput of both in MB/s
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <util/general.h>
+#include <util/dlink.h>
+#include "CminusParser.h"
+#include "CminusLexer.h"
+
+#define BENCH_BYTES (64 * 1024 * 1024)	/**< the minimum number of bytes scanned by each lexer in a benchmark */
+
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+
+EXTERN(int, Cminus_lex, (void));
+EXTERN(YY_BUFFER_STATE, Cminus__scan_bytes, (const char *bytes, int len));
+EXTERN(void, Cminus__delete_buffer, (YY_BUFFER_STATE buffer));
+
+extern int Cminus_lineno;
+
+YYSTYPE Cminus_lval;
+
+int Cminus_wrap() {
+	return 1;
+}
+
+/**
+ * Return true if a token carries a lexeme in Cminus_lval.name.
+ */
+static bool hasLexeme(int token) {
+	return (bool)(token == IDENTIFIER || token == STRING || token == INTCON || token == FLOATCON);
+}
+
+/**
+ * Read a whole file into a lexer.
+ */
+static bool loadFile(char *fileName, CminusLexerPtr lexer) {
+	FILE *fp = fopen(fileName,"r");
+	if (fp == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",fileName);
+		return false;
+	}
+	bool ok = CminusLexerReadFile(lexer,fp);
+	fclose(fp);
+	return ok;
+}
+
+/**
+ * Compare the token streams of both scanners on one file.
+ *
+ * @return the number of tokens compared, -1 on a mismatch
+ */
+static int compareFile(char *fileName) {
+	CminusLexer lexer;
+	if (!loadFile(fileName,&lexer))
+		return -1;
+
+	YY_BUFFER_STATE flexBuffer = Cminus__scan_bytes(lexer.buf,lexer.end - lexer.buf);
+	Cminus_lineno = 1;
+
+	int count = 0, result = 0;
+	for (;;) {
+		int flexToken = Cminus_lex();
+		char *flexName = hasLexeme(flexToken) ? Cminus_lval.name : NULL;
+		char *handName = NULL;
+		int handToken = CminusLexerNext(&lexer,&handName);
+
+		if (flexToken != handToken || Cminus_lineno != lexer.lineno ||
+		    (flexName != NULL && strcmp(flexName,handName) != 0)) {
+			printf("%s: token %d differs: flex %d '%s' line %d, hand %d '%s' line %d\n",
+			       fileName,count,flexToken,flexName ? flexName : "",Cminus_lineno,
+			       handToken,handName ? handName : "",lexer.lineno);
+			result = -1;
+		}
+		free(flexName);
+		free(handName);
+
+		if (flexToken == 0 || handToken == 0 || result != 0)
+			break;
+		count++;
+	}
+
+	Cminus__delete_buffer(flexBuffer);
+	CminusLexerFree(&lexer);
+	return result == 0 ? count : -1;
+}
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Scan every file repeatedly with both scanners and print the throughput.
+ */
+static void benchmark(int numFiles, char **fileNames) {
+	CminusLexer *files = (CminusLexer*)malloc(numFiles * sizeof(CminusLexer));
+	size_t bytes = 0;
+	int i, rounds;
+
+	for (i = 0; i < numFiles; i++) {
+		if (!loadFile(fileNames[i],&files[i]))
+			exit(-1);
+		bytes += files[i].end - files[i].buf;
+	}
+	if (bytes == 0)
+		return;
+	rounds = BENCH_BYTES / bytes + 1;
+
+	double start = seconds();
+	for (int r = 0; r < rounds; r++)
+		for (i = 0; i < numFiles; i++) {
+			YY_BUFFER_STATE buffer = Cminus__scan_bytes(files[i].buf,files[i].end - files[i].buf);
+			int token;
+			while ((token = Cminus_lex()) != 0)
+				if (hasLexeme(token))
+					free(Cminus_lval.name);
+			Cminus__delete_buffer(buffer);
+		}
+	double flexTime = seconds() - start;
+
+	start = seconds();
+	for (int r = 0; r < rounds; r++)
+		for (i = 0; i < numFiles; i++) {
+			CminusLexer lexer;
+			char *name;
+			int token;
+			CminusLexerInit(&lexer,files[i].buf,files[i].end - files[i].buf);
+			while ((token = CminusLexerNext(&lexer,&name)) != 0)
+				if (hasLexeme(token))
+					free(name);
+			CminusLexerFree(&lexer);
+		}
+	double handTime = seconds() - start;
+
+	double mb = (double)bytes * rounds / (1024 * 1024);
+	printf("scanned %.1f MB from %d files\n",mb,numFiles);
+	printf("flex: %8.1f MB/s\n",mb / flexTime);
+	printf("hand: %8.1f MB/s\n",mb / handTime);
+
+	for (i = 0; i < numFiles; i++)
+		CminusLexerFree(&files[i]);
+	free(files);
+}
+
+int main(int argc, char **argv) {
+	int i, failures = 0;
+
+	if (argc > 1 && strcmp(argv[1],"-b") == 0) {
+		benchmark(argc - 2,argv + 2);
+		return 0;
+	}
+
+	for (i = 1; i < argc; i++) {
+		int count = compareFile(argv[i]);
+		if (count < 0)
+			failures++;
+		else
+			printf("%s: %d tokens match\n",argv[i],count);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
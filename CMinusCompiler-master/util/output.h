@@ -0,0 +1,30 @@
+/**
+ * output.h
+ *
+ * A large output buffer for the assembly code printed by the code
+ * generators. Instructions are copied into the buffer and the buffer is
+ * written to stdout in one call when it fills, instead of formatting each
+ * instruction through printf.
+ *
+ * Nothing else may write to stdout between two calls of outputFlush, and
+ * outputFlush must be called before stdout is closed or replaced. The buffer
+ * is shared by the whole process, so only one thread may print at a time.
+ *
+ */
+
+#ifndef OUTPUT_H_
+#define OUTPUT_H_
+
+#include <stddef.h>
+#include <util/general.h>
+
+#define OUTPUT_BUFFER_SIZE (256 * 1024)	/**< the number of bytes buffered before a write */
+
+EXTERN(void, outputWrite, (const char *data, size_t length));
+EXTERN(void, outputString, (const char *s));
+EXTERN(void, outputLine, (const char *s));
+EXTERN(void, outputChar, (char c));
+EXTERN(void, outputLong, (long n));
+EXTERN(void, outputFlush, (void));
+
+#endif /* OUTPUT_H_ */
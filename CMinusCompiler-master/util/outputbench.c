@@ -0,0 +1,141 @@
+/**
+ * outputbench.c
+ *
+ * Benchmark for the output buffer.
+ *
+ *   outputbench file.s out    print every line of file.s to out, once with
+ *                             printf("%s\n") per line as the code generators
+ *                             used to, once through the output buffer, and
+ *                             report the throughput of both
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <util/general.h>
+#include <util/output.h>
+
+#define BENCH_RUNS 5	/**< the best of this many runs is reported */
+
+/**
+ * Return the time in seconds.
+ */
+static double now() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * Read a file and split it into lines.
+ *
+ * @param fileName the name of the file
+ * @param numLines receives the number of lines
+ * @param size receives the size of the file
+ * @return the lines, or NULL if the file could not be read
+ */
+static char **readLines(char *fileName, int *numLines, long *size) {
+	FILE *fp = fopen(fileName,"r");
+	int i, count = 0;
+
+	if (fp == NULL)
+		return NULL;
+	fseek(fp,0,SEEK_END);
+	*size = ftell(fp);
+	rewind(fp);
+
+	char *text = (char*)malloc(*size + 1);
+	if (fread(text,1,*size,fp) != (size_t)*size) {
+		fclose(fp);
+		return NULL;
+	}
+	fclose(fp);
+	text[*size] = '\0';
+
+	for (i = 0; i < *size; i++)
+		if (text[i] == '\n')
+			count++;
+
+	char **lines = (char**)malloc((count + 1) * sizeof(char*));
+	char *line = text;
+	for (i = 0; i < count; i++) {
+		char *end = strchr(line,'\n');
+		*end = '\0';
+		lines[i] = line;
+		line = end + 1;
+	}
+
+	*numLines = count;
+	return lines;
+}
+
+/**
+ * Print all lines to a file and return the time it took.
+ *
+ * @param outName the name of the file
+ * @param lines the lines
+ * @param numLines the number of lines
+ * @param buffered use the output buffer instead of printf
+ * @param size the size the file must have afterwards
+ * @return the time in seconds, or -1 if the file is wrong
+ */
+static double printLines(char *outName, char **lines, int numLines, bool buffered, long size) {
+	struct stat st;
+	int i;
+
+	if (freopen(outName,"w",stdout) == NULL)
+		return -1;
+
+	double start = now();
+	if (buffered) {
+		for (i = 0; i < numLines; i++)
+			outputLine(lines[i]);
+		outputFlush();
+	} else {
+		for (i = 0; i < numLines; i++)
+			printf("%s\n",lines[i]);
+		fflush(stdout);
+	}
+	double elapsed = now() - start;
+
+	if (stat(outName,&st) != 0 || st.st_size != size)
+		return -1;
+	return elapsed;
+}
+
+int main(int argc, char **argv) {
+	int numLines, run, buffered;
+	long size;
+
+	if (argc != 3) {
+		fprintf(stderr,"Usage: %s file.s out\n",argv[0]);
+		return -1;
+	}
+
+	char **lines = readLines(argv[1],&numLines,&size);
+	if (lines == NULL) {
+		fprintf(stderr,"Error: Could not read file %s\n",argv[1]);
+		return -1;
+	}
+
+	fprintf(stderr,"%d lines, %.1f MB\n",numLines,size / 1e6);
+	for (buffered = 0; buffered <= 1; buffered++) {
+		double best = 1e9;
+		for (run = 0; run < BENCH_RUNS; run++) {
+			double t = printLines(argv[2],lines,numLines,buffered,size);
+			if (t < 0) {
+				fprintf(stderr,"Error: %s does not match %s\n",argv[2],argv[1]);
+				return -1;
+			}
+			if (t < best)
+				best = t;
+		}
+		fprintf(stderr,"%-14s %7.1f ms  %7.1f MB/s  %6.1f M lines/s\n",
+			buffered ? "output buffer" : "printf",best * 1e3,size / best / 1e6,numLines / best / 1e6);
+	}
+
+	return 0;
+}
@@ -493,3 +493,45 @@ int fmatch(char* target, char* string, int i)
   else        return 0;
 }
 
+
+/**
+ *
+ * Save a string constant with its quotes removed and its escapes replaced as
+ * the assembler replaces them in a .string directive
+ *
+ * @param spelling a string constant as written, quotes included
+ * @return a new string with the characters of the constant
+ */
+char* sunquote(const char* const spelling)
+{
+  char *s = (char*)malloc(strlen(spelling) + 1);
+  const char *p = spelling + 1, *end = spelling + strlen(spelling) - 1;
+  char *q = s;
+
+  while (p < end)
+    {
+      int c = (unsigned char)*p++;
+      if (c == '\\' && p < end)
+	{
+	  c = (unsigned char)*p++;
+	  if (c >= '0' && c <= '7')
+	    {
+	      int n = c - '0', digits = 1;
+	      for (; digits < 3 && *p >= '0' && *p <= '7'; digits++)
+		n = 8 * n + *p++ - '0';
+	      c = n;
+	    }
+	  else if (c == 'x')
+	    c = (int)strtol(p, (char**)&p, 16);
+	  else if (c == 'n')  c = '\n';
+	  else if (c == 't')  c = '\t';
+	  else if (c == 'r')  c = '\r';
+	  else if (c == 'b')  c = '\b';
+	  else if (c == 'f')  c = '\f';
+	}
+      *q++ = (char)c;
+    }
+  *q = '\0';
+
+  return s;
+}
@@ -42,6 +42,7 @@ EXTERN(int, eat_space, (char* string, int at));
 EXTERN(char, to_lower, (char c));
 EXTERN(int, gobble, (char* target, char* string, int j));
 EXTERN(int, fmatch, (char* target, char* string, int i));
+EXTERN(char*, sunquote, (const char *const spelling));
 
 
 #endif /* STRING_UTILS_H_ */
@@ -209,6 +209,37 @@ void SymKill(SymTable ip)
 #endif
 }
 
+/**
+ *
+ * removes every entry but the first "count", so that the instance can be
+ * used again without being rebuilt. the cleanup function of each field
+ * is invoked on the values of the removed entries, which then get the
+ * field's initial value again. the remaining entries stay where they are:
+ * an entry's probe sequence only passes through entries added before it.
+ *
+ * @param ip a symbol table
+ * @param count the number of entries to keep
+ */
+void SymTruncate(SymTable ip, int count)
+{
+  register int i, j;
+
+  for(i=0;i<ip->NumFields;i++)
+    if (ip->FieldVals[i] != 0)
+      for(j=count;j<ip->NextSlot;j++)
+      {
+        if (ip->CleanupFns[i] != 0)
+          (*(ip->CleanupFns[i]))(ip->FieldVals[i][j]);
+        ip->FieldVals[i][j] = ip->InitVals[i];
+      }
+
+  for(i=0;i<ip->NumIndices;i++)
+    if (ip->Index[i] >= count)
+      ip->Index[i] = -1;
+
+  ip->NextSlot = count;
+}
+
 /**
  *
  * returns the maximum index used for an entry in the symbol table
@@ -19,6 +19,7 @@ typedef struct SymTable_internal_structure *SymTable;
 
 EXTERN(SymTable, SymInit, (unsigned int size));
 EXTERN(void, SymKill, (SymTable ip));
+EXTERN(void, SymTruncate, (SymTable ip, int count));
 
 EXTERN(int, SymMaxIndex, (SymTable ip));
 EXTERN(int, SymIndex, (SymTable ip, char *name));
@@ -10,6 +10,10 @@
 #include <codegen/codegen.h>
 #include <codegen/reg.h>
 
+static __thread SymTable recycledSymtabs[MAX_RECYCLED_SYMTABS];	/**< released tables holding only the prelude */
+static __thread int numRecycled = 0;
+static __thread int preludeSize = 0;	/**< the number of entries a new scope starts with */
+
 /**
  * Initalize an empty stack of symbol tables
  *
@@ -17,7 +21,7 @@
 SymtabStack symtabStackInit() {
 	int *size = malloc(sizeof(int));
 	*size = 0;
-	dlinkListAlloc((Generic)size);
+	return dlinkListAlloc((Generic)size);
 }
 
 /**
@@ -38,7 +42,17 @@ int stackSize(SymtabStack stack) {
  * @return a new symbol table 
  */
 SymTable beginScope(SymtabStack stack) {
-	SymTable symtab = SymInit(SYMTABLE_SIZE);
+	SymTable symtab;
+
+	if (numRecycled > 0) {
+		symtab = recycledSymtabs[--numRecycled];
+		dlinkPush(dlinkNodeAlloc((Generic)symtab),stack);
+		int *size = (int*)dlinkListAtom(stack);
+		(*size)++;
+		return symtab;
+	}
+
+	symtab = SymInit(SYMTABLE_SIZE);
 
 	SymInitField(symtab,SYMTAB_OFFSET_FIELD,(Generic)-1,NULL);
 	SymInitField(symtab,SYMTAB_REGISTER_INDEX_FIELD,(Generic)-1,NULL);
@@ -54,6 +68,7 @@ SymTable beginScope(SymtabStack stack) {
     SymPutFieldByIndex(symtab,intIndex,SYMTAB_BASIC_TYPE_FIELD,(Generic)INTEGER_TYPE);
     SymPutFieldByIndex(symtab,errorIndex,SYMTAB_BASIC_TYPE_FIELD,(Generic)ERROR_TYPE);
     SymPutFieldByIndex(symtab,voidIndex,SYMTAB_BASIC_TYPE_FIELD,(Generic)VOID_TYPE);
+	preludeSize = SymMaxIndex(symtab) + 1;
 
 	dlinkPush(dlinkNodeAlloc((Generic)symtab),stack);
 	int *size = (int*)dlinkListAtom(stack);
@@ -75,6 +90,35 @@ SymTable endScope(SymtabStack stack) {
 	return symtab;
 }
 
+/**
+ * Release a symbol table popped off of a stack. The table is emptied down to
+ * the basic types every scope starts with and kept for the next beginScope.
+ *
+ * @param symtab a symbol table returned by endScope
+ */
+void releaseScope(SymTable symtab) {
+	if (numRecycled < MAX_RECYCLED_SYMTABS) {
+		SymTruncate(symtab,preludeSize);
+		recycledSymtabs[numRecycled++] = symtab;
+	} else {
+		SymKillField(symtab,SYMTAB_REGISTER_INDEX_FIELD);
+		SymKillField(symtab,SYMTAB_OFFSET_FIELD);
+		SymKill(symtab);
+	}
+}
+
+/**
+ * Free the symbol tables kept for reuse by the calling thread.
+ */
+void freeRecycledScopes() {
+	while (numRecycled > 0) {
+		SymTable symtab = recycledSymtabs[--numRecycled];
+		SymKillField(symtab,SYMTAB_REGISTER_INDEX_FIELD);
+		SymKillField(symtab,SYMTAB_OFFSET_FIELD);
+		SymKill(symtab);
+	}
+}
+
 /**
  * Find the topmost symbol table that contains an entry for a string
  *
@@ -6,12 +6,16 @@
 #include <util/dlink.h>
 
 #define SYMTABLE_SIZE 100
+#define MAX_RECYCLED_SYMTABS 8	/**< the number of released symbol tables kept for reuse by each thread */
 
 typedef DList SymtabStack;
 
 EXTERN(SymtabStack, symtabStackInit, (void));
+EXTERN(int, stackSize, (SymtabStack stack));
 EXTERN(SymTable, beginScope, (SymtabStack stack));
 EXTERN(SymTable, endScope, (SymtabStack stack));
+EXTERN(void, releaseScope, (SymTable symtab));
+EXTERN(void, freeRecycledScopes, (void));
 EXTERN(SymTable, findSymtab, (SymtabStack stack, char* key));
 EXTERN(SymTable, currentSymtab, (SymtabStack stack));
 EXTERN(SymTable, lastSymtab, (SymtabStack stack));
@@ -0,0 +1,114 @@
+/**
+ * bytecode.h
+ *
+ * The bytecode of the cmc --interp virtual machine. An instruction is an
+ * opcode word followed by its operand words, all 32-bit. The operands name
+ * registers, which are the words of the current frame: register k of a
+ * function holds the local variable at SYMTAB_OFFSET_FIELD 4k, so element i
+ * of a local array at offset o is register o/4 + i, and the registers after
+ * the locals hold temporaries. Globals are words of one block laid out as
+ * _gp, numbered in the same way.
+ *
+ * Operands: d, a, b and i are registers, g and l the first word of a global
+ * or a local, k a constant, L the index in the code of a branch target, f
+ * the number of a function, x the number of an external function, and s the
+ * offset of a string in the string table.
+ *
+ */
+
+#ifndef BYTECODE_H_
+#define BYTECODE_H_
+
+#include <stddef.h>
+#include <util/general.h>
+#include "vm.h"
+
+/**
+ * The opcodes with the number of their operands.
+ */
+#define VM_OPCODES(OP) \
+	OP(CONST, 2)	/* d k: d = k */ \
+	OP(MOVE, 2)	/* d a: d = a */ \
+	OP(LOADG, 2)	/* d g: d = global g */ \
+	OP(STOREG, 2)	/* g a: global g = a */ \
+	OP(LOADGX, 3)	/* d g i: d = global g + i */ \
+	OP(STOREGX, 3)	/* g i a: global g + i = a */ \
+	OP(LOADLX, 3)	/* d l i: d = register l + i */ \
+	OP(STORELX, 3)	/* l i a: register l + i = a */ \
+	OP(ADD, 3)	/* d a b: d = a + b */ \
+	OP(SUB, 3) \
+	OP(MUL, 3) \
+	OP(DIV, 3)	/* d a b: d = a / b, also left in %eax */ \
+	OP(OR, 3) \
+	OP(AND, 3) \
+	OP(EQ, 3)	/* d a b: d = 1 if a == b, else 0 */ \
+	OP(NE, 3) \
+	OP(LT, 3) \
+	OP(LE, 3) \
+	OP(GT, 3) \
+	OP(GE, 3) \
+	OP(NOT, 2)	/* d a: d = a ^ 1 */ \
+	OP(JUMP, 1)	/* L */ \
+	OP(JZ, 2)	/* a L: jump if a == 0 */ \
+	OP(JNZ, 2)	/* a L: jump if a != 0 */ \
+	OP(CALL, 2)	/* d f: call function f, d = %eax */ \
+	OP(CALLX, 2)	/* d x: call external function x, d = %eax */ \
+	OP(STRING, 2)	/* d s: d = the address of string s */ \
+	OP(READ, 1)	/* d: scanf into d */ \
+	OP(WRITE, 1)	/* a: printf a */ \
+	OP(WRITES, 1)	/* s: printf string s */ \
+	OP(RETURN, 1)	/* a: %eax = a, without leaving the function */ \
+	OP(EXIT, 0)	/* leave the function */
+
+#define VM_ENUM(name,operands) VM_##name,
+
+typedef enum VmOpcode_enum {
+	VM_OPCODES(VM_ENUM)
+	VM_NUM_OPCODES
+} VmOpcode;
+
+#define VM_LENGTH_ENUM(name,operands) VM_LENGTH_##name = 1 + (operands),
+
+/**
+ * The length in words of the instructions of each opcode.
+ */
+enum VmLength_enum {
+	VM_OPCODES(VM_LENGTH_ENUM)
+};
+
+extern const unsigned char vmOperandCount[VM_NUM_OPCODES];
+extern const char *const vmOpcodeNames[VM_NUM_OPCODES];
+
+/**
+ * A function of a program.
+ */
+typedef struct VmFunction_struct {
+	int name;		/**< the offset of its name in the string table */
+	int entry;		/**< the index in the code of its first instruction */
+	int frameSize;		/**< its registers in words */
+} VmFunction;
+
+/**
+ * A program compiled to bytecode. Everything in it is an index or an offset,
+ * so it does not depend on where it is in memory.
+ */
+typedef struct VmProgram_struct {
+	int *code;
+	int codeSize;		/**< in words */
+	VmFunction *functions;
+	int numFunctions;
+	int main;		/**< the number of main, or -1 */
+	int *externals;		/**< the offsets of the names of the external functions */
+	int numExternals;
+	char *strings;		/**< the string table: names and string constants */
+	int stringsSize;
+	int globalsSize;	/**< in words */
+	int *threaded;		/**< the code threaded for this interpreter, or NULL */
+	void *image;		/**< the bytecode image mapped for the program, or NULL */
+	size_t imageSize;
+} VmProgramStruct;
+
+EXTERN(int *, vmThreadCode, (VmProgram program, bool fuse));
+EXTERN(unsigned int, vmHandlerFingerprint, (void));
+
+#endif /* BYTECODE_H_ */
@@ -0,0 +1,477 @@
+/**
+ * compile.c
+ *
+ * The compiler from the syntax tree to bytecode. Variables are laid out as
+ * lowerDeclList lays them out, so a local lives in the register of its offset
+ * and a global in the word of its offset in _gp. A scalar local is used in
+ * place, and every other value is computed into a temporary register, with
+ * the temporaries of an expression reused as soon as it has been computed.
+ * The result of an assignment to a scalar local goes straight to the local.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <util/general.h>
+#include <util/symtab.h>
+#include <util/string_utils.h>
+#include <ast/ast.h>
+#include <codegen/types.h>
+#include <codegen/lower.h>
+#include "bytecode.h"
+#include "vm.h"
+
+#define VM_OFFSET_FIELD "offset"	/**< the offset of a variable */
+#define VM_ARRAY_FIELD "array"		/**< true if a variable is an array */
+#define VM_INDEX_FIELD "index"		/**< the number of a function or an external function */
+#define VM_NAME_SIZE 300
+
+EXTERN(void,Cminus_error,(char*));
+
+/**
+ * Where a variable lives.
+ */
+typedef struct VmVariable_struct {
+	bool global;
+	bool array;
+	int word;		/**< its first word in the globals or its register */
+} VmVariable;
+
+static Ast vmAst;
+static VmProgram program;
+static SymTable globalTable;
+static SymTable localTable;
+static SymTable functionTable;	/**< the functions of the program by name */
+static SymTable externalTable;	/**< the external functions by name */
+static int codeCapacity;
+static int nextTemp;		/**< the first free temporary register */
+static int maxTemp;		/**< the registers the current function needs */
+static bool failed;
+
+/**
+ * Create a table of variables.
+ */
+static SymTable newVariableTable() {
+	SymTable table = SymInit(64);
+	SymInitField(table,VM_OFFSET_FIELD,(Generic)0,NULL);
+	SymInitField(table,VM_ARRAY_FIELD,(Generic)0,NULL);
+	return table;
+}
+
+/**
+ * Enter a list of declarations in a table of variables with the offsets
+ * lowerDeclList gives them.
+ *
+ * @param table a table of variables
+ * @param decl the first AST_DECL of a list
+ * @return the number of bytes used by the declarations
+ */
+static int layOutDeclList(SymTable table, AstIndex decl) {
+	int offset = 0;
+
+	for (; decl != AST_NULL; decl = AST_NEXT(vmAst,decl)) {
+		AstIndex var;
+		for (var = AST_KID(vmAst,decl,0); var != AST_NULL; var = AST_NEXT(vmAst,var)) {
+			bool isArray = AST_NODE(vmAst,var)->kind == AST_ARRAY;
+			int index = SymIndex(table,AST_NAME(vmAst,var));
+
+			SymPutFieldByIndex(table,index,VM_OFFSET_FIELD,(Generic)(long)offset);
+			SymPutFieldByIndex(table,index,VM_ARRAY_FIELD,(Generic)(long)isArray);
+			if (isArray)
+				offset += VOID_SIZE * atoi(AST_NAME(vmAst,AST_KID(vmAst,var,0)));
+			else if (AST_NODE(vmAst,decl)->type == AST_TYPE_INTEGER)
+				offset += INTEGER_SIZE;
+		}
+	}
+
+	return offset;
+}
+
+/**
+ * Add a string to the string table.
+ *
+ * @return its offset
+ */
+static int addString(const char *s) {
+	int offset = program->stringsSize;
+	int length = strlen(s) + 1;
+
+	program->strings = (char*)realloc(program->strings,offset + length);
+	memcpy(program->strings + offset,s,length);
+	program->stringsSize += length;
+	return offset;
+}
+
+/**
+ * Report an error at the line of a node.
+ */
+static void reportError(AstIndex node, char *format, char *name) {
+	char msg[VM_NAME_SIZE];
+
+	snprintf(msg,VM_NAME_SIZE,format,name);
+	lowerLineno = AST_NODE(vmAst,node)->line;
+	Cminus_error(msg);
+	lowerLineno = 0;
+	failed = true;
+}
+
+/**
+ * Append an instruction to the code.
+ *
+ * @param op the opcode
+ * @param a,b,c its operands; the ones it does not have are ignored
+ * @return the index in the code of the instruction
+ */
+static int emit(VmOpcode op, int a, int b, int c) {
+	int at = program->codeSize;
+	int operands[3] = { a, b, c };
+	int i;
+
+	if (at + 4 > codeCapacity) {
+		codeCapacity = MAX(2 * codeCapacity,1024);
+		program->code = (int*)realloc(program->code,codeCapacity * sizeof(int));
+	}
+	program->code[program->codeSize++] = op;
+	for (i = 0; i < vmOperandCount[op]; i++)
+		program->code[program->codeSize++] = operands[i];
+
+	return at;
+}
+
+/**
+ * Point the last operand of a branch at the next instruction.
+ *
+ * @param branch the index in the code of the branch
+ */
+static void patchHere(int branch) {
+	program->code[branch + vmOperandCount[program->code[branch]]] = program->codeSize;
+}
+
+/**
+ * Return a new temporary register.
+ */
+static int newTemp() {
+	maxTemp = MAX(maxTemp,nextTemp + 1);
+	return nextTemp++;
+}
+
+/**
+ * Find where a variable lives, looking in the local scope first as the code
+ * generator does. An error is reported for a variable that is not declared
+ * or a scalar used as an array.
+ *
+ * @param var an AST_VAR_ADDR or AST_ARRAY_ADDR node
+ */
+static VmVariable resolveVariable(AstIndex var) {
+	VmVariable v = { false, false, 0 };
+	char *name = AST_NAME(vmAst,var);
+	SymTable table = localTable;
+	int index = SymQueryIndex(localTable,name);
+
+	if (index == SYM_INVALID_INDEX) {
+		table = globalTable;
+		index = SymQueryIndex(globalTable,name);
+	}
+	if (index == SYM_INVALID_INDEX) {
+		reportError(var,"Undeclared variable %s",name);
+		return v;
+	}
+
+	v.global = table == globalTable;
+	v.array = AST_NODE(vmAst,var)->kind == AST_ARRAY_ADDR;
+	v.word = (int)(long)SymGetFieldByIndex(table,index,VM_OFFSET_FIELD) / INTEGER_SIZE;
+	if (v.array && !SymGetFieldByIndex(table,index,VM_ARRAY_FIELD))
+		reportError(var,"Scalar variable %s used as an array",name);
+	return v;
+}
+
+/**
+ * Return the register for the result of an expression.
+ */
+static int destination(int dest) {
+	return dest >= 0 ? dest : newTemp();
+}
+
+STATIC(int, compileExpr, (AstIndex expr, int dest));
+
+/**
+ * Compile the load of a variable.
+ *
+ * @param v the variable
+ * @param index the register of the index of an array element
+ * @param dest the register for the value
+ */
+static void compileLoad(VmVariable v, int index, int dest) {
+	if (v.array)
+		emit(v.global ? VM_LOADGX : VM_LOADLX,dest,v.word,index);
+	else if (v.global)
+		emit(VM_LOADG,dest,v.word,0);
+	else if (dest != v.word)
+		emit(VM_MOVE,dest,v.word,0);
+}
+
+/**
+ * Compile the store of a register into a variable.
+ *
+ * @param v the variable
+ * @param index the register of the index of an array element
+ * @param value the register of the value
+ */
+static void compileStore(VmVariable v, int index, int value) {
+	if (v.array)
+		emit(v.global ? VM_STOREGX : VM_STORELX,v.word,index,value);
+	else if (v.global)
+		emit(VM_STOREG,v.word,value,0);
+	else if (value != v.word)
+		emit(VM_MOVE,v.word,value,0);
+}
+
+/**
+ * Compile a call of a function of the program or of this process.
+ */
+static void compileCall(AstIndex call, int dest) {
+	char *name = AST_NAME(vmAst,call);
+	int index = SymQueryIndex(functionTable,name);
+
+	if (index != SYM_INVALID_INDEX) {
+		emit(VM_CALL,dest,(int)(long)SymGetFieldByIndex(functionTable,index,VM_INDEX_FIELD),0);
+		return;
+	}
+
+	index = SymQueryIndex(externalTable,name);
+	if (index == SYM_INVALID_INDEX) {
+		index = SymIndex(externalTable,name);
+		SymPutFieldByIndex(externalTable,index,VM_INDEX_FIELD,(Generic)(long)program->numExternals);
+		program->externals = (int*)realloc(program->externals,(program->numExternals + 1) * sizeof(int));
+		program->externals[program->numExternals++] = addString(name);
+	}
+	emit(VM_CALLX,dest,(int)(long)SymGetFieldByIndex(externalTable,index,VM_INDEX_FIELD),0);
+}
+
+/**
+ * Compile an expression.
+ *
+ * @param expr an expression node
+ * @param dest the register for the value, or -1 for any register
+ * @return the register that holds the value
+ */
+static int compileExpr(AstIndex expr, int dest) {
+	static const VmOpcode binaryOps[AST_NUM_KINDS] = {
+		[AST_OR] = VM_OR, [AST_AND] = VM_AND,
+		[AST_EQ] = VM_EQ, [AST_NE] = VM_NE, [AST_LE] = VM_LE,
+		[AST_LT] = VM_LT, [AST_GE] = VM_GE, [AST_GT] = VM_GT,
+		[AST_ADD] = VM_ADD, [AST_SUB] = VM_SUB, [AST_MUL] = VM_MUL, [AST_DIV] = VM_DIV
+	};
+	AstNode *node = AST_NODE(vmAst,expr);
+	int mark = nextTemp;
+	int left, right;
+
+	switch (node->kind) {
+	case AST_LOAD: {
+		VmVariable v = resolveVariable(node->kid[0]);
+		if (!v.array && !v.global && dest < 0)
+			return v.word;
+		int index = v.array ? compileExpr(AST_KID(vmAst,node->kid[0],0),-1) : 0;
+		nextTemp = mark;
+		dest = destination(dest);
+		compileLoad(v,index,dest);
+		return dest;
+	}
+	case AST_CONST:
+		dest = destination(dest);
+		emit(VM_CONST,dest,(int)strtol(AST_NAME(vmAst,expr),NULL,10),0);
+		return dest;
+	case AST_STRING: {
+		char *s = sunquote(AST_NAME(vmAst,expr));
+		dest = destination(dest);
+		emit(VM_STRING,dest,addString(s),0);
+		free(s);
+		return dest;
+	}
+	case AST_CALL:
+		dest = destination(dest);
+		compileCall(expr,dest);
+		return dest;
+	case AST_NOT:
+		left = compileExpr(node->kid[0],-1);
+		nextTemp = mark;
+		dest = destination(dest);
+		emit(VM_NOT,dest,left,0);
+		return dest;
+	}
+
+	left = compileExpr(node->kid[0],-1);
+	right = compileExpr(node->kid[1],-1);
+	nextTemp = mark;
+	dest = destination(dest);
+	emit(binaryOps[node->kind],dest,left,right);
+	return dest;
+}
+
+/**
+ * Compile a statement.
+ *
+ * @param stmt a statement node
+ */
+static void compileStmt(AstIndex stmt) {
+	AstNode *node = AST_NODE(vmAst,stmt);
+	int mark = nextTemp;
+	int index = 0, value, branch, jump;
+	VmVariable v;
+
+	switch (node->kind) {
+	case AST_ASSIGN:
+		v = resolveVariable(node->kid[0]);
+		if (v.array)
+			index = compileExpr(AST_KID(vmAst,node->kid[0],0),-1);
+		value = compileExpr(node->kid[1],!v.array && !v.global ? v.word : -1);
+		compileStore(v,index,value);
+		break;
+	case AST_IF:
+		value = compileExpr(node->kid[0],-1);
+		nextTemp = mark;
+		branch = emit(VM_JZ,value,0,0);
+		compileStmt(node->kid[1]);
+		if (node->kid[2] != AST_NULL) {
+			jump = emit(VM_JUMP,0,0,0);
+			patchHere(branch);
+			compileStmt(node->kid[2]);
+			patchHere(jump);
+		} else
+			patchHere(branch);
+		break;
+	case AST_WHILE: {
+		/* the test is at the bottom, so an iteration takes one branch */
+		jump = emit(VM_JUMP,0,0,0);
+		int body = program->codeSize;
+		compileStmt(node->kid[1]);
+		patchHere(jump);
+		value = compileExpr(node->kid[0],-1);
+		emit(VM_JNZ,value,body,0);
+		break;
+	}
+	case AST_READ:
+		/* scanf leaves the variable alone when it reads nothing */
+		v = resolveVariable(node->kid[0]);
+		if (!v.array && !v.global) {
+			emit(VM_READ,v.word,0,0);
+			break;
+		}
+		if (v.array)
+			index = compileExpr(AST_KID(vmAst,node->kid[0],0),-1);
+		value = newTemp();
+		compileLoad(v,index,value);
+		emit(VM_READ,value,0,0);
+		compileStore(v,index,value);
+		break;
+	case AST_WRITE:
+		if (AST_NODE(vmAst,node->kid[0])->kind == AST_STRING) {
+			char *s = sunquote(AST_NAME(vmAst,node->kid[0]));
+			emit(VM_WRITES,addString(s),0,0);
+			free(s);
+		} else
+			emit(VM_WRITE,compileExpr(node->kid[0],-1),0,0);
+		break;
+	case AST_RETURN:
+		/* as in the compiled code, return sets the result and goes on */
+		emit(VM_RETURN,compileExpr(node->kid[0],-1),0,0);
+		break;
+	case AST_EXIT:
+		emit(VM_EXIT,0,0,0);
+		break;
+	case AST_BLOCK:
+		for (stmt = node->kid[0]; stmt != AST_NULL; stmt = AST_NEXT(vmAst,stmt))
+			compileStmt(stmt);
+		break;
+	}
+
+	nextTemp = mark;
+}
+
+/**
+ * Compile a function.
+ *
+ * @param f the function
+ * @param func its AST_FUNCTION node
+ */
+static void compileFunction(VmFunction *f, AstIndex func) {
+	AstIndex stmt;
+
+	localTable = newVariableTable();
+	f->name = addString(AST_NAME(vmAst,func));
+	f->entry = program->codeSize;
+	nextTemp = maxTemp = layOutDeclList(localTable,AST_KID(vmAst,func,0)) / INTEGER_SIZE;
+
+	for (stmt = AST_KID(vmAst,func,1); stmt != AST_NULL; stmt = AST_NEXT(vmAst,stmt))
+		compileStmt(stmt);
+	emit(VM_EXIT,0,0,0);
+
+	f->frameSize = maxTemp;
+	SymKill(localTable);
+}
+
+/**
+ * Compile a parsed program to bytecode.
+ *
+ * @param ast the syntax tree of a program
+ * @return the program, or NULL if errors were reported
+ */
+VmProgram vmCompile(Ast ast) {
+	AstIndex func;
+	int i;
+
+	vmAst = ast;
+	failed = false;
+	codeCapacity = 0;
+	program = (VmProgram)calloc(1,sizeof(VmProgramStruct));
+	program->main = -1;
+
+	globalTable = newVariableTable();
+	program->globalsSize = layOutDeclList(globalTable,AST_KID(ast,ast->root,0)) / INTEGER_SIZE;
+
+	functionTable = SymInit(64);
+	SymInitField(functionTable,VM_INDEX_FIELD,(Generic)0,NULL);
+	externalTable = SymInit(64);
+	SymInitField(externalTable,VM_INDEX_FIELD,(Generic)0,NULL);
+	for (func = AST_KID(ast,ast->root,1); func != AST_NULL; func = AST_NEXT(ast,func)) {
+		char *name = AST_NAME(ast,func);
+		if (SymQueryIndex(functionTable,name) == SYM_INVALID_INDEX)
+			SymPutField(functionTable,name,VM_INDEX_FIELD,(Generic)(long)program->numFunctions);
+		if (program->main < 0 && strcmp(name,"main") == 0)
+			program->main = program->numFunctions;
+		program->numFunctions++;
+	}
+
+	program->functions = (VmFunction*)calloc(program->numFunctions + 1,sizeof(VmFunction));
+	for (i = 0, func = AST_KID(ast,ast->root,1); func != AST_NULL; i++, func = AST_NEXT(ast,func))
+		compileFunction(&program->functions[i],func);
+
+	SymKill(globalTable);
+	SymKill(functionTable);
+	SymKill(externalTable);
+	if (failed) {
+		vmFree(program);
+		return NULL;
+	}
+	return program;
+}
+
+/**
+ * Free a program, or unmap the image it was mapped from.
+ */
+void vmFree(VmProgram program) {
+	if (program == NULL)
+		return;
+	if (program->image != NULL) {
+		munmap(program->image,program->imageSize);
+		free(program);
+		return;
+	}
+	free(program->code);
+	free(program->functions);
+	free(program->externals);
+	free(program->strings);
+	free(program);
+}
@@ -0,0 +1,190 @@
+/**
+ * image.c
+ *
+ * Bytecode images: a compiled program in a file that the interpreter maps
+ * into memory and runs as it is. The file starts with a header and holds
+ * the bytecode, the same code threaded for the interpreter that wrote it,
+ * the functions, the external functions, the string table and the size of
+ * the globals, each at an offset from the start of the file. Nothing in it
+ * is an address, so it runs wherever it is mapped. The threaded code is
+ * used when the fingerprint of the handlers in the header matches those of
+ * the interpreter; another interpreter threads the bytecode itself.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <util/general.h>
+#include "bytecode.h"
+#include "vm.h"
+
+#define VM_IMAGE_MAGIC 0x626d6321	/**< "!cmb" */
+#define VM_IMAGE_VERSION 1
+
+/**
+ * A section of an image.
+ */
+typedef struct VmSection_struct {
+	int offset;		/**< in bytes from the start of the file */
+	int count;		/**< the number of entries */
+} VmSection;
+
+/**
+ * The header of an image.
+ */
+typedef struct VmImageHeader_struct {
+	unsigned int magic;
+	unsigned int version;
+	unsigned int handlers;	/**< the fingerprint of the handlers of the threaded code */
+	int main;
+	int globalsSize;
+	VmSection code;
+	VmSection threaded;
+	VmSection functions;
+	VmSection externals;
+	VmSection strings;
+} VmImageHeader;
+
+/**
+ * Write a section and the padding that aligns the next one.
+ *
+ * @param fp the image
+ * @param section where to put the offset and count of the section
+ * @param data the entries
+ * @param count the number of entries
+ * @param size the size of an entry
+ * @return false if the section could not be written
+ */
+static bool writeSection(FILE *fp, VmSection *section, const void *data, int count, size_t size) {
+	static const char padding[8];
+	long offset = ftell(fp);
+	size_t pad = -(offset + count * size) & 7;
+
+	section->offset = (int)offset;
+	section->count = count;
+	if (count > 0 && fwrite(data,size,count,fp) != (size_t)count)
+		return false;
+	return fwrite(padding,1,pad,fp) == pad;
+}
+
+/**
+ * Write a program as a bytecode image.
+ *
+ * @param program the program
+ * @param fileName the image to write
+ * @return false if the image could not be written
+ */
+bool vmWriteImage(VmProgram program, char *fileName) {
+	VmImageHeader header;
+	FILE *fp = fopen(fileName,"wb");
+
+	if (fp == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",fileName);
+		return false;
+	}
+
+	int *threaded = vmThreadCode(program,true);
+	memset(&header,0,sizeof(header));
+	header.magic = VM_IMAGE_MAGIC;
+	header.version = VM_IMAGE_VERSION;
+	header.handlers = vmHandlerFingerprint();
+	header.main = program->main;
+	header.globalsSize = program->globalsSize;
+
+	bool ok = fwrite(&header,sizeof(header),1,fp) == 1 &&
+		writeSection(fp,&header.code,program->code,program->codeSize,sizeof(int)) &&
+		writeSection(fp,&header.threaded,threaded,program->codeSize,sizeof(int)) &&
+		writeSection(fp,&header.functions,program->functions,program->numFunctions,sizeof(VmFunction)) &&
+		writeSection(fp,&header.externals,program->externals,program->numExternals,sizeof(int)) &&
+		writeSection(fp,&header.strings,program->strings,program->stringsSize,1) &&
+		fseek(fp,0,SEEK_SET) == 0 && fwrite(&header,sizeof(header),1,fp) == 1;
+	free(threaded);
+
+	if (fclose(fp) != 0 || !ok) {
+		fprintf(stderr,"Error: Could not write file %s\n",fileName);
+		remove(fileName);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Return true if a section lies in an image of a given size.
+ */
+static bool inImage(VmSection section, size_t size, size_t imageSize) {
+	return section.offset >= (int)sizeof(VmImageHeader) && section.count >= 0 &&
+		section.offset % sizeof(int) == 0 &&
+		(size_t)section.offset + section.count * size <= imageSize;
+}
+
+/**
+ * Map a bytecode image into memory as a program. Only the header is read;
+ * the program's code and tables are those of the mapped file.
+ *
+ * @param fileName the image
+ * @return the program, or NULL if the file is not an image this interpreter
+ *	   can run
+ */
+VmProgram vmMapImage(char *fileName) {
+	struct stat st;
+	int fd = open(fileName,O_RDONLY);
+
+	if (fd < 0) {
+		fprintf(stderr,"Error: Could not open file %s\n",fileName);
+		return NULL;
+	}
+	if (fstat(fd,&st) < 0 || (size_t)st.st_size < sizeof(VmImageHeader)) {
+		fprintf(stderr,"Error: %s is not a bytecode image\n",fileName);
+		close(fd);
+		return NULL;
+	}
+
+	char *image = (char*)mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if (image == MAP_FAILED) {
+		fprintf(stderr,"Error: Could not map file %s\n",fileName);
+		return NULL;
+	}
+
+	VmImageHeader *header = (VmImageHeader*)image;
+	if (header->magic != VM_IMAGE_MAGIC) {
+		fprintf(stderr,"Error: %s is not a bytecode image\n",fileName);
+		munmap(image,st.st_size);
+		return NULL;
+	}
+	if (header->version != VM_IMAGE_VERSION) {
+		fprintf(stderr,"Error: %s is a bytecode image of version %u, not %d\n",fileName,header->version,VM_IMAGE_VERSION);
+		munmap(image,st.st_size);
+		return NULL;
+	}
+	if (!inImage(header->code,sizeof(int),st.st_size) || !inImage(header->threaded,sizeof(int),st.st_size) ||
+	    !inImage(header->functions,sizeof(VmFunction),st.st_size) || !inImage(header->externals,sizeof(int),st.st_size) ||
+	    !inImage(header->strings,1,st.st_size) || header->main >= header->functions.count) {
+		fprintf(stderr,"Error: %s is a damaged bytecode image\n",fileName);
+		munmap(image,st.st_size);
+		return NULL;
+	}
+
+	VmProgram program = (VmProgram)calloc(1,sizeof(VmProgramStruct));
+	program->image = image;
+	program->imageSize = st.st_size;
+	program->code = (int*)(image + header->code.offset);
+	program->codeSize = header->code.count;
+	program->functions = (VmFunction*)(image + header->functions.offset);
+	program->numFunctions = header->functions.count;
+	program->main = header->main;
+	program->externals = (int*)(image + header->externals.offset);
+	program->numExternals = header->externals.count;
+	program->strings = image + header->strings.offset;
+	program->stringsSize = header->strings.count;
+	program->globalsSize = header->globalsSize;
+	if (header->handlers == vmHandlerFingerprint() && header->threaded.count == header->code.count)
+		program->threaded = (int*)(image + header->threaded.offset);
+
+	return program;
+}
@@ -0,0 +1,40 @@
+/**
+ * superinstructions.h
+ *
+ * The superinstructions of the bytecode interpreter, written by make
+ * superinstructions from the adjacent instructions the input* programs run
+ * most often, by the dispatches fusing them saves. Each S2 or S3 names the
+ * opcodes it fuses.
+ *
+ */
+
+#ifndef SUPERINSTRUCTIONS_H_
+#define SUPERINSTRUCTIONS_H_
+
+#define VM_SUPERINSTRUCTIONS(S2,S3) \
+	S3(LOADG,MUL,LOADG) \
+	S3(MUL,LOADG,ADD) \
+	S3(LOADG,LOADG,MUL) \
+	S2(LOADG,MUL) \
+	S2(MUL,LOADG) \
+	S2(LOADG,ADD) \
+	S3(LOADG,ADD,LOADGX) \
+	S2(LOADG,LOADG) \
+	S3(LOADGX,LT,JZ) \
+	S3(LOADG,ADD,LOADG) \
+	S2(CONST,ADD) \
+	S3(LOADG,CONST,SUB) \
+	S2(CONST,SUB) \
+	S3(CONST,SUB,LOADG) \
+	S3(SUB,LOADG,MUL) \
+	S3(ADD,CONST,SUB) \
+	S3(CONST,SUB,LOADGX) \
+	S3(LOADG,ADD,CONST) \
+	S2(ADD,LOADGX) \
+	S2(LOADG,CONST) \
+	S2(ADD,LOADG) \
+	S3(ADD,LOADGX,LT) \
+	S3(LOADGX,LOADG,LOADG) \
+	S3(ADD,STOREGX,LOADG) \
+
+#endif /* SUPERINSTRUCTIONS_H_ */
@@ -0,0 +1,585 @@
+/**
+ * vm.c
+ *
+ * The bytecode interpreter. Before a program runs, its code is threaded:
+ * the opcode word of every instruction is replaced by the distance of the
+ * instruction's handler from the start of the interpreter's handlers, so an
+ * instruction jumps to the next one's handler directly, with one indirect
+ * jump and no table lookup. The threaded code still holds only offsets and
+ * does not depend on where it or the interpreter is in memory.
+ *
+ * Threading also fuses instructions: where the instructions that start at
+ * an opcode word are those of a superinstruction (superinstructions.h), the
+ * word gets the superinstruction's handler, which does the work of all of
+ * them and dispatches once. The words of the later instructions keep their
+ * own handlers, so a branch to one of them still works.
+ *
+ * The value of %eax, which the compiled code leaves in place across
+ * statements and returns at the end of a function, is kept in one variable,
+ * so a program prints and exits as its native code does.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <time.h>
+#include <pthread.h>
+#include <util/general.h>
+#include <util/string_utils.h>
+#include "bytecode.h"
+#include "superinstructions.h"
+#include "vm.h"
+
+typedef FUNCTION_POINTER(int, ExternalFunction, (void));
+
+#define VM_COUNT(name,operands) operands,
+#define VM_NAME(name,operands) #name,
+
+const unsigned char vmOperandCount[VM_NUM_OPCODES] = {
+	VM_OPCODES(VM_COUNT)
+};
+
+const char *const vmOpcodeNames[VM_NUM_OPCODES] = {
+	VM_OPCODES(VM_NAME)
+};
+
+/**
+ * The opcodes a superinstruction fuses.
+ */
+typedef struct VmSuper_struct {
+	int length;		/**< the number of opcodes */
+	VmOpcode op[3];
+} VmSuper;
+
+#define VM_SUPER2_ENTRY(a,b) { 2, { VM_##a, VM_##b } },
+#define VM_SUPER3_ENTRY(a,b,c) { 3, { VM_##a, VM_##b, VM_##c } },
+
+static const VmSuper supers[] = {
+	VM_SUPERINSTRUCTIONS(VM_SUPER2_ENTRY,VM_SUPER3_ENTRY)
+};
+
+#define VM_NUM_SUPERS ((int)(sizeof(supers) / sizeof(supers[0])))
+#define VM_COUNT_HANDLER (VM_NUM_OPCODES + VM_NUM_SUPERS)	/**< the handler that counts dispatches */
+
+/**
+ * A call in progress.
+ */
+typedef struct VmCall_struct {
+	int *pc;		/**< the call */
+	int *fp;		/**< the caller's registers */
+	int frameSize;		/**< the size of the caller's frame */
+} VmCall;
+
+/**
+ * The context of a run of a program: what a run changes is its own, and
+ * the program, its threaded code and the external functions are shared by
+ * all runs.
+ */
+typedef struct VmRun_struct {
+	VmProgram program;
+	int *code;		/**< the threaded code */
+	ExternalFunction *externals;
+	int *globals;
+	int *stack;		/**< the frames of the calls */
+	VmCall *calls;
+	FILE *in;		/**< where read reads */
+	FILE *out;		/**< where write writes */
+	bool failed;		/**< the run overflowed its stack */
+	int *handlers;		/**< when counting, the handlers of the opcode words of code */
+	long dispatches;
+	long *pairs;		/**< when profiling, the adjacent pairs executed */
+	long *triples;		/**< and the adjacent triples */
+} VmRunStruct, *VmRun;
+
+/*
+ * The work of each instruction, for the instruction at p. An instruction
+ * that branches dispatches itself when it does.
+ */
+#define VM_DO_CONST(p) fp[p[1]] = p[2];
+#define VM_DO_MOVE(p) fp[p[1]] = fp[p[2]];
+#define VM_DO_LOADG(p) fp[p[1]] = globals[p[2]];
+#define VM_DO_STOREG(p) globals[p[1]] = fp[p[2]];
+#define VM_DO_LOADGX(p) fp[p[1]] = globals[p[2] + fp[p[3]]];
+#define VM_DO_STOREGX(p) globals[p[1] + fp[p[2]]] = fp[p[3]];
+#define VM_DO_LOADLX(p) fp[p[1]] = fp[p[2] + fp[p[3]]];
+#define VM_DO_STORELX(p) fp[p[1] + fp[p[2]]] = fp[p[3]];
+#define VM_DO_ADD(p) fp[p[1]] = (int)((unsigned int)fp[p[2]] + (unsigned int)fp[p[3]]);
+#define VM_DO_SUB(p) fp[p[1]] = (int)((unsigned int)fp[p[2]] - (unsigned int)fp[p[3]]);
+#define VM_DO_MUL(p) fp[p[1]] = (int)((unsigned int)fp[p[2]] * (unsigned int)fp[p[3]]);
+/* dividing by 0 traps as idivl does */
+#define VM_DO_DIV(p) fp[p[1]] = eax = fp[p[2]] / fp[p[3]];
+#define VM_DO_OR(p) fp[p[1]] = fp[p[2]] | fp[p[3]];
+#define VM_DO_AND(p) fp[p[1]] = fp[p[2]] & fp[p[3]];
+#define VM_DO_EQ(p) fp[p[1]] = fp[p[2]] == fp[p[3]];
+#define VM_DO_NE(p) fp[p[1]] = fp[p[2]] != fp[p[3]];
+#define VM_DO_LT(p) fp[p[1]] = fp[p[2]] < fp[p[3]];
+#define VM_DO_LE(p) fp[p[1]] = fp[p[2]] <= fp[p[3]];
+#define VM_DO_GT(p) fp[p[1]] = fp[p[2]] > fp[p[3]];
+#define VM_DO_GE(p) fp[p[1]] = fp[p[2]] >= fp[p[3]];
+#define VM_DO_NOT(p) fp[p[1]] = fp[p[2]] ^ 1;
+#define VM_DO_JUMP(p) { pc = code + p[1]; NEXT(0); }
+#define VM_DO_JZ(p) if (fp[p[1]] == 0) { pc = code + p[2]; NEXT(0); }
+#define VM_DO_JNZ(p) if (fp[p[1]] != 0) { pc = code + p[2]; NEXT(0); }
+#define VM_DO_CALL(p) { \
+	f = &functions[p[2]]; \
+	if (call == callEnd || fp + frameSize + f->frameSize > stackEnd) \
+		goto overflow; \
+	call->pc = pc; \
+	call->fp = fp; \
+	call->frameSize = frameSize; \
+	call++; \
+	fp += frameSize; \
+	frameSize = f->frameSize; \
+	pc = code + f->entry; \
+	NEXT(0); \
+}
+#define VM_DO_CALLX(p) fp[p[1]] = eax = run->externals[p[2]]();
+#define VM_DO_STRING(p) fp[p[1]] = (int)(long)(program->strings + p[2]);
+#define VM_DO_READ(p) eax = fscanf(in,"%d",&fp[p[1]]);
+#define VM_DO_WRITE(p) eax = fprintf(out,"%d\n",fp[p[1]]);
+#define VM_DO_WRITES(p) eax = fprintf(out,"%s\n",program->strings + p[1]);
+#define VM_DO_RETURN(p) eax = fp[p[1]];
+#define VM_DO_EXIT(p) { \
+	if (call == run->calls) \
+		return eax; \
+	call--; \
+	pc = call->pc; \
+	fp = call->fp; \
+	frameSize = call->frameSize; \
+	fp[pc[1]] = eax; \
+	NEXT(VM_LENGTH_CALL); \
+}
+
+#define NEXT(length) do { pc += (length); goto *(&&op_CONST + *pc); } while (0)
+
+#define VM_HANDLER(name,operands) op_##name: VM_DO_##name(pc) NEXT(1 + (operands));
+#define VM_SUPER2_HANDLER(a,b) op_##a##_##b: \
+	VM_DO_##a(pc) VM_DO_##b((pc + VM_LENGTH_##a)) NEXT(VM_LENGTH_##a + VM_LENGTH_##b);
+#define VM_SUPER3_HANDLER(a,b,c) op_##a##_##b##_##c: \
+	VM_DO_##a(pc) VM_DO_##b((pc + VM_LENGTH_##a)) VM_DO_##c((pc + VM_LENGTH_##a + VM_LENGTH_##b)) \
+	NEXT(VM_LENGTH_##a + VM_LENGTH_##b + VM_LENGTH_##c);
+
+#define VM_OFFSET(name,operands) &&op_##name - &&op_CONST,
+#define VM_SUPER2_OFFSET(a,b) &&op_##a##_##b - &&op_CONST,
+#define VM_SUPER3_OFFSET(a,b,c) &&op_##a##_##b##_##c - &&op_CONST,
+
+/**
+ * Run a program from the start of main or, with a NULL run, return the
+ * offsets of the handlers, which must be known to thread the code and are
+ * only known inside this function: those of the opcodes, then those of the
+ * superinstructions, then the one that counts dispatches.
+ *
+ * @param run the state of the run, with the code threaded
+ * @param handlers where to put the offsets of the handlers if run is NULL
+ * @return the value of %eax when main returns
+ */
+static int execute(VmRun run, const int **handlers) {
+	static const int offsets[VM_COUNT_HANDLER + 1] = {
+		VM_OPCODES(VM_OFFSET)
+		VM_SUPERINSTRUCTIONS(VM_SUPER2_OFFSET,VM_SUPER3_OFFSET)
+		&&op_COUNT - &&op_CONST
+	};
+
+	if (run == NULL) {
+		*handlers = offsets;
+		return 0;
+	}
+
+	VmProgram program = run->program;
+	VmFunction *functions = program->functions;
+	int *code = run->code;
+	int *globals = run->globals;
+	int *stackEnd = run->stack + VM_STACK_WORDS;
+	VmCall *call = run->calls;
+	VmCall *callEnd = run->calls + VM_CALL_DEPTH;
+	VmFunction *f = &functions[program->main];
+	int *fp = run->stack;
+	int frameSize = f->frameSize;
+	int *pc = code + f->entry;
+	int *last = NULL, *nextToLast = NULL;
+	FILE *in = run->in, *out = run->out;
+	int eax = 0;
+
+	if (fp + frameSize > stackEnd)
+		goto overflow;
+	NEXT(0);
+
+	VM_OPCODES(VM_HANDLER)
+	VM_SUPERINSTRUCTIONS(VM_SUPER2_HANDLER,VM_SUPER3_HANDLER)
+
+op_COUNT:
+	run->dispatches++;
+	if (run->pairs != NULL) {
+		/* count the instructions run after the one next to them in the code */
+		int *source = program->code;
+		int op = source[pc - code];
+		if (last != NULL && pc == last + 1 + vmOperandCount[source[last - code]]) {
+			run->pairs[source[last - code] * VM_NUM_OPCODES + op]++;
+			if (nextToLast != NULL)
+				run->triples[(source[nextToLast - code] * VM_NUM_OPCODES + source[last - code]) * VM_NUM_OPCODES + op]++;
+			nextToLast = last;
+		} else
+			nextToLast = NULL;
+		last = pc;
+	}
+	goto *(&&op_CONST + run->handlers[pc - code]);
+
+overflow:
+	fprintf(stderr,"Error: Stack overflow in %s\n",program->strings + f->name);
+	run->failed = true;
+	return -1;
+}
+
+/**
+ * Return true if an opcode can be part of a superinstruction: every opcode
+ * but those that change frames, and a jump only at the end.
+ */
+static bool fusible(VmOpcode op, bool atEnd) {
+	return op != VM_CALL && op != VM_EXIT && (op != VM_JUMP || atEnd);
+}
+
+/**
+ * Find the longest superinstruction that starts at an instruction.
+ *
+ * @param program the program
+ * @param at the index in the code of the instruction
+ * @return the number of the superinstruction, or -1
+ */
+static int findSuper(VmProgram program, int at) {
+	int best = -1;
+	int s, i;
+
+	for (s = 0; s < VM_NUM_SUPERS; s++) {
+		int pos = at;
+		for (i = 0; i < supers[s].length && pos < program->codeSize && program->code[pos] == supers[s].op[i]; i++)
+			pos += 1 + vmOperandCount[program->code[pos]];
+		if (i == supers[s].length && (best < 0 || supers[s].length > supers[best].length))
+			best = s;
+	}
+
+	return best;
+}
+
+/**
+ * Thread the code of a program.
+ *
+ * @param program the program
+ * @param fuse true to use the superinstructions
+ * @return a copy of its code with handler offsets for opcodes
+ */
+int *vmThreadCode(VmProgram program, bool fuse) {
+	int *code = (int*)malloc(MAX(program->codeSize,1) * sizeof(int));
+	const int *handlers;
+	int i;
+
+	execute(NULL,&handlers);
+	memcpy(code,program->code,program->codeSize * sizeof(int));
+	for (i = 0; i < program->codeSize; i += 1 + vmOperandCount[program->code[i]]) {
+		int s = fuse ? findSuper(program,i) : -1;
+		code[i] = handlers[s >= 0 ? VM_NUM_OPCODES + s : program->code[i]];
+	}
+
+	return code;
+}
+
+/**
+ * Return a fingerprint of the handlers of this interpreter. Threaded code
+ * runs only in an interpreter with the same fingerprint.
+ */
+unsigned int vmHandlerFingerprint() {
+	unsigned int hash = 2166136261u;
+	const int *handlers;
+	int i, j;
+
+	execute(NULL,&handlers);
+	for (i = 0; i <= VM_COUNT_HANDLER; i++)
+		hash = (hash ^ (unsigned int)handlers[i]) * 16777619u;
+	for (i = 0; i < VM_NUM_SUPERS; i++)
+		for (j = 0; j < supers[i].length; j++)
+			hash = (hash ^ (unsigned int)supers[i].op[j]) * 16777619u;
+
+	return hash;
+}
+
+/**
+ * Add the counts of the adjacent pairs and triples of instructions that a
+ * superinstruction could fuse to a profile, one per line: the count, then
+ * the opcodes.
+ *
+ * @return false if the profile could not be written
+ */
+static bool writeProfile(VmRun run, char *profileFile) {
+	FILE *fp = fopen(profileFile,"a");
+	int a, b, c;
+
+	if (fp == NULL) {
+		fprintf(stderr,"Error: Could not open file %s\n",profileFile);
+		return false;
+	}
+
+	for (a = 0; a < VM_NUM_OPCODES; a++)
+		for (b = 0; b < VM_NUM_OPCODES; b++) {
+			long count = run->pairs[a * VM_NUM_OPCODES + b];
+			if (count > 0 && fusible(a,false) && fusible(b,true))
+				fprintf(fp,"%ld %s %s\n",count,vmOpcodeNames[a],vmOpcodeNames[b]);
+			for (c = 0; c < VM_NUM_OPCODES; c++) {
+				count = run->triples[(a * VM_NUM_OPCODES + b) * VM_NUM_OPCODES + c];
+				if (count > 0 && fusible(a,false) && fusible(b,false) && fusible(c,true))
+					fprintf(fp,"%ld %s %s %s\n",count,vmOpcodeNames[a],vmOpcodeNames[b],vmOpcodeNames[c]);
+			}
+		}
+
+	fclose(fp);
+	return true;
+}
+
+/**
+ * Resolve the external functions a program calls, as the loader does, to
+ * the functions of this process.
+ *
+ * @return the functions, or NULL if one is not defined
+ */
+static ExternalFunction *resolveExternals(VmProgram program) {
+	ExternalFunction *externals = (ExternalFunction*)calloc(program->numExternals + 1,sizeof(ExternalFunction));
+	int i;
+
+	for (i = 0; i < program->numExternals; i++) {
+		char *external = program->strings + program->externals[i];
+		externals[i] = (ExternalFunction)dlsym(RTLD_DEFAULT,external);
+		if (externals[i] == NULL) {
+			fprintf(stderr,"Error: Undefined symbol %s\n",external);
+			free(externals);
+			return NULL;
+		}
+	}
+
+	return externals;
+}
+
+/**
+ * Create the context of a run.
+ *
+ * @param program the program
+ * @param code its threaded code
+ * @param externals its external functions
+ * @param in where read reads
+ * @param out where write writes
+ */
+static VmRun newRun(VmProgram program, int *code, ExternalFunction *externals, FILE *in, FILE *out) {
+	VmRun run = (VmRun)calloc(1,sizeof(VmRunStruct));
+
+	run->program = program;
+	run->code = code;
+	run->externals = externals;
+	run->globals = (int*)calloc(program->globalsSize + 1,sizeof(int));
+	run->stack = (int*)calloc(VM_STACK_WORDS,sizeof(int));
+	run->calls = (VmCall*)malloc(VM_CALL_DEPTH * sizeof(VmCall));
+	run->in = in;
+	run->out = out;
+	return run;
+}
+
+/**
+ * Free the context of a run, but not what it shares.
+ */
+static void freeRun(VmRun run) {
+	free(run->globals);
+	free(run->stack);
+	free(run->calls);
+	free(run->pairs);
+	free(run->triples);
+	free(run);
+}
+
+/**
+ * Return the code of a program threaded for this interpreter, which is that
+ * of its bytecode image when it has one.
+ */
+static int *sharedCode(VmProgram program, bool fuse) {
+	return program->threaded != NULL && fuse ? program->threaded : vmThreadCode(program,fuse);
+}
+
+/**
+ * Run a program compiled to bytecode. The program's output goes to stdout
+ * and its input comes from stdin.
+ *
+ * @param program the program
+ * @param name the name of the program used in diagnostics
+ * @param fuse true to use the superinstructions
+ * @param stats true to print the number of dispatches
+ * @param profileFile a file to add the counts of adjacent instructions to,
+ *	  which are counted without superinstructions, or NULL
+ * @return the value main returns, or -1 if the program could not be run
+ */
+int vmRun(VmProgram program, char *name, bool fuse, bool stats, char *profileFile) {
+	const int *handlers;
+	int i, result;
+
+	if (program->main < 0) {
+		fprintf(stderr,"Error: %s has no main function\n",name);
+		return -1;
+	}
+	ExternalFunction *externals = resolveExternals(program);
+	if (externals == NULL)
+		return -1;
+
+	fuse = fuse && profileFile == NULL;
+	int *code = sharedCode(program,fuse);
+	VmRun run = newRun(program,code,externals,stdin,stdout);
+	if (stats || profileFile != NULL) {
+		/* every dispatch goes to the counting handler, which goes on to the real one */
+		execute(NULL,&handlers);
+		run->handlers = code;
+		run->code = (int*)malloc(MAX(program->codeSize,1) * sizeof(int));
+		memcpy(run->code,code,program->codeSize * sizeof(int));
+		for (i = 0; i < program->codeSize; i += 1 + vmOperandCount[program->code[i]])
+			run->code[i] = handlers[VM_COUNT_HANDLER];
+	}
+	if (profileFile != NULL) {
+		run->pairs = (long*)calloc(VM_NUM_OPCODES * VM_NUM_OPCODES,sizeof(long));
+		run->triples = (long*)calloc(VM_NUM_OPCODES * VM_NUM_OPCODES * VM_NUM_OPCODES,sizeof(long));
+	}
+
+	result = execute(run,NULL);
+	fflush(stdout);
+
+	if (stats)
+		fprintf(stderr,"%ld instructions dispatched\n",run->dispatches);
+	if (profileFile != NULL && !writeProfile(run,profileFile))
+		result = -1;
+
+	if (run->code != code)
+		free(run->code);
+	if (code != program->threaded)
+		free(code);
+	free(externals);
+	freeRun(run);
+	return result;
+}
+
+/**
+ * The runs of a batch.
+ */
+typedef struct VmBatch_struct {
+	VmProgram program;
+	int *code;
+	ExternalFunction *externals;
+	char **inputs;		/**< the input file of each run */
+	int numInputs;
+	int next;		/**< the next run to start */
+	int failed;		/**< the runs that failed */
+} VmBatch;
+
+static pthread_mutex_t batchLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Take the next run of a batch.
+ *
+ * @return the number of the run, or -1 when all runs are taken
+ */
+static int takeRun(VmBatch *batch) {
+	int task;
+
+	pthread_mutex_lock(&batchLock);
+	task = batch->next < batch->numInputs ? batch->next++ : -1;
+	pthread_mutex_unlock(&batchLock);
+
+	return task;
+}
+
+/**
+ * Do runs of a batch until none are left, all in one context, with the
+ * globals cleared before each run.
+ *
+ * @param arg the batch
+ * @return NULL
+ */
+static void *batchWorker(void *arg) {
+	VmBatch *batch = (VmBatch*)arg;
+	VmRun run = newRun(batch->program,batch->code,batch->externals,NULL,NULL);
+	int task, failed = 0;
+
+	while ((task = takeRun(batch)) != -1) {
+		char *input = batch->inputs[task];
+		char *output = nssave(2,input,".out");
+
+		run->in = fopen(input,"r");
+		run->out = run->in != NULL ? fopen(output,"w") : NULL;
+		if (run->out == NULL) {
+			fprintf(stderr,"Error: Could not open file %s\n",run->in == NULL ? input : output);
+			failed++;
+		} else {
+			memset(run->globals,0,batch->program->globalsSize * sizeof(int));
+			run->failed = false;
+			execute(run,NULL);
+			if (fclose(run->out) != 0 || run->failed)
+				failed++;
+		}
+		if (run->in != NULL)
+			fclose(run->in);
+		sfree(output);
+	}
+
+	pthread_mutex_lock(&batchLock);
+	batch->failed += failed;
+	pthread_mutex_unlock(&batchLock);
+	freeRun(run);
+	return NULL;
+}
+
+/**
+ * Run a program once for each of a number of input files, on a number of
+ * threads that share the program. A run reads from its input file and
+ * writes to the file of the same name with .out appended.
+ *
+ * @param program the program
+ * @param name the name of the program used in diagnostics
+ * @param inputs the input files
+ * @param numInputs the number of input files
+ * @param jobs the number of threads
+ * @param fuse true to use the superinstructions
+ * @param stats true to print the runs per second
+ * @return 0 if every run succeeded, else -1
+ */
+int vmRunBatch(VmProgram program, char *name, char **inputs, int numInputs, int jobs, bool fuse, bool stats) {
+	VmBatch batch;
+	struct timespec start, end;
+	int i;
+
+	if (program->main < 0) {
+		fprintf(stderr,"Error: %s has no main function\n",name);
+		return -1;
+	}
+	memset(&batch,0,sizeof(batch));
+	batch.externals = resolveExternals(program);
+	if (batch.externals == NULL)
+		return -1;
+	batch.program = program;
+	batch.code = sharedCode(program,fuse);
+	batch.inputs = inputs;
+	batch.numInputs = numInputs;
+
+	clock_gettime(CLOCK_MONOTONIC,&start);
+	pthread_t *threads = (pthread_t*)malloc(jobs * sizeof(pthread_t));
+	for (i = 1; i < jobs; i++)
+		pthread_create(&threads[i],NULL,batchWorker,&batch);
+	batchWorker(&batch);
+	for (i = 1; i < jobs; i++)
+		pthread_join(threads[i],NULL);
+	free(threads);
+	clock_gettime(CLOCK_MONOTONIC,&end);
+
+	if (stats) {
+		double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+		fprintf(stderr,"%d runs in %.3f s on %d threads, %.0f runs/s\n",numInputs,seconds,jobs,numInputs / seconds);
+	}
+	if (batch.failed > 0)
+		fprintf(stderr,"Error: %d of %d runs of %s failed\n",batch.failed,numInputs,name);
+
+	if (batch.code != program->threaded)
+		free(batch.code);
+	free(batch.externals);
+	return batch.failed > 0 ? -1 : 0;
+}
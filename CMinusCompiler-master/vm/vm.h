@@ -0,0 +1,34 @@
+/**
+ * vm.h
+ *
+ * A bytecode virtual machine for running a program in this process without
+ * an assembler or native code. The program is compiled once to a compact
+ * register-based bytecode and run by a direct-threaded interpreter, with
+ * read and write built into the machine. Sequences of instructions that run
+ * often are fused into superinstructions, chosen from a profile of the
+ * adjacent instructions programs run. A compiled program can be written to a
+ * bytecode image, which is mapped and run later without the front end. A
+ * program never changes once it is loaded, so a batch of runs with inputs of
+ * their own can share it on any number of threads.
+ *
+ */
+
+#ifndef VM_H_
+#define VM_H_
+
+#include <util/general.h>
+#include <ast/ast.h>
+
+#define VM_STACK_WORDS (1 << 22)	/**< the size of the stack of frames */
+#define VM_CALL_DEPTH (1 << 20)		/**< the number of calls that can be active */
+
+typedef struct VmProgram_struct *VmProgram;
+
+EXTERN(VmProgram, vmCompile, (Ast ast));
+EXTERN(void, vmFree, (VmProgram program));
+EXTERN(bool, vmWriteImage, (VmProgram program, char *fileName));
+EXTERN(VmProgram, vmMapImage, (char *fileName));
+EXTERN(int, vmRun, (VmProgram program, char *name, bool fuse, bool stats, char *profileFile));
+EXTERN(int, vmRunBatch, (VmProgram program, char *name, char **inputs, int numInputs, int jobs, bool fuse, bool stats));
+
+#endif /* VM_H_ */
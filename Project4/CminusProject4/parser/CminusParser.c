@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.4"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -65,12 +70,11 @@
 #define yyerror         Cminus_error
 #define yydebug         Cminus_debug
 #define yynerrs         Cminus_nerrs
-
 #define yylval          Cminus_lval
 #define yychar          Cminus_char
 
-/* Copy the first part of user declarations.  */
-#line 7 "CminusParser.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 7 "CminusParser.y"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -81,6 +85,7 @@
 #include <util/symtab_stack.h>
 #include <util/dlink.h>
 #include <util/string_utils.h>
+#include <util/output.h>
 #include "mips_mgmt.h"
 
 #define SYMTABLE_SIZE 100
@@ -104,123 +109,195 @@ long getValue(int);
 int  setValue(int,long);
 
 
-#line 108 "CminusParser.c" /* yacc.c:339  */
+#line 113 "CminusParser.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "CminusParser.h".  */
-#ifndef YY_CMINUS_CMINUSPARSER_H_INCLUDED
-# define YY_CMINUS_CMINUSPARSER_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int Cminus_debug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    AND = 258,
-    ELSE = 259,
-    EXIT = 260,
-    FOR = 261,
-    IF = 262,
-    INTEGER = 263,
-    NOT = 264,
-    OR = 265,
-    READ = 266,
-    WHILE = 267,
-    WRITE = 268,
-    LBRACE = 269,
-    RBRACE = 270,
-    LE = 271,
-    LT = 272,
-    GE = 273,
-    GT = 274,
-    EQ = 275,
-    NE = 276,
-    ASSIGN = 277,
-    COMMA = 278,
-    SEMICOLON = 279,
-    LBRACKET = 280,
-    RBRACKET = 281,
-    LPAREN = 282,
-    RPAREN = 283,
-    PLUS = 284,
-    TIMES = 285,
-    IDENTIFIER = 286,
-    DIVIDE = 287,
-    RETURN = 288,
-    STRING = 289,
-    INTCON = 290,
-    MINUS = 291,
-    DIVDE = 292
-  };
-#endif
+#include "CminusParser.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_AND = 3,                        /* AND  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_EXIT = 5,                       /* EXIT  */
+  YYSYMBOL_FOR = 6,                        /* FOR  */
+  YYSYMBOL_IF = 7,                         /* IF  */
+  YYSYMBOL_INTEGER = 8,                    /* INTEGER  */
+  YYSYMBOL_NOT = 9,                        /* NOT  */
+  YYSYMBOL_OR = 10,                        /* OR  */
+  YYSYMBOL_READ = 11,                      /* READ  */
+  YYSYMBOL_WHILE = 12,                     /* WHILE  */
+  YYSYMBOL_WRITE = 13,                     /* WRITE  */
+  YYSYMBOL_LBRACE = 14,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 15,                    /* RBRACE  */
+  YYSYMBOL_LE = 16,                        /* LE  */
+  YYSYMBOL_LT = 17,                        /* LT  */
+  YYSYMBOL_GE = 18,                        /* GE  */
+  YYSYMBOL_GT = 19,                        /* GT  */
+  YYSYMBOL_EQ = 20,                        /* EQ  */
+  YYSYMBOL_NE = 21,                        /* NE  */
+  YYSYMBOL_ASSIGN = 22,                    /* ASSIGN  */
+  YYSYMBOL_COMMA = 23,                     /* COMMA  */
+  YYSYMBOL_SEMICOLON = 24,                 /* SEMICOLON  */
+  YYSYMBOL_LBRACKET = 25,                  /* LBRACKET  */
+  YYSYMBOL_RBRACKET = 26,                  /* RBRACKET  */
+  YYSYMBOL_LPAREN = 27,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 28,                    /* RPAREN  */
+  YYSYMBOL_PLUS = 29,                      /* PLUS  */
+  YYSYMBOL_TIMES = 30,                     /* TIMES  */
+  YYSYMBOL_IDENTIFIER = 31,                /* IDENTIFIER  */
+  YYSYMBOL_DIVIDE = 32,                    /* DIVIDE  */
+  YYSYMBOL_RETURN = 33,                    /* RETURN  */
+  YYSYMBOL_STRING = 34,                    /* STRING  */
+  YYSYMBOL_INTCON = 35,                    /* INTCON  */
+  YYSYMBOL_MINUS = 36,                     /* MINUS  */
+  YYSYMBOL_DIVDE = 37,                     /* DIVDE  */
+  YYSYMBOL_YYACCEPT = 38,                  /* $accept  */
+  YYSYMBOL_Program = 39,                   /* Program  */
+  YYSYMBOL_Procedures = 40,                /* Procedures  */
+  YYSYMBOL_ProcedureDecl = 41,             /* ProcedureDecl  */
+  YYSYMBOL_ProcedureHead = 42,             /* ProcedureHead  */
+  YYSYMBOL_FunctionDecl = 43,              /* FunctionDecl  */
+  YYSYMBOL_ProcedureBody = 44,             /* ProcedureBody  */
+  YYSYMBOL_DeclList = 45,                  /* DeclList  */
+  YYSYMBOL_IdentifierList = 46,            /* IdentifierList  */
+  YYSYMBOL_VarDecl = 47,                   /* VarDecl  */
+  YYSYMBOL_Type = 48,                      /* Type  */
+  YYSYMBOL_Statement = 49,                 /* Statement  */
+  YYSYMBOL_Assignment = 50,                /* Assignment  */
+  YYSYMBOL_IfStatement = 51,               /* IfStatement  */
+  YYSYMBOL_TestAndThen = 52,               /* TestAndThen  */
+  YYSYMBOL_Test = 53,                      /* Test  */
+  YYSYMBOL_WhileStatement = 54,            /* WhileStatement  */
+  YYSYMBOL_WhileExpr = 55,                 /* WhileExpr  */
+  YYSYMBOL_WhileToken = 56,                /* WhileToken  */
+  YYSYMBOL_IOStatement = 57,               /* IOStatement  */
+  YYSYMBOL_ReturnStatement = 58,           /* ReturnStatement  */
+  YYSYMBOL_ExitStatement = 59,             /* ExitStatement  */
+  YYSYMBOL_CompoundStatement = 60,         /* CompoundStatement  */
+  YYSYMBOL_StatementList = 61,             /* StatementList  */
+  YYSYMBOL_Expr = 62,                      /* Expr  */
+  YYSYMBOL_SimpleExpr = 63,                /* SimpleExpr  */
+  YYSYMBOL_AddExpr = 64,                   /* AddExpr  */
+  YYSYMBOL_MulExpr = 65,                   /* MulExpr  */
+  YYSYMBOL_Factor = 66,                    /* Factor  */
+  YYSYMBOL_Variable = 67,                  /* Variable  */
+  YYSYMBOL_StringConstant = 68,            /* StringConstant  */
+  YYSYMBOL_Constant = 69                   /* Constant  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef int YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
 
 
-extern YYSTYPE Cminus_lval;
 
-int Cminus_parse (void);
+#ifdef short
+# undef short
+#endif
 
-#endif /* !YY_CMINUS_CMINUSPARSER_H_INCLUDED  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-#line 197 "CminusParser.c" /* yacc.c:358  */
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -228,15 +305,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -250,47 +340,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -303,8 +389,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -369,8 +469,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -379,17 +478,17 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -402,11 +501,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -418,12 +517,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -446,17 +545,20 @@ union yyalloc
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  130
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   292
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -491,28 +593,35 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,    90,    90,    94,   100,   105,   110,   116,   120,   126,
-     132,   139,   143,   150,   155,   161,   166,   173,   179,   184,
-     199,   211,   215,   219,   223,   229,   239,   242,   248,   253,
-     265,   270,   279,   289,   296,   302,   310,   316,   322,   328,
-     332,   338,   342,   350,   358,   367,   371,   379,   387,   395,
-     403,   411,   421,   425,   433,   443,   447,   455,   465,   472,
-     478,   482,   488,   496,   514,   523
+       0,    91,    91,    95,   101,   106,   111,   117,   121,   127,
+     133,   140,   144,   151,   156,   162,   167,   174,   180,   185,
+     200,   212,   216,   220,   224,   230,   240,   243,   249,   254,
+     266,   271,   280,   290,   297,   303,   311,   317,   323,   329,
+     333,   339,   343,   351,   359,   368,   372,   380,   388,   396,
+     404,   412,   422,   426,   434,   444,   448,   456,   466,   473,
+     479,   483,   489,   497,   515,   524
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "AND", "ELSE", "EXIT", "FOR", "IF",
-  "INTEGER", "NOT", "OR", "READ", "WHILE", "WRITE", "LBRACE", "RBRACE",
-  "LE", "LT", "GE", "GT", "EQ", "NE", "ASSIGN", "COMMA", "SEMICOLON",
-  "LBRACKET", "RBRACKET", "LPAREN", "RPAREN", "PLUS", "TIMES",
+  "\"end of file\"", "error", "\"invalid token\"", "AND", "ELSE", "EXIT",
+  "FOR", "IF", "INTEGER", "NOT", "OR", "READ", "WHILE", "WRITE", "LBRACE",
+  "RBRACE", "LE", "LT", "GE", "GT", "EQ", "NE", "ASSIGN", "COMMA",
+  "SEMICOLON", "LBRACKET", "RBRACKET", "LPAREN", "RPAREN", "PLUS", "TIMES",
   "IDENTIFIER", "DIVIDE", "RETURN", "STRING", "INTCON", "MINUS", "DIVDE",
   "$accept", "Program", "Procedures", "ProcedureDecl", "ProcedureHead",
   "FunctionDecl", "ProcedureBody", "DeclList", "IdentifierList", "VarDecl",
@@ -522,32 +631,26 @@ static const char *const yytname[] =
   "Expr", "SimpleExpr", "AddExpr", "MulExpr", "Factor", "Variable",
   "StringConstant", "Constant", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -65
+#define YYPACT_NINF (-65)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-65)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
       30,   -65,    11,   -65,    30,    49,    30,    30,   -14,   -65,
@@ -565,10 +668,10 @@ static const yytype_int8 yypact[] =
       68,   -65,   -65,   -65,   -65,   -65,   -65,   -65,   -65,   -65
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
        5,    17,     0,     2,     5,     0,     8,     5,     0,     1,
        4,     0,     0,     0,     0,    32,     0,     0,    62,     0,
@@ -585,7 +688,7 @@ static const yytype_uint8 yydefact[] =
       54,    56,    57,    31,    25,    16,     9,    33,    34,    35
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
      -65,   -65,    23,   -65,   -65,   -65,   -65,   133,   -31,    77,
@@ -594,18 +697,18 @@ static const yytype_int16 yypgoto[] =
      -65,   -65
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     2,     3,     4,     5,     6,    20,     7,    37,    38,
+       0,     2,     3,     4,     5,     6,    20,     7,    37,    38,
        8,    21,    22,    23,    42,    43,    24,    60,    25,    26,
       27,    28,    29,    30,    52,    53,    54,    55,    56,    57,
       77,    58
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
       31,    80,    62,    40,    66,    73,    92,    11,    83,    33,
@@ -644,9 +747,9 @@ static const yytype_int8 yycheck[] =
       24,    24,    24,    17,    -1,    -1,    69
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     8,    39,    40,    41,    42,    43,    45,    48,     0,
       40,    48,     5,     7,    11,    12,    13,    14,    31,    33,
@@ -663,8 +766,8 @@ static const yytype_uint8 yystos[] =
       65,    66,    66,    28,    24,    26,    14,    24,    24,    24
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
        0,    38,    39,    39,    40,    40,    41,    42,    42,    43,
       44,    45,    45,    46,    46,    47,    47,    48,    49,    49,
@@ -675,8 +778,8 @@ static const yytype_uint8 yyr1[] =
       66,    66,    67,    67,    68,    69
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     1,     2,     2,     0,     2,     2,     1,     5,
        2,     3,     4,     1,     3,     1,     4,     1,     1,     1,
@@ -688,39 +791,39 @@ static const yytype_uint8 yyr2[] =
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
 /* Enable debugging if requested.  */
@@ -737,55 +840,52 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value); \
+                  Kind, Value); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -794,7 +894,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -817,21 +917,21 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                                              );
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -846,8 +946,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -870,249 +970,30 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-static YYSIZE_T
-yystrlen (const char *yystr)
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            /* Fall through.  */
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
 
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
 
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
 
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
@@ -1121,6 +1002,8 @@ YYSTYPE yylval;
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1128,43 +1011,36 @@ int yynerrs;
 int
 yyparse (void)
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1172,71 +1048,75 @@ yyparse (void)
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
                     &yystacksize);
-
         yyss = yyss1;
         yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1244,30 +1124,31 @@ yyparse (void)
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1278,18 +1159,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1317,15 +1209,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1340,7 +1230,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1360,148 +1250,148 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 91 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 2: /* Program: Procedures  */
+#line 92 "CminusParser.y"
+                {
 			//printf("<Program> -> <Procedures>\n");
 		}
-#line 1369 "CminusParser.c" /* yacc.c:1646  */
+#line 1259 "CminusParser.c"
     break;
 
-  case 3:
-#line 95 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 3: /* Program: DeclList Procedures  */
+#line 96 "CminusParser.y"
+                {
 			//printf("<Program> -> <DeclList> <Procedures>\n");
 		}
-#line 1377 "CminusParser.c" /* yacc.c:1646  */
+#line 1267 "CminusParser.c"
     break;
 
-  case 4:
-#line 101 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 4: /* Procedures: ProcedureDecl Procedures  */
+#line 102 "CminusParser.y"
+                {
 			//printf("<Procedures> -> <ProcedureDecl> <Procedures>\n");
 		}
-#line 1385 "CminusParser.c" /* yacc.c:1646  */
+#line 1275 "CminusParser.c"
     break;
 
-  case 5:
-#line 105 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 5: /* Procedures: %empty  */
+#line 106 "CminusParser.y"
+                {
 			//printf("<Procedures> -> epsilon\n");
 		}
-#line 1393 "CminusParser.c" /* yacc.c:1646  */
+#line 1283 "CminusParser.c"
     break;
 
-  case 6:
-#line 111 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 6: /* ProcedureDecl: ProcedureHead ProcedureBody  */
+#line 112 "CminusParser.y"
+                {
 			//printf("<ProcedureDecl> -> <ProcedureHead> <ProcedureBody>\n");
 		}
-#line 1401 "CminusParser.c" /* yacc.c:1646  */
+#line 1291 "CminusParser.c"
     break;
 
-  case 7:
-#line 117 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 7: /* ProcedureHead: FunctionDecl DeclList  */
+#line 118 "CminusParser.y"
+                {
 			//printf("<ProcedureHead> -> <FunctionDecl> <DeclList>\n");
 		}
-#line 1409 "CminusParser.c" /* yacc.c:1646  */
+#line 1299 "CminusParser.c"
     break;
 
-  case 8:
-#line 121 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 8: /* ProcedureHead: FunctionDecl  */
+#line 122 "CminusParser.y"
+                {
 			//printf("<ProcedureHead> -> <FunctionDecl>\n");
 		}
-#line 1417 "CminusParser.c" /* yacc.c:1646  */
+#line 1307 "CminusParser.c"
     break;
 
-  case 9:
-#line 127 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 9: /* FunctionDecl: Type IDENTIFIER LPAREN RPAREN LBRACE  */
+#line 128 "CminusParser.y"
+                {
 			//printf("<FunctionDecl> ->  <Type> <IDENTIFIER> <LP> <RP> <LBR>\n"); 
 		}
-#line 1425 "CminusParser.c" /* yacc.c:1646  */
+#line 1315 "CminusParser.c"
     break;
 
-  case 10:
-#line 133 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 10: /* ProcedureBody: StatementList RBRACE  */
+#line 134 "CminusParser.y"
+                {
 			//printf("<ProcedureBody> -> <StatementList> <RBR>\n");
 		}
-#line 1433 "CminusParser.c" /* yacc.c:1646  */
+#line 1323 "CminusParser.c"
     break;
 
-  case 11:
-#line 140 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 11: /* DeclList: Type IdentifierList SEMICOLON  */
+#line 141 "CminusParser.y"
+                {
 			//printf("<DeclList> -> <Type> <IdentifierList> <SC>\n");
 		}
-#line 1441 "CminusParser.c" /* yacc.c:1646  */
+#line 1331 "CminusParser.c"
     break;
 
-  case 12:
-#line 144 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 12: /* DeclList: DeclList Type IdentifierList SEMICOLON  */
+#line 145 "CminusParser.y"
+                {
 			//printf("<DeclList> -> <DeclList> <Type> <IdentifierList> <SC>\n");
 	 	}
-#line 1449 "CminusParser.c" /* yacc.c:1646  */
+#line 1339 "CminusParser.c"
     break;
 
-  case 13:
-#line 151 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 13: /* IdentifierList: VarDecl  */
+#line 152 "CminusParser.y"
+                {
 			//printf("<IdentifierList> -> <VarDecl>\n");
 		}
-#line 1457 "CminusParser.c" /* yacc.c:1646  */
+#line 1347 "CminusParser.c"
     break;
 
-  case 14:
-#line 156 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 14: /* IdentifierList: IdentifierList COMMA VarDecl  */
+#line 157 "CminusParser.y"
+                {
 			//printf("<IdentifierList> -> <IdentifierList> <CM> <VarDecl>\n");
 		}
-#line 1465 "CminusParser.c" /* yacc.c:1646  */
+#line 1355 "CminusParser.c"
     break;
 
-  case 15:
-#line 162 "CminusParser.y" /* yacc.c:1646  */
-    { 
-			setValue((yyvsp[0]), g_GP_NEXT_OFFSET);
+  case 15: /* VarDecl: IDENTIFIER  */
+#line 163 "CminusParser.y"
+                { 
+			setValue(yyvsp[0], g_GP_NEXT_OFFSET);
 			g_GP_NEXT_OFFSET += 4; // next slot for a 4B value.
 		}
-#line 1474 "CminusParser.c" /* yacc.c:1646  */
+#line 1364 "CminusParser.c"
     break;
 
-  case 16:
-#line 167 "CminusParser.y" /* yacc.c:1646  */
-    {
-			setValue((yyvsp[-3]), g_GP_NEXT_OFFSET);
-			g_GP_NEXT_OFFSET += (4*(yyvsp[-1])); // next slot for a 4B value.
+  case 16: /* VarDecl: IDENTIFIER LBRACKET INTCON RBRACKET  */
+#line 168 "CminusParser.y"
+                {
+			setValue(yyvsp[-3], g_GP_NEXT_OFFSET);
+			g_GP_NEXT_OFFSET += (4*yyvsp[-1]); // next slot for a 4B value.
 		}
-#line 1483 "CminusParser.c" /* yacc.c:1646  */
+#line 1373 "CminusParser.c"
     break;
 
-  case 17:
-#line 174 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 17: /* Type: INTEGER  */
+#line 175 "CminusParser.y"
+                { 
 			//printf("<Type> -> <INTEGER>\n");
 		}
-#line 1491 "CminusParser.c" /* yacc.c:1646  */
+#line 1381 "CminusParser.c"
     break;
 
-  case 18:
-#line 180 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 18: /* Statement: Assignment  */
+#line 181 "CminusParser.y"
+                { 
 			//$$=$1;
 			//printf("<Statement> -> <Assignment>\n");
 		}
-#line 1500 "CminusParser.c" /* yacc.c:1646  */
+#line 1390 "CminusParser.c"
     break;
 
-  case 19:
-#line 185 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 19: /* Statement: IfStatement  */
+#line 186 "CminusParser.y"
+                { 
                     // if-then/if-then-else was completely parsed, but needs to be printed
                     // placing the code here so it is written only once
 
@@ -1509,486 +1399,487 @@ yyreduce:
                     print_label(IS_IN_ELSE? ELSE_LBL : IF_LBL);
                     if (IDX_TOP == 0) {   // if there is only 1 element left in the stack
                         elt_t* e = POP(); // stack is empty here
-                        puts(e->buffer);  // print to file
+                        outputLine(e->buffer);  // print to file
                         elt_destroy(e);   // free memory
                     } else {
                         MERGE_LEVELS(2ul);
                     }
 		}
-#line 1519 "CminusParser.c" /* yacc.c:1646  */
+#line 1409 "CminusParser.c"
     break;
 
-  case 20:
-#line 200 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 20: /* Statement: WhileStatement  */
+#line 201 "CminusParser.y"
+                { 
                     issue_jmp(WHILE_START_LBL);
                     print_label(WHILE_END_LBL);
                     if (IDX_TOP == 0) {   // if there is only 1 element left in the stack
                         elt_t* e = POP(); // stack is empty here
-                        puts(e->buffer);  // print to file
+                        outputLine(e->buffer);  // print to file
                         elt_destroy(e);   // free memory
                     } else {
                         MERGE_LEVELS(2ul);
                     }
 		}
-#line 1535 "CminusParser.c" /* yacc.c:1646  */
+#line 1425 "CminusParser.c"
     break;
 
-  case 21:
-#line 212 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 21: /* Statement: IOStatement  */
+#line 213 "CminusParser.y"
+                { 
 			//printf("<Statement> -> <IOStatement>\n");
 		}
-#line 1543 "CminusParser.c" /* yacc.c:1646  */
+#line 1433 "CminusParser.c"
     break;
 
-  case 22:
-#line 216 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 22: /* Statement: ReturnStatement  */
+#line 217 "CminusParser.y"
+                { 
 			//printf("<Statement> -> <ReturnStatement>\n");
 		}
-#line 1551 "CminusParser.c" /* yacc.c:1646  */
+#line 1441 "CminusParser.c"
     break;
 
-  case 23:
-#line 220 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 23: /* Statement: ExitStatement  */
+#line 221 "CminusParser.y"
+                { 
 			//printf("<Statement> -> <ExitStatement>\n");
 		}
-#line 1559 "CminusParser.c" /* yacc.c:1646  */
+#line 1449 "CminusParser.c"
     break;
 
-  case 24:
-#line 224 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 24: /* Statement: CompoundStatement  */
+#line 225 "CminusParser.y"
+                { 
 			//printf("<Statement> -> <CompoundStatement>\n");
 		}
-#line 1567 "CminusParser.c" /* yacc.c:1646  */
+#line 1457 "CminusParser.c"
     break;
 
-  case 25:
-#line 230 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 25: /* Assignment: Variable ASSIGN Expr SEMICOLON  */
+#line 231 "CminusParser.y"
+                {
 			// $1 == reg index of target addr
 			// $3 == reg index of value to store
-			issue_sw((yyvsp[-1]), (yyvsp[-3]), 0);
-			reg_free((yyvsp[-1]));
-			reg_free((yyvsp[-3]));
+			issue_sw(yyvsp[-1], yyvsp[-3], 0);
+			reg_free(yyvsp[-1]);
+			reg_free(yyvsp[-3]);
 		}
-#line 1579 "CminusParser.c" /* yacc.c:1646  */
+#line 1469 "CminusParser.c"
     break;
 
-  case 26:
-#line 240 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 26: /* IfStatement: IF TestAndThen ELSE CompoundStatement  */
+#line 241 "CminusParser.y"
+                {
 		}
-#line 1586 "CminusParser.c" /* yacc.c:1646  */
+#line 1476 "CminusParser.c"
     break;
 
-  case 27:
-#line 243 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 27: /* IfStatement: IF TestAndThen  */
+#line 244 "CminusParser.y"
+                {
 		}
-#line 1593 "CminusParser.c" /* yacc.c:1646  */
+#line 1483 "CminusParser.c"
     break;
 
-  case 28:
-#line 249 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 28: /* TestAndThen: Test CompoundStatement  */
+#line 250 "CminusParser.y"
+                {
 		}
-#line 1600 "CminusParser.c" /* yacc.c:1646  */
+#line 1490 "CminusParser.c"
     break;
 
-  case 29:
-#line 254 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 29: /* Test: LPAREN Expr RPAREN  */
+#line 255 "CminusParser.y"
+                {
                     // $2 == register containing result of test expression
                     PUSH(); // enter new ctrl flow context
                     IF_LBL = g_NXT_LBL_ID++;
                     // if condition result in $2 is false goto end of if-block
-                    issue_beq((yyvsp[-1]), ZERO, IF_LBL);
-                    reg_free((yyvsp[-1]));
+                    issue_beq(yyvsp[-1], ZERO, IF_LBL);
+                    reg_free(yyvsp[-1]);
 		}
-#line 1613 "CminusParser.c" /* yacc.c:1646  */
+#line 1503 "CminusParser.c"
     break;
 
-  case 30:
-#line 266 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 30: /* WhileStatement: WhileToken WhileExpr Statement  */
+#line 267 "CminusParser.y"
+                {
 		}
-#line 1620 "CminusParser.c" /* yacc.c:1646  */
+#line 1510 "CminusParser.c"
     break;
 
-  case 31:
-#line 271 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 31: /* WhileExpr: LPAREN Expr RPAREN  */
+#line 272 "CminusParser.y"
+                {
                     // $2 == register containing result of test expression
                     // if condition result in $2 is false goto end of while-block
-                    issue_beq((yyvsp[-1]), ZERO, WHILE_END_LBL);
-                    reg_free((yyvsp[-1]));
+                    issue_beq(yyvsp[-1], ZERO, WHILE_END_LBL);
+                    reg_free(yyvsp[-1]);
 		}
-#line 1631 "CminusParser.c" /* yacc.c:1646  */
+#line 1521 "CminusParser.c"
     break;
 
-  case 32:
-#line 280 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 32: /* WhileToken: WHILE  */
+#line 281 "CminusParser.y"
+                {
                     PUSH(); // enter new ctrl flow context
                     WHILE_START_LBL = g_NXT_LBL_ID++;
                     print_label(WHILE_START_LBL);
                     WHILE_END_LBL   = g_NXT_LBL_ID++;
 		}
-#line 1642 "CminusParser.c" /* yacc.c:1646  */
+#line 1532 "CminusParser.c"
     break;
 
-  case 33:
-#line 290 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 33: /* IOStatement: READ LPAREN Variable RPAREN SEMICOLON  */
+#line 291 "CminusParser.y"
+                {
 		  reg_idx_t reg = reg_alloc();
 		  read_int(reg); // read value from stdin and store into reg
-		  issue_sw(reg, (yyvsp[-2]), 0); // store reg's content at variable's location
+		  issue_sw(reg, yyvsp[-2], 0); // store reg's content at variable's location
 		  reg_free(reg);
 		}
-#line 1653 "CminusParser.c" /* yacc.c:1646  */
+#line 1543 "CminusParser.c"
     break;
 
-  case 34:
-#line 297 "CminusParser.y" /* yacc.c:1646  */
-    {
-			write_reg_value((yyvsp[-2]));
+  case 34: /* IOStatement: WRITE LPAREN Expr RPAREN SEMICOLON  */
+#line 298 "CminusParser.y"
+                {
+			write_reg_value(yyvsp[-2]);
 			write_new_line();
-			reg_free((yyvsp[-2]));
+			reg_free(yyvsp[-2]);
 		}
-#line 1663 "CminusParser.c" /* yacc.c:1646  */
+#line 1553 "CminusParser.c"
     break;
 
-  case 35:
-#line 303 "CminusParser.y" /* yacc.c:1646  */
-    {
-			write_const_string((yyvsp[-2]));
+  case 35: /* IOStatement: WRITE LPAREN StringConstant RPAREN SEMICOLON  */
+#line 304 "CminusParser.y"
+                {
+			write_const_string(yyvsp[-2]);
 			write_new_line();
-			reg_free((yyvsp[-2]));
+			reg_free(yyvsp[-2]);
 		}
-#line 1673 "CminusParser.c" /* yacc.c:1646  */
+#line 1563 "CminusParser.c"
     break;
 
-  case 36:
-#line 311 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 36: /* ReturnStatement: RETURN Expr SEMICOLON  */
+#line 312 "CminusParser.y"
+                {
 			//printf("<ReturnStatement> -> <RETURN> <Expr> <SC>\n");
 		}
-#line 1681 "CminusParser.c" /* yacc.c:1646  */
+#line 1571 "CminusParser.c"
     break;
 
-  case 37:
-#line 317 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 37: /* ExitStatement: EXIT SEMICOLON  */
+#line 318 "CminusParser.y"
+                {
 			//printf("<ExitStatement> -> <EXIT> <SC>\n");
 		}
-#line 1689 "CminusParser.c" /* yacc.c:1646  */
+#line 1579 "CminusParser.c"
     break;
 
-  case 38:
-#line 323 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 38: /* CompoundStatement: LBRACE StatementList RBRACE  */
+#line 324 "CminusParser.y"
+                {
 			//printf("<CompoundStatement> -> <LBR> <StatementList> <RBR>\n");
 		}
-#line 1697 "CminusParser.c" /* yacc.c:1646  */
+#line 1587 "CminusParser.c"
     break;
 
-  case 39:
-#line 329 "CminusParser.y" /* yacc.c:1646  */
-    {		
+  case 39: /* StatementList: Statement  */
+#line 330 "CminusParser.y"
+                {		
 			//printf("<StatementList> -> <Statement>\n");
 		}
-#line 1705 "CminusParser.c" /* yacc.c:1646  */
+#line 1595 "CminusParser.c"
     break;
 
-  case 40:
-#line 333 "CminusParser.y" /* yacc.c:1646  */
-    {		
+  case 40: /* StatementList: StatementList Statement  */
+#line 334 "CminusParser.y"
+                {		
 			//printf("<StatementList> -> <StatementList> <Statement>\n");
 		}
-#line 1713 "CminusParser.c" /* yacc.c:1646  */
+#line 1603 "CminusParser.c"
     break;
 
-  case 41:
-#line 339 "CminusParser.y" /* yacc.c:1646  */
-    {
-			(yyval) = (yyvsp[0]);
+  case 41: /* Expr: SimpleExpr  */
+#line 340 "CminusParser.y"
+                {
+			yyval = yyvsp[0];
 		}
-#line 1721 "CminusParser.c" /* yacc.c:1646  */
+#line 1611 "CminusParser.c"
     break;
 
-  case 42:
-#line 343 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 42: /* Expr: Expr OR SimpleExpr  */
+#line 344 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_OR(reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_OR(reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1733 "CminusParser.c" /* yacc.c:1646  */
+#line 1623 "CminusParser.c"
     break;
 
-  case 43:
-#line 351 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 43: /* Expr: Expr AND SimpleExpr  */
+#line 352 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_AND(reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_AND(reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1745 "CminusParser.c" /* yacc.c:1646  */
+#line 1635 "CminusParser.c"
     break;
 
-  case 44:
-#line 359 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 44: /* Expr: NOT SimpleExpr  */
+#line 360 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_XORI(reg, (yyvsp[0]), 1);
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_XORI(reg, yyvsp[0], 1);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1756 "CminusParser.c" /* yacc.c:1646  */
+#line 1646 "CminusParser.c"
     break;
 
-  case 45:
-#line 368 "CminusParser.y" /* yacc.c:1646  */
-    {
-			(yyval) = (yyvsp[0]);
+  case 45: /* SimpleExpr: AddExpr  */
+#line 369 "CminusParser.y"
+                {
+			yyval = yyvsp[0];
 		}
-#line 1764 "CminusParser.c" /* yacc.c:1646  */
+#line 1654 "CminusParser.c"
     break;
 
-  case 46:
-#line 372 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 46: /* SimpleExpr: SimpleExpr EQ AddExpr  */
+#line 373 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			issue_op("seq", reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			issue_op("seq", reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1776 "CminusParser.c" /* yacc.c:1646  */
+#line 1666 "CminusParser.c"
     break;
 
-  case 47:
-#line 380 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 47: /* SimpleExpr: SimpleExpr NE AddExpr  */
+#line 381 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			issue_op("sne", reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			issue_op("sne", reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1788 "CminusParser.c" /* yacc.c:1646  */
+#line 1678 "CminusParser.c"
     break;
 
-  case 48:
-#line 388 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 48: /* SimpleExpr: SimpleExpr LE AddExpr  */
+#line 389 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			issue_op("sle", reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			issue_op("sle", reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1800 "CminusParser.c" /* yacc.c:1646  */
+#line 1690 "CminusParser.c"
     break;
 
-  case 49:
-#line 396 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 49: /* SimpleExpr: SimpleExpr LT AddExpr  */
+#line 397 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			issue_op("slt", reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			issue_op("slt", reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1812 "CminusParser.c" /* yacc.c:1646  */
+#line 1702 "CminusParser.c"
     break;
 
-  case 50:
-#line 404 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 50: /* SimpleExpr: SimpleExpr GE AddExpr  */
+#line 405 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			issue_op("sge", reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			issue_op("sge", reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1824 "CminusParser.c" /* yacc.c:1646  */
+#line 1714 "CminusParser.c"
     break;
 
-  case 51:
-#line 412 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 51: /* SimpleExpr: SimpleExpr GT AddExpr  */
+#line 413 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			issue_op("sgt", reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			issue_op("sgt", reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1836 "CminusParser.c" /* yacc.c:1646  */
+#line 1726 "CminusParser.c"
     break;
 
-  case 52:
-#line 422 "CminusParser.y" /* yacc.c:1646  */
-    {
-			(yyval) = (yyvsp[0]);
+  case 52: /* AddExpr: MulExpr  */
+#line 423 "CminusParser.y"
+                {
+			yyval = yyvsp[0];
 		}
-#line 1844 "CminusParser.c" /* yacc.c:1646  */
+#line 1734 "CminusParser.c"
     break;
 
-  case 53:
-#line 426 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 53: /* AddExpr: AddExpr PLUS MulExpr  */
+#line 427 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_ADD(reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_ADD(reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1856 "CminusParser.c" /* yacc.c:1646  */
+#line 1746 "CminusParser.c"
     break;
 
-  case 54:
-#line 434 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 54: /* AddExpr: AddExpr MINUS MulExpr  */
+#line 435 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_SUB(reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_SUB(reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1868 "CminusParser.c" /* yacc.c:1646  */
+#line 1758 "CminusParser.c"
     break;
 
-  case 55:
-#line 444 "CminusParser.y" /* yacc.c:1646  */
-    {
-			(yyval) = (yyvsp[0]);
+  case 55: /* MulExpr: Factor  */
+#line 445 "CminusParser.y"
+                {
+			yyval = yyvsp[0];
 		}
-#line 1876 "CminusParser.c" /* yacc.c:1646  */
+#line 1766 "CminusParser.c"
     break;
 
-  case 56:
-#line 448 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 56: /* MulExpr: MulExpr TIMES Factor  */
+#line 449 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_MUL(reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_MUL(reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1888 "CminusParser.c" /* yacc.c:1646  */
+#line 1778 "CminusParser.c"
     break;
 
-  case 57:
-#line 456 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 57: /* MulExpr: MulExpr DIVIDE Factor  */
+#line 457 "CminusParser.y"
+                {
 			reg_idx_t reg = reg_alloc();
-			ISSUE_DIV(reg, (yyvsp[-2]), (yyvsp[0]));
-			reg_free((yyvsp[-2]));
-			reg_free((yyvsp[0]));
-			(yyval) = reg;
+			ISSUE_DIV(reg, yyvsp[-2], yyvsp[0]);
+			reg_free(yyvsp[-2]);
+			reg_free(yyvsp[0]);
+			yyval = reg;
 		}
-#line 1900 "CminusParser.c" /* yacc.c:1646  */
+#line 1790 "CminusParser.c"
     break;
 
-  case 58:
-#line 466 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 58: /* Factor: Variable  */
+#line 467 "CminusParser.y"
+                { 
 			reg_idx_t reg = reg_alloc();
-			issue_lw(reg, (yyvsp[0]), 0);
-			reg_free((yyvsp[0]));
-			(yyval) = reg; 
+			issue_lw(reg, yyvsp[0], 0);
+			reg_free(yyvsp[0]);
+			yyval = reg; 
 		}
-#line 1911 "CminusParser.c" /* yacc.c:1646  */
+#line 1801 "CminusParser.c"
     break;
 
-  case 59:
-#line 473 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 59: /* Factor: Constant  */
+#line 474 "CminusParser.y"
+                { 
 			reg_idx_t reg = reg_alloc();
-			issue_li(reg, (yyvsp[0]));
-			(yyval) = reg;
+			issue_li(reg, yyvsp[0]);
+			yyval = reg;
 		}
-#line 1921 "CminusParser.c" /* yacc.c:1646  */
+#line 1811 "CminusParser.c"
     break;
 
-  case 60:
-#line 479 "CminusParser.y" /* yacc.c:1646  */
-    {	
+  case 60: /* Factor: IDENTIFIER LPAREN RPAREN  */
+#line 480 "CminusParser.y"
+                {	
 			//printf("<Factor> -> <IDENTIFIER> <LP> <RP>\n");
 		}
-#line 1929 "CminusParser.c" /* yacc.c:1646  */
+#line 1819 "CminusParser.c"
     break;
 
-  case 61:
-#line 483 "CminusParser.y" /* yacc.c:1646  */
-    {
-			(yyval) = (yyvsp[-1]);
+  case 61: /* Factor: LPAREN Expr RPAREN  */
+#line 484 "CminusParser.y"
+                {
+			yyval = yyvsp[-1];
 		}
-#line 1937 "CminusParser.c" /* yacc.c:1646  */
+#line 1827 "CminusParser.c"
     break;
 
-  case 62:
-#line 489 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 62: /* Variable: IDENTIFIER  */
+#line 490 "CminusParser.y"
+                {
 			// $1 == index of symbol in symtable
 			reg_idx_t reg    = reg_alloc();
-			long      offset = getValue((yyvsp[0]));
+			long      offset = getValue(yyvsp[0]);
 			ISSUE_ADDI(reg, GP, offset);
-			(yyval) = reg;
+			yyval = reg;
 		}
-#line 1949 "CminusParser.c" /* yacc.c:1646  */
+#line 1839 "CminusParser.c"
     break;
 
-  case 63:
-#line 497 "CminusParser.y" /* yacc.c:1646  */
-    {
+  case 63: /* Variable: IDENTIFIER LBRACKET Expr RBRACKET  */
+#line 498 "CminusParser.y"
+                {
 			// $1 == index of symbol in symtable
 			// $3 == reg idx for result of expr
 			reg_idx_t reg    = reg_alloc(),
 				  r2	 = reg_alloc();
 			// load offset and add sizeof(int) * idx value
-			long      offset = getValue((yyvsp[-3])); // load base offset
+			long      offset = getValue(yyvsp[-3]); // load base offset
 			ISSUE_ADDI(reg, GP, offset);	 // base + offset
 			issue_li(r2, 4);
-			ISSUE_MUL((yyvsp[-1]), (yyvsp[-1]), r2);           // idx * sizeof(int)
-			ISSUE_ADD((yyvsp[-1]), (yyvsp[-1]), reg);          // base + offset + idx * 4
+			ISSUE_MUL(yyvsp[-1], yyvsp[-1], r2);           // idx * sizeof(int)
+			ISSUE_ADD(yyvsp[-1], yyvsp[-1], reg);          // base + offset + idx * 4
 			reg_free(reg);
 			reg_free(r2);
-			(yyval) = (yyvsp[-1]);
+			yyval = yyvsp[-1];
                	}
-#line 1969 "CminusParser.c" /* yacc.c:1646  */
+#line 1859 "CminusParser.c"
     break;
 
-  case 64:
-#line 515 "CminusParser.y" /* yacc.c:1646  */
-    { 
+  case 64: /* StringConstant: STRING  */
+#line 516 "CminusParser.y"
+                { 
 			reg_idx_t reg   = reg_alloc();
-			char*     label = SymGetFieldByIndex(symtab, (yyvsp[0]), SYM_NAME_FIELD);
+			char*     label = SymGetFieldByIndex(symtab, yyvsp[0], SYM_NAME_FIELD);
 			issue_la(reg, label);
-			(yyval) = reg;
+			yyval = reg;
 		}
-#line 1980 "CminusParser.c" /* yacc.c:1646  */
+#line 1870 "CminusParser.c"
     break;
 
-  case 65:
-#line 524 "CminusParser.y" /* yacc.c:1646  */
-    { 
-			(yyval) = (yyvsp[0]);
+  case 65: /* Constant: INTCON  */
+#line 525 "CminusParser.y"
+                { 
+			yyval = yyvsp[0];
 		}
-#line 1988 "CminusParser.c" /* yacc.c:1646  */
+#line 1878 "CminusParser.c"
     break;
 
 
-#line 1992 "CminusParser.c" /* yacc.c:1646  */
+#line 1882 "CminusParser.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2002,25 +1893,23 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -2031,50 +1920,14 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2103,12 +1956,11 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
-
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2125,13 +1977,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2145,7 +1998,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2157,7 +2010,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2168,26 +2021,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2203,20 +2060,18 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 529 "CminusParser.y" /* yacc.c:1906  */
+
+#line 530 "CminusParser.y"
 
 
 
@@ -2275,6 +2130,7 @@ int main(int argc, char** argv)
 	print_epilog();
 
 	print_string_labels();
+	outputFlush();
   
     stack_destroy_content(&g_STACK); // clear/clean the stack from remaining levels
 
@@ -14,6 +14,7 @@
 #include <util/symtab_stack.h>
 #include <util/dlink.h>
 #include <util/string_utils.h>
+#include <util/output.h>
 #include "mips_mgmt.h"
 
 #define SYMTABLE_SIZE 100
@@ -190,7 +191,7 @@ Statement 	: Assignment
                     print_label(IS_IN_ELSE? ELSE_LBL : IF_LBL);
                     if (IDX_TOP == 0) {   // if there is only 1 element left in the stack
                         elt_t* e = POP(); // stack is empty here
-                        puts(e->buffer);  // print to file
+                        outputLine(e->buffer);  // print to file
                         elt_destroy(e);   // free memory
                     } else {
                         MERGE_LEVELS(2ul);
@@ -202,7 +203,7 @@ Statement 	: Assignment
                     print_label(WHILE_END_LBL);
                     if (IDX_TOP == 0) {   // if there is only 1 element left in the stack
                         elt_t* e = POP(); // stack is empty here
-                        puts(e->buffer);  // print to file
+                        outputLine(e->buffer);  // print to file
                         elt_destroy(e);   // free memory
                     } else {
                         MERGE_LEVELS(2ul);
@@ -584,6 +585,7 @@ int main(int argc, char** argv)
 	print_epilog();
 
 	print_string_labels();
+	outputFlush();
   
     stack_destroy_content(&g_STACK); // clear/clean the stack from remaining levels
 
@@ -8,6 +8,7 @@
 #include <util/symtab_stack.h>
 #include <util/dlink.h>
 #include <util/string_utils.h>
+#include <util/output.h>
 #include "mips_mgmt.h"
 
 extern SymTable symtab;
@@ -148,7 +149,7 @@ write_new_line()
 {
 	PUTS("#\tprint new line");
     if ( IS_EMPTY ) 
-        printf("\tla $a0, .newline\n\tli $v0, 4\n\tsyscall\n");
+        outputString("\tla $a0, .newline\n\tli $v0, 4\n\tsyscall\n");
     else 
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tla $a0, .newline\n\tli $v0, 4\n\tsyscall\n");
@@ -161,9 +162,11 @@ void
 write_const_int(long value)
 {
 	PUTS("#\tprint constant value");
-    if ( IS_EMPTY ) 
-        printf("\tli $a0, %ld\n\tli $v0, 1\n\tsyscall\n", value);
-    else 
+    if ( IS_EMPTY ) {
+        outputString("\tli $a0, ");
+        outputLong(value);
+        outputString("\n\tli $v0, 1\n\tsyscall\n");
+    } else 
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tli $a0, %ld\n\tli $v0, 1\n\tsyscall\n", 
                             value);
@@ -178,7 +181,9 @@ write_reg_value(reg_idx_t reg)
 	assert(reg != INVALID && "reg != INVALID");
 	PUTS("#\tprint register content");
     if ( IS_EMPTY ) {
-        printf("\tmove $a0, $%s\n\tli $v0, 1\n\tsyscall\n", REG_NAME(reg) );
+        outputString("\tmove $a0, $");
+        outputString(REG_NAME(reg));
+        outputString("\n\tli $v0, 1\n\tsyscall\n");
     } else {
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tmove $a0, $%s\n\tli $v0, 1\n\tsyscall\n", 
@@ -195,9 +200,11 @@ write_const_string(reg_idx_t reg)
 {
 	assert(reg != INVALID && "reg != INVALID");
 	PUTS("#\tprint constant string");
-    if ( IS_EMPTY ) 
-        printf("\tmove $a0, $%s\n\tli $v0, 4\n\tsyscall\n", REG_NAME(reg) ); 
-    else 
+    if ( IS_EMPTY ) {
+        outputString("\tmove $a0, $");
+        outputString(REG_NAME(reg));
+        outputString("\n\tli $v0, 4\n\tsyscall\n");
+    } else 
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tmove $a0, $%s\n\tli $v0, 4\n\tsyscall\n", 
                             REG_NAME(reg) ); 
@@ -207,9 +214,11 @@ void
 read_int(reg_idx_t dst)
 {
 	PRINTF("#\t%s = <stdin>\n");
-    if ( IS_EMPTY ) 
-        printf("\tli $v0, 5\n\tsyscall\n\tmove $%s, $v0\n", REG_NAME(dst));
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tli $v0, 5\n\tsyscall\n\tmove $");
+        outputString(REG_NAME(dst));
+        outputString(", $v0\n");
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tli $v0, 5\n\tsyscall\n\tmove$%s, $v0\n",
                             REG_NAME(dst));
@@ -219,9 +228,13 @@ void
 issue_move(reg_idx_t dst, reg_idx_t src)
 {
 	PRINTF("#\t%s = %s\n", REG_NAME(dst), REG_NAME(src));
-    if ( IS_EMPTY )
-        printf("\tmove %s, %s\n", REG_NAME(dst), REG_NAME(src));
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tmove ");
+        outputString(REG_NAME(dst));
+        outputString(", ");
+        outputString(REG_NAME(src));
+        outputChar('\n');
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tmove %s, %s\n", 
                             REG_NAME(dst), REG_NAME(src));
@@ -239,10 +252,17 @@ issue_op(const char* op, reg_idx_t dst, reg_idx_t src1, reg_idx_t src2)
 {
 	PRINTF("#\t%s = %s (%s,%s)\n", 
 		REG_NAME(dst), op, REG_NAME(src1), REG_NAME(src2));
-    if ( IS_EMPTY ) 
-        printf("\t%s $%s, $%s, $%s\n", 
-                op, REG_NAME(dst), REG_NAME(src1), REG_NAME(src2));
-    else
+    if ( IS_EMPTY ) {
+        outputChar('\t');
+        outputString(op);
+        outputString(" $");
+        outputString(REG_NAME(dst));
+        outputString(", $");
+        outputString(REG_NAME(src1));
+        outputString(", $");
+        outputString(REG_NAME(src2));
+        outputChar('\n');
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\t%s $%s, $%s, $%s\n", 
                             op, REG_NAME(dst), REG_NAME(src1), REG_NAME(src2));
@@ -261,9 +281,17 @@ issue_op_imm(const char* op, reg_idx_t dst, reg_idx_t src, long value)
 {
 	PRINTF("#\t%s = %s (%s %ld)\n", 
 		REG_NAME(dst), op, REG_NAME(src), value);
-    if ( IS_EMPTY ) 
-        printf("\t%si $%s, $%s, %ld\n", op, REG_NAME(dst), REG_NAME(src), value);
-    else
+    if ( IS_EMPTY ) {
+        outputChar('\t');
+        outputString(op);
+        outputString("i $");
+        outputString(REG_NAME(dst));
+        outputString(", $");
+        outputString(REG_NAME(src));
+        outputString(", ");
+        outputLong(value);
+        outputChar('\n');
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\t%si $%s, $%s, %ld\n", 
                             op, REG_NAME(dst), REG_NAME(src), value);
@@ -273,9 +301,15 @@ void
 issue_beq(reg_idx_t op1, reg_idx_t op2, long label_id)
 {
 	PRINTF("# if %s != %s goto .L%ld\n", REG_NAME(dst), REG_NAME(base), label_id);
-    if ( IS_EMPTY )
-        printf("\tbeq $%s, $%s, .L%ld\n", REG_NAME(op1), REG_NAME(op2), label_id);
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tbeq $");
+        outputString(REG_NAME(op1));
+        outputString(", $");
+        outputString(REG_NAME(op2));
+        outputString(", .L");
+        outputLong(label_id);
+        outputChar('\n');
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP,
                             "\tbeq $%s, $%s, .L%ld\n", 
                             REG_NAME(op1), REG_NAME(op2), label_id);
@@ -295,9 +329,15 @@ issue_lw(reg_idx_t dst, reg_idx_t base, long offset)
 //	the next line is not useful anymore
 //	assert((base == GP || base == SP || base == FP) && "base is not a good base address!");
 	PRINTF("#\t%s = %s[%ld]\n", REG_NAME(dst), REG_NAME(base), offset);
-    if ( IS_EMPTY )
-        printf("\tlw $%s, %ld($%s)\n", REG_NAME(dst), offset, REG_NAME(base));
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tlw $");
+        outputString(REG_NAME(dst));
+        outputString(", ");
+        outputLong(offset);
+        outputString("($");
+        outputString(REG_NAME(base));
+        outputString(")\n");
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP, 
                             "\tlw $%s, %ld($%s)\n", 
                             REG_NAME(dst), offset, REG_NAME(base));
@@ -317,9 +357,15 @@ issue_sw(reg_idx_t src, reg_idx_t base, long offset)
 //	the next line is not useful anymore
 //	assert((base == GP || base == SP || base == FP) && "base is not a good base address!");
 	PRINTF("#\t%s[%ld] = %s\n", REG_NAME(base), offset, REG_NAME(src));
-    if ( IS_EMPTY )
-        printf("\tsw $%s, %ld($%s)\n", REG_NAME(src), offset, REG_NAME(base));
-    else 
+    if ( IS_EMPTY ) {
+        outputString("\tsw $");
+        outputString(REG_NAME(src));
+        outputString(", ");
+        outputLong(offset);
+        outputString("($");
+        outputString(REG_NAME(base));
+        outputString(")\n");
+    } else 
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP, 
                             "\tsw $%s, %ld($%s)\n", 
                             REG_NAME(src), offset, REG_NAME(base));
@@ -334,9 +380,13 @@ void
 issue_li(reg_idx_t dst, long value)
 {
 	PRINTF("#\t%s = %ld\n", REG_NAME(dst), value);
-    if ( IS_EMPTY )
-        printf("\tli $%s, %ld\n", REG_NAME(dst), value);
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tli $");
+        outputString(REG_NAME(dst));
+        outputString(", ");
+        outputLong(value);
+        outputChar('\n');
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP, "\tli $%s, %ld\n", REG_NAME(dst), value);
 }
 
@@ -349,9 +399,12 @@ void
 issue_la(reg_idx_t dst, const char* str)
 {
 	PRINTF("#\t%s = %s\n", REG_NAME(dst), str);
-    if ( IS_EMPTY )
-        printf("\tla $%s, %s\n", REG_NAME(dst), str);
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tla $");
+        outputString(REG_NAME(dst));
+        outputString(", ");
+        outputLine(str);
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP, "\tla $%s, %s\n", REG_NAME(dst), str);
 }
 
@@ -359,18 +412,22 @@ void
 issue_jmp(long label_id)
 {
     PRINTF("#\tgoto L%ld\n", label_id);
-    if ( IS_EMPTY )
-        printf("\tj .L%ld\n", label_id);
-    else
+    if ( IS_EMPTY ) {
+        outputString("\tj .L");
+        outputLong(label_id);
+        outputChar('\n');
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP, BUFFER_SZ-LEN_TOP, "\tj .L%ld\n", label_id);
 }
 
 void
 print_label(long label_id)
 {
-    if ( IS_EMPTY )
-        printf(".L%ld:\n", label_id);
-    else
+    if ( IS_EMPTY ) {
+        outputString(".L");
+        outputLong(label_id);
+        outputString(":\n");
+    } else
         LEN_TOP += snprintf(BUF_TOP+LEN_TOP,BUFFER_SZ-LEN_TOP, ".L%ld:\n", label_id);
 }
 
@@ -388,19 +445,19 @@ void
 print_prolog() 
 {
 	PUTS("# prolog");
-	puts(".data");
-	puts(".newline: .asciiz \"\\n\"");
-	puts(".text");
-	puts(".globl main");
-	puts("main: nop");
+	outputString(".data\n"
+		     ".newline: .asciiz \"\\n\"\n"
+		     ".text\n"
+		     ".globl main\n"
+		     "main: nop\n");
 }
 
 void
 print_epilog()
 {
 	PUTS("#\texit()ing the program");
-	puts("\tli $v0, 10");
-	puts("\tsyscall");
+	outputString("\tli $v0, 10\n"
+		     "\tsyscall\n");
 }
 
 long getValue(int idx);
@@ -412,10 +469,13 @@ int setValue(int idx,long value);
 void print_string_labels() {
 	int i = 0;
 	char string[10]; // we should never go beyond 10 characters for a string index...
-	printf(".data\n");
+	outputString(".data\n");
 	for (i = 0 ; i < g_STRING_INDEX; ++i) {
 		snprintf(string, 10u, "__str%d", i);
-		printf("%s: .asciiz \"%s\"\n", string, (char*)getValue(SymIndex(symtab, string)));
+		outputString(string);
+		outputString(": .asciiz \"");
+		outputString((char*)getValue(SymIndex(symtab, string)));
+		outputString("\"\n");
 	}
 }
 
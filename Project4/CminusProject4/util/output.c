@@ -0,0 +1,106 @@
+/**
+ * output.c
+ *
+ * The buffered writer for assembly code.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <util/general.h>
+#include <util/output.h>
+
+static char outputBuffer[OUTPUT_BUFFER_SIZE];
+static size_t outputLength = 0;	/**< the number of bytes in outputBuffer */
+
+/**
+ * Write the buffer to stdout and empty it.
+ */
+void outputFlush() {
+	if (outputLength > 0)
+		fwrite(outputBuffer,1,outputLength,stdout);
+	outputLength = 0;
+	fflush(stdout);
+}
+
+/**
+ * Append bytes to the output. Data longer than the buffer is written
+ * directly.
+ *
+ * @param data the bytes
+ * @param length the number of bytes
+ */
+void outputWrite(const char *data, size_t length) {
+	if (outputLength + length > OUTPUT_BUFFER_SIZE) {
+		if (outputLength > 0)
+			fwrite(outputBuffer,1,outputLength,stdout);
+		outputLength = 0;
+		if (length > OUTPUT_BUFFER_SIZE) {
+			fwrite(data,1,length,stdout);
+			return;
+		}
+	}
+
+	memcpy(outputBuffer + outputLength,data,length);
+	outputLength += length;
+}
+
+/**
+ * Append a string to the output.
+ *
+ * @param s a C string
+ */
+void outputString(const char *s) {
+	outputWrite(s,strlen(s));
+}
+
+/**
+ * Append a string and a newline to the output.
+ *
+ * @param s a C string
+ */
+void outputLine(const char *s) {
+	size_t length = strlen(s);
+
+	if (outputLength + length + 1 <= OUTPUT_BUFFER_SIZE) {
+		memcpy(outputBuffer + outputLength,s,length);
+		outputBuffer[outputLength + length] = '\n';
+		outputLength += length + 1;
+	} else {
+		outputWrite(s,length);
+		outputChar('\n');
+	}
+}
+
+/**
+ * Append a character to the output.
+ *
+ * @param c a character
+ */
+void outputChar(char c) {
+	if (outputLength == OUTPUT_BUFFER_SIZE) {
+		fwrite(outputBuffer,1,outputLength,stdout);
+		outputLength = 0;
+	}
+	outputBuffer[outputLength++] = c;
+}
+
+/**
+ * Append a number in decimal to the output.
+ *
+ * @param n a number
+ */
+void outputLong(long n) {
+	char digits[24];
+	int i = sizeof(digits);
+	unsigned long u = (n < 0) ? -(unsigned long)n : (unsigned long)n;
+
+	do {
+		digits[--i] = '0' + u % 10;
+		u /= 10;
+	} while (u > 0);
+	if (n < 0)
+		digits[--i] = '-';
+
+	outputWrite(digits + i,sizeof(digits) - i);
+}